@@ -0,0 +1,139 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmark of the checksum algorithms which can be selected for a
+// transfer. Each algorithm hashes the same in-memory buffer with its
+// fastest kernel, and the throughput is reported. The CRC-32C kernels are
+// additionally compared with each other.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include <checksum.h>
+#include <crc32c_digest.h>
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+/**
+ * Measure the throughput of a hash function, in GB/s.
+ *
+ * The hash function returns the first word of the digest. It is stored in a
+ * volatile variable, such that the computation cannot be optimized out.
+ */
+template <typename HashFunction>
+auto measure(
+    const std::string& data_, const int repetitions_, HashFunction&& hash_
+) -> double {
+    volatile std::uint32_t sink = 0;
+    const auto start = clock_t_::now();
+    for (int i = 0; i < repetitions_; ++i) {
+        sink = hash_(data_);
+    }
+    static_cast<void>(sink);
+    const auto seconds =
+        std::chrono::duration<double>(clock_t_::now() - start).count();
+    return static_cast<double>(data_.size()) * repetitions_ / seconds / 1e9;
+}
+
+} // namespace
+
+namespace po = boost::program_options;
+
+auto main(int argc, char** argv) -> int {
+    po::options_description description("Benchmark options");
+    description.add_options()("help", "Show CLI help.")(
+        "size",
+        po::value<std::size_t>()->default_value(std::size_t{1} << 28),
+        "Size of the hashed buffer, in bytes."
+    )("repetitions",
+      po::value<int>()->default_value(4),
+      "Number of times the buffer is hashed per algorithm.");
+
+    auto variables = po::variables_map{};
+    try {
+        po::store(po::parse_command_line(argc, argv, description), variables);
+        po::notify(variables);
+    } catch (std::exception& e) {
+        std::cout << "Invalid command line arguments: " << e.what()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (variables.count("help") != 0U) {
+        std::cout << description;
+        return EXIT_SUCCESS;
+    }
+    const auto repetitions = variables["repetitions"].as<int>();
+    const std::string data(variables["size"].as<std::size_t>(), 'x');
+
+    std::cout << std::left << std::setw(20) << "algorithm"
+              << "throughput [GB/s]" << '\n';
+
+    namespace detail = file_transfer::detail;
+    for (const auto algorithm :
+         {detail::checksum_algorithm::sha1,
+          detail::checksum_algorithm::crc32c,
+          detail::checksum_algorithm::xxh64,
+          detail::checksum_algorithm::blake3}) {
+        const auto throughput =
+            measure(data, repetitions, [&](const std::string& data_) {
+                auto hasher = detail::make_hasher(algorithm);
+                hasher->update(data_.data(), data_.size());
+                return static_cast<std::uint32_t>(hasher->hex_digest()[0]);
+            });
+        std::cout << std::left << std::setw(20) << detail::to_string(algorithm)
+                  << throughput << std::endl;
+    }
+
+    for (const auto& kernel : detail::get_supported_crc32c_kernels()) {
+        const auto throughput =
+            measure(data, repetitions, [&](const std::string& data_) {
+                detail::crc32c_hasher hasher{kernel};
+                hasher.update(data_.data(), data_.size());
+                return static_cast<std::uint32_t>(hasher.hex_digest()[0]);
+            });
+        std::cout << std::left << std::setw(20)
+                  << std::string("crc32c/") + kernel.name << throughput
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
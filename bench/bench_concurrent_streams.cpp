@@ -0,0 +1,340 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmark of the service engines with many concurrent "DownloadFile"
+// streams. For each engine and each number of streams, an in-process server
+// is started, and the given number of clients download the same file
+// concurrently. The wall-clock time, the aggregate throughput, and the
+// per-stream latencies are reported.
+//
+// With --striped, the streams instead download disjoint stripes of the
+// file, and the throughput refers to the single file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include <grpcpp/grpcpp.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include <filetransfer_callback_service.h>
+#include <filetransfer_service.h>
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+using clock_t_ = std::chrono::steady_clock;
+
+auto make_service(
+    const std::string& engine_, const file_transfer::ServiceOptions& options_
+) -> std::unique_ptr<grpc::Service> {
+    if (engine_ == "callback") {
+        return std::make_unique<file_transfer::FileTransferCallbackServiceImpl>(
+            options_
+        );
+    }
+    return std::make_unique<file_transfer::FileTransferServiceImpl>(options_);
+}
+
+/**
+ * Get the number of bytes in the ranges returned by the server.
+ */
+auto get_num_range_bytes(const grpc::ClientContext& context_)
+    -> std::int64_t {
+    const auto& server_metadata = context_.GetServerInitialMetadata();
+    const auto it = server_metadata.find("ansys-filetransfer-ranges");
+    std::int64_t num_bytes = 0;
+    if (it == server_metadata.end()) {
+        return num_bytes;
+    }
+    std::istringstream ranges{std::string(it->second.data(), it->second.size())
+    };
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        num_bytes += std::stoll(range.substr(range.find(':') + 1));
+    }
+    return num_bytes;
+}
+
+/**
+ * Download the file once, and return whether the download succeeded.
+ */
+auto download(
+    api::FileTransferService::Stub& stub_,
+    const std::string& file_name_,
+    const std::int64_t chunk_size_,
+    const std::string& stripe_
+) -> bool {
+    grpc::ClientContext context;
+    if (!stripe_.empty()) {
+        context.AddMetadata("ansys-filetransfer-stripe", stripe_);
+    }
+    auto stream = stub_.DownloadFile(&context);
+
+    api::DownloadFileRequest request;
+    request.mutable_initialize()->set_filename(file_name_);
+    request.mutable_initialize()->set_chunk_size(chunk_size_);
+    stream->Write(request);
+
+    api::DownloadFileResponse response;
+    if (!stream->Read(&response)) {
+        return stream->Finish().ok();
+    }
+    const auto file_size = stripe_.empty() ? response.file_info().size()
+                                           : get_num_range_bytes(context);
+
+    request.Clear();
+    request.mutable_receive_data();
+    stream->Write(request);
+    auto num_bytes_received = decltype(file_size){0};
+    while (num_bytes_received < file_size && stream->Read(&response)) {
+        num_bytes_received += static_cast<decltype(file_size)>(
+            response.file_data().data().size()
+        );
+    }
+
+    request.Clear();
+    request.mutable_finalize();
+    stream->Write(request);
+    stream->WritesDone();
+    while (stream->Read(&response)) {
+    }
+    return stream->Finish().ok() && num_bytes_received == file_size;
+}
+
+struct run_result {
+    double wall_seconds;
+    std::vector<double> stream_seconds;
+    std::size_t num_failed;
+};
+
+auto run(
+    const std::string& engine_,
+    const file_transfer::ServiceOptions& options_,
+    const std::size_t num_streams_,
+    const std::string& file_name_,
+    const std::int64_t chunk_size_,
+    const bool striped_
+) -> run_result {
+    const auto service = make_service(engine_, options_);
+    grpc::ServerBuilder builder;
+    int port = 0;
+    builder.AddListeningPort(
+        "localhost:0", grpc::InsecureServerCredentials(), &port
+    );
+    builder.RegisterService(service.get());
+    const auto server = builder.BuildAndStart();
+
+    // Spread the streams over several connections, as separate clients
+    // would.
+    constexpr std::size_t streams_per_channel = 100;
+    std::vector<std::unique_ptr<api::FileTransferService::Stub>> stubs;
+    for (std::size_t i = 0; i < num_streams_; i += streams_per_channel) {
+        grpc::ChannelArguments channel_args;
+        channel_args.SetInt("channel_id", static_cast<int>(i));
+        stubs.push_back(api::FileTransferService::NewStub(grpc::CreateCustomChannel(
+            "localhost:" + std::to_string(port),
+            grpc::InsecureChannelCredentials(),
+            channel_args
+        )));
+    }
+
+    run_result result{0.0, std::vector<double>(num_streams_, 0.0), 0};
+    std::vector<char> failed(num_streams_, 0);
+    std::vector<std::thread> clients;
+    const auto start = clock_t_::now();
+    for (std::size_t i = 0; i < num_streams_; ++i) {
+        clients.emplace_back([&, i]() {
+            const auto stream_start = clock_t_::now();
+            const auto stripe =
+                striped_ ? std::to_string(i) + "/" + std::to_string(num_streams_)
+                         : std::string{};
+            failed[i] = download(
+                            *stubs[i / streams_per_channel],
+                            file_name_,
+                            chunk_size_,
+                            stripe
+                        )
+                            ? 0
+                            : 1;
+            result.stream_seconds[i] =
+                std::chrono::duration<double>(clock_t_::now() - stream_start)
+                    .count();
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    result.wall_seconds =
+        std::chrono::duration<double>(clock_t_::now() - start).count();
+    result.num_failed =
+        static_cast<std::size_t>(std::count(failed.begin(), failed.end(), 1));
+
+    server->Shutdown();
+    return result;
+}
+
+auto percentile(std::vector<double> values_, const double fraction_)
+    -> double {
+    std::sort(values_.begin(), values_.end());
+    const auto index = static_cast<std::size_t>(
+        fraction_ * static_cast<double>(values_.size() - 1)
+    );
+    return values_[index];
+}
+
+} // namespace
+
+namespace po = boost::program_options;
+
+auto main(int argc, char** argv) -> int {
+    po::options_description description("Benchmark options");
+    description.add_options()("help", "Show CLI help.")(
+        "engines",
+        po::value<std::vector<std::string>>()->multitoken()->default_value(
+            {"sync", "callback"}, "sync callback"
+        ),
+        "Engines to benchmark."
+    )("streams",
+      po::value<std::vector<std::size_t>>()->multitoken()->default_value(
+          {10, 100, 1000}, "10 100 1000"
+      ),
+      "Numbers of concurrent streams to benchmark.")(
+        "file-size",
+        po::value<std::size_t>()->default_value(std::size_t{1} << 20),
+        "Size of the downloaded file, in bytes."
+    )("chunk-size",
+      po::value<std::int64_t>()->default_value(std::int64_t{1} << 16),
+      "Chunk size requested by the clients, in bytes.")(
+        "io-backend",
+        po::value<std::string>()->default_value("stream"),
+        "Backend used to read the file."
+    )("striped",
+      po::bool_switch(),
+      "Download disjoint stripes of the file, instead of the whole file per "
+      "stream.");
+
+    auto variables = po::variables_map{};
+    try {
+        po::store(po::parse_command_line(argc, argv, description), variables);
+        po::notify(variables);
+    } catch (std::exception& e) {
+        std::cout << "Invalid command line arguments: " << e.what()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (variables.count("help") != 0U) {
+        std::cout << description;
+        return EXIT_SUCCESS;
+    }
+    // The per-chunk log output would dominate the measurement.
+    boost::log::core::get()->set_filter(
+        boost::log::trivial::severity >= boost::log::trivial::warning
+    );
+
+    const auto file_size = variables["file-size"].as<std::size_t>();
+    const auto chunk_size = variables["chunk-size"].as<std::int64_t>();
+    const auto striped = variables["striped"].as<bool>();
+    file_transfer::ServiceOptions options;
+    options.io_backend = file_transfer::detail::io_backend_from_string(
+        variables["io-backend"].as<std::string>()
+    );
+    // As in the server, the callback engine runs the session steps on a
+    // separate thread pool.
+    options.session_thread_pool = std::make_shared<boost::asio::thread_pool>(8);
+
+    const auto file_path = boost::filesystem::temp_directory_path() /
+                           boost::filesystem::unique_path();
+    {
+        boost::filesystem::ofstream out_file{file_path, std::ios_base::binary};
+        const std::string block(4096, 'x');
+        for (std::size_t i = 0; i < file_size; i += block.size()) {
+            out_file.write(
+                block.data(),
+                static_cast<std::streamsize>(
+                    std::min(block.size(), file_size - i)
+                )
+            );
+        }
+    }
+
+    std::cout << std::left << std::setw(10) << "engine" << std::setw(10)
+              << "streams" << std::setw(12) << "wall [s]" << std::setw(14)
+              << "total [MB/s]" << std::setw(12) << "p50 [s]"
+              << std::setw(12) << "p99 [s]"
+              << "failed" << '\n';
+    for (const auto& engine : variables["engines"].as<std::vector<std::string>>(
+         )) {
+        for (const auto num_streams :
+             variables["streams"].as<std::vector<std::size_t>>()) {
+            const auto result = run(
+                engine,
+                options,
+                num_streams,
+                file_path.string(),
+                chunk_size,
+                striped
+            );
+            const auto total_mb =
+                static_cast<double>(file_size * (striped ? 1 : num_streams)) /
+                1e6;
+            std::cout << std::left << std::setw(10) << engine << std::setw(10)
+                      << num_streams << std::setw(12) << result.wall_seconds
+                      << std::setw(14) << total_mb / result.wall_seconds
+                      << std::setw(12)
+                      << percentile(result.stream_seconds, 0.5)
+                      << std::setw(12)
+                      << percentile(result.stream_seconds, 0.99)
+                      << result.num_failed << std::endl;
+        }
+    }
+
+    boost::filesystem::remove(file_path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmark of the I/O backends. A file is read in chunks, the way a
+// download reads it, and written in chunks, the way an upload writes it.
+// The throughput and the number of system calls per GB are reported for
+// each backend.
+//
+// The system calls are counted from the read and write calls in
+// /proc/self/io, plus the io_uring_enter calls, so they are only available
+// on Linux. Unless the page cache is dropped between the runs, the reads
+// are served from memory, which shows the overhead of the backends rather
+// than the speed of the disk.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include <file_io.h>
+#include <io_uring_queue.h>
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+namespace detail = file_transfer::detail;
+
+/**
+ * Count the system calls which transfer file data, or return 0 if they
+ * cannot be counted.
+ */
+auto count_syscalls() -> std::uint64_t {
+    std::uint64_t count = detail::io_uring_queue::num_enter_calls();
+    std::ifstream io_file{"/proc/self/io"};
+    std::string key;
+    std::uint64_t value = 0;
+    while (io_file >> key >> value) {
+        if (key == "syscr:" || key == "syscw:") {
+            count += value;
+        }
+    }
+    return count;
+}
+
+struct measurement {
+    double throughput = 0;
+    double syscalls_per_gb = 0;
+};
+
+/**
+ * Measure the throughput in GB/s and the system calls per GB of a function
+ * which transfers the given number of bytes.
+ */
+template <typename Function>
+auto measure(std::uint64_t num_bytes_, int repetitions_, Function&& transfer_)
+    -> measurement {
+    const auto syscalls_before = count_syscalls();
+    const auto start = clock_t_::now();
+    for (int i = 0; i < repetitions_; ++i) {
+        transfer_();
+    }
+    const auto seconds =
+        std::chrono::duration<double>(clock_t_::now() - start).count();
+    const auto syscalls = count_syscalls() - syscalls_before;
+    const auto gigabytes =
+        static_cast<double>(num_bytes_) * repetitions_ / 1e9;
+    return {gigabytes / seconds, static_cast<double>(syscalls) / gigabytes};
+}
+
+/**
+ * Read the file in chunks, prefetching the next chunk, as a download does.
+ */
+auto read_file(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    std::size_t chunk_size_,
+    detail::io_backend backend_
+) -> void {
+    const auto reader = detail::open_file_reader(path_, file_size_, backend_);
+    std::string chunk;
+    for (std::uint64_t offset = 0; offset < file_size_;) {
+        const auto size = static_cast<std::size_t>(
+            std::min<std::uint64_t>(chunk_size_, file_size_ - offset)
+        );
+        reader->read(offset, size, chunk);
+        offset += size;
+        if (offset < file_size_) {
+            reader->prefetch(
+                offset,
+                static_cast<std::size_t>(
+                    std::min<std::uint64_t>(chunk_size_, file_size_ - offset)
+                )
+            );
+        }
+    }
+}
+
+/**
+ * Write a file in chunks, as a sequential upload does.
+ */
+auto write_file(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    const std::string& chunk_,
+    detail::io_backend backend_
+) -> void {
+    const auto buffer = detail::open_file_writer(
+        path_, std::ios_base::out | std::ios_base::binary, backend_
+    );
+    for (std::uint64_t offset = 0; offset < file_size_;) {
+        const auto size = static_cast<std::streamsize>(
+            std::min<std::uint64_t>(chunk_.size(), file_size_ - offset)
+        );
+        if (buffer->sputn(chunk_.data(), size) != size) {
+            throw std::runtime_error("Could not write the file.");
+        }
+        offset += static_cast<std::uint64_t>(size);
+    }
+    if (buffer->pubsync() != 0) {
+        throw std::runtime_error("Could not write the file.");
+    }
+}
+
+auto print_row(
+    const std::string& operation_,
+    const std::string& backend_,
+    const measurement& result_
+) -> void {
+    std::cout << std::left << std::setw(8) << operation_ << std::setw(12)
+              << backend_ << std::setw(20) << result_.throughput
+              << result_.syscalls_per_gb << std::endl;
+}
+
+} // namespace
+
+namespace po = boost::program_options;
+
+auto main(int argc, char** argv) -> int {
+    po::options_description description("Benchmark options");
+    description.add_options()("help", "Show CLI help.")(
+        "directory",
+        po::value<std::string>()->default_value(
+            boost::filesystem::temp_directory_path().string()
+        ),
+        "Directory in which the benchmark files are created."
+    )("size",
+      po::value<std::uint64_t>()->default_value(std::uint64_t{1} << 28),
+      "Size of the benchmark file, in bytes."
+    )("chunk-size",
+      po::value<std::size_t>()->default_value(std::size_t{1} << 20),
+      "Size of the chunks which are read and written, in bytes."
+    )("repetitions",
+      po::value<int>()->default_value(4),
+      "Number of times the file is read or written per backend.");
+
+    auto variables = po::variables_map{};
+    try {
+        po::store(po::parse_command_line(argc, argv, description), variables);
+        po::notify(variables);
+    } catch (std::exception& e) {
+        std::cout << "Invalid command line arguments: " << e.what()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (variables.count("help") != 0U) {
+        std::cout << description;
+        return EXIT_SUCCESS;
+    }
+    const auto file_size = variables["size"].as<std::uint64_t>();
+    const auto chunk_size = variables["chunk-size"].as<std::size_t>();
+    const auto repetitions = variables["repetitions"].as<int>();
+    const auto path =
+        boost::filesystem::path{variables["directory"].as<std::string>()} /
+        boost::filesystem::unique_path("bench-io-%%%%-%%%%");
+
+    std::vector<std::pair<std::string, detail::io_backend>> backends{
+        {"stream", detail::io_backend::stream},
+        {"mmap", detail::io_backend::mmap},
+    };
+#ifndef _WIN32
+    backends.emplace_back("pread", detail::io_backend::pread);
+#endif
+    backends.emplace_back("io_uring", detail::io_backend::io_uring);
+    if (!detail::io_uring_queue::is_supported()) {
+        std::cout << "io_uring is not supported, the 'io_uring' backend "
+                     "falls back to another backend."
+                  << std::endl;
+    }
+
+    std::cout << std::left << std::setw(8) << "op" << std::setw(12)
+              << "backend" << std::setw(20) << "throughput [GB/s]"
+              << "syscalls / GB" << '\n';
+
+    const std::string chunk(chunk_size, 'x');
+    int exit_code = EXIT_SUCCESS;
+    try {
+        // Only the io_uring backend writes differently from the streams.
+        for (const auto& [name, backend] : backends) {
+            if (backend != detail::io_backend::stream &&
+                backend != detail::io_backend::io_uring) {
+                continue;
+            }
+            const auto result = measure(file_size, repetitions, [&]() {
+                write_file(path, file_size, chunk, backend);
+            });
+            print_row("write", name, result);
+        }
+        for (const auto& [name, backend] : backends) {
+            const auto result = measure(file_size, repetitions, [&]() {
+                read_file(path, file_size, chunk_size, backend);
+            });
+            print_row("read", name, result);
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Benchmark failed: " << e.what() << std::endl;
+        exit_code = EXIT_FAILURE;
+    }
+    boost::system::error_code error;
+    boost::filesystem::remove(path, error);
+    return exit_code;
+}
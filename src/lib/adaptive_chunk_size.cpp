@@ -0,0 +1,66 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "adaptive_chunk_size.h"
+
+#include <algorithm>
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Weight of the newest measurement in the smoothed throughput.
+constexpr double smoothing = 0.25;
+
+/// Chunk sizes are multiples of the page size, which suits the backends
+/// that read from memory mappings or with direct I/O.
+constexpr std::size_t granularity = std::size_t{4} << 10;
+
+} // namespace
+
+adaptive_chunk_size::adaptive_chunk_size(chunk_size_limits limits_)
+    : m_limits{limits_},
+      m_current{std::clamp(m_limits.initial, m_limits.min, m_limits.max)} {}
+
+auto adaptive_chunk_size::on_chunk_sent(
+    std::size_t size_, std::chrono::nanoseconds duration_
+) -> std::size_t {
+    if (size_ == 0 || duration_.count() <= 0) {
+        return m_current;
+    }
+    const auto throughput = static_cast<double>(size_) /
+                            std::chrono::duration<double>(duration_).count();
+    m_throughput = m_throughput == 0.0
+                       ? throughput
+                       : smoothing * throughput + (1.0 - smoothing) * m_throughput;
+
+    const auto desired = m_throughput *
+                         std::chrono::duration<double>(m_limits.target_duration)
+                             .count();
+    const auto lower = static_cast<double>(std::max(m_current / 2, m_limits.min));
+    const auto upper = static_cast<double>(std::min(m_current * 2, m_limits.max));
+    const auto size = static_cast<std::size_t>(std::clamp(desired, lower, upper));
+    m_current = std::clamp(size - size % granularity, m_limits.min, m_limits.max);
+    return m_current;
+}
+
+} // namespace file_transfer::detail
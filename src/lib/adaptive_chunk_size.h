@@ -0,0 +1,86 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Bounds and target of an adaptive_chunk_size.
+ */
+struct chunk_size_limits {
+    std::size_t min = std::size_t{64} << 10;
+    /// Stays below the default 4 MiB limit on the size of messages which
+    /// gRPC clients receive, leaving room for the message framing.
+    std::size_t max = (std::size_t{4} << 20) - (std::size_t{4} << 10);
+    std::size_t initial = std::size_t{256} << 10;
+    /// Time which sending one chunk should take.
+    std::chrono::nanoseconds target_duration = std::chrono::milliseconds{20};
+};
+
+/**
+ * @brief Chunk size which adapts to the measured throughput of a transfer.
+ *
+ * The chunk size is chosen such that sending one chunk takes roughly the
+ * target duration: small enough that progress is reported regularly and
+ * slow streams are not stalled, large enough that the per-message
+ * overhead does not dominate on fast links. The throughput is smoothed
+ * over several chunks, and the size changes by at most a factor of two
+ * per chunk.
+ */
+class adaptive_chunk_size {
+public:
+    /**
+     * @brief Construct the chunk size.
+     * @param limits_ Bounds and target of the adaptation.
+     */
+    explicit adaptive_chunk_size(chunk_size_limits limits_ = {});
+
+    /**
+     * @brief Get the size of the next chunk.
+     */
+    [[nodiscard]] auto current() const -> std::size_t { return m_current; }
+
+    /**
+     * @brief Record the time it took to send a chunk, and adapt the size.
+     * @param size_ Size of the chunk.
+     * @param duration_ Time from the start of the chunk to the start of
+     *      the next one, including reading and sending it.
+     * @return The size of the next chunk.
+     */
+    auto on_chunk_sent(std::size_t size_, std::chrono::nanoseconds duration_)
+        -> std::size_t;
+
+private:
+    chunk_size_limits m_limits;
+    std::size_t m_current;
+    /// Smoothed throughput, in bytes per second. Zero until the first
+    /// measurement.
+    double m_throughput = 0.0;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,289 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "atomic_file.h"
+
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/xattr.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+#ifndef _WIN32
+/// Synchronize an open file or directory, retrying if interrupted.
+auto sync_descriptor(int fd_, bool data_only_) -> bool {
+    int result = 0;
+    do {
+#ifdef __linux__
+        result = data_only_ ? ::fdatasync(fd_) : ::fsync(fd_);
+#else
+        static_cast<void>(data_only_);
+        result = ::fsync(fd_);
+#endif
+    } while (result < 0 && errno == EINTR);
+    return result == 0;
+}
+
+/// Give a temporary file the mode, owner and access control list of the
+/// file which it replaces. Failures are only logged, since the server may
+/// not be allowed to change the owner.
+auto copy_attributes(
+    const boost::filesystem::path& target_,
+    const boost::filesystem::path& temporary_
+) -> void {
+    struct stat target_status {};
+    if (::stat(target_.c_str(), &target_status) != 0) {
+        // There is no file to replace.
+        return;
+    }
+    const auto fd = ::open(temporary_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (::fchown(fd, target_status.st_uid, target_status.st_gid) != 0) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "Could not give " << temporary_.string()
+            << " the owner of the replaced file.";
+    }
+    // The mode is set after the owner, since a change of the owner clears
+    // the set-user-ID and set-group-ID bits.
+    if (::fchmod(fd, target_status.st_mode & 07777) != 0) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Could not give " << temporary_.string()
+            << " the mode of the replaced file.";
+    }
+#ifdef __linux__
+    constexpr const char* acl_name = "system.posix_acl_access";
+    const auto acl_size = ::getxattr(target_.c_str(), acl_name, nullptr, 0);
+    if (acl_size > 0) {
+        std::vector<char> acl(static_cast<std::size_t>(acl_size));
+        const auto num_read =
+            ::getxattr(target_.c_str(), acl_name, acl.data(), acl.size());
+        if (num_read < 0 ||
+            ::fsetxattr(
+                fd, acl_name, acl.data(), static_cast<std::size_t>(num_read), 0
+            ) != 0) {
+            BOOST_LOG_TRIVIAL(warning)
+                << "Could not give " << temporary_.string()
+                << " the access control list of the replaced file.";
+        }
+    }
+#endif
+    ::close(fd);
+}
+#endif
+
+/// Follow symbolic links to the file which they point to, which need not
+/// exist.
+auto resolve_symlinks(const boost::filesystem::path& path_)
+    -> boost::filesystem::path {
+    auto result = path_;
+    // Like the operating system, give up on long chains, which may be
+    // loops.
+    for (int i = 0; i < 40; ++i) {
+        boost::system::error_code error_code;
+        const auto status =
+            boost::filesystem::symlink_status(result, error_code);
+        if (error_code || !boost::filesystem::is_symlink(status)) {
+            break;
+        }
+        const auto link = boost::filesystem::read_symlink(result, error_code);
+        if (error_code) {
+            break;
+        }
+        result = link.is_absolute() ? link : result.parent_path() / link;
+    }
+    return result;
+}
+
+} // namespace
+
+auto upload_durability_from_string(const std::string& name_)
+    -> upload_durability {
+    if (name_ == "none") {
+        return upload_durability::none;
+    }
+    if (name_ == "finalize") {
+        return upload_durability::finalize;
+    }
+    if (name_ == "periodic") {
+        return upload_durability::periodic;
+    }
+    throw std::invalid_argument("Unknown upload durability '" + name_ + "'.");
+}
+
+auto get_temporary_path(
+    const boost::filesystem::path& target_, const std::string& tag_
+) -> boost::filesystem::path {
+    const auto tag =
+        tag_.empty() ? boost::filesystem::unique_path("%%%%%%%%%%%%").string()
+                     : tag_;
+    const auto target = resolve_symlinks(target_);
+    return target.parent_path() /
+           ("." + target.filename().string() + "." + tag + ".part");
+}
+
+auto can_replace_atomically(const boost::filesystem::path& target_) -> bool {
+#ifdef _WIN32
+    static_cast<void>(target_);
+    return true;
+#else
+    const auto target = resolve_symlinks(target_);
+    struct stat target_status {};
+    // The link count of a directory also counts its subdirectories.
+    if (::stat(target.c_str(), &target_status) == 0 &&
+        S_ISREG(target_status.st_mode) && target_status.st_nlink > 1) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "Writing " << target.string()
+            << " in place, since it has other hard links.";
+        return false;
+    }
+    const auto directory = target.has_parent_path()
+                               ? target.parent_path()
+                               : boost::filesystem::path{"."};
+    if (::access(directory.c_str(), W_OK | X_OK) != 0) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "Writing " << target.string()
+            << " in place, since its directory is not writable.";
+        return false;
+    }
+    return true;
+#endif
+}
+
+auto sync_file(const boost::filesystem::path& path_) -> void {
+#ifdef _WIN32
+    const auto handle = CreateFileW(
+        path_.wstring().c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    const auto success = handle != INVALID_HANDLE_VALUE &&
+                         FlushFileBuffers(handle) != 0;
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+    }
+#else
+    // The data written through other descriptors of the file is
+    // synchronized as well.
+    const auto fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    const auto success = fd >= 0 && sync_descriptor(fd, true);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+    if (!success) {
+        throw exceptions::internal("Could not synchronize the output file.");
+    }
+}
+
+auto commit_file(
+    const boost::filesystem::path& temporary_,
+    const boost::filesystem::path& target_,
+    bool sync_
+) -> void {
+    const auto target = resolve_symlinks(target_);
+#ifndef _WIN32
+    copy_attributes(target, temporary_);
+#endif
+    boost::system::error_code error_code;
+    boost::filesystem::rename(temporary_, target, error_code);
+    if (error_code) {
+        throw exceptions::internal(
+            "Could not move the output file into place: " +
+            error_code.message()
+        );
+    }
+#ifndef _WIN32
+    if (!sync_) {
+        return;
+    }
+    // The rename is only durable once the directory entry is on disk.
+    const auto directory = target.has_parent_path()
+                               ? target.parent_path()
+                               : boost::filesystem::path{"."};
+    const auto fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    const auto success = fd >= 0 && sync_descriptor(fd, false);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (!success) {
+        throw exceptions::internal(
+            "Could not synchronize the directory of the output file."
+        );
+    }
+#else
+    static_cast<void>(sync_);
+#endif
+}
+
+auto discard_file(const boost::filesystem::path& temporary_) noexcept
+    -> void {
+    boost::system::error_code error_code;
+    boost::filesystem::remove(temporary_, error_code);
+    if (error_code) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Could not remove the temporary file "
+            << temporary_.string() << ": " << error_code.message();
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,133 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief When the data of uploaded files is synchronized to disk.
+ */
+enum class upload_durability {
+    /// The data is left to the write-back of the operating system.
+    none,
+    /// The data is synchronized once the upload is complete, before the
+    /// file is renamed into place, and before the checkpoints of a
+    /// resumable upload are saved. The checkpoints are synchronized too.
+    finalize,
+    /// Like `finalize`, and additionally at regular intervals while the
+    /// upload is in progress.
+    periodic,
+};
+
+/**
+ * @brief Get the upload durability from its name.
+ * @param name_ Name of the durability, as shown on the command line.
+ * @return The upload durability.
+ */
+auto upload_durability_from_string(const std::string& name_)
+    -> upload_durability;
+
+/**
+ * @brief Get the path of the temporary file to which a file is written
+ *      before it is renamed into place.
+ *
+ * The temporary file is a hidden sibling of the target, such that the
+ * rename does not cross file systems. If the target is a symbolic link,
+ * it is a sibling of the file which the link points to.
+ *
+ * @param target_ Path of the file once it is complete.
+ * @param tag_ Tag which distinguishes the temporary files of the same
+ *      target. If empty, a random tag is used.
+ * @return Path of the temporary file.
+ */
+auto get_temporary_path(
+    const boost::filesystem::path& target_, const std::string& tag_ = {}
+) -> boost::filesystem::path;
+
+/**
+ * @brief Check whether a file can be replaced by renaming a temporary
+ *      file over it, as if it had been written in place.
+ *
+ * This is not the case if the file has other hard links, which the
+ * rename would detach from the new content, or if its directory is not
+ * writable, such that no temporary file can be created next to it.
+ *
+ * @param target_ Path of the file once it is complete.
+ */
+auto can_replace_atomically(const boost::filesystem::path& target_) -> bool;
+
+/**
+ * @brief Synchronize the data of a file to disk.
+ * @param path_ Path of the file.
+ * @throws exceptions::internal if the data could not be synchronized.
+ */
+auto sync_file(const boost::filesystem::path& path_) -> void;
+
+/**
+ * @brief Rename a complete temporary file into place, replacing the
+ *      target if it exists.
+ *
+ * If the target is a symbolic link, the file which it points to is
+ * replaced. On POSIX platforms, the temporary file first receives the
+ * mode, the owner and the access control list of the replaced file, as
+ * far as the permissions of the server allow.
+ *
+ * @param temporary_ Path of the temporary file.
+ * @param target_ Path of the file once it is complete.
+ * @param sync_ Whether the rename is synchronized to disk, by syncing the
+ *      directory which contains the target. Only done on POSIX platforms.
+ * @throws exceptions::internal if the file could not be renamed.
+ */
+auto commit_file(
+    const boost::filesystem::path& temporary_,
+    const boost::filesystem::path& target_,
+    bool sync_
+) -> void;
+
+/**
+ * @brief Remove a temporary file which will not be committed, ignoring
+ *      errors.
+ * @param temporary_ Path of the temporary file.
+ */
+auto discard_file(const boost::filesystem::path& temporary_) noexcept -> void;
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,366 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "blake3_digest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace file_transfer::detail {
+
+namespace {
+
+using chaining_value_t = blake3_hasher::chaining_value_t;
+using block_words_t = std::array<std::uint32_t, 16>;
+
+constexpr chaining_value_t blake3_iv{
+    0x6A09E667,
+    0xBB67AE85,
+    0x3C6EF372,
+    0xA54FF53A,
+    0x510E527F,
+    0x9B05688C,
+    0x1F83D9AB,
+    0x5BE0CD19
+};
+
+constexpr std::array<std::size_t, 16> message_permutation{
+    2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8
+};
+
+constexpr int num_rounds = 7;
+
+/**
+ * @brief Compute the order in which each round reads the message words.
+ *
+ * The message is permuted after each round. Indexing the original message
+ * through this table avoids copying it.
+ */
+constexpr auto make_message_schedule()
+    -> std::array<std::array<std::size_t, 16>, num_rounds> {
+    std::array<std::array<std::size_t, 16>, num_rounds> schedule{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        schedule[0][i] = i;
+    }
+    for (std::size_t round = 1; round < num_rounds; ++round) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            schedule[round][i] = schedule[round - 1][message_permutation[i]];
+        }
+    }
+    return schedule;
+}
+
+constexpr auto message_schedule = make_message_schedule();
+
+constexpr std::uint32_t chunk_start = 1U << 0;
+constexpr std::uint32_t chunk_end = 1U << 1;
+constexpr std::uint32_t parent = 1U << 2;
+constexpr std::uint32_t root = 1U << 3;
+
+constexpr auto rotr(std::uint32_t value_, int shift_) -> std::uint32_t {
+    return (value_ >> shift_) | (value_ << (32 - shift_));
+}
+
+auto load_little_endian(const unsigned char* data_) -> std::uint32_t {
+    return static_cast<std::uint32_t>(data_[0]) |
+           (static_cast<std::uint32_t>(data_[1]) << 8) |
+           (static_cast<std::uint32_t>(data_[2]) << 16) |
+           (static_cast<std::uint32_t>(data_[3]) << 24);
+}
+
+auto load_block_words(const unsigned char* block_) -> block_words_t {
+    block_words_t words{};
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] = load_little_endian(block_ + 4 * i);
+    }
+    return words;
+}
+
+template <std::size_t A, std::size_t B, std::size_t C, std::size_t D>
+inline auto g(
+    std::array<std::uint32_t, 16>& state_, std::uint32_t mx_, std::uint32_t my_
+) -> void {
+    state_[A] = state_[A] + state_[B] + mx_;
+    state_[D] = rotr(state_[D] ^ state_[A], 16);
+    state_[C] = state_[C] + state_[D];
+    state_[B] = rotr(state_[B] ^ state_[C], 12);
+    state_[A] = state_[A] + state_[B] + my_;
+    state_[D] = rotr(state_[D] ^ state_[A], 8);
+    state_[C] = state_[C] + state_[D];
+    state_[B] = rotr(state_[B] ^ state_[C], 7);
+}
+
+template <std::size_t Round>
+inline auto round_function(
+    std::array<std::uint32_t, 16>& state_, const block_words_t& message_
+) -> void {
+    constexpr const auto& s = message_schedule[Round];
+    const auto& m = message_;
+    g<0, 4, 8, 12>(state_, m[s[0]], m[s[1]]);
+    g<1, 5, 9, 13>(state_, m[s[2]], m[s[3]]);
+    g<2, 6, 10, 14>(state_, m[s[4]], m[s[5]]);
+    g<3, 7, 11, 15>(state_, m[s[6]], m[s[7]]);
+    g<0, 5, 10, 15>(state_, m[s[8]], m[s[9]]);
+    g<1, 6, 11, 12>(state_, m[s[10]], m[s[11]]);
+    g<2, 7, 8, 13>(state_, m[s[12]], m[s[13]]);
+    g<3, 4, 9, 14>(state_, m[s[14]], m[s[15]]);
+}
+
+template <std::size_t... Rounds>
+inline auto all_rounds(
+    std::array<std::uint32_t, 16>& state_,
+    const block_words_t& message_,
+    std::index_sequence<Rounds...> /*unused*/
+) -> void {
+    (round_function<Rounds>(state_, message_), ...);
+}
+
+/**
+ * @brief The BLAKE3 compression function.
+ * @return The full 16-word output. The first 8 words are the chaining
+ *      value.
+ */
+auto compress(
+    const chaining_value_t& cv_,
+    const block_words_t& message_,
+    std::uint64_t counter_,
+    std::uint32_t block_size_,
+    std::uint32_t flags_
+) -> std::array<std::uint32_t, 16> {
+    std::array<std::uint32_t, 16> state{
+        cv_[0],
+        cv_[1],
+        cv_[2],
+        cv_[3],
+        cv_[4],
+        cv_[5],
+        cv_[6],
+        cv_[7],
+        blake3_iv[0],
+        blake3_iv[1],
+        blake3_iv[2],
+        blake3_iv[3],
+        static_cast<std::uint32_t>(counter_),
+        static_cast<std::uint32_t>(counter_ >> 32),
+        block_size_,
+        flags_
+    };
+    all_rounds(state, message_, std::make_index_sequence<num_rounds>{});
+    for (std::size_t i = 0; i < 8; ++i) {
+        state[i] ^= state[i + 8];
+        state[i + 8] ^= cv_[i];
+    }
+    return state;
+}
+
+auto first_8_words(const std::array<std::uint32_t, 16>& words_)
+    -> chaining_value_t {
+    chaining_value_t result{};
+    std::copy_n(words_.begin(), result.size(), result.begin());
+    return result;
+}
+
+/**
+ * @brief Input of the compression function for a node of the tree.
+ *
+ * The compression is deferred, since the root node is compressed with an
+ * additional flag.
+ */
+struct node_output {
+    chaining_value_t input_cv;
+    block_words_t block_words;
+    std::uint64_t counter;
+    std::uint32_t block_size;
+    std::uint32_t flags;
+
+    [[nodiscard]] auto chaining_value() const -> chaining_value_t {
+        return first_8_words(
+            compress(input_cv, block_words, counter, block_size, flags)
+        );
+    }
+
+    [[nodiscard]] auto root_hash() const -> chaining_value_t {
+        return first_8_words(
+            compress(input_cv, block_words, 0, block_size, flags | root)
+        );
+    }
+};
+
+auto parent_output(
+    const chaining_value_t& left_child_, const chaining_value_t& right_child_
+) -> node_output {
+    block_words_t block_words{};
+    std::copy(left_child_.begin(), left_child_.end(), block_words.begin());
+    std::copy(
+        right_child_.begin(), right_child_.end(), block_words.begin() + 8
+    );
+    return {blake3_iv, block_words, 0, 64, parent};
+}
+
+} // namespace
+
+blake3_hasher::blake3_hasher() : m_chunk_cv{blake3_iv} {}
+
+auto blake3_hasher::chunk_length() const -> std::size_t {
+    return m_blocks_compressed * block_size + m_block_size;
+}
+
+auto blake3_hasher::update_chunk(const unsigned char* data_, std::size_t size_)
+    -> void {
+    const auto start_flag = [this]() {
+        return m_blocks_compressed == 0 ? chunk_start : 0U;
+    };
+    while (size_ > 0) {
+        // A block is only compressed once more data follows, since the
+        // last block of the chunk is compressed with different flags.
+        if (m_block_size == block_size) {
+            m_chunk_cv = first_8_words(compress(
+                m_chunk_cv,
+                load_block_words(m_block.data()),
+                m_chunk_counter,
+                block_size,
+                start_flag()
+            ));
+            ++m_blocks_compressed;
+            m_block_size = 0;
+        }
+        if (m_block_size == 0) {
+            for (; size_ > block_size; size_ -= block_size) {
+                m_chunk_cv = first_8_words(compress(
+                    m_chunk_cv,
+                    load_block_words(data_),
+                    m_chunk_counter,
+                    block_size,
+                    start_flag()
+                ));
+                ++m_blocks_compressed;
+                data_ += block_size;
+            }
+        }
+        const auto num_copied = std::min(size_, block_size - m_block_size);
+        std::memcpy(m_block.data() + m_block_size, data_, num_copied);
+        m_block_size += num_copied;
+        data_ += num_copied;
+        size_ -= num_copied;
+    }
+}
+
+auto blake3_hasher::push_chunk(
+    chaining_value_t chunk_cv_, std::uint64_t total_chunks_
+) -> void {
+    // Merge the completed subtrees. Their number is given by the number of
+    // trailing zero bits in the total number of chunks.
+    while ((total_chunks_ & 1U) == 0) {
+        --m_cv_stack_size;
+        chunk_cv_ =
+            parent_output(m_cv_stack[m_cv_stack_size], chunk_cv_)
+                .chaining_value();
+        total_chunks_ >>= 1;
+    }
+    m_cv_stack[m_cv_stack_size] = chunk_cv_;
+    ++m_cv_stack_size;
+}
+
+auto blake3_hasher::update(const char* data_, std::size_t size_) -> void {
+    const auto* data = reinterpret_cast<const unsigned char*>(data_);
+    while (size_ > 0) {
+        if (chunk_length() == chunk_size) {
+            const node_output chunk_output{
+                m_chunk_cv,
+                load_block_words(m_block.data()),
+                m_chunk_counter,
+                static_cast<std::uint32_t>(m_block_size),
+                chunk_end
+            };
+            const auto total_chunks = m_chunk_counter + 1;
+            push_chunk(chunk_output.chaining_value(), total_chunks);
+            m_chunk_cv = blake3_iv;
+            m_chunk_counter = total_chunks;
+            m_block_size = 0;
+            m_blocks_compressed = 0;
+        }
+        const auto num_taken = std::min(size_, chunk_size - chunk_length());
+        update_chunk(data, num_taken);
+        data += num_taken;
+        size_ -= num_taken;
+    }
+}
+
+auto blake3_hasher::hex_digest() const -> std::string {
+    std::array<unsigned char, block_size> last_block{};
+    std::memcpy(last_block.data(), m_block.data(), m_block_size);
+    auto output = node_output{
+        m_chunk_cv,
+        load_block_words(last_block.data()),
+        m_chunk_counter,
+        static_cast<std::uint32_t>(m_block_size),
+        (m_blocks_compressed == 0 ? chunk_start : 0U) | chunk_end
+    };
+    for (auto i = m_cv_stack_size; i > 0; --i) {
+        output = parent_output(m_cv_stack[i - 1], output.chaining_value());
+    }
+
+    std::stringstream res_stream;
+    res_stream << std::hex << std::setfill('0');
+    for (const auto& word : output.root_hash()) {
+        for (int byte = 0; byte < 4; ++byte) {
+            res_stream << std::setw(2) << ((word >> (8 * byte)) & 0xFFU);
+        }
+    }
+    return res_stream.str();
+}
+
+auto blake3_hasher::save_state() const -> std::string {
+    return save_trivial_state(
+        m_chunk_cv,
+        m_chunk_counter,
+        m_block,
+        m_block_size,
+        m_blocks_compressed,
+        m_cv_stack,
+        m_cv_stack_size
+    );
+}
+
+auto blake3_hasher::restore_state(const std::string& state_) -> void {
+    restore_trivial_state(
+        state_,
+        m_chunk_cv,
+        m_chunk_counter,
+        m_block,
+        m_block_size,
+        m_blocks_compressed,
+        m_cv_stack,
+        m_cv_stack_size
+    );
+    if (m_block_size > block_size || chunk_length() > chunk_size ||
+        m_cv_stack_size >= max_stack_depth) {
+        throw std::invalid_argument("Invalid BLAKE3 hasher state.");
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,97 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "checksum.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Incremental computation of a BLAKE3 digest.
+ *
+ * BLAKE3 splits the data into 1 KiB chunks, which are the leaves of a
+ * binary hash tree. The chaining values of completed subtrees are kept on
+ * a stack, such that the data can be hashed in a single pass. The hex
+ * digest is the default 256-bit output.
+ */
+class blake3_hasher final : public hasher {
+public:
+    /// Chaining value of a chunk or subtree.
+    using chaining_value_t = std::array<std::uint32_t, 8>;
+
+    blake3_hasher();
+
+    /**
+     * @brief Add data to the digest.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    auto update(const char* data_, std::size_t size_) -> void override;
+
+    /**
+     * @brief Get the hex digest of all data added so far.
+     */
+    [[nodiscard]] auto hex_digest() const -> std::string override;
+
+    /**
+     * @brief Get the internal state, such that hashing can be resumed later.
+     */
+    [[nodiscard]] auto save_state() const -> std::string override;
+
+    /**
+     * @brief Restore an internal state returned by save_state.
+     * @param state_ The saved state.
+     */
+    auto restore_state(const std::string& state_) -> void override;
+
+private:
+    static constexpr std::size_t block_size = 64;
+    static constexpr std::size_t chunk_size = 1024;
+    /// Enough for 2^54 chunks, the maximum input size of BLAKE3.
+    static constexpr std::size_t max_stack_depth = 54;
+
+    [[nodiscard]] auto chunk_length() const -> std::size_t;
+    auto update_chunk(const unsigned char* data_, std::size_t size_) -> void;
+    auto push_chunk(chaining_value_t chunk_cv_, std::uint64_t total_chunks_)
+        -> void;
+
+    /// State of the current chunk.
+    chaining_value_t m_chunk_cv;
+    std::uint64_t m_chunk_counter = 0;
+    std::array<unsigned char, block_size> m_block{};
+    std::size_t m_block_size = 0;
+    std::size_t m_blocks_compressed = 0;
+
+    /// Chaining values of the completed subtrees.
+    std::array<chaining_value_t, max_stack_depth> m_cv_stack{};
+    std::size_t m_cv_stack_size = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,178 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "checksum.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <stdexcept>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "blake3_digest.h"
+#include "crc32c_digest.h"
+#include "metrics.h"
+#include "sha1_digest.h"
+#include "xxh64_digest.h"
+
+namespace file_transfer::detail {
+
+auto checksum_algorithm_from_string(const std::string& name_)
+    -> checksum_algorithm {
+    if (name_ == "sha1") {
+        return checksum_algorithm::sha1;
+    }
+    if (name_ == "crc32c") {
+        return checksum_algorithm::crc32c;
+    }
+    if (name_ == "xxh64") {
+        return checksum_algorithm::xxh64;
+    }
+    if (name_ == "blake3") {
+        return checksum_algorithm::blake3;
+    }
+    throw std::invalid_argument("Unknown checksum algorithm '" + name_ + "'.");
+}
+
+auto to_string(checksum_algorithm algorithm_) -> std::string {
+    switch (algorithm_) {
+    case checksum_algorithm::sha1:
+        return "sha1";
+    case checksum_algorithm::crc32c:
+        return "crc32c";
+    case checksum_algorithm::xxh64:
+        return "xxh64";
+    case checksum_algorithm::blake3:
+        return "blake3";
+    }
+    throw std::invalid_argument("Unknown checksum algorithm.");
+}
+
+auto make_hasher(checksum_algorithm algorithm_) -> std::unique_ptr<hasher> {
+    switch (algorithm_) {
+    case checksum_algorithm::sha1:
+        return std::make_unique<sha1_hasher>();
+    case checksum_algorithm::crc32c:
+        return std::make_unique<crc32c_hasher>();
+    case checksum_algorithm::xxh64:
+        return std::make_unique<xxh64_hasher>();
+    case checksum_algorithm::blake3:
+        return std::make_unique<blake3_hasher>();
+    }
+    throw std::invalid_argument("Unknown checksum algorithm.");
+}
+
+auto digest_from_hex(const std::string& hex_digest_) -> std::string {
+    const auto nibble = [](char digit_) -> int {
+        return digit_ <= '9' ? digit_ - '0' : (digit_ | 0x20) - 'a' + 10;
+    };
+    std::string digest(hex_digest_.size() / 2, '\0');
+    for (std::size_t i = 0; i < digest.size(); ++i) {
+        digest[i] = static_cast<char>(
+            (nibble(hex_digest_[2 * i]) << 4) | nibble(hex_digest_[2 * i + 1])
+        );
+    }
+    return digest;
+}
+
+auto get_hex_digest(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    std::size_t chunk_size_
+) -> std::string {
+    std::string buffer(chunk_size_, '\0');
+    boost::filesystem::ifstream in_file{path_, std::ios_base::binary};
+    if (!in_file.good()) {
+        throw std::runtime_error("Could not open file.");
+    }
+    auto hasher = make_hasher(algorithm_);
+    while (in_file.good()) {
+        {
+            const metrics::phase_timer timer{metrics::phase::disk_read};
+            in_file.read(
+                buffer.data(), static_cast<std::streamsize>(chunk_size_)
+            );
+        }
+        const metrics::phase_timer timer{metrics::phase::hashing};
+        hasher->update(
+            buffer.data(), static_cast<std::size_t>(in_file.gcount())
+        );
+    }
+    return hasher->hex_digest();
+}
+
+auto get_hex_digest(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    io_backend backend_,
+    std::size_t chunk_size_
+) -> std::string {
+    boost::system::error_code error;
+    const auto file_size = boost::filesystem::file_size(path_, error);
+    if (error) {
+        throw std::runtime_error("Could not open file.");
+    }
+    const auto reader = open_file_reader(path_, file_size, backend_);
+    auto hasher = make_hasher(algorithm_);
+    std::string chunk;
+    for (std::uint64_t offset = 0; offset < file_size;) {
+        const auto size = static_cast<std::size_t>(
+            std::min<std::uint64_t>(chunk_size_, file_size - offset)
+        );
+        {
+            const metrics::phase_timer timer{metrics::phase::disk_read};
+            reader->read(offset, size, chunk);
+        }
+        offset += size;
+        if (offset < file_size) {
+            reader->prefetch(
+                offset,
+                static_cast<std::size_t>(
+                    std::min<std::uint64_t>(chunk_size_, file_size - offset)
+                )
+            );
+        }
+        const metrics::phase_timer timer{metrics::phase::hashing};
+        hasher->update(chunk.data(), chunk.size());
+    }
+    return hasher->hex_digest();
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,200 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "file_io.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Algorithms which can be used for the checksum of a transfer.
+ */
+enum class checksum_algorithm {
+    /// SHA1, the only algorithm known to older clients.
+    sha1,
+    /// CRC-32C (Castagnoli), hardware accelerated on x86.
+    crc32c,
+    /// 64-bit xxHash.
+    xxh64,
+    /// BLAKE3, a cryptographic hash based on a binary tree of chunks.
+    blake3,
+};
+
+/**
+ * @brief Get the checksum algorithm from its name.
+ * @param name_ Name of the algorithm, for example "sha1".
+ * @return The checksum algorithm.
+ */
+auto checksum_algorithm_from_string(const std::string& name_)
+    -> checksum_algorithm;
+
+/**
+ * @brief Get the name of a checksum algorithm.
+ * @param algorithm_ The checksum algorithm.
+ */
+auto to_string(checksum_algorithm algorithm_) -> std::string;
+
+/**
+ * @brief Interface for the incremental computation of a checksum.
+ *
+ * The data can be passed in pieces of arbitrary size, for example the
+ * chunks of a file as they are transferred.
+ */
+class hasher {
+public:
+    hasher() = default;
+    hasher(const hasher&) = default;
+    hasher& operator=(const hasher&) = default;
+    hasher(hasher&&) = default;
+    hasher& operator=(hasher&&) = default;
+    virtual ~hasher() = default;
+
+    /**
+     * @brief Add data to the checksum.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    virtual auto update(const char* data_, std::size_t size_) -> void = 0;
+
+    /**
+     * @brief Get the hex digest of all data added so far.
+     *
+     * More data can be added after the digest has been computed.
+     */
+    [[nodiscard]] virtual auto hex_digest() const -> std::string = 0;
+
+    /**
+     * @brief Get the internal state, such that hashing can be resumed later.
+     *
+     * The state is only meant to be restored by the same build of the
+     * server.
+     */
+    [[nodiscard]] virtual auto save_state() const -> std::string = 0;
+
+    /**
+     * @brief Restore an internal state returned by save_state.
+     * @param state_ The saved state.
+     * @throws std::invalid_argument if the state is malformed.
+     */
+    virtual auto restore_state(const std::string& state_) -> void = 0;
+};
+
+/**
+ * @brief Concatenate the bytes of trivially copyable values.
+ *
+ * Helper for implementing hasher::save_state.
+ */
+template <typename... Ts>
+auto save_trivial_state(const Ts&... values_) -> std::string {
+    static_assert((std::is_trivially_copyable_v<Ts> && ...));
+    std::string state;
+    (state.append(reinterpret_cast<const char*>(&values_), sizeof(Ts)), ...);
+    return state;
+}
+
+/**
+ * @brief Restore values saved by save_trivial_state.
+ *
+ * Helper for implementing hasher::restore_state. Only the total size of
+ * the state is checked, the values must be validated by the caller.
+ */
+template <typename... Ts>
+auto restore_trivial_state(const std::string& state_, Ts&... values_)
+    -> void {
+    static_assert((std::is_trivially_copyable_v<Ts> && ...));
+    if (state_.size() != (sizeof(Ts) + ...)) {
+        throw std::invalid_argument("Invalid size of the hasher state.");
+    }
+    const char* data = state_.data();
+    ((std::memcpy(&values_, data, sizeof(Ts)), data += sizeof(Ts)), ...);
+}
+
+/**
+ * @brief Create a hasher for the given checksum algorithm.
+ * @param algorithm_ The checksum algorithm.
+ */
+auto make_hasher(checksum_algorithm algorithm_) -> std::unique_ptr<hasher>;
+
+/**
+ * @brief Get the raw bytes of a hex digest.
+ * @param hex_digest_ The hex digest, as returned by hasher::hex_digest.
+ */
+auto digest_from_hex(const std::string& hex_digest_) -> std::string;
+
+/**
+ * @brief Get the hex digest of a file.
+ * @param path_ Path to the file.
+ * @param algorithm_ The checksum algorithm.
+ * @param chunk_size_ Size of the chunks to read from the file.
+ * @return Hex digest of the file.
+ */
+auto get_hex_digest(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    std::size_t chunk_size_ = std::size_t{1} << 16
+) -> std::string;
+
+/**
+ * @brief Get the hex digest of a file, read with the given I/O backend.
+ *
+ * The next chunk is prefetched while a chunk is hashed, which lets
+ * backends with asynchronous reads overlap the disk and the hashing.
+ *
+ * @param path_ Path to the file.
+ * @param algorithm_ The checksum algorithm.
+ * @param backend_ Backend used to read the file.
+ * @param chunk_size_ Size of the chunks to read from the file.
+ * @return Hex digest of the file.
+ */
+auto get_hex_digest(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    io_backend backend_,
+    std::size_t chunk_size_ = std::size_t{1} << 20
+) -> std::string;
+
+} // namespace detail
+} // namespace file_transfer
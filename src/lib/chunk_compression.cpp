@@ -0,0 +1,363 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "chunk_compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#ifdef FILE_TRANSFER_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef FILE_TRANSFER_HAS_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Header byte of a frame whose payload is the raw chunk.
+constexpr char raw_frame = 0;
+/// Size of the header of a compressed frame: the header byte, and the
+/// size of the raw chunk.
+constexpr std::size_t compressed_header_size = 5;
+/// Largest raw chunk which is compressed, such that its size fits into
+/// the header.
+constexpr std::uint32_t max_raw_size = std::uint32_t{1} << 30;
+/// Largest raw chunk which a received frame is decompressed into. A raw
+/// chunk must fit into a message, and the server keeps the 4 MiB default
+/// message size limit of gRPC, so larger chunks are never sent raw either.
+constexpr std::uint32_t max_decoded_size = std::uint32_t{4} << 20;
+
+/// Largest ratio between the raw and the compressed size which the format
+/// of an algorithm can reach, including runs of a single byte.
+auto get_max_compression_ratio(compression_algorithm algorithm_)
+    -> std::uint64_t {
+    switch (algorithm_) {
+    case compression_algorithm::zlib:
+        return 1032;
+    case compression_algorithm::zstd:
+        // An RLE block of 128 KiB takes a 3 byte header and one byte.
+        return 32768;
+    case compression_algorithm::lz4:
+        return 255;
+    }
+    throw std::invalid_argument("Unknown compression algorithm.");
+}
+
+auto get_level_range(compression_algorithm algorithm_) -> std::pair<int, int> {
+    switch (algorithm_) {
+    case compression_algorithm::zlib:
+        return {1, 9};
+    case compression_algorithm::zstd:
+#ifdef FILE_TRANSFER_HAS_ZSTD
+        return {1, ZSTD_maxCLevel()};
+#else
+        return {1, 22};
+#endif
+    case compression_algorithm::lz4:
+        return {1, 12};
+    }
+    throw std::invalid_argument("Unknown compression algorithm.");
+}
+
+#ifdef FILE_TRANSFER_HAS_ZSTD
+/// Contexts are reused for the chunks compressed by the same thread.
+auto get_zstd_compression_context() -> ZSTD_CCtx* {
+    thread_local const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>
+        context{ZSTD_createCCtx(), &ZSTD_freeCCtx};
+    return context.get();
+}
+
+auto get_zstd_decompression_context() -> ZSTD_DCtx* {
+    thread_local const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>
+        context{ZSTD_createDCtx(), &ZSTD_freeDCtx};
+    return context.get();
+}
+#endif
+
+} // namespace
+
+auto to_string(compression_algorithm algorithm_) -> std::string {
+    switch (algorithm_) {
+    case compression_algorithm::zlib:
+        return "zlib";
+    case compression_algorithm::zstd:
+        return "zstd";
+    case compression_algorithm::lz4:
+        return "lz4";
+    }
+    throw std::invalid_argument("Unknown compression algorithm.");
+}
+
+auto compression_algorithm_from_string(const std::string& name_)
+    -> compression_algorithm {
+    if (name_ == "zlib") {
+        return compression_algorithm::zlib;
+    }
+    if (name_ == "zstd") {
+        return compression_algorithm::zstd;
+    }
+    if (name_ == "lz4") {
+        return compression_algorithm::lz4;
+    }
+    throw std::invalid_argument(
+        "Unknown compression algorithm '" + name_ + "'."
+    );
+}
+
+auto get_supported_compression_algorithms()
+    -> std::vector<compression_algorithm> {
+    return {
+#ifdef FILE_TRANSFER_HAS_ZSTD
+        compression_algorithm::zstd,
+#endif
+#ifdef FILE_TRANSFER_HAS_LZ4
+        compression_algorithm::lz4,
+#endif
+        compression_algorithm::zlib,
+    };
+}
+
+auto get_default_compression_level(compression_algorithm algorithm_) -> int {
+    switch (algorithm_) {
+    case compression_algorithm::zlib:
+        return 1;
+    case compression_algorithm::zstd:
+        return 3;
+    case compression_algorithm::lz4:
+        return 1;
+    }
+    throw std::invalid_argument("Unknown compression algorithm.");
+}
+
+auto to_string(const compression_settings& settings_) -> std::string {
+    return to_string(settings_.algorithm) + ":" +
+           std::to_string(settings_.level);
+}
+
+chunk_codec::chunk_codec(const compression_settings& settings_)
+    : m_settings{settings_} {
+    const auto supported = get_supported_compression_algorithms();
+    if (std::find(supported.begin(), supported.end(), m_settings.algorithm) ==
+        supported.end()) {
+        throw std::invalid_argument(
+            "The compression algorithm '" + to_string(m_settings.algorithm) +
+            "' is not supported."
+        );
+    }
+    const auto [min_level, max_level] = get_level_range(m_settings.algorithm);
+    m_settings.level = std::clamp(m_settings.level, min_level, max_level);
+}
+
+auto chunk_codec::encode(
+    const char* data_, std::size_t size_, std::string& frame_
+) const -> void {
+    if (size_ > compressed_header_size && size_ <= max_raw_size) {
+        // The compressed frame must be smaller than the raw one.
+        frame_.resize(size_);
+        const auto compressed_size = compress(
+            data_,
+            size_,
+            frame_.data() + compressed_header_size,
+            size_ - compressed_header_size
+        );
+        if (compressed_size > 0) {
+            frame_[0] = static_cast<char>(m_settings.algorithm);
+            const auto raw_size = static_cast<std::uint32_t>(size_);
+            for (std::size_t i = 0; i < 4; ++i) {
+                frame_[1 + i] = static_cast<char>((raw_size >> (8 * i)) & 0xff);
+            }
+            frame_.resize(compressed_header_size + compressed_size);
+            return;
+        }
+    }
+    frame_.resize(size_ + 1);
+    frame_[0] = raw_frame;
+    std::memcpy(frame_.data() + 1, data_, size_);
+}
+
+auto chunk_codec::compress(
+    const char* data_,
+    std::size_t size_,
+    char* buffer_,
+    std::size_t capacity_
+) const -> std::size_t {
+    switch (m_settings.algorithm) {
+    case compression_algorithm::zlib: {
+        auto compressed_size = boost::numeric_cast<uLongf>(capacity_);
+        const auto result = compress2(
+            reinterpret_cast<Bytef*>(buffer_),
+            &compressed_size,
+            reinterpret_cast<const Bytef*>(data_),
+            boost::numeric_cast<uLong>(size_),
+            m_settings.level
+        );
+        return result == Z_OK ? compressed_size : 0;
+    }
+    case compression_algorithm::zstd: {
+#ifdef FILE_TRANSFER_HAS_ZSTD
+        const auto result = ZSTD_compressCCtx(
+            get_zstd_compression_context(),
+            buffer_,
+            capacity_,
+            data_,
+            size_,
+            m_settings.level
+        );
+        return ZSTD_isError(result) != 0 ? 0 : result;
+#else
+        break;
+#endif
+    }
+    case compression_algorithm::lz4: {
+#ifdef FILE_TRANSFER_HAS_LZ4
+        const auto size = boost::numeric_cast<int>(size_);
+        const auto capacity = boost::numeric_cast<int>(capacity_);
+        const auto result =
+            m_settings.level <= 1
+                ? LZ4_compress_default(data_, buffer_, size, capacity)
+                : LZ4_compress_HC(
+                      data_, buffer_, size, capacity, m_settings.level
+                  );
+        return result > 0 ? static_cast<std::size_t>(result) : 0;
+#else
+        break;
+#endif
+    }
+    }
+    return 0;
+}
+
+auto chunk_codec::decode(const std::string& frame_, std::string& data_) const
+    -> void {
+    if (frame_.empty()) {
+        throw exceptions::invalid_argument("Received an empty chunk frame.");
+    }
+    if (frame_[0] == raw_frame) {
+        data_.assign(frame_, 1);
+        return;
+    }
+    if (frame_[0] != static_cast<char>(m_settings.algorithm)) {
+        throw exceptions::invalid_argument(
+            "Received a chunk which is not compressed with " +
+            to_string(m_settings.algorithm) + "."
+        );
+    }
+    if (frame_.size() < compressed_header_size) {
+        throw exceptions::invalid_argument("Received a truncated chunk frame.");
+    }
+    std::uint32_t raw_size = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        raw_size |= static_cast<std::uint32_t>(
+                        static_cast<unsigned char>(frame_[1 + i])
+                    )
+                    << (8 * i);
+    }
+    const auto* payload = frame_.data() + compressed_header_size;
+    const auto payload_size = frame_.size() - compressed_header_size;
+    // The size is checked before the chunk is allocated, such that a small
+    // malformed frame can not make the server allocate a large buffer.
+    if (raw_size > max_decoded_size) {
+        throw exceptions::invalid_argument(
+            "Received an oversized chunk frame."
+        );
+    }
+    if (raw_size > payload_size *
+                       get_max_compression_ratio(m_settings.algorithm)) {
+        throw exceptions::invalid_argument(
+            "Received a chunk frame whose size does not match its data."
+        );
+    }
+    data_.resize(raw_size);
+    bool success = false;
+    switch (m_settings.algorithm) {
+    case compression_algorithm::zlib: {
+        auto decompressed_size = static_cast<uLongf>(raw_size);
+        success = uncompress(
+                      reinterpret_cast<Bytef*>(data_.data()),
+                      &decompressed_size,
+                      reinterpret_cast<const Bytef*>(payload),
+                      boost::numeric_cast<uLong>(payload_size)
+                  ) == Z_OK &&
+                  decompressed_size == raw_size;
+        break;
+    }
+    case compression_algorithm::zstd: {
+#ifdef FILE_TRANSFER_HAS_ZSTD
+        const auto result = ZSTD_decompressDCtx(
+            get_zstd_decompression_context(),
+            data_.data(),
+            raw_size,
+            payload,
+            payload_size
+        );
+        success = ZSTD_isError(result) == 0 && result == raw_size;
+#endif
+        break;
+    }
+    case compression_algorithm::lz4: {
+#ifdef FILE_TRANSFER_HAS_LZ4
+        const auto result = LZ4_decompress_safe(
+            payload,
+            data_.data(),
+            boost::numeric_cast<int>(payload_size),
+            static_cast<int>(raw_size)
+        );
+        success = result >= 0 && static_cast<std::uint32_t>(result) == raw_size;
+#endif
+        break;
+    }
+    }
+    if (!success) {
+        throw exceptions::invalid_argument(
+            "Could not decompress the received chunk."
+        );
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,147 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Algorithms with which the chunks of a transfer can be
+ *      compressed.
+ *
+ * zlib is always available. zstd and lz4 are only available if the
+ * server was built with them.
+ */
+enum class compression_algorithm {
+    zlib = 1,
+    zstd = 2,
+    lz4 = 3,
+};
+
+/**
+ * @brief Get the name of a compression algorithm.
+ * @param algorithm_ The compression algorithm.
+ */
+auto to_string(compression_algorithm algorithm_) -> std::string;
+
+/**
+ * @brief Get the compression algorithm with the given name.
+ * @param name_ Name of the algorithm, for example "zstd".
+ * @return The compression algorithm.
+ * @throws std::invalid_argument if the name is unknown.
+ */
+auto compression_algorithm_from_string(const std::string& name_)
+    -> compression_algorithm;
+
+/**
+ * @brief Get the compression algorithms which the server was built with.
+ */
+auto get_supported_compression_algorithms()
+    -> std::vector<compression_algorithm>;
+
+/**
+ * @brief Compression algorithm and level of a transfer.
+ */
+struct compression_settings {
+    compression_algorithm algorithm = compression_algorithm::zlib;
+    /// Level of the algorithm. Higher levels compress better, but slower.
+    int level = 0;
+};
+
+/**
+ * @brief Get the default level of a compression algorithm, which favors
+ *      speed.
+ * @param algorithm_ The compression algorithm.
+ */
+auto get_default_compression_level(compression_algorithm algorithm_) -> int;
+
+/**
+ * @brief Format compression settings as "name:level".
+ * @param settings_ The compression settings.
+ */
+auto to_string(const compression_settings& settings_) -> std::string;
+
+/**
+ * @brief Compresses and decompresses the chunks of a transfer.
+ *
+ * Each chunk is compressed independently into a frame, such that chunks
+ * can be sent in any order, and ranged or resumed transfers still work.
+ * A frame starts with a header byte: 0 if the payload is the raw chunk,
+ * or the value of the compression_algorithm otherwise. A compressed
+ * payload is preceded by the size of the raw chunk, as four bytes in
+ * little-endian order. Chunks which do not shrink are sent raw. Received
+ * frames are decompressed into at most 4 MiB, the largest raw chunk which
+ * fits into a message.
+ *
+ * The member functions are thread-safe.
+ */
+class chunk_codec {
+public:
+    /**
+     * @brief Construct the codec.
+     * @param settings_ Compression settings. The level is clamped to the
+     *      range of the algorithm.
+     * @throws std::invalid_argument if the algorithm is not supported.
+     */
+    explicit chunk_codec(const compression_settings& settings_);
+
+    [[nodiscard]] auto settings() const -> const compression_settings& {
+        return m_settings;
+    }
+
+    /**
+     * @brief Compress a chunk into a frame.
+     * @param data_ Start of the chunk.
+     * @param size_ Size of the chunk.
+     * @param frame_ String which receives the frame. Its buffer is reused.
+     */
+    auto encode(const char* data_, std::size_t size_, std::string& frame_)
+        const -> void;
+
+    /**
+     * @brief Decompress a frame into a chunk.
+     * @param frame_ The frame.
+     * @param data_ String which receives the chunk. Its buffer is reused.
+     * @throws exceptions::invalid_argument if the frame is malformed.
+     */
+    auto decode(const std::string& frame_, std::string& data_) const -> void;
+
+private:
+    /// Compress into the buffer, returning the compressed size, or zero
+    /// if the data does not fit.
+    auto compress(
+        const char* data_,
+        std::size_t size_,
+        char* buffer_,
+        std::size_t capacity_
+    ) const -> std::size_t;
+
+    compression_settings m_settings;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,500 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "chunk_store.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "blake3_digest.h"
+#include "checksum.h"
+#include "content_chunker.h"
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Number of bytes which are read from a file at once when its manifest
+/// is computed.
+constexpr std::size_t manifest_read_size = std::size_t{1} << 20;
+/// Smallest total size of the chunks at which garbage is collected.
+constexpr std::uint64_t min_collection_threshold = std::uint64_t{64} << 20;
+
+auto digest_from_string(const std::string& hex_) -> std::optional<chunk_digest> {
+    chunk_digest digest{};
+    if (hex_.size() != 2 * digest.size() ||
+        !std::all_of(hex_.begin(), hex_.end(), [](unsigned char c_) {
+            return std::isxdigit(c_) != 0;
+        })) {
+        return std::nullopt;
+    }
+    const auto bytes = digest_from_hex(hex_);
+    std::memcpy(digest.data(), bytes.data(), digest.size());
+    return digest;
+}
+
+/**
+ * @brief Content of a manifest file.
+ */
+struct stored_manifest {
+    /// Absolute path of the file, in generic format.
+    std::string path;
+    file_identity identity;
+    chunk_manifest chunks;
+};
+
+auto read_manifest(const boost::filesystem::path& manifest_path_)
+    -> std::optional<stored_manifest> {
+    boost::filesystem::ifstream in_file{manifest_path_};
+    if (!in_file.good()) {
+        return std::nullopt;
+    }
+    stored_manifest manifest;
+    std::getline(in_file, manifest.path);
+    auto& identity = manifest.identity;
+    in_file >> identity.device >> identity.inode >> identity.size >>
+        identity.mtime_ns;
+    std::uint64_t file_size = 0;
+    std::string hex;
+    std::uint32_t size = 0;
+    while (!in_file.fail() && in_file >> hex >> size) {
+        const auto digest = digest_from_string(hex);
+        if (!digest) {
+            break;
+        }
+        manifest.chunks.push_back({*digest, size});
+        file_size += size;
+    }
+    if (!in_file.eof() || file_size != identity.size) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Ignoring malformed manifest " << manifest_path_.string();
+        return std::nullopt;
+    }
+    return manifest;
+}
+
+template <typename T>
+auto append_little_endian(std::string& target_, T value_) -> void {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        target_.push_back(static_cast<char>((value_ >> (8 * i)) & 0xff));
+    }
+}
+
+} // namespace
+
+auto get_chunk_digest(const char* data_, std::size_t size_) -> chunk_digest {
+    blake3_hasher hasher;
+    hasher.update(data_, size_);
+    return *digest_from_string(hasher.hex_digest());
+}
+
+auto to_string(const chunk_digest& digest_) -> std::string {
+    static constexpr const char* digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * digest_.size());
+    for (const auto byte : digest_) {
+        hex.push_back(digits[byte >> 4]);
+        hex.push_back(digits[byte & 0xf]);
+    }
+    return hex;
+}
+
+auto encode_manifest(const chunk_manifest& manifest_) -> std::string {
+    std::uint64_t file_size = 0;
+    for (const auto& entry : manifest_) {
+        file_size += entry.size;
+    }
+    std::string encoded;
+    encoded.reserve(8 + manifest_.size() * 36);
+    append_little_endian(encoded, file_size);
+    for (const auto& entry : manifest_) {
+        encoded.append(
+            reinterpret_cast<const char*>(entry.digest.data()),
+            entry.digest.size()
+        );
+        append_little_endian(encoded, entry.size);
+    }
+    return encoded;
+}
+
+auto chunk_store::chunk_digest_hash::operator()(const chunk_digest& digest_
+) const -> std::size_t {
+    // The digest is uniformly distributed, so any of its bytes will do.
+    std::size_t hash = 0;
+    std::memcpy(&hash, digest_.data(), sizeof(hash));
+    return hash;
+}
+
+chunk_store::chunk_store(boost::filesystem::path directory_)
+    : m_directory{std::move(directory_)} {
+    boost::filesystem::create_directories(m_directory / "chunks");
+    boost::filesystem::create_directories(m_directory / "manifests");
+    load_index();
+    collect_garbage_locked();
+}
+
+chunk_store::transaction::~transaction() {
+    for (const auto& chunk : m_chunks) {
+        boost::system::error_code error_code;
+        boost::filesystem::remove(chunk.second, error_code);
+    }
+}
+
+auto chunk_store::transaction::insert(const char* data_, std::size_t size_)
+    -> manifest_entry {
+    const manifest_entry entry{
+        get_chunk_digest(data_, size_), boost::numeric_cast<std::uint32_t>(size_)
+    };
+    if (m_store.contains(entry.digest) || m_digests.count(entry.digest) != 0) {
+        return entry;
+    }
+    m_chunks.emplace_back(entry, m_store.write_temporary(entry, data_));
+    m_digests.insert(entry.digest);
+    return entry;
+}
+
+auto chunk_store::transaction::commit() -> void {
+    const std::unique_lock lock{m_store.m_mutex};
+    m_store.add_locked(m_chunks);
+    m_chunks.clear();
+    m_digests.clear();
+    m_store.maybe_collect_garbage_locked();
+}
+
+auto chunk_store::transaction::commit(
+    const boost::filesystem::path& path_,
+    const file_identity& identity_,
+    const chunk_manifest& manifest_
+) -> void {
+    // The manifest is saved under the same lock as the chunks are added,
+    // such that no garbage collection removes them in between.
+    const std::unique_lock lock{m_store.m_mutex};
+    m_store.add_locked(m_chunks);
+    m_chunks.clear();
+    m_digests.clear();
+    m_store.save_manifest(path_, identity_, manifest_);
+    m_store.maybe_collect_garbage_locked();
+}
+
+auto chunk_store::contains(const chunk_digest& digest_) const -> bool {
+    const std::shared_lock lock{m_mutex};
+    return m_index.count(digest_) != 0;
+}
+
+auto chunk_store::insert(const char* data_, std::size_t size_)
+    -> manifest_entry {
+    transaction chunks{*this};
+    const auto entry = chunks.insert(data_, size_);
+    chunks.commit();
+    return entry;
+}
+
+auto chunk_store::write_temporary(
+    const manifest_entry& entry_, const char* data_
+) const -> boost::filesystem::path {
+    const auto path = get_chunk_path(entry_.digest);
+    boost::filesystem::create_directories(path.parent_path());
+    // Concurrent inserts of the same chunk write separate temporary files,
+    // and only the first one is moved into place.
+    auto temporary_path = path;
+    temporary_path += "." + boost::filesystem::unique_path().string() + ".tmp";
+    boost::filesystem::ofstream out_file{
+        temporary_path, std::ios_base::out | std::ios_base::binary
+    };
+    out_file.write(data_, static_cast<std::streamsize>(entry_.size));
+    if (!out_file.good()) {
+        out_file.close();
+        boost::system::error_code error_code;
+        boost::filesystem::remove(temporary_path, error_code);
+        throw exceptions::internal(
+            "Could not write chunk " + to_string(entry_.digest) +
+            " to the chunk store."
+        );
+    }
+    return temporary_path;
+}
+
+auto chunk_store::add_locked(
+    const std::vector<std::pair<manifest_entry, boost::filesystem::path>>&
+        chunks_
+) -> void {
+    for (const auto& [entry, temporary_path] : chunks_) {
+        if (m_index.count(entry.digest) != 0) {
+            boost::system::error_code error_code;
+            boost::filesystem::remove(temporary_path, error_code);
+            continue;
+        }
+        boost::filesystem::rename(temporary_path, get_chunk_path(entry.digest));
+        m_index.emplace(entry.digest, entry.size);
+        m_num_bytes += entry.size;
+    }
+}
+
+auto chunk_store::read(const chunk_digest& digest_, std::string& target_) const
+    -> void {
+    const auto path = get_chunk_path(digest_);
+    boost::system::error_code error_code;
+    const auto size = boost::filesystem::file_size(path, error_code);
+    boost::filesystem::ifstream in_file{
+        path, std::ios_base::in | std::ios_base::binary
+    };
+    if (error_code || !in_file.good()) {
+        throw exceptions::failed_precondition(
+            "Chunk " + to_string(digest_) + " is not in the chunk store."
+        );
+    }
+    target_.resize(boost::numeric_cast<std::size_t>(size));
+    in_file.read(target_.data(), boost::numeric_cast<std::streamsize>(size));
+    if (!in_file.good()) {
+        throw exceptions::internal(
+            "Could not read chunk " + to_string(digest_) +
+            " from the chunk store."
+        );
+    }
+}
+
+auto chunk_store::save_manifest(
+    const boost::filesystem::path& path_,
+    const file_identity& identity_,
+    const chunk_manifest& manifest_
+) const -> void {
+    const auto manifest_path = get_manifest_path(path_);
+    auto temporary_path = manifest_path;
+    temporary_path += "." + boost::filesystem::unique_path().string() + ".tmp";
+    {
+        boost::filesystem::ofstream out_file{
+            temporary_path, std::ios_base::out | std::ios_base::trunc
+        };
+        out_file << boost::filesystem::absolute(path_).generic_string() << '\n'
+                 << identity_.device << ' ' << identity_.inode << ' '
+                 << identity_.size << ' ' << identity_.mtime_ns << '\n';
+        for (const auto& entry : manifest_) {
+            out_file << to_string(entry.digest) << ' ' << entry.size << '\n';
+        }
+        if (!out_file.good()) {
+            throw exceptions::internal(
+                "Could not write the manifest of " + path_.string() + "."
+            );
+        }
+    }
+    boost::filesystem::rename(temporary_path, manifest_path);
+}
+
+auto chunk_store::load_manifest(const boost::filesystem::path& path_) const
+    -> std::optional<chunk_manifest> {
+    auto manifest = read_manifest(get_manifest_path(path_));
+    if (!manifest ||
+        manifest->path != boost::filesystem::absolute(path_).generic_string() ||
+        get_file_identity(path_) != manifest->identity) {
+        return std::nullopt;
+    }
+    // Chunks may have been removed from the store since.
+    const std::shared_lock lock{m_mutex};
+    for (const auto& entry : manifest->chunks) {
+        if (m_index.count(entry.digest) == 0) {
+            return std::nullopt;
+        }
+    }
+    return std::move(manifest->chunks);
+}
+
+auto chunk_store::get_manifest(
+    const boost::filesystem::path& path_, io_backend backend_
+) -> chunk_manifest {
+    if (auto manifest = load_manifest(path_)) {
+        return *std::move(manifest);
+    }
+    const auto identity = get_file_identity(path_);
+    if (!identity) {
+        throw exceptions::not_found(
+            "The file " + path_.string() + " does not exist."
+        );
+    }
+    transaction chunks{*this};
+    chunk_manifest manifest;
+    content_chunker chunker{[&](const char* data_, std::size_t size_) {
+        manifest.push_back(chunks.insert(data_, size_));
+    }};
+    const auto reader = open_file_reader(path_, identity->size, backend_);
+    std::string buffer;
+    for (std::uint64_t offset = 0; offset < identity->size;) {
+        const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(
+            manifest_read_size, identity->size - offset
+        ));
+        reader->read(offset, size, buffer);
+        chunker.update(buffer.data(), buffer.size());
+        offset += size;
+    }
+    chunker.finish();
+    // The file may have changed while it was read, in which case only the
+    // chunks are kept, until the next garbage collection.
+    if (get_file_identity(path_) == identity) {
+        chunks.commit(path_, *identity, manifest);
+    } else {
+        chunks.commit();
+    }
+    return manifest;
+}
+
+auto chunk_store::num_chunks() const -> std::size_t {
+    const std::shared_lock lock{m_mutex};
+    return m_index.size();
+}
+
+auto chunk_store::num_bytes() const -> std::uint64_t {
+    const std::shared_lock lock{m_mutex};
+    return m_num_bytes;
+}
+
+auto chunk_store::collect_garbage() -> void {
+    const std::unique_lock lock{m_mutex};
+    collect_garbage_locked();
+}
+
+auto chunk_store::maybe_collect_garbage_locked() -> void {
+    if (m_num_bytes > m_collection_threshold) {
+        collect_garbage_locked();
+    }
+}
+
+auto chunk_store::collect_garbage_locked() -> void {
+    std::unordered_set<chunk_digest, chunk_digest_hash> referenced;
+    std::size_t num_stale_manifests = 0;
+    for (const auto& entry :
+         boost::filesystem::directory_iterator(m_directory / "manifests")) {
+        // Manifests which are being saved end in .tmp.
+        if (entry.path().extension() != ".manifest") {
+            continue;
+        }
+        const auto manifest = read_manifest(entry.path());
+        if (manifest &&
+            get_file_identity(manifest->path) == manifest->identity) {
+            for (const auto& chunk : manifest->chunks) {
+                referenced.insert(chunk.digest);
+            }
+            continue;
+        }
+        boost::system::error_code error_code;
+        boost::filesystem::remove(entry.path(), error_code);
+        ++num_stale_manifests;
+    }
+    std::size_t num_removed = 0;
+    std::uint64_t num_bytes_removed = 0;
+    for (auto it = m_index.begin(); it != m_index.end();) {
+        if (referenced.count(it->first) != 0) {
+            ++it;
+            continue;
+        }
+        boost::system::error_code error_code;
+        boost::filesystem::remove(get_chunk_path(it->first), error_code);
+        ++num_removed;
+        num_bytes_removed += it->second;
+        m_num_bytes -= it->second;
+        it = m_index.erase(it);
+    }
+    m_collection_threshold =
+        std::max(2 * m_num_bytes, min_collection_threshold);
+    if (num_removed > 0 || num_stale_manifests > 0) {
+        BOOST_LOG_TRIVIAL(info)
+            << "Removed " << num_removed << " chunks (" << num_bytes_removed
+            << " bytes) and " << num_stale_manifests
+            << " outdated manifests from the chunk store "
+            << m_directory.string() << ".";
+    }
+}
+
+auto chunk_store::get_chunk_path(const chunk_digest& digest_) const
+    -> boost::filesystem::path {
+    const auto hex = to_string(digest_);
+    return m_directory / "chunks" / hex.substr(0, 2) / hex;
+}
+
+auto chunk_store::get_manifest_path(const boost::filesystem::path& path_) const
+    -> boost::filesystem::path {
+    const auto name = boost::filesystem::absolute(path_).generic_string();
+    blake3_hasher hasher;
+    hasher.update(name.data(), name.size());
+    return m_directory / "manifests" / (hasher.hex_digest() + ".manifest");
+}
+
+auto chunk_store::load_index() -> void {
+    std::vector<boost::filesystem::path> leftovers;
+    for (const auto& entry :
+         boost::filesystem::recursive_directory_iterator(m_directory / "chunks"
+         )) {
+        if (!boost::filesystem::is_regular_file(entry.status())) {
+            continue;
+        }
+        const auto name = entry.path().filename().string();
+        if (const auto digest = digest_from_string(name)) {
+            const auto size = boost::numeric_cast<std::uint32_t>(
+                boost::filesystem::file_size(entry.path())
+            );
+            m_index.emplace(*digest, size);
+            m_num_bytes += size;
+        } else if (entry.path().extension() == ".tmp") {
+            // Left behind by an insert which was interrupted, or a
+            // transaction which was not committed.
+            leftovers.push_back(entry.path());
+        }
+    }
+    for (const auto& entry :
+         boost::filesystem::directory_iterator(m_directory / "manifests")) {
+        if (entry.path().extension() == ".tmp") {
+            leftovers.push_back(entry.path());
+        }
+    }
+    for (const auto& path : leftovers) {
+        boost::system::error_code error_code;
+        boost::filesystem::remove(path, error_code);
+    }
+    BOOST_LOG_TRIVIAL(info) << "Chunk store " << m_directory.string()
+                            << " holds " << m_index.size() << " chunks ("
+                            << m_num_bytes << " bytes).";
+}
+
+} // namespace file_transfer::detail
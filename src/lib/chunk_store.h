@@ -0,0 +1,283 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "digest_cache.h"
+#include "file_io.h"
+
+namespace file_transfer {
+namespace detail {
+
+/// BLAKE3 digest of a chunk, which is its key in the chunk store.
+using chunk_digest = std::array<unsigned char, 32>;
+
+/**
+ * @brief Get the digest of a chunk.
+ * @param data_ Pointer to the data of the chunk.
+ * @param size_ Size of the chunk.
+ */
+auto get_chunk_digest(const char* data_, std::size_t size_) -> chunk_digest;
+
+/**
+ * @brief Get the hex representation of a chunk digest.
+ * @param digest_ The digest.
+ */
+auto to_string(const chunk_digest& digest_) -> std::string;
+
+/**
+ * @brief Chunk of a file, as listed in its manifest.
+ */
+struct manifest_entry {
+    chunk_digest digest{};
+    std::uint32_t size = 0;
+
+    auto operator==(const manifest_entry& other_) const -> bool {
+        return digest == other_.digest && size == other_.size;
+    }
+};
+
+/// Chunks of a file, in order.
+using chunk_manifest = std::vector<manifest_entry>;
+
+/**
+ * @brief Encode a manifest as it is sent to clients.
+ *
+ * The encoding is the size of the file (8 bytes), followed by the digest
+ * (32 bytes) and size (4 bytes) of each chunk. All numbers are
+ * little-endian.
+ * @param manifest_ The manifest.
+ */
+auto encode_manifest(const chunk_manifest& manifest_) -> std::string;
+
+/**
+ * @brief Content-addressable storage of file chunks.
+ *
+ * Each unique chunk is stored once, in a file named after its digest.
+ * The digests of all stored chunks are kept in memory, such that checking
+ * whether a chunk exists does not touch the disk. The store also keeps
+ * the manifests of files, which list the content-defined chunks of each
+ * file. A manifest is only valid while the file is unchanged.
+ *
+ * Chunks which no valid manifest references are removed when the store is
+ * opened, and whenever it has grown to twice its size after the last
+ * collection. The store thus only holds the chunks of the current content
+ * of the files, and the garbage of the files which changed since.
+ *
+ * All member functions are thread-safe.
+ */
+class chunk_store {
+    struct chunk_digest_hash {
+        auto operator()(const chunk_digest& digest_) const -> std::size_t;
+    };
+
+public:
+    /**
+     * @brief Construct the store, create its directory if needed, and
+     *      index the chunks it already holds.
+     * @param directory_ Directory in which the chunks and manifests are
+     *      stored.
+     */
+    explicit chunk_store(boost::filesystem::path directory_);
+
+    /**
+     * @brief Chunks which are written to the store, but only added to it
+     *      once they are committed, for example after the checksum of the
+     *      uploaded file is verified. Chunks which are not committed are
+     *      removed with the transaction.
+     */
+    class transaction {
+    public:
+        explicit transaction(chunk_store& store_) : m_store{store_} {}
+        ~transaction();
+
+        transaction(const transaction&) = delete;
+        auto operator=(const transaction&) -> transaction& = delete;
+        transaction(transaction&&) = delete;
+        auto operator=(transaction&&) -> transaction& = delete;
+
+        /**
+         * @brief Write a chunk, unless it is stored already.
+         * @param data_ Pointer to the data of the chunk.
+         * @param size_ Size of the chunk.
+         * @return The entry of the chunk, for the manifest of its file.
+         */
+        auto insert(const char* data_, std::size_t size_) -> manifest_entry;
+
+        /**
+         * @brief Add the written chunks to the store.
+         */
+        auto commit() -> void;
+
+        /**
+         * @brief Add the written chunks to the store, together with the
+         *      manifest of the file which references them.
+         * @param path_ Path of the file.
+         * @param identity_ Identity of the file with the content which the
+         *      manifest describes.
+         * @param manifest_ The manifest.
+         */
+        auto commit(
+            const boost::filesystem::path& path_,
+            const file_identity& identity_,
+            const chunk_manifest& manifest_
+        ) -> void;
+
+    private:
+        chunk_store& m_store;
+        /// Written chunks, and the temporary files which hold them.
+        std::vector<std::pair<manifest_entry, boost::filesystem::path>>
+            m_chunks;
+        std::unordered_set<chunk_digest, chunk_digest_hash> m_digests;
+    };
+
+    /**
+     * @brief Check whether a chunk is stored.
+     * @param digest_ Digest of the chunk.
+     */
+    [[nodiscard]] auto contains(const chunk_digest& digest_) const -> bool;
+
+    /**
+     * @brief Store a chunk, unless a chunk with the same digest is stored
+     *      already.
+     *
+     * The chunk is removed by the next garbage collection, unless a
+     * manifest references it by then.
+     * @param data_ Pointer to the data of the chunk.
+     * @param size_ Size of the chunk.
+     * @return The entry of the chunk, for the manifest of its file.
+     */
+    auto insert(const char* data_, std::size_t size_) -> manifest_entry;
+
+    /**
+     * @brief Read a stored chunk.
+     * @param digest_ Digest of the chunk.
+     * @param target_ String which receives the data of the chunk.
+     * @throws exceptions::failed_precondition if the chunk is not stored.
+     */
+    auto read(const chunk_digest& digest_, std::string& target_) const
+        -> void;
+
+    /**
+     * @brief Store the manifest of a file.
+     * @param path_ Path of the file.
+     * @param identity_ Identity of the file when it had the content which
+     *      the manifest describes.
+     * @param manifest_ The manifest.
+     */
+    auto save_manifest(
+        const boost::filesystem::path& path_,
+        const file_identity& identity_,
+        const chunk_manifest& manifest_
+    ) const -> void;
+
+    /**
+     * @brief Load the manifest of a file.
+     * @param path_ Path of the file.
+     * @return The manifest, or an empty optional if there is none, or the
+     *      file has changed since it was stored.
+     */
+    [[nodiscard]] auto load_manifest(const boost::filesystem::path& path_) const
+        -> std::optional<chunk_manifest>;
+
+    /**
+     * @brief Get the manifest of a file, and store its chunks if the
+     *      manifest is not stored already.
+     * @param path_ Path of the file.
+     * @param backend_ Backend used to read the file.
+     */
+    auto get_manifest(const boost::filesystem::path& path_, io_backend backend_)
+        -> chunk_manifest;
+
+    /**
+     * @brief Get the number of stored chunks.
+     */
+    [[nodiscard]] auto num_chunks() const -> std::size_t;
+
+    /**
+     * @brief Get the total size of the stored chunks.
+     */
+    [[nodiscard]] auto num_bytes() const -> std::uint64_t;
+
+    /**
+     * @brief Remove the chunks which no valid manifest references, and the
+     *      manifests of files which have changed.
+     */
+    auto collect_garbage() -> void;
+
+private:
+    [[nodiscard]] auto get_chunk_path(const chunk_digest& digest_) const
+        -> boost::filesystem::path;
+    [[nodiscard]] auto get_manifest_path(const boost::filesystem::path& path_
+    ) const -> boost::filesystem::path;
+    /// Write a chunk to a temporary file next to its final path.
+    auto write_temporary(const manifest_entry& entry_, const char* data_)
+        const -> boost::filesystem::path;
+    /// Move written chunks into place and add them to the index. The
+    /// caller holds the lock.
+    auto add_locked(
+        const std::vector<std::pair<manifest_entry, boost::filesystem::path>>&
+            chunks_
+    ) -> void;
+    /// Collect garbage if the store has grown enough since the last time.
+    /// The caller holds the lock.
+    auto maybe_collect_garbage_locked() -> void;
+    auto collect_garbage_locked() -> void;
+    auto load_index() -> void;
+
+    boost::filesystem::path m_directory;
+    mutable std::shared_mutex m_mutex;
+    /// Size of each stored chunk, by its digest.
+    std::unordered_map<chunk_digest, std::uint32_t, chunk_digest_hash> m_index;
+    std::uint64_t m_num_bytes = 0;
+    /// Total size beyond which garbage is collected again.
+    std::uint64_t m_collection_threshold = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
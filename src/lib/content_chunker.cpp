@@ -0,0 +1,86 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "content_chunker.h"
+
+#include <utility>
+
+namespace file_transfer::detail {
+
+namespace {
+
+auto make_gear_table() -> std::array<std::uint64_t, 256> {
+    std::array<std::uint64_t, 256> table{};
+    std::uint64_t state = 0;
+    for (auto& entry : table) {
+        state += 0x9e37'79b9'7f4a'7c15;
+        auto value = state;
+        value = (value ^ (value >> 30)) * 0xbf58'476d'1ce4'e5b9;
+        value = (value ^ (value >> 27)) * 0x94d0'49bb'1331'11eb;
+        entry = value ^ (value >> 31);
+    }
+    return table;
+}
+
+} // namespace
+
+auto get_gear_table() -> const std::array<std::uint64_t, 256>& {
+    static const auto table = make_gear_table();
+    return table;
+}
+
+content_chunker::content_chunker(chunk_handler_t on_chunk_)
+    : m_on_chunk(std::move(on_chunk_)) {}
+
+auto content_chunker::update(const char* data_, std::size_t size_) -> void {
+    const auto& gear = get_gear_table();
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < size_; ++i) {
+        m_hash = (m_hash << 1) + gear[static_cast<unsigned char>(data_[i])];
+        const auto length = m_pending.size() + i + 1 - start;
+        if (length < max_content_chunk_size &&
+            (length < min_content_chunk_size ||
+             (m_hash & content_boundary_mask) != 0)) {
+            continue;
+        }
+        if (m_pending.empty()) {
+            m_on_chunk(data_ + start, length);
+        } else {
+            m_pending.append(data_ + start, i + 1 - start);
+            m_on_chunk(m_pending.data(), m_pending.size());
+            m_pending.clear();
+        }
+        m_hash = 0;
+        start = i + 1;
+    }
+    m_pending.append(data_ + start, size_ - start);
+}
+
+auto content_chunker::finish() -> void {
+    if (!m_pending.empty()) {
+        m_on_chunk(m_pending.data(), m_pending.size());
+        m_pending.clear();
+    }
+    m_hash = 0;
+}
+
+} // namespace file_transfer::detail
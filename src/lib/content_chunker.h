@@ -0,0 +1,94 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace file_transfer {
+namespace detail {
+
+/// Smallest size of a content-defined chunk, except for the last chunk.
+inline constexpr std::size_t min_content_chunk_size = std::size_t{1} << 13;
+/// Largest size of a content-defined chunk.
+inline constexpr std::size_t max_content_chunk_size = std::size_t{1} << 18;
+/// Mask of the gear hash bits which must be zero at a chunk boundary. With
+/// 16 bits, chunks are about 72 KiB on average.
+inline constexpr std::uint64_t content_boundary_mask = 0xffff'0000'0000'0000;
+
+/**
+ * @brief Get the table of the gear hash.
+ *
+ * Entry i is the (i + 1)-th output of the SplitMix64 generator, seeded
+ * with 0.
+ */
+auto get_gear_table() -> const std::array<std::uint64_t, 256>&;
+
+/**
+ * @brief Splits a stream of data into chunks at boundaries which depend
+ *      on the content, such that an insertion only changes the chunks
+ *      around it.
+ *
+ * The gear hash h starts at 0 with each chunk. For each byte b of the
+ * chunk, h = 2 * h + gear[b] modulo 2^64. The chunk ends after the first
+ * byte at which it has at least min_content_chunk_size bytes and
+ * h & content_boundary_mask is 0, or at max_content_chunk_size bytes.
+ */
+class content_chunker {
+public:
+    /// Called with the data and size of each complete chunk.
+    using chunk_handler_t = std::function<void(const char*, std::size_t)>;
+
+    /**
+     * @brief Construct the chunker.
+     * @param on_chunk_ Called for each complete chunk, in order.
+     */
+    explicit content_chunker(chunk_handler_t on_chunk_);
+
+    /**
+     * @brief Add data to the stream.
+     *
+     * Chunks which lie completely within the data are passed on without
+     * copying them.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    auto update(const char* data_, std::size_t size_) -> void;
+
+    /**
+     * @brief End the stream, and pass on the last chunk, if any.
+     */
+    auto finish() -> void;
+
+private:
+    chunk_handler_t m_on_chunk;
+    /// Start of the current chunk, if it began in an earlier update.
+    std::string m_pending;
+    std::uint64_t m_hash = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
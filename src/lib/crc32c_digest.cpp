@@ -0,0 +1,185 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "crc32c_digest.h"
+
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FILE_TRANSFER_CRC32C_X86_64
+#endif
+
+#ifdef FILE_TRANSFER_CRC32C_X86_64
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FILE_TRANSFER_SSE42_TARGET
+#else
+#include <cpuid.h>
+#define FILE_TRANSFER_SSE42_TARGET __attribute__((target("sse4.2")))
+#endif
+#include <nmmintrin.h>
+#endif
+
+namespace file_transfer::detail {
+
+namespace {
+
+// ---------- Portable kernel ----------
+
+/// Reversed Castagnoli polynomial.
+constexpr std::uint32_t crc32c_polynomial = 0x82F63B78;
+
+using crc32c_tables_t = std::array<std::array<std::uint32_t, 256>, 8>;
+
+/**
+ * @brief Compute the lookup tables of the slicing-by-8 algorithm.
+ *
+ * Table k contains the CRC of a byte followed by k zero bytes.
+ */
+constexpr auto make_crc32c_tables() -> crc32c_tables_t {
+    crc32c_tables_t tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        auto crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1U) != 0 ? crc32c_polynomial : 0U);
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < tables.size(); ++k) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            const auto previous = tables[k - 1][i];
+            tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr crc32c_tables_t crc32c_tables = make_crc32c_tables();
+
+auto load_little_endian(const unsigned char* data_) -> std::uint32_t {
+    return static_cast<std::uint32_t>(data_[0]) |
+           (static_cast<std::uint32_t>(data_[1]) << 8) |
+           (static_cast<std::uint32_t>(data_[2]) << 16) |
+           (static_cast<std::uint32_t>(data_[3]) << 24);
+}
+
+auto update_portable(
+    std::uint32_t crc_, const unsigned char* data_, std::size_t size_
+) -> std::uint32_t {
+    const auto& t = crc32c_tables;
+    for (; size_ >= 8; size_ -= 8, data_ += 8) {
+        const auto low = crc_ ^ load_little_endian(data_);
+        const auto high = load_little_endian(data_ + 4);
+        crc_ = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+               t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+               t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+               t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for (; size_ > 0; --size_, ++data_) {
+        crc_ = (crc_ >> 8) ^ t[0][(crc_ ^ *data_) & 0xFF];
+    }
+    return crc_;
+}
+
+#ifdef FILE_TRANSFER_CRC32C_X86_64
+
+// ---------- SSE4.2 kernel ----------
+
+auto cpu_supports_sse42() -> bool {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (ecx & bit_SSE4_2) != 0;
+#endif
+}
+
+FILE_TRANSFER_SSE42_TARGET auto update_sse42(
+    std::uint32_t crc_, const unsigned char* data_, std::size_t size_
+) -> std::uint32_t {
+    std::uint64_t crc = crc_;
+    for (; size_ >= 8; size_ -= 8, data_ += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data_, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    auto crc32 = static_cast<std::uint32_t>(crc);
+    for (; size_ > 0; --size_, ++data_) {
+        crc32 = _mm_crc32_u8(crc32, *data_);
+    }
+    return crc32;
+}
+
+#endif
+
+} // namespace
+
+auto get_supported_crc32c_kernels() -> std::vector<crc32c_kernel> {
+    std::vector<crc32c_kernel> kernels{{"portable", &update_portable}};
+#ifdef FILE_TRANSFER_CRC32C_X86_64
+    if (cpu_supports_sse42()) {
+        kernels.push_back({"sse4.2", &update_sse42});
+    }
+#endif
+    return kernels;
+}
+
+auto get_best_crc32c_kernel() -> const crc32c_kernel& {
+    static const crc32c_kernel best_kernel =
+        get_supported_crc32c_kernels().back();
+    return best_kernel;
+}
+
+auto crc32c_hasher::update(const char* data_, std::size_t size_) -> void {
+    m_crc = m_kernel->update(
+        m_crc, reinterpret_cast<const unsigned char*>(data_), size_
+    );
+}
+
+auto crc32c_hasher::hex_digest() const -> std::string {
+    std::stringstream res_stream;
+    res_stream << std::hex << std::setfill('0') << std::setw(8) << ~m_crc;
+    return res_stream.str();
+}
+
+auto crc32c_hasher::save_state() const -> std::string {
+    return save_trivial_state(m_crc);
+}
+
+auto crc32c_hasher::restore_state(const std::string& state_) -> void {
+    restore_trivial_state(state_, m_crc);
+}
+
+} // namespace file_transfer::detail
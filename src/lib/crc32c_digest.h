@@ -0,0 +1,114 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "checksum.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Implementation of the CRC-32C update function.
+ *
+ * All kernels produce bit-identical results. The fastest one supported by
+ * the CPU is selected at runtime.
+ */
+struct crc32c_kernel {
+    /// Name of the kernel, for logging and benchmarks.
+    const char* name;
+
+    /**
+     * @brief Update a CRC with additional data.
+     * @param crc_ CRC of the previous data, without the final inversion.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     * @return The updated CRC, without the final inversion.
+     */
+    std::uint32_t (*update)(
+        std::uint32_t crc_, const unsigned char* data_, std::size_t size_
+    );
+};
+
+/**
+ * @brief Get all CRC-32C kernels which are supported by the CPU.
+ * @return The kernels, ordered from the slowest to the fastest.
+ */
+auto get_supported_crc32c_kernels() -> std::vector<crc32c_kernel>;
+
+/**
+ * @brief Get the fastest CRC-32C kernel which is supported by the CPU.
+ */
+auto get_best_crc32c_kernel() -> const crc32c_kernel&;
+
+/**
+ * @brief Incremental computation of a CRC-32C checksum.
+ *
+ * The hex digest is the CRC as a big-endian 32-bit number, as printed by
+ * common tools.
+ */
+class crc32c_hasher final : public hasher {
+public:
+    /**
+     * @brief Construct the hasher.
+     * @param kernel_ Kernel which processes the data.
+     */
+    explicit crc32c_hasher(
+        const crc32c_kernel& kernel_ = get_best_crc32c_kernel()
+    )
+        : m_kernel{&kernel_} {}
+
+    /**
+     * @brief Add data to the checksum.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    auto update(const char* data_, std::size_t size_) -> void override;
+
+    /**
+     * @brief Get the hex digest of all data added so far.
+     */
+    [[nodiscard]] auto hex_digest() const -> std::string override;
+
+    /**
+     * @brief Get the internal state, such that hashing can be resumed later.
+     */
+    [[nodiscard]] auto save_state() const -> std::string override;
+
+    /**
+     * @brief Restore an internal state returned by save_state.
+     * @param state_ The saved state.
+     */
+    auto restore_state(const std::string& state_) -> void override;
+
+private:
+    const crc32c_kernel* m_kernel;
+    std::uint32_t m_crc = 0xFFFFFFFF;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,233 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "delta_transfer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Opcode of an instruction which inserts literal data.
+constexpr char literal_instruction = 0;
+/// Opcode of an instruction which copies blocks of the basis.
+constexpr char copy_instruction = 1;
+/// Opcode of an instruction which inserts a chunk of the chunk store.
+constexpr char reference_instruction = 2;
+/// Number of bytes which are read from the file at once when computing
+/// the signatures.
+constexpr std::size_t signature_read_size = std::size_t{1} << 20;
+
+template <typename T>
+auto append_little_endian(std::string& target_, T value_) -> void {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        target_.push_back(static_cast<char>((value_ >> (8 * i)) & 0xff));
+    }
+}
+
+template <typename T>
+auto read_little_endian(const std::string& source_, std::size_t& position_)
+    -> T {
+    if (source_.size() - position_ < sizeof(T)) {
+        throw exceptions::invalid_argument(
+            "Truncated instruction in the delta chunk."
+        );
+    }
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<unsigned char>(source_[position_++]))
+                 << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+rolling_checksum::rolling_checksum(const char* data_, std::size_t size_)
+    : m_size(size_) {
+    for (std::size_t i = 0; i < size_; ++i) {
+        const auto value = static_cast<std::uint32_t>(
+            static_cast<unsigned char>(data_[i])
+        );
+        m_a += value;
+        m_b += static_cast<std::uint32_t>(size_ - i) * value;
+    }
+    m_a &= 0xffff;
+    m_b &= 0xffff;
+}
+
+auto get_default_delta_block_size(std::uint64_t file_size_) -> std::size_t {
+    constexpr std::size_t granularity = 1024;
+    constexpr std::size_t min_default = 2048;
+    constexpr std::size_t max_default = std::size_t{1} << 20;
+    const auto root = static_cast<std::size_t>(
+        std::sqrt(static_cast<double>(file_size_))
+    );
+    const auto rounded = (root + granularity - 1) / granularity * granularity;
+    return std::clamp(rounded, min_default, max_default);
+}
+
+auto compute_block_signatures(
+    file_reader& reader_,
+    std::uint64_t file_size_,
+    std::size_t block_size_,
+    checksum_algorithm strong_algorithm_
+) -> std::string {
+    const auto num_blocks = (file_size_ + block_size_ - 1) / block_size_;
+    std::string signatures;
+    append_little_endian(signatures, static_cast<std::uint32_t>(block_size_));
+    append_little_endian(signatures, file_size_);
+    const auto digest_size_position = signatures.size();
+    signatures.push_back('\0');
+
+    const auto read_size = std::max(
+        block_size_, signature_read_size / block_size_ * block_size_
+    );
+    std::string buffer;
+    std::size_t digest_size = 0;
+    for (std::uint64_t offset = 0; offset < file_size_;) {
+        const auto size = static_cast<std::size_t>(
+            std::min<std::uint64_t>(read_size, file_size_ - offset)
+        );
+        reader_.read(offset, size, buffer);
+        for (std::size_t position = 0; position < size;
+             position += block_size_) {
+            const auto length = std::min(block_size_, size - position);
+            const auto* block = buffer.data() + position;
+            append_little_endian(
+                signatures, rolling_checksum(block, length).value()
+            );
+            auto strong = make_hasher(strong_algorithm_);
+            strong->update(block, length);
+            const auto digest = digest_from_hex(strong->hex_digest());
+            signatures += digest;
+            digest_size = digest.size();
+        }
+        offset += size;
+    }
+    if (num_blocks == 0) {
+        digest_size = make_hasher(strong_algorithm_)->hex_digest().size() / 2;
+    }
+    signatures[digest_size_position] = static_cast<char>(digest_size);
+    return signatures;
+}
+
+delta_decoder::delta_decoder(
+    std::shared_ptr<file_reader> basis_,
+    std::uint64_t basis_size_,
+    std::size_t block_size_,
+    std::shared_ptr<const chunk_store> store_
+)
+    : m_basis(std::move(basis_)),
+      m_basis_size(basis_size_),
+      m_block_size(block_size_),
+      m_num_blocks((basis_size_ + block_size_ - 1) / block_size_),
+      m_store(std::move(store_)) {}
+
+delta_decoder::delta_decoder(std::shared_ptr<const chunk_store> store_)
+    : m_basis_size(0),
+      m_block_size(1),
+      m_num_blocks(0),
+      m_store(std::move(store_)) {}
+
+auto delta_decoder::decode(const std::string& instructions_, std::string& data_)
+    -> void {
+    data_.clear();
+    std::size_t position = 0;
+    while (position < instructions_.size()) {
+        const auto opcode = instructions_[position++];
+        std::uint64_t length = 0;
+        std::uint64_t offset = 0;
+        if (opcode == literal_instruction) {
+            length = read_little_endian<std::uint32_t>(instructions_, position);
+            if (instructions_.size() - position < length) {
+                throw exceptions::invalid_argument(
+                    "Truncated literal in the delta chunk."
+                );
+            }
+        } else if (opcode == copy_instruction) {
+            const auto first_block =
+                read_little_endian<std::uint64_t>(instructions_, position);
+            const auto num_blocks =
+                read_little_endian<std::uint32_t>(instructions_, position);
+            if (num_blocks == 0 || first_block >= m_num_blocks ||
+                num_blocks > m_num_blocks - first_block) {
+                throw exceptions::invalid_argument(
+                    "Delta chunk refers to blocks " +
+                    std::to_string(first_block) + " to " +
+                    std::to_string(first_block + num_blocks) +
+                    ", but the file has " + std::to_string(m_num_blocks) +
+                    " blocks."
+                );
+            }
+            offset = first_block * m_block_size;
+            length = std::min<std::uint64_t>(
+                num_blocks * std::uint64_t{m_block_size}, m_basis_size - offset
+            );
+        } else if (opcode == reference_instruction && m_store) {
+            chunk_digest digest{};
+            if (instructions_.size() - position < digest.size()) {
+                throw exceptions::invalid_argument(
+                    "Truncated instruction in the delta chunk."
+                );
+            }
+            std::memcpy(
+                digest.data(), instructions_.data() + position, digest.size()
+            );
+            position += digest.size();
+            m_store->read(digest, m_buffer);
+            length = m_buffer.size();
+        } else {
+            throw exceptions::invalid_argument(
+                "Unknown instruction in the delta chunk."
+            );
+        }
+        if (length > max_delta_chunk_size - data_.size()) {
+            throw exceptions::invalid_argument(
+                "Delta chunk produces more than " +
+                std::to_string(max_delta_chunk_size) + " bytes."
+            );
+        }
+        if (opcode == literal_instruction) {
+            data_.append(
+                instructions_, position, static_cast<std::size_t>(length)
+            );
+            position += static_cast<std::size_t>(length);
+        } else {
+            if (opcode == copy_instruction) {
+                m_basis->read(
+                    offset, static_cast<std::size_t>(length), m_buffer
+                );
+            }
+            data_.append(m_buffer);
+        }
+    }
+}
+
+} // namespace file_transfer::detail
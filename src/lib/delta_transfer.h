@@ -0,0 +1,179 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "checksum.h"
+#include "chunk_store.h"
+#include "file_io.h"
+
+namespace file_transfer {
+namespace detail {
+
+/// Smallest block size of a delta upload.
+inline constexpr std::size_t min_delta_block_size = 512;
+/// Largest block size of a delta upload.
+inline constexpr std::size_t max_delta_block_size = std::size_t{1} << 24;
+/// Largest number of bytes which the instructions of one chunk of a
+/// delta upload may produce.
+inline constexpr std::size_t max_delta_chunk_size = std::size_t{1} << 26;
+
+/**
+ * @brief Weak checksum of a window of bytes, which can be rolled over the
+ *      data one byte at a time.
+ *
+ * For the bytes x_0 ... x_{l-1} of the window, with unsigned values,
+ * a = sum(x_i) mod 2^16 and b = sum((l - i) * x_i) mod 2^16. The value
+ * of the checksum is a + 2^16 * b, as in rsync.
+ */
+class rolling_checksum {
+public:
+    rolling_checksum() = default;
+
+    /**
+     * @brief Compute the checksum of a window.
+     * @param data_ Start of the window.
+     * @param size_ Size of the window.
+     */
+    rolling_checksum(const char* data_, std::size_t size_);
+
+    /**
+     * @brief Move the window by one byte.
+     * @param out_ Byte which leaves the window at its start.
+     * @param in_ Byte which enters the window at its end.
+     */
+    auto roll(char out_, char in_) -> void {
+        const auto out = static_cast<std::uint32_t>(
+            static_cast<unsigned char>(out_)
+        );
+        const auto in = static_cast<std::uint32_t>(
+            static_cast<unsigned char>(in_)
+        );
+        m_a = (m_a - out + in) & 0xffff;
+        m_b = (m_b - static_cast<std::uint32_t>(m_size) * out + m_a) & 0xffff;
+    }
+
+    [[nodiscard]] auto value() const -> std::uint32_t {
+        return m_a | (m_b << 16);
+    }
+
+private:
+    std::uint32_t m_a = 0;
+    std::uint32_t m_b = 0;
+    std::size_t m_size = 0;
+};
+
+/**
+ * @brief Get the block size of the signatures of a file, if the client
+ *      does not choose one.
+ *
+ * The block size grows with the square root of the file size, such that
+ * both the signatures and the number of blocks stay small.
+ *
+ * @param file_size_ Size of the file.
+ */
+auto get_default_delta_block_size(std::uint64_t file_size_) -> std::size_t;
+
+/**
+ * @brief Compute the block signatures of a file.
+ *
+ * The file is split into blocks of the given size, the last of which
+ * may be shorter. The signatures start with a header of the block size
+ * (4 bytes), the file size (8 bytes), and the size of the strong digests
+ * (1 byte). Each block follows with its rolling_checksum (4 bytes), and
+ * the raw digest of its strong checksum. All numbers are little-endian.
+ *
+ * @param reader_ Reader of the file.
+ * @param file_size_ Size of the file.
+ * @param block_size_ Size of the blocks.
+ * @param strong_algorithm_ Algorithm of the strong checksums.
+ * @return The signatures.
+ */
+auto compute_block_signatures(
+    file_reader& reader_,
+    std::uint64_t file_size_,
+    std::size_t block_size_,
+    checksum_algorithm strong_algorithm_
+) -> std::string;
+
+/**
+ * @brief Reconstructs the chunks of a delta upload from the existing
+ *      copy of the file, the basis, and from the chunk store.
+ *
+ * The data of each chunk is a sequence of instructions. A literal
+ * instruction is the byte 0, the length of the literal (4 bytes), and
+ * its data. A copy instruction is the byte 1, the index of the first
+ * block of the basis (8 bytes), and the number of consecutive blocks
+ * (4 bytes). A reference instruction is the byte 2, and the digest of a
+ * chunk in the chunk store (32 bytes). All numbers are little-endian.
+ */
+class delta_decoder {
+public:
+    /**
+     * @brief Construct the decoder.
+     * @param basis_ Reader of the basis.
+     * @param basis_size_ Size of the basis.
+     * @param block_size_ Block size of the signatures of the basis.
+     * @param store_ Store of the referenced chunks, if any.
+     */
+    delta_decoder(
+        std::shared_ptr<file_reader> basis_,
+        std::uint64_t basis_size_,
+        std::size_t block_size_,
+        std::shared_ptr<const chunk_store> store_ = nullptr
+    );
+
+    /**
+     * @brief Construct a decoder without a basis, which only accepts
+     *      literal and reference instructions.
+     * @param store_ Store of the referenced chunks.
+     */
+    explicit delta_decoder(std::shared_ptr<const chunk_store> store_);
+
+    /**
+     * @brief Reconstruct the data of a chunk.
+     * @param instructions_ Instructions of the chunk.
+     * @param data_ String which receives the data. Its buffer is reused.
+     * @throws exceptions::invalid_argument if the instructions are
+     *      malformed, refer to blocks which do not exist, or produce more
+     *      than max_delta_chunk_size bytes.
+     * @throws exceptions::failed_precondition if a referenced chunk is not
+     *      in the chunk store.
+     */
+    auto decode(const std::string& instructions_, std::string& data_) -> void;
+
+private:
+    std::shared_ptr<file_reader> m_basis;
+    std::uint64_t m_basis_size;
+    std::size_t m_block_size;
+    std::uint64_t m_num_blocks;
+    std::shared_ptr<const chunk_store> m_store;
+    std::string m_buffer;
+};
+
+} // namespace detail
+} // namespace file_transfer
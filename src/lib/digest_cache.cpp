@@ -0,0 +1,404 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "digest_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Factor by which the index may grow beyond its compacted size.
+constexpr std::size_t index_compaction_factor = 4;
+
+/// Number of records below which the index is never compacted.
+constexpr std::size_t min_index_compaction = 1024;
+
+} // namespace
+
+auto get_file_identity(const boost::filesystem::path& path_)
+    -> std::optional<file_identity> {
+    file_identity identity;
+#ifdef _WIN32
+    const auto handle = CreateFileW(
+        path_.wstring().c_str(),
+        0,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS,
+        nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    const auto success = GetFileInformationByHandle(handle, &info);
+    CloseHandle(handle);
+    if (success == 0) {
+        return std::nullopt;
+    }
+    identity.device = info.dwVolumeSerialNumber;
+    identity.inode = (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) |
+                     info.nFileIndexLow;
+    identity.size = (static_cast<std::uint64_t>(info.nFileSizeHigh) << 32) |
+                    info.nFileSizeLow;
+    // The write time is given in 100-nanosecond intervals.
+    identity.mtime_ns = static_cast<std::int64_t>(
+        ((static_cast<std::uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32
+         ) |
+         info.ftLastWriteTime.dwLowDateTime) *
+        100
+    );
+#else
+    struct stat status {};
+    if (::stat(path_.c_str(), &status) != 0) {
+        return std::nullopt;
+    }
+    identity.device = static_cast<std::uint64_t>(status.st_dev);
+    identity.inode = static_cast<std::uint64_t>(status.st_ino);
+    identity.size = static_cast<std::uint64_t>(status.st_size);
+#ifdef __APPLE__
+    const auto& mtime = status.st_mtimespec;
+#else
+    const auto& mtime = status.st_mtim;
+#endif
+    identity.mtime_ns =
+        static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+#endif
+    return identity;
+}
+
+auto digest_cache::file_key_hash::operator()(const file_key& key_) const
+    -> std::size_t {
+    const auto device_hash = std::hash<std::uint64_t>{}(key_.device);
+    const auto inode_hash = std::hash<std::uint64_t>{}(key_.inode);
+    return device_hash ^ (inode_hash + 0x9E3779B9 + (device_hash << 6) +
+                          (device_hash >> 2));
+}
+
+digest_cache::digest_cache(
+    std::size_t max_files_, const boost::filesystem::path& index_path_
+)
+    : m_max_files{max_files_}, m_index_path{index_path_} {
+    if (!m_index_path.empty()) {
+        load_index();
+    }
+}
+
+auto digest_cache::get_hex_digest(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    io_backend backend_
+) -> std::string {
+    const auto identity = get_file_identity(path_);
+    if (identity) {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        auto hex_digest = lookup_locked(*identity, algorithm_);
+        if (hex_digest) {
+            BOOST_LOG_TRIVIAL(debug)
+                << "Using cached checksum of " << path_.generic_string();
+            return *std::move(hex_digest);
+        }
+    }
+
+    // Hash without holding the lock. The digest is only cached if the file
+    // did not change in the meantime.
+    auto hex_digest = detail::get_hex_digest(path_, algorithm_, backend_);
+    const auto identity_after = get_file_identity(path_);
+    if (identity && identity_after && *identity == *identity_after) {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        insert_locked(*identity, algorithm_, hex_digest);
+    }
+    return hex_digest;
+}
+
+auto digest_cache::lookup(
+    const boost::filesystem::path& path_, checksum_algorithm algorithm_
+) -> std::optional<std::string> {
+    const auto identity = get_file_identity(path_);
+    if (!identity) {
+        return std::nullopt;
+    }
+    return lookup(*identity, algorithm_);
+}
+
+auto digest_cache::lookup(
+    const file_identity& identity_, checksum_algorithm algorithm_
+) -> std::optional<std::string> {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    return lookup_locked(identity_, algorithm_);
+}
+
+auto digest_cache::insert(
+    const boost::filesystem::path& path_,
+    checksum_algorithm algorithm_,
+    const std::string& hex_digest_
+) -> void {
+    const auto identity = get_file_identity(path_);
+    if (!identity) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    insert_locked(*identity, algorithm_, hex_digest_);
+}
+
+auto digest_cache::insert(
+    const boost::filesystem::path& path_,
+    const file_identity& identity_,
+    checksum_algorithm algorithm_,
+    const std::string& hex_digest_
+) -> void {
+    if (get_file_identity(path_) != identity_) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    insert_locked(identity_, algorithm_, hex_digest_);
+}
+
+auto digest_cache::invalidate(const boost::filesystem::path& path_) -> void {
+    const auto identity = get_file_identity(path_);
+    if (!identity) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    const file_key key{identity->device, identity->inode};
+    if (m_entries.count(key) == 0) {
+        return;
+    }
+    erase_locked(key);
+    write_index_record(
+        "- " + std::to_string(key.device) + " " + std::to_string(key.inode)
+    );
+}
+
+auto digest_cache::lookup_locked(
+    const file_identity& identity_, checksum_algorithm algorithm_
+) -> std::optional<std::string> {
+    const file_key key{identity_.device, identity_.inode};
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    auto& entry = it->second;
+    if (entry.size != identity_.size || entry.mtime_ns != identity_.mtime_ns) {
+        // The file has been modified since its digests were computed.
+        erase_locked(key);
+        return std::nullopt;
+    }
+    const auto digest_it = entry.hex_digests.find(algorithm_);
+    if (digest_it == entry.hex_digests.end()) {
+        return std::nullopt;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru_position);
+    return digest_it->second;
+}
+
+auto digest_cache::insert_locked(
+    const file_identity& identity_,
+    checksum_algorithm algorithm_,
+    const std::string& hex_digest_
+) -> void {
+    if (m_max_files == 0) {
+        return;
+    }
+    const file_key key{identity_.device, identity_.inode};
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && (it->second.size != identity_.size ||
+                                  it->second.mtime_ns != identity_.mtime_ns)) {
+        erase_locked(key);
+        it = m_entries.end();
+    }
+    if (it == m_entries.end()) {
+        m_lru.push_front(key);
+        it = m_entries
+                 .emplace(
+                     key,
+                     entry{identity_.size, identity_.mtime_ns, {}, m_lru.begin()}
+                 )
+                 .first;
+    } else {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+    }
+    it->second.hex_digests[algorithm_] = hex_digest_;
+    write_index_record(
+        "+ " + std::to_string(identity_.device) + " " +
+        std::to_string(identity_.inode) + " " + std::to_string(identity_.size) +
+        " " + std::to_string(identity_.mtime_ns) + " " + to_string(algorithm_) +
+        " " + hex_digest_
+    );
+
+    while (m_entries.size() > m_max_files) {
+        erase_locked(m_lru.back());
+    }
+}
+
+auto digest_cache::erase_locked(const file_key& key_) -> void {
+    const auto it = m_entries.find(key_);
+    if (it != m_entries.end()) {
+        m_lru.erase(it->second.lru_position);
+        m_entries.erase(it);
+    }
+}
+
+auto digest_cache::load_index() -> void {
+    {
+        boost::filesystem::ifstream index{m_index_path};
+        std::string line;
+        while (std::getline(index, line)) {
+            std::istringstream record{line};
+            std::string type;
+            file_identity identity;
+            record >> type >> identity.device >> identity.inode;
+            if (type == "-" && record) {
+                erase_locked({identity.device, identity.inode});
+                continue;
+            }
+            std::string algorithm;
+            std::string hex_digest;
+            record >> identity.size >> identity.mtime_ns >> algorithm >>
+                hex_digest;
+            if (type != "+" || !record) {
+                BOOST_LOG_TRIVIAL(warning)
+                    << "Ignoring malformed checksum cache record: " << line;
+                continue;
+            }
+            try {
+                insert_locked(
+                    identity,
+                    checksum_algorithm_from_string(algorithm),
+                    hex_digest
+                );
+            } catch (const std::invalid_argument&) {
+                BOOST_LOG_TRIVIAL(warning)
+                    << "Ignoring malformed checksum cache record: " << line;
+            }
+        }
+    }
+
+    // Compact the index, such that it only contains the current entries.
+    compact_index_locked();
+}
+
+auto digest_cache::compact_index_locked() -> void {
+    m_index.close();
+    auto compacted_path = m_index_path;
+    compacted_path += ".tmp";
+    std::size_t num_records = 0;
+    {
+        boost::filesystem::ofstream compacted{
+            compacted_path, std::ios_base::out | std::ios_base::trunc
+        };
+        for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it) {
+            const auto& entry = m_entries.at(*it);
+            for (const auto& [algorithm, hex_digest] : entry.hex_digests) {
+                compacted << "+ " << it->device << " " << it->inode << " "
+                          << entry.size << " " << entry.mtime_ns << " "
+                          << to_string(algorithm) << " " << hex_digest
+                          << '\n';
+                ++num_records;
+            }
+        }
+        compacted.close();
+        boost::system::error_code error_code;
+        if (compacted.fail()) {
+            boost::filesystem::remove(compacted_path, error_code);
+            throw std::runtime_error(
+                "Could not write the checksum cache index " +
+                compacted_path.generic_string() + "."
+            );
+        }
+        boost::filesystem::rename(compacted_path, m_index_path, error_code);
+        if (error_code) {
+            boost::system::error_code ignored;
+            boost::filesystem::remove(compacted_path, ignored);
+            throw std::runtime_error(
+                "Could not replace the checksum cache index " +
+                m_index_path.generic_string() + ": " + error_code.message()
+            );
+        }
+    }
+    m_index.open(m_index_path, std::ios_base::app);
+    if (!m_index.good()) {
+        throw std::runtime_error(
+            "Could not open the checksum cache index " +
+            m_index_path.generic_string() + "."
+        );
+    }
+    m_num_index_records = num_records;
+    m_index_compaction_threshold =
+        std::max(index_compaction_factor * num_records, min_index_compaction);
+}
+
+auto digest_cache::write_index_record(const std::string& record_) -> void {
+    if (!m_index.is_open()) {
+        return;
+    }
+    m_index << record_ << std::endl;
+    ++m_num_index_records;
+    // Records of replaced, invalidated, and evicted entries accumulate in
+    // the index until it is compacted.
+    if (m_num_index_records <= m_index_compaction_threshold) {
+        return;
+    }
+    try {
+        compact_index_locked();
+    } catch (const std::runtime_error& e) {
+        BOOST_LOG_TRIVIAL(warning) << e.what() << " Not persisting digests.";
+    }
+}
+
+} // namespace file_transfer::detail
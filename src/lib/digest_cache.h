@@ -0,0 +1,231 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "checksum.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Identity of a file on disk, and the state of its content.
+ *
+ * The device and inode identify the file independently of its path. The
+ * size and modification time change whenever the content is written.
+ */
+struct file_identity {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    auto operator==(const file_identity& other_) const -> bool {
+        return device == other_.device && inode == other_.inode &&
+               size == other_.size && mtime_ns == other_.mtime_ns;
+    }
+    auto operator!=(const file_identity& other_) const -> bool {
+        return !(*this == other_);
+    }
+};
+
+/**
+ * @brief Get the identity of a file.
+ * @param path_ Path to the file.
+ * @return The identity, or an empty optional if the file does not exist.
+ */
+auto get_file_identity(const boost::filesystem::path& path_)
+    -> std::optional<file_identity>;
+
+/**
+ * @brief Cache of file digests, keyed by the identity of the files.
+ *
+ * A cached digest is only returned while the size and modification time
+ * of the file are unchanged. The cache holds a limited number of files,
+ * and evicts the least recently used ones.
+ *
+ * Optionally, the cache is persisted in an index file, such that digests
+ * survive a restart of the server. Changes are appended to the index as
+ * they happen, and the index is compacted when it is loaded, and when it
+ * has grown to several times its compacted size.
+ *
+ * All member functions are thread-safe.
+ */
+class digest_cache {
+public:
+    /**
+     * @brief Construct the cache.
+     * @param max_files_ Maximum number of files for which digests are kept.
+     * @param index_path_ Path of the index file, or an empty path to keep
+     *      the cache in memory only.
+     * @throws std::runtime_error if the index can not be written.
+     */
+    explicit digest_cache(
+        std::size_t max_files_, const boost::filesystem::path& index_path_ = {}
+    );
+
+    /**
+     * @brief Get the hex digest of a file, computing it on a cache miss.
+     * @param path_ Path to the file.
+     * @param algorithm_ The checksum algorithm.
+     * @param backend_ Backend used to read the file on a cache miss.
+     */
+    auto get_hex_digest(
+        const boost::filesystem::path& path_,
+        checksum_algorithm algorithm_,
+        io_backend backend_ = io_backend::stream
+    ) -> std::string;
+
+    /**
+     * @brief Get the hex digest of a file, if it is cached.
+     * @param path_ Path to the file.
+     * @param algorithm_ The checksum algorithm.
+     */
+    auto lookup(
+        const boost::filesystem::path& path_, checksum_algorithm algorithm_
+    ) -> std::optional<std::string>;
+
+    /**
+     * @brief Get the cached hex digest of a given file content.
+     *
+     * Use this overload if the identity of the file is needed as well, such
+     * that the digest is known to belong to that identity.
+     * @param identity_ Identity of the file.
+     * @param algorithm_ The checksum algorithm.
+     */
+    auto lookup(const file_identity& identity_, checksum_algorithm algorithm_)
+        -> std::optional<std::string>;
+
+    /**
+     * @brief Add a digest which was computed from the current file content.
+     * @param path_ Path to the file.
+     * @param algorithm_ The checksum algorithm.
+     * @param hex_digest_ The hex digest of the file.
+     */
+    auto insert(
+        const boost::filesystem::path& path_,
+        checksum_algorithm algorithm_,
+        const std::string& hex_digest_
+    ) -> void;
+
+    /**
+     * @brief Add a digest which was computed from a given file content.
+     *
+     * Use this overload if the file was read over a longer time, and its
+     * identity was taken before it was read. The digest is not cached if
+     * the file has changed since.
+     * @param path_ Path to the file.
+     * @param identity_ Identity of the file when it was read.
+     * @param algorithm_ The checksum algorithm.
+     * @param hex_digest_ The hex digest of the file.
+     */
+    auto insert(
+        const boost::filesystem::path& path_,
+        const file_identity& identity_,
+        checksum_algorithm algorithm_,
+        const std::string& hex_digest_
+    ) -> void;
+
+    /**
+     * @brief Remove all digests of a file, before it is overwritten.
+     * @param path_ Path to the file.
+     */
+    auto invalidate(const boost::filesystem::path& path_) -> void;
+
+private:
+    struct file_key {
+        std::uint64_t device;
+        std::uint64_t inode;
+
+        auto operator==(const file_key& other_) const -> bool {
+            return device == other_.device && inode == other_.inode;
+        }
+    };
+    struct file_key_hash {
+        auto operator()(const file_key& key_) const -> std::size_t;
+    };
+    struct entry {
+        std::uint64_t size;
+        std::int64_t mtime_ns;
+        std::map<checksum_algorithm, std::string> hex_digests;
+        std::list<file_key>::iterator lru_position;
+    };
+
+    auto lookup_locked(
+        const file_identity& identity_, checksum_algorithm algorithm_
+    ) -> std::optional<std::string>;
+    auto insert_locked(
+        const file_identity& identity_,
+        checksum_algorithm algorithm_,
+        const std::string& hex_digest_
+    ) -> void;
+    auto erase_locked(const file_key& key_) -> void;
+
+    auto load_index() -> void;
+    /**
+     * @brief Rewrite the index with the current entries only.
+     * @throws std::runtime_error if the index can not be written.
+     */
+    auto compact_index_locked() -> void;
+    auto write_index_record(const std::string& record_) -> void;
+
+    std::size_t m_max_files;
+    boost::filesystem::path m_index_path;
+    boost::filesystem::ofstream m_index;
+    /// Number of records in the index, including outdated ones.
+    std::size_t m_num_index_records = 0;
+    /// Number of records beyond which the index is compacted again.
+    std::size_t m_index_compaction_threshold = 0;
+
+    std::mutex m_mutex;
+    std::unordered_map<file_key, entry, file_key_hash> m_entries;
+    /// Keys of the entries, from the most to the least recently used.
+    std::list<file_key> m_lru;
+};
+
+} // namespace detail
+} // namespace file_transfer
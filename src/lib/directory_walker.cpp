@@ -0,0 +1,166 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "directory_walker.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/post.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer::detail {
+
+directory_walker::directory_walker(
+    boost::filesystem::path root_,
+    path_filter filter_,
+    boost::asio::thread_pool* thread_pool_
+)
+    : m_root{std::move(root_)},
+      m_filter{std::move(filter_)},
+      m_thread_pool{thread_pool_} {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    m_directories.emplace_back();
+    schedule();
+}
+
+directory_walker::~directory_walker() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_stopped = true;
+    m_condition.wait(lock, [this]() { return m_num_tasks == 0; });
+}
+
+auto directory_walker::schedule() -> void {
+    if (m_thread_pool == nullptr || m_stopped) {
+        return;
+    }
+    ++m_num_tasks;
+    boost::asio::post(*m_thread_pool, [this]() {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        list_next(lock);
+        --m_num_tasks;
+        m_condition.notify_all();
+    });
+}
+
+auto directory_walker::list_next(std::unique_lock<std::mutex>& lock_)
+    -> void {
+    // Another task or the consumer may have taken the directory already.
+    if (m_stopped || m_directories.empty()) {
+        return;
+    }
+    const auto relative_path = std::move(m_directories.front());
+    m_directories.pop_front();
+    ++m_num_listing;
+    lock_.unlock();
+    list(relative_path);
+    lock_.lock();
+    --m_num_listing;
+    m_condition.notify_all();
+}
+
+auto directory_walker::list(const std::string& relative_path_) -> void {
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+    std::optional<std::string> error;
+
+    boost::system::error_code error_code;
+    const auto directory =
+        relative_path_.empty() ? m_root : m_root / relative_path_;
+    boost::filesystem::directory_iterator it{directory, error_code};
+    for (; !error_code && it != boost::filesystem::directory_iterator{};
+         it.increment(error_code)) {
+        const auto name = it->path().filename().string();
+        const auto entry_path =
+            relative_path_.empty() ? name : relative_path_ + "/" + name;
+        const auto link_status = it->symlink_status(error_code);
+        if (error_code) {
+            break;
+        }
+        if (boost::filesystem::is_directory(link_status)) {
+            if (m_filter.includes_directory(entry_path)) {
+                directories.push_back(entry_path);
+            }
+            continue;
+        }
+        // Broken links and other special files are skipped.
+        boost::system::error_code status_error;
+        if (boost::filesystem::is_regular_file(it->status(status_error)) &&
+            m_filter.includes_file(entry_path)) {
+            files.push_back(entry_path);
+        }
+    }
+    if (error_code) {
+        error = "Could not list the directory " + directory.string() + ": " +
+                error_code.message();
+    }
+    std::sort(files.begin(), files.end());
+
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    for (auto& file : files) {
+        m_entries.push_back({std::move(file), std::nullopt});
+    }
+    if (error) {
+        m_entries.push_back({relative_path_, std::move(error)});
+    }
+    for (auto& subdirectory : directories) {
+        m_directories.push_back(std::move(subdirectory));
+        schedule();
+    }
+}
+
+auto directory_walker::next() -> std::optional<directory_entry> {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (true) {
+        if (!m_entries.empty()) {
+            auto entry = std::move(m_entries.front());
+            m_entries.pop_front();
+            return entry;
+        }
+        if (!m_directories.empty()) {
+            // Rather than wait for the thread pool, the consumer lists the
+            // next directory itself.
+            list_next(lock);
+            continue;
+        }
+        if (m_num_listing == 0) {
+            return std::nullopt;
+        }
+        m_condition.wait(lock);
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,132 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "path_filter.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief A file found by the directory_walker, or a directory which could
+ *      not be listed.
+ */
+struct directory_entry {
+    /// Path relative to the root of the walk, with "/" as separator. Empty
+    /// for the root itself.
+    std::string relative_path;
+    /// Why the directory could not be listed, if it is not a file.
+    std::optional<std::string> error;
+};
+
+/**
+ * @brief Walks a directory tree, and yields the regular files which the
+ *      filter includes.
+ *
+ * The directories are listed on a thread pool, several at a time, ahead
+ * of the consumer. The entries of one directory are yielded in the order
+ * of their names, but the directories are yielded in no particular order.
+ * Symbolic links to files are yielded; symbolic links to directories are
+ * not followed.
+ *
+ * The member functions must be called from a single thread.
+ */
+class directory_walker {
+public:
+    /**
+     * @brief Construct the walker, and start listing the root.
+     * @param root_ Root directory of the walk.
+     * @param filter_ Filter which selects the files and directories.
+     * @param thread_pool_ Thread pool which lists the directories. It must
+     *      outlive the walker. If null, the directories are listed by next.
+     */
+    directory_walker(
+        boost::filesystem::path root_,
+        path_filter filter_,
+        boost::asio::thread_pool* thread_pool_
+    );
+
+    directory_walker(const directory_walker&) = delete;
+    directory_walker& operator=(const directory_walker&) = delete;
+    directory_walker(directory_walker&&) = delete;
+    directory_walker& operator=(directory_walker&&) = delete;
+
+    /**
+     * @brief Destroy the walker, after the running listings ended.
+     */
+    ~directory_walker();
+
+    /**
+     * @brief Get the next entry, waiting for a directory to be listed if
+     *      needed.
+     * @return The entry, or an empty optional if the walk is complete.
+     */
+    auto next() -> std::optional<directory_entry>;
+
+private:
+    /// Take a directory off the queue and list it, unless the walk is
+    /// stopped. Must be called with the lock held.
+    auto list_next(std::unique_lock<std::mutex>& lock_) -> void;
+    auto list(const std::string& relative_path_) -> void;
+    auto schedule() -> void;
+
+    boost::filesystem::path m_root;
+    path_filter m_filter;
+    boost::asio::thread_pool* m_thread_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    /// Directories which have not been listed yet.
+    std::deque<std::string> m_directories;
+    /// Entries which have not been yielded yet.
+    std::deque<directory_entry> m_entries;
+    std::size_t m_num_listing = 0;
+    std::size_t m_num_tasks = 0;
+    bool m_stopped = false;
+};
+
+} // namespace detail
+} // namespace file_transfer
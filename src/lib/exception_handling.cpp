@@ -40,6 +40,7 @@
 #endif
 
 #include "exception_types.h"
+#include "metrics.h"
 
 namespace file_transfer::exceptions {
 
@@ -49,10 +50,8 @@ auto get_exception_message(const ExceptionT& exc) -> std::string {
     return std::string(exc.what()) + '\n' +
            to_string(boost::stacktrace::stacktrace());
 }
-} // namespace detail
 
-auto convert_exceptions_to_status_codes(const std::function<void()>& fun)
-    -> ::grpc::Status {
+auto run_and_convert(const std::function<void()>& fun) -> ::grpc::Status {
     try {
         fun();
     } catch (const exceptions::not_found& exc) {
@@ -96,5 +95,15 @@ auto convert_exceptions_to_status_codes(const std::function<void()>& fun)
     }
     return ::grpc::Status::OK;
 }
+} // namespace detail
+
+auto convert_exceptions_to_status_codes(const std::function<void()>& fun)
+    -> ::grpc::Status {
+    auto status = detail::run_and_convert(fun);
+    if (!status.ok()) {
+        metrics::count_error(status.error_code());
+    }
+    return status;
+}
 
 } // namespace file_transfer::exceptions
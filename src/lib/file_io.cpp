@@ -0,0 +1,937 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "file_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ios>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_types.h"
+#include "io_uring_queue.h"
+
+namespace file_transfer::detail {
+
+auto io_backend_from_string(const std::string& name_) -> io_backend {
+    if (name_ == "stream") {
+        return io_backend::stream;
+    }
+    if (name_ == "mmap") {
+        return io_backend::mmap;
+    }
+    if (name_ == "pread") {
+#ifdef _WIN32
+        throw std::invalid_argument(
+            "The 'pread' I/O backend is not available on Windows."
+        );
+#else
+        return io_backend::pread;
+#endif
+    }
+    if (name_ == "io_uring") {
+        return io_backend::io_uring;
+    }
+    throw std::invalid_argument("Unknown I/O backend '" + name_ + "'.");
+}
+
+namespace {
+
+/**
+ * @brief File reader based on a buffered file stream.
+ */
+class stream_file_reader final : public file_reader {
+public:
+    explicit stream_file_reader(const boost::filesystem::path& path_)
+        : m_file{path_, std::ios_base::binary} {
+        if (!m_file.good()) {
+            throw exceptions::failed_precondition(
+                "Could not open file " + path_.string() + " for reading."
+            );
+        }
+    }
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override {
+        // Seeking discards the stream buffer, so it is only done when the
+        // chunks are not read sequentially.
+        if (offset_ != m_position) {
+            m_file.seekg(boost::numeric_cast<std::streamoff>(offset_));
+        }
+        target_.resize(size_);
+        m_file.read(target_.data(), boost::numeric_cast<std::streamsize>(size_));
+        if (m_file.gcount() != boost::numeric_cast<std::streamsize>(size_)) {
+            throw exceptions::internal("Could not read the requested chunk.");
+        }
+        m_position = offset_ + size_;
+    }
+
+private:
+    boost::filesystem::ifstream m_file;
+    std::uint64_t m_position = 0;
+};
+
+/**
+ * @brief File reader based on a read-only memory mapping of the file.
+ *
+ * The chunks are copied directly from the mapped pages into the target,
+ * without a read call per chunk.
+ *
+ * @note If the file is truncated while it is mapped, accessing the
+ *      pages past the new end of the file raises a bus error.
+ */
+class mapped_file_reader final : public file_reader {
+public:
+    mapped_file_reader(
+        const boost::filesystem::path& path_, std::uint64_t file_size_
+    )
+        : m_file_size{file_size_} {
+        // An empty file cannot be mapped, but it has no chunks to read
+        // either.
+        if (m_file_size == 0) {
+            return;
+        }
+        try {
+            m_mapping = boost::interprocess::file_mapping(
+                path_.c_str(), boost::interprocess::read_only
+            );
+            m_region = boost::interprocess::mapped_region(
+                m_mapping,
+                boost::interprocess::read_only,
+                0,
+                boost::numeric_cast<std::size_t>(m_file_size)
+            );
+        } catch (const boost::interprocess::interprocess_exception& exc) {
+            throw exceptions::failed_precondition(
+                "Could not map file " + path_.string() + ": " + exc.what()
+            );
+        }
+        m_region.advise(boost::interprocess::mapped_region::advice_sequential);
+    }
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override {
+        if (offset_ > m_file_size || size_ > m_file_size - offset_) {
+            throw exceptions::internal("Could not read the requested chunk.");
+        }
+        if (size_ == 0) {
+            target_.clear();
+            return;
+        }
+        target_.assign(
+            static_cast<const char*>(m_region.get_address()) +
+                boost::numeric_cast<std::size_t>(offset_),
+            size_
+        );
+    }
+
+    auto prefetch(std::uint64_t offset_, std::size_t size_) -> void override {
+#ifdef _WIN32
+        static_cast<void>(offset_);
+        static_cast<void>(size_);
+#else
+        if (offset_ >= m_file_size || size_ == 0) {
+            return;
+        }
+        // madvise needs a page-aligned start address.
+        const auto page_size =
+            boost::interprocess::mapped_region::get_page_size();
+        const auto begin = boost::numeric_cast<std::size_t>(offset_);
+        const auto aligned_begin = begin - begin % page_size;
+        const auto end = std::min(
+            begin + size_, boost::numeric_cast<std::size_t>(m_file_size)
+        );
+        // The advice is only a hint, so errors are ignored.
+        static_cast<void>(::madvise(
+            static_cast<char*>(m_region.get_address()) + aligned_begin,
+            end - aligned_begin,
+            MADV_WILLNEED
+        ));
+#endif
+    }
+
+    [[nodiscard]] auto supports_concurrent_reads() const -> bool override {
+        return true;
+    }
+
+private:
+    std::uint64_t m_file_size;
+    boost::interprocess::file_mapping m_mapping;
+    boost::interprocess::mapped_region m_region;
+};
+
+#ifndef _WIN32
+/**
+ * @brief File reader based on positional reads of a file descriptor.
+ *
+ * Since pread does not modify the file offset, concurrent reads of the
+ * same descriptor do not interfere, and the reader can be shared.
+ */
+class positional_file_reader final : public file_reader {
+public:
+    explicit positional_file_reader(const boost::filesystem::path& path_)
+        : m_fd{::open(path_.c_str(), O_RDONLY | O_CLOEXEC)} {
+        if (m_fd < 0) {
+            throw exceptions::failed_precondition(
+                "Could not open file " + path_.string() +
+                " for reading: " + std::strerror(errno)
+            );
+        }
+    }
+
+    positional_file_reader(const positional_file_reader&) = delete;
+    positional_file_reader& operator=(const positional_file_reader&) = delete;
+    positional_file_reader(positional_file_reader&&) = delete;
+    positional_file_reader& operator=(positional_file_reader&&) = delete;
+    ~positional_file_reader() override { ::close(m_fd); }
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override {
+        target_.resize(size_);
+        std::size_t num_read = 0;
+        while (num_read < size_) {
+            const auto result = ::pread(
+                m_fd,
+                target_.data() + num_read,
+                size_ - num_read,
+                boost::numeric_cast<off_t>(offset_ + num_read)
+            );
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                throw exceptions::internal("Could not read the requested chunk.");
+            }
+            num_read += static_cast<std::size_t>(result);
+        }
+    }
+
+    auto prefetch(std::uint64_t offset_, std::size_t size_) -> void override {
+#ifdef POSIX_FADV_WILLNEED
+        // The advice is only a hint, so errors are ignored.
+        static_cast<void>(::posix_fadvise(
+            m_fd,
+            boost::numeric_cast<off_t>(offset_),
+            boost::numeric_cast<off_t>(size_),
+            POSIX_FADV_WILLNEED
+        ));
+#else
+        static_cast<void>(offset_);
+        static_cast<void>(size_);
+#endif
+    }
+
+    [[nodiscard]] auto supports_concurrent_reads() const -> bool override {
+        return true;
+    }
+
+private:
+    int m_fd;
+};
+#endif
+
+#ifndef _WIN32
+auto open_descriptor(
+    const boost::filesystem::path& path_, int flags_, const char* purpose_
+) -> int {
+    const auto fd = ::open(path_.c_str(), flags_ | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        throw exceptions::failed_precondition(
+            "Could not open file " + path_.string() + " for " + purpose_ +
+            ": " + std::strerror(errno)
+        );
+    }
+    return fd;
+}
+
+/**
+ * @brief Get the flags which open a file for writing, like a file stream
+ *      with the given mode.
+ */
+auto get_write_flags(std::ios_base::openmode mode_) -> int {
+    return (mode_ & std::ios_base::in) != 0 ? O_RDWR
+                                            : O_WRONLY | O_CREAT | O_TRUNC;
+}
+#endif
+
+#ifdef O_DIRECT
+/// Alignment of the buffers, offsets and sizes of direct writes.
+constexpr std::size_t direct_io_alignment = 4096;
+/// Size of the blocks which a direct writer fills and writes.
+constexpr std::size_t direct_io_block_size = std::size_t{1} << 20;
+
+/**
+ * @brief Buffer of a file which is written with O_DIRECT, bypassing the
+ *      page cache.
+ *
+ * Direct writes need aligned memory, offsets and sizes. Data which does
+ * not fill an aligned block, such as the end of the file or the data
+ * before an unaligned offset, is written through the page cache instead.
+ */
+class direct_file_buffer final : public std::streambuf {
+public:
+    /**
+     * @brief Take over a file descriptor which was opened with O_DIRECT.
+     */
+    explicit direct_file_buffer(int fd_)
+        : m_fd{fd_},
+          m_flags{::fcntl(fd_, F_GETFL)},
+          m_buffer{static_cast<char*>(
+              std::aligned_alloc(direct_io_alignment, direct_io_block_size)
+          )} {
+        if (!m_buffer) {
+            ::close(m_fd);
+            throw std::bad_alloc();
+        }
+        reset_put_area();
+    }
+
+    direct_file_buffer(const direct_file_buffer&) = delete;
+    direct_file_buffer& operator=(const direct_file_buffer&) = delete;
+    direct_file_buffer(direct_file_buffer&&) = delete;
+    direct_file_buffer& operator=(direct_file_buffer&&) = delete;
+    ~direct_file_buffer() override {
+        static_cast<void>(sync());
+        ::close(m_fd);
+    }
+
+protected:
+    auto overflow(int_type ch_) -> int_type override {
+        if (!write_buffer()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch_, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch_);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch_);
+    }
+
+    auto sync() -> int override { return write_buffer() ? 0 : -1; }
+
+    auto seekoff(
+        off_type offset_,
+        std::ios_base::seekdir direction_,
+        std::ios_base::openmode /* which_ */
+    ) -> pos_type override {
+        const auto buffered = static_cast<off_type>(pptr() - pbase());
+        if (direction_ == std::ios_base::cur && offset_ == 0) {
+            return static_cast<off_type>(m_position) + buffered;
+        }
+        if (!write_buffer()) {
+            return {off_type{-1}};
+        }
+        off_type base = 0;
+        if (direction_ == std::ios_base::cur) {
+            base = static_cast<off_type>(m_position);
+        } else if (direction_ == std::ios_base::end) {
+            base = ::lseek(m_fd, 0, SEEK_END);
+        }
+        if (base < 0 || base + offset_ < 0) {
+            return {off_type{-1}};
+        }
+        m_position = static_cast<std::uint64_t>(base + offset_);
+        reset_put_area();
+        return static_cast<off_type>(m_position);
+    }
+
+    auto seekpos(pos_type position_, std::ios_base::openmode which_)
+        -> pos_type override {
+        return seekoff(off_type{position_}, std::ios_base::beg, which_);
+    }
+
+private:
+    struct free_deleter {
+        auto operator()(char* buffer_) const -> void { std::free(buffer_); }
+    };
+
+    auto reset_put_area() -> void {
+        // Up to the next aligned offset, the data is written through the
+        // page cache, after which whole blocks are written directly.
+        const auto misalignment = m_position % direct_io_alignment;
+        const auto capacity = misalignment == 0
+                                  ? direct_io_block_size
+                                  : direct_io_alignment - misalignment;
+        setp(m_buffer.get(), m_buffer.get() + capacity);
+    }
+
+    auto write_buffer() -> bool {
+        const auto size = static_cast<std::size_t>(pptr() - pbase());
+        const auto num_direct = m_position % direct_io_alignment == 0
+                                    ? size - size % direct_io_alignment
+                                    : 0;
+        auto success = write_at(pbase(), num_direct, m_position, true) &&
+                       write_at(
+                           pbase() + num_direct,
+                           size - num_direct,
+                           m_position + num_direct,
+                           false
+                       );
+        m_position += size;
+        reset_put_area();
+        return success;
+    }
+
+    auto write_at(
+        const char* data_,
+        std::size_t size_,
+        std::uint64_t offset_,
+        bool direct_
+    ) -> bool {
+        if (size_ == 0) {
+            return true;
+        }
+        set_direct(direct_);
+        std::size_t num_written = 0;
+        while (num_written < size_) {
+            const auto result = ::pwrite(
+                m_fd,
+                data_ + num_written,
+                size_ - num_written,
+                static_cast<off_t>(offset_ + num_written)
+            );
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 && errno == EINVAL && m_direct) {
+                // The device needs a larger alignment, so the data is
+                // written through the page cache from now on.
+                m_flags &= ~O_DIRECT;
+                set_direct(false);
+                continue;
+            }
+            if (result <= 0) {
+                return false;
+            }
+            num_written += static_cast<std::size_t>(result);
+        }
+        return true;
+    }
+
+    auto set_direct(bool direct_) -> void {
+        direct_ = direct_ && (m_flags & O_DIRECT) != 0;
+        if (direct_ != m_direct) {
+            const auto flags = direct_ ? m_flags : m_flags & ~O_DIRECT;
+            if (::fcntl(m_fd, F_SETFL, flags) == 0) {
+                m_direct = direct_;
+            }
+        }
+    }
+
+    int m_fd;
+    /// Status flags of the descriptor, with O_DIRECT if it is supported.
+    int m_flags;
+    /// Whether O_DIRECT is currently set on the descriptor.
+    bool m_direct = true;
+    std::unique_ptr<char, free_deleter> m_buffer;
+    /// Offset in the file of the start of the buffer.
+    std::uint64_t m_position = 0;
+};
+
+/**
+ * @brief Open a file for direct writes.
+ * @return The buffer, or nullptr if the file system does not support
+ *      direct writes.
+ */
+auto open_direct_file_buffer(
+    const boost::filesystem::path& path_, std::ios_base::openmode mode_
+) -> std::unique_ptr<std::streambuf> {
+    const auto fd = ::open(
+        path_.c_str(), get_write_flags(mode_) | O_DIRECT | O_CLOEXEC, 0666
+    );
+    if (fd < 0 && errno == EINVAL) {
+        static std::once_flag flag;
+        std::call_once(flag, []() {
+            BOOST_LOG_TRIVIAL(warning)
+                << "The file system does not support direct writes, "
+                   "writing through the page cache instead.";
+        });
+        return nullptr;
+    }
+    if (fd < 0) {
+        throw exceptions::failed_precondition(
+            "Could not open file " + path_.string() +
+            " for writing: " + std::strerror(errno)
+        );
+    }
+    return std::make_unique<direct_file_buffer>(fd);
+}
+#endif
+
+#ifdef FILE_TRANSFER_HAS_IO_URING
+/// Number of operations which an io_uring reader or writer keeps in flight.
+constexpr unsigned io_uring_depth = 8;
+/// Smallest part of a chunk which is read by a separate operation.
+constexpr std::size_t io_uring_min_segment_size = std::size_t{1} << 17;
+/// Number of blocks which an io_uring writer fills and writes.
+constexpr unsigned io_uring_num_write_blocks = 4;
+/// Size of the blocks which an io_uring writer submits.
+constexpr std::size_t io_uring_write_block_size = std::size_t{1} << 20;
+
+/**
+ * @brief File reader based on io_uring.
+ *
+ * A chunk is split into segments which are read concurrently, and
+ * submitted by a single system call. A prefetched chunk is read into a
+ * spare buffer in the background, and handed over by the read which
+ * requests it.
+ */
+class io_uring_file_reader final : public file_reader {
+public:
+    io_uring_file_reader(
+        const boost::filesystem::path& path_, std::uint64_t file_size_
+    )
+        : m_queue{io_uring_depth},
+          m_fd{open_descriptor(path_, O_RDONLY, "reading")},
+          m_file_size{file_size_} {}
+
+    io_uring_file_reader(const io_uring_file_reader&) = delete;
+    io_uring_file_reader& operator=(const io_uring_file_reader&) = delete;
+    io_uring_file_reader(io_uring_file_reader&&) = delete;
+    io_uring_file_reader& operator=(io_uring_file_reader&&) = delete;
+    ~io_uring_file_reader() override {
+        // The reads must not outlive the descriptor or the buffers.
+        static_cast<void>(complete_reads());
+        ::close(m_fd);
+    }
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override {
+        const auto prefetched = m_prefetch_offset == offset_ &&
+                                m_prefetch_size == size_ && m_prefetching;
+        const auto prefetch_ok = complete_reads();
+        m_prefetching = false;
+        if (prefetched && prefetch_ok) {
+            // The buffers are swapped, such that the memory of the previous
+            // chunk is reused by the next prefetch.
+            target_.swap(m_prefetch_buffer);
+            return;
+        }
+        target_.resize(size_);
+        if (size_ == 0) {
+            return;
+        }
+        start_reads(offset_, size_, target_.data());
+        if (!complete_reads()) {
+            throw exceptions::internal("Could not read the requested chunk.");
+        }
+    }
+
+    auto prefetch(std::uint64_t offset_, std::size_t size_) -> void override {
+        if (m_prefetching || offset_ >= m_file_size || size_ == 0 ||
+            size_ > m_file_size - offset_) {
+            return;
+        }
+        m_prefetch_buffer.resize(size_);
+        m_prefetch_offset = offset_;
+        m_prefetch_size = size_;
+        m_prefetching = true;
+        start_reads(offset_, size_, m_prefetch_buffer.data());
+    }
+
+private:
+    struct segment {
+        char* data;
+        std::size_t size;
+        std::uint64_t offset;
+    };
+
+    auto start_reads(std::uint64_t offset_, std::size_t size_, char* data_)
+        -> void {
+        const auto num_segments = std::min<std::size_t>(
+            io_uring_depth,
+            (size_ + io_uring_min_segment_size - 1) / io_uring_min_segment_size
+        );
+        const auto segment_size = (size_ + num_segments - 1) / num_segments;
+        m_segments.clear();
+        for (std::size_t position = 0; position < size_;
+             position += segment_size) {
+            m_segments.push_back(
+                {data_ + position,
+                 std::min(segment_size, size_ - position),
+                 offset_ + position}
+            );
+        }
+        for (std::size_t i = 0; i < m_segments.size(); ++i) {
+            submit_segment(i);
+        }
+        m_queue.submit();
+    }
+
+    auto submit_segment(std::size_t index_) -> void {
+        const auto& part = m_segments[index_];
+        m_queue.prepare_read(m_fd, part.data, part.size, part.offset, index_);
+    }
+
+    /**
+     * @brief Wait for all reads in flight.
+     * @return Whether all segments were read completely.
+     */
+    auto complete_reads() -> bool {
+        auto success = true;
+        while (m_queue.num_in_flight() > 0) {
+            const auto completion = m_queue.wait();
+            auto& part = m_segments[completion.user_data];
+            if (completion.result == -EINTR || completion.result == -EAGAIN) {
+                submit_segment(completion.user_data);
+                m_queue.submit();
+            } else if (completion.result <= 0) {
+                // Reading past the end of the file returns zero bytes.
+                success = false;
+            } else if (static_cast<std::size_t>(completion.result) <
+                       part.size) {
+                // The rest of a short read is read again.
+                const auto num_read =
+                    static_cast<std::size_t>(completion.result);
+                part = {
+                    part.data + num_read, part.size - num_read,
+                    part.offset + num_read
+                };
+                submit_segment(completion.user_data);
+                m_queue.submit();
+            }
+        }
+        return success;
+    }
+
+    io_uring_queue m_queue;
+    int m_fd;
+    std::uint64_t m_file_size;
+    std::vector<segment> m_segments;
+
+    bool m_prefetching = false;
+    std::uint64_t m_prefetch_offset = 0;
+    std::size_t m_prefetch_size = 0;
+    std::string m_prefetch_buffer;
+};
+
+/**
+ * @brief Buffer of a file which is written through io_uring.
+ *
+ * Full blocks are written while the next block is filled, such that
+ * several writes are in flight. The blocks are submitted in pairs, to
+ * halve the number of system calls. Flushing the buffer waits for all
+ * writes.
+ */
+class io_uring_file_buffer final : public std::streambuf {
+public:
+    io_uring_file_buffer(
+        const boost::filesystem::path& path_, std::ios_base::openmode mode_
+    )
+        : m_queue{io_uring_num_write_blocks},
+          m_fd{open_descriptor(path_, get_write_flags(mode_), "writing")},
+          m_blocks(io_uring_num_write_blocks) {
+        for (std::size_t i = 0; i < m_blocks.size(); ++i) {
+            m_blocks[i].data.resize(io_uring_write_block_size);
+            m_free_blocks.push_back(i);
+        }
+        use_next_block();
+    }
+
+    io_uring_file_buffer(const io_uring_file_buffer&) = delete;
+    io_uring_file_buffer& operator=(const io_uring_file_buffer&) = delete;
+    io_uring_file_buffer(io_uring_file_buffer&&) = delete;
+    io_uring_file_buffer& operator=(io_uring_file_buffer&&) = delete;
+    ~io_uring_file_buffer() override {
+        static_cast<void>(sync());
+        ::close(m_fd);
+    }
+
+protected:
+    auto overflow(int_type ch_) -> int_type override {
+        if (!submit_current_block()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch_, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch_);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch_);
+    }
+
+    auto sync() -> int override {
+        if (!submit_current_block()) {
+            return -1;
+        }
+        m_queue.submit();
+        while (m_queue.num_in_flight() > 0) {
+            complete_write();
+        }
+        return m_error == 0 ? 0 : -1;
+    }
+
+    auto seekoff(
+        off_type offset_,
+        std::ios_base::seekdir direction_,
+        std::ios_base::openmode /* which_ */
+    ) -> pos_type override {
+        const auto buffered = static_cast<off_type>(pptr() - pbase());
+        if (direction_ == std::ios_base::cur && offset_ == 0) {
+            return static_cast<off_type>(m_position) + buffered;
+        }
+        if (sync() != 0) {
+            return {off_type{-1}};
+        }
+        off_type base = 0;
+        if (direction_ == std::ios_base::cur) {
+            base = static_cast<off_type>(m_position);
+        } else if (direction_ == std::ios_base::end) {
+            base = ::lseek(m_fd, 0, SEEK_END);
+        }
+        if (base < 0 || base + offset_ < 0) {
+            return {off_type{-1}};
+        }
+        m_position = static_cast<std::uint64_t>(base + offset_);
+        return static_cast<off_type>(m_position);
+    }
+
+    auto seekpos(pos_type position_, std::ios_base::openmode which_)
+        -> pos_type override {
+        return seekoff(off_type{position_}, std::ios_base::beg, which_);
+    }
+
+private:
+    struct block {
+        std::string data;
+        std::size_t offset_in_block = 0;
+        std::size_t size = 0;
+        std::uint64_t file_offset = 0;
+    };
+
+    auto use_next_block() -> void {
+        while (m_free_blocks.empty()) {
+            complete_write();
+        }
+        m_current = m_free_blocks.back();
+        m_free_blocks.pop_back();
+        auto& data = m_blocks[m_current].data;
+        setp(data.data(), data.data() + data.size());
+    }
+
+    auto submit_current_block() -> bool {
+        if (m_error != 0) {
+            return false;
+        }
+        const auto size = static_cast<std::size_t>(pptr() - pbase());
+        if (size == 0) {
+            return true;
+        }
+        auto& current = m_blocks[m_current];
+        current.offset_in_block = 0;
+        current.size = size;
+        current.file_offset = m_position;
+        submit_block(m_current);
+        if (m_queue.num_unsubmitted() >= io_uring_num_write_blocks / 2) {
+            m_queue.submit();
+        }
+        m_position += size;
+        use_next_block();
+        return m_error == 0;
+    }
+
+    auto submit_block(std::size_t index_) -> void {
+        const auto& part = m_blocks[index_];
+        m_queue.prepare_write(
+            m_fd,
+            part.data.data() + part.offset_in_block,
+            part.size,
+            part.file_offset,
+            index_
+        );
+    }
+
+    auto complete_write() -> void {
+        const auto completion = m_queue.wait();
+        auto& part = m_blocks[completion.user_data];
+        if (completion.result == -EINTR || completion.result == -EAGAIN) {
+            submit_block(completion.user_data);
+            m_queue.submit();
+            return;
+        }
+        if (completion.result <= 0) {
+            m_error = completion.result < 0 ? -completion.result : EIO;
+        } else if (static_cast<std::size_t>(completion.result) < part.size) {
+            // The rest of a short write is written again.
+            const auto num_written =
+                static_cast<std::size_t>(completion.result);
+            part.offset_in_block += num_written;
+            part.size -= num_written;
+            part.file_offset += num_written;
+            submit_block(completion.user_data);
+            m_queue.submit();
+            return;
+        }
+        m_free_blocks.push_back(completion.user_data);
+    }
+
+    io_uring_queue m_queue;
+    int m_fd;
+    std::vector<block> m_blocks;
+    std::vector<std::size_t> m_free_blocks;
+    /// Block which is currently filled.
+    std::size_t m_current = 0;
+    /// Offset in the file of the start of the current block.
+    std::uint64_t m_position = 0;
+    /// Error number of the first failed write.
+    int m_error = 0;
+};
+
+/**
+ * @brief Log once that io_uring cannot be used.
+ */
+auto warn_io_uring_unavailable(const std::string& reason_) -> void {
+    static std::once_flag flag;
+    std::call_once(flag, [&]() {
+        BOOST_LOG_TRIVIAL(warning)
+            << "The io_uring I/O backend is not available (" << reason_
+            << "), falling back to another backend.";
+    });
+}
+
+/**
+ * @brief Create an object which uses io_uring, if the kernel supports it.
+ * @return The object, or nullptr if io_uring cannot be used.
+ */
+template <typename T, typename... Args>
+auto make_io_uring_object(Args&&... args_) -> std::unique_ptr<T> {
+    if (!io_uring_queue::is_supported()) {
+        warn_io_uring_unavailable("not supported by the kernel");
+        return nullptr;
+    }
+    try {
+        return std::make_unique<T>(std::forward<Args>(args_)...);
+    } catch (const std::system_error& e) {
+        // Setting up the queue can fail even though io_uring is supported,
+        // for example if the limit of locked memory is reached.
+        warn_io_uring_unavailable(e.what());
+        return nullptr;
+    }
+}
+#endif
+
+} // namespace
+
+auto memory_file_reader::read(
+    std::uint64_t offset_, std::size_t size_, std::string& target_
+) -> void {
+    if (offset_ > m_data.size() || size_ > m_data.size() - offset_) {
+        throw exceptions::internal("Could not read the requested chunk.");
+    }
+    target_.assign(m_data, static_cast<std::size_t>(offset_), size_);
+}
+
+auto open_file_reader(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    io_backend backend_
+) -> std::unique_ptr<file_reader> {
+    switch (backend_) {
+    case io_backend::mmap:
+        return std::make_unique<mapped_file_reader>(path_, file_size_);
+    case io_backend::io_uring:
+#ifdef FILE_TRANSFER_HAS_IO_URING
+        if (auto reader =
+                make_io_uring_object<io_uring_file_reader>(path_, file_size_)) {
+            return reader;
+        }
+#endif
+#ifdef _WIN32
+        return std::make_unique<stream_file_reader>(path_);
+#else
+        return std::make_unique<positional_file_reader>(path_);
+    case io_backend::pread:
+        return std::make_unique<positional_file_reader>(path_);
+#endif
+    case io_backend::stream:
+    default:
+        return std::make_unique<stream_file_reader>(path_);
+    }
+}
+
+auto open_file_writer(
+    const boost::filesystem::path& path_,
+    std::ios_base::openmode mode_,
+    io_backend backend_,
+    page_cache_mode cache_mode_
+) -> std::unique_ptr<std::streambuf> {
+#ifdef O_DIRECT
+    if (cache_mode_ == page_cache_mode::direct) {
+        if (auto buffer = open_direct_file_buffer(path_, mode_)) {
+            return buffer;
+        }
+    }
+#else
+    static_cast<void>(cache_mode_);
+#endif
+#ifdef FILE_TRANSFER_HAS_IO_URING
+    if (backend_ == io_backend::io_uring) {
+        if (auto buffer =
+                make_io_uring_object<io_uring_file_buffer>(path_, mode_)) {
+            return buffer;
+        }
+    }
+#else
+    static_cast<void>(backend_);
+#endif
+    auto buffer = std::make_unique<boost::filesystem::filebuf>();
+    if (buffer->open(
+            path_, mode_ | std::ios_base::out | std::ios_base::binary
+        ) == nullptr) {
+        throw exceptions::failed_precondition(
+            "Could not open file " + path_.string() + " for writing."
+        );
+    }
+    return buffer;
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,184 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "page_cache.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Backends which can be used to access the transferred files.
+ */
+enum class io_backend {
+    /// Buffered file streams.
+    stream,
+    /// Memory-mapped files. Only affects reading, since the size of
+    /// uploaded files is not reliable until all data has been received.
+    mmap,
+    /// Positional reads on a file descriptor. The reader can be shared by
+    /// concurrent downloads of the same file. Only available on POSIX
+    /// systems.
+    pread,
+    /// Reads and writes submitted through io_uring, with several
+    /// operations in flight per transfer. Falls back to `pread`, or to
+    /// `stream` on Windows, if the kernel does not support io_uring.
+    io_uring,
+};
+
+/**
+ * @brief Get the I/O backend from its name.
+ * @param name_ Name of the backend, as shown on the command line.
+ * @return The I/O backend.
+ */
+auto io_backend_from_string(const std::string& name_) -> io_backend;
+
+/**
+ * @brief Interface for reading chunks of a file at arbitrary offsets.
+ */
+class file_reader {
+public:
+    file_reader() = default;
+    file_reader(const file_reader&) = delete;
+    file_reader& operator=(const file_reader&) = delete;
+    file_reader(file_reader&&) = delete;
+    file_reader& operator=(file_reader&&) = delete;
+    virtual ~file_reader() = default;
+
+    /**
+     * @brief Read a chunk of the file.
+     *
+     * The data is placed directly into the target string, which typically
+     * is the data field of the message to send. This avoids copying the
+     * chunk through an intermediate buffer.
+     *
+     * @param offset_ Offset of the chunk in the file.
+     * @param size_ Size of the chunk.
+     * @param target_ String which receives the data. It is resized to the
+     *      size of the chunk.
+     */
+    virtual auto read(
+        std::uint64_t offset_, std::size_t size_, std::string& target_
+    ) -> void = 0;
+
+    /**
+     * @brief Hint that a chunk of the file will be read soon.
+     *
+     * Backends which support it start loading the chunk in the background,
+     * such that the following read does not wait for the disk.
+     *
+     * @param offset_ Offset of the chunk in the file.
+     * @param size_ Size of the chunk.
+     */
+    virtual auto prefetch(
+        std::uint64_t /* offset_ */, std::size_t /* size_ */
+    ) -> void {}
+
+    /**
+     * @brief Whether the reader can be used by several threads at once.
+     */
+    [[nodiscard]] virtual auto supports_concurrent_reads() const -> bool {
+        return false;
+    }
+};
+
+/**
+ * @brief File reader over data which is held in memory, for example data
+ *      which is generated rather than stored in a file.
+ */
+class memory_file_reader final : public file_reader {
+public:
+    /**
+     * @brief Construct the reader.
+     * @param data_ The data, which the reader takes ownership of.
+     */
+    explicit memory_file_reader(std::string data_) : m_data(std::move(data_)) {}
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override;
+
+    [[nodiscard]] auto supports_concurrent_reads() const -> bool override {
+        return true;
+    }
+
+private:
+    std::string m_data;
+};
+
+/**
+ * @brief Open a file for reading.
+ * @param path_ Path of the file.
+ * @param file_size_ Size of the file.
+ * @param backend_ Backend used to access the file.
+ * @return The file reader.
+ */
+auto open_file_reader(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    io_backend backend_
+) -> std::unique_ptr<file_reader>;
+
+/**
+ * @brief Open a file for writing.
+ * @param path_ Path of the file.
+ * @param mode_ Open mode, as for a file stream. The file is truncated,
+ *      unless the mode includes std::ios_base::in, in which case the file
+ *      must exist.
+ * @param backend_ Backend used to access the file. Only io_uring differs
+ *      from the buffered file stream for writing.
+ * @param cache_mode_ How the written data uses the page cache. Only
+ *      `direct` affects the buffer, which then ignores the backend.
+ * @return Buffer of the file. It is flushed when it is destroyed, but
+ *      errors are only reported by flushing it explicitly.
+ */
+auto open_file_writer(
+    const boost::filesystem::path& path_,
+    std::ios_base::openmode mode_,
+    io_backend backend_,
+    page_cache_mode cache_mode_ = page_cache_mode::keep
+) -> std::unique_ptr<std::streambuf>;
+
+} // namespace detail
+} // namespace file_transfer
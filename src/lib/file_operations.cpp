@@ -0,0 +1,314 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "file_operations.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/operations.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+#ifndef _WIN32
+/// Size of the buffer of a stream copy.
+constexpr std::size_t copy_buffer_size = std::size_t{1} << 20;
+
+/// Closes a file descriptor when it goes out of scope.
+class descriptor {
+public:
+    explicit descriptor(int fd_) : m_fd{fd_} {}
+    descriptor(const descriptor&) = delete;
+    descriptor& operator=(const descriptor&) = delete;
+    descriptor(descriptor&&) = delete;
+    descriptor& operator=(descriptor&&) = delete;
+    ~descriptor() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    [[nodiscard]] auto get() const -> int { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+auto error_message() -> std::string {
+    return std::system_category().message(errno);
+}
+
+/// Copy the rest of the source through a buffer, from the current file
+/// offsets.
+auto stream_copy(int in_, int out_) -> void {
+    std::vector<char> buffer(copy_buffer_size);
+    while (true) {
+        const auto num_read = ::read(in_, buffer.data(), buffer.size());
+        if (num_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num_read < 0) {
+            throw exceptions::internal(
+                "Could not read the source file: " + error_message()
+            );
+        }
+        if (num_read == 0) {
+            return;
+        }
+        auto offset = std::size_t{0};
+        while (offset < static_cast<std::size_t>(num_read)) {
+            const auto num_written = ::write(
+                out_,
+                buffer.data() + offset,
+                static_cast<std::size_t>(num_read) - offset
+            );
+            if (num_written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (num_written < 0) {
+                throw exceptions::internal(
+                    "Could not write the target file: " + error_message()
+                );
+            }
+            offset += static_cast<std::size_t>(num_written);
+        }
+    }
+}
+
+#ifdef __linux__
+/// Copy the source with copy_file_range, from the current file offsets.
+/// Returns false if the file systems do not support it, in which case
+/// the offsets are unchanged.
+auto copy_range(int in_, int out_, std::uint64_t size_) -> bool {
+    auto num_copied = std::uint64_t{0};
+    while (num_copied < size_) {
+        const auto result = ::copy_file_range(
+            in_, nullptr, out_, nullptr, size_ - num_copied, 0
+        );
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0) {
+            const auto unsupported = errno == EXDEV || errno == EINVAL ||
+                                     errno == ENOSYS || errno == EOPNOTSUPP;
+            if (unsupported && num_copied == 0) {
+                return false;
+            }
+            throw exceptions::internal(
+                "Could not copy the file: " + error_message()
+            );
+        }
+        if (result == 0) {
+            // The source has shrunk since its size was taken.
+            break;
+        }
+        num_copied += static_cast<std::uint64_t>(result);
+    }
+    // Data appended to the source in the meantime is copied as well.
+    stream_copy(in_, out_);
+    return true;
+}
+#endif
+#endif
+
+auto kind_of(const boost::filesystem::file_status& status_) -> char {
+    if (boost::filesystem::is_symlink(status_)) {
+        return 'l';
+    }
+    if (boost::filesystem::is_regular_file(status_)) {
+        return 'f';
+    }
+    if (boost::filesystem::is_directory(status_)) {
+        return 'd';
+    }
+    return 'o';
+}
+
+} // namespace
+
+auto to_string(copy_method method_) -> std::string {
+    switch (method_) {
+    case copy_method::reflink:
+        return "reflink";
+    case copy_method::copy_range:
+        return "copy_file_range";
+    case copy_method::stream:
+        return "stream";
+    }
+    return "unknown";
+}
+
+auto copy_file_contents(
+    const boost::filesystem::path& source_,
+    const boost::filesystem::path& target_
+) -> copy_method {
+#ifndef _WIN32
+    const descriptor in{::open(source_.c_str(), O_RDONLY | O_CLOEXEC)};
+    struct stat source_stat {};
+    if (in.get() < 0 || ::fstat(in.get(), &source_stat) != 0) {
+        throw exceptions::not_found(
+            "Could not open the file " + source_.string() + ": " +
+            error_message()
+        );
+    }
+    // Opening the target truncates it, so the source must not be the
+    // same file under another name.
+    struct stat target_stat {};
+    if (::stat(target_.c_str(), &target_stat) == 0 &&
+        target_stat.st_dev == source_stat.st_dev &&
+        target_stat.st_ino == source_stat.st_ino) {
+        throw exceptions::invalid_argument(
+            "Can not copy " + source_.string() + " onto itself."
+        );
+    }
+    const descriptor out{::open(
+        target_.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        source_stat.st_mode & 07777
+    )};
+    if (out.get() < 0) {
+        throw exceptions::internal(
+            "Could not create the file " + target_.string() + ": " +
+            error_message()
+        );
+    }
+#ifdef FICLONE
+    if (::ioctl(out.get(), FICLONE, in.get()) == 0) {
+        return copy_method::reflink;
+    }
+#endif
+#ifdef __linux__
+    if (copy_range(
+            in.get(), out.get(), static_cast<std::uint64_t>(source_stat.st_size)
+        )) {
+        return copy_method::copy_range;
+    }
+#endif
+    stream_copy(in.get(), out.get());
+    return copy_method::stream;
+#else
+    boost::system::error_code error_code;
+    if (!boost::filesystem::exists(source_, error_code)) {
+        throw exceptions::not_found(
+            "Could not open the file " + source_.string() + "."
+        );
+    }
+    if (boost::filesystem::equivalent(source_, target_, error_code)) {
+        throw exceptions::invalid_argument(
+            "Can not copy " + source_.string() + " onto itself."
+        );
+    }
+    boost::filesystem::copy_file(
+        source_,
+        target_,
+        boost::filesystem::copy_options::overwrite_existing,
+        error_code
+    );
+    if (error_code) {
+        throw exceptions::internal(
+            "Could not copy the file: " + error_code.message()
+        );
+    }
+    return copy_method::stream;
+#endif
+}
+
+auto list_directory(const boost::filesystem::path& path_) -> std::string {
+    boost::system::error_code error_code;
+    const auto status = boost::filesystem::status(path_, error_code);
+    if (!boost::filesystem::exists(status)) {
+        throw exceptions::not_found(
+            "The directory " + path_.string() + " does not exist."
+        );
+    }
+    if (!boost::filesystem::is_directory(status)) {
+        throw exceptions::failed_precondition(
+            path_.string() + " is not a directory."
+        );
+    }
+    std::vector<std::pair<std::string, std::string>> entries;
+    boost::filesystem::directory_iterator it{path_, error_code};
+    for (; !error_code && it != boost::filesystem::directory_iterator{};
+         it.increment(error_code)) {
+        boost::system::error_code entry_error;
+        const auto entry_status = it->symlink_status(entry_error);
+        const auto kind = kind_of(entry_status);
+        auto size = std::uintmax_t{0};
+        if (kind == 'f') {
+            size = boost::filesystem::file_size(it->path(), entry_error);
+            if (entry_error) {
+                size = 0;
+            }
+        }
+        const auto name = it->path().filename().string();
+        entries.emplace_back(
+            name, std::string{kind} + '\t' + std::to_string(size) + '\t' + name
+        );
+    }
+    if (error_code) {
+        throw exceptions::failed_precondition(
+            "Could not list the directory " + path_.string() + ": " +
+            error_code.message()
+        );
+    }
+    std::sort(entries.begin(), entries.end());
+    std::string listing;
+    for (const auto& entry : entries) {
+        listing += entry.second;
+        listing += '\0';
+    }
+    return listing;
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,97 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief How copy_file_contents copied a file.
+ */
+enum class copy_method {
+    /// The target shares the blocks of the source, on file systems which
+    /// support it.
+    reflink,
+    /// The kernel copied the data, without passing it through user space.
+    copy_range,
+    /// The data were read and written through a buffer.
+    stream
+};
+
+/**
+ * @brief Get the name of a copy method, for logging.
+ */
+auto to_string(copy_method method_) -> std::string;
+
+/**
+ * @brief Copy the content of a file on the server, replacing the target.
+ *
+ * The fastest method which the file systems support is used: a reflink,
+ * then copy_file_range, then reading and writing through a buffer. The
+ * target is created with the permissions of the source.
+ * @param source_ The file to copy.
+ * @param target_ The copy.
+ * @return The method which copied the file.
+ * @throws exceptions::not_found if the source can not be opened.
+ * @throws exceptions::invalid_argument if the source and the target are
+ *      the same file, also through a link.
+ * @throws exceptions::internal if the copy fails.
+ */
+auto copy_file_contents(
+    const boost::filesystem::path& source_,
+    const boost::filesystem::path& target_
+) -> copy_method;
+
+/**
+ * @brief List the entries of a directory.
+ *
+ * Each entry is its kind, a tab, its size, a tab, and its name, followed
+ * by a NUL character. The kind is "f" for a regular file, "d" for a
+ * directory, "l" for a symbolic link, and "o" for other entries. The size
+ * is 0 except for regular files. The entries are sorted by name.
+ * @param path_ The directory.
+ * @throws exceptions::not_found if the directory does not exist.
+ * @throws exceptions::failed_precondition if it is not a directory, or
+ *      can not be listed.
+ */
+auto list_directory(const boost::filesystem::path& path_) -> std::string;
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,76 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "file_reader_pool.h"
+
+#include <iterator>
+
+#include "digest_cache.h"
+
+namespace file_transfer::detail {
+
+auto file_reader_pool::acquire(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    io_backend backend_
+) -> std::shared_ptr<file_reader> {
+    const auto identity = get_file_identity(path_);
+    if (!identity || identity->size != file_size_) {
+        return open_file_reader(path_, file_size_, backend_);
+    }
+    const auto key = std::to_string(static_cast<int>(backend_)) + " " +
+                     std::to_string(identity->device) + " " +
+                     std::to_string(identity->inode) + " " +
+                     std::to_string(identity->size) + " " +
+                     std::to_string(identity->mtime_ns);
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    // Forget the readers of downloads which have ended.
+    for (auto it = m_readers.begin(); it != m_readers.end();) {
+        it = it->second.expired() ? m_readers.erase(it) : std::next(it);
+    }
+    if (const auto it = m_readers.find(key); it != m_readers.end()) {
+        // The last user may have released the reader since the cleanup.
+        if (auto reader = it->second.lock()) {
+            return reader;
+        }
+    }
+    std::shared_ptr<file_reader> reader =
+        open_file_reader(path_, file_size_, backend_);
+    if (reader->supports_concurrent_reads()) {
+        m_readers[key] = reader;
+    }
+    return reader;
+}
+
+auto file_reader_pool::size() const -> std::size_t {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    std::size_t num_readers = 0;
+    for (const auto& [key, reader] : m_readers) {
+        if (!reader.expired()) {
+            ++num_readers;
+        }
+    }
+    return num_readers;
+}
+
+} // namespace file_transfer::detail
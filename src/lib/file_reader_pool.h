@@ -0,0 +1,88 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "file_io.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Readers which are shared by concurrent downloads of the same file.
+ *
+ * When a file is downloaded by several streams at once, for example in
+ * stripes, the streams share a single open file instead of opening it
+ * once each. Only readers which support concurrent reads are shared.
+ * A reader is shared only while the identity of the file is unchanged,
+ * and it is closed when the last download using it ends.
+ *
+ * All member functions are thread-safe.
+ */
+class file_reader_pool {
+public:
+    /**
+     * @brief Get a reader for a file, opening it if it is not shared yet.
+     * @param path_ Path of the file.
+     * @param file_size_ Size of the file.
+     * @param backend_ Backend used to access the file.
+     * @return The file reader.
+     */
+    auto acquire(
+        const boost::filesystem::path& path_,
+        std::uint64_t file_size_,
+        io_backend backend_
+    ) -> std::shared_ptr<file_reader>;
+
+    /**
+     * @brief Get the number of files which are currently shared.
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::weak_ptr<file_reader>> m_readers;
+};
+
+} // namespace detail
+} // namespace file_transfer
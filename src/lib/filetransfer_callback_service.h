@@ -0,0 +1,248 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/post.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_handling.h"
+#include "exception_types.h"
+#include "filetransfer_service.h"
+#include "metrics.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Base of the reactors which drive a session from the gRPC
+ *      callbacks.
+ *
+ * The steps of a session may block, for example to hash a file or to wait
+ * for the disk, so they run on the session thread pool of the service
+ * options instead of the callback threads of gRPC. Each step starts the
+ * next read or write on the stream, or finishes the RPC, such that at
+ * most one step or operation is pending at a time. The reactor deletes
+ * itself once the RPC is done and no step is running.
+ *
+ * @tparam Request Type of the requests.
+ * @tparam Response Type of the responses.
+ */
+template <typename Request, typename Response>
+class session_reactor : public ::grpc::ServerBidiReactor<Request, Response> {
+public:
+    session_reactor(const session_reactor&) = delete;
+    session_reactor& operator=(const session_reactor&) = delete;
+    session_reactor(session_reactor&&) = delete;
+    session_reactor& operator=(session_reactor&&) = delete;
+
+    auto OnDone() -> void final {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_done = true;
+            if (m_num_running_steps > 0) {
+                // The running step deletes the reactor when it ends.
+                return;
+            }
+        }
+        delete this;
+    }
+
+protected:
+    /**
+     * @brief Construct the reactor.
+     * @param options_ Options of the service which handles the RPC.
+     */
+    explicit session_reactor(const ServiceOptions& options_)
+        : m_options{options_} {}
+
+    ~session_reactor() override = default;
+
+    /**
+     * @brief Run a step of the session, and finish the RPC if it throws.
+     * @param step_ The step. It must start the next operation on the
+     *      stream, or finish the RPC.
+     */
+    auto run_step(std::function<void()> step_) -> void {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            ++m_num_running_steps;
+        }
+        if (!m_options.session_thread_pool) {
+            complete_step(step_);
+            return;
+        }
+        boost::asio::post(
+            *m_options.session_thread_pool,
+            [this, step = std::move(step_)]() { complete_step(step); }
+        );
+    }
+
+    /**
+     * @brief Check that a read on the stream succeeded.
+     * @param ok_ Whether the read succeeded.
+     * @throws exceptions::invalid_argument if the client stopped sending.
+     */
+    static auto check_read(bool ok_) -> void {
+        if (!ok_) {
+            throw exceptions::invalid_argument(
+                "Request stream stopped prematurely."
+            );
+        }
+    }
+
+    /**
+     * @brief Check that a write on the stream succeeded, and finish the RPC
+     *      otherwise.
+     * @param ok_ Whether the write succeeded.
+     * @return Whether the write succeeded.
+     */
+    auto check_write(bool ok_) -> bool {
+        if (!ok_) {
+            this->Finish(::grpc::Status::CANCELLED);
+        }
+        return ok_;
+    }
+
+    /**
+     * @brief Start reading the next request, and time the wait for it.
+     * @param request_ Request to read into.
+     */
+    auto start_read(Request* request_) -> void {
+        m_network_timer.start(metrics::phase::network_read);
+        this->StartRead(request_);
+    }
+
+    /**
+     * @brief Start writing a response, and time the wait for it.
+     * @param response_ Response to write.
+     */
+    auto start_write(const Response* response_) -> void {
+        m_network_timer.start(metrics::phase::network_write);
+        this->StartWrite(response_);
+    }
+
+    /**
+     * @brief Record the time of the read or write which has completed.
+     */
+    auto stop_network_timer() -> void { m_network_timer.stop(); }
+
+    const ServiceOptions& m_options;
+
+private:
+    auto complete_step(const std::function<void()>& step_) -> void {
+        const auto status =
+            exceptions::convert_exceptions_to_status_codes(step_);
+        if (!status.ok()) {
+            this->Finish(status);
+        }
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            --m_num_running_steps;
+            if (!m_done || m_num_running_steps > 0) {
+                return;
+            }
+        }
+        delete this;
+    }
+
+    metrics::async_timer m_network_timer;
+    std::mutex m_mutex;
+    std::size_t m_num_running_steps = 0;
+    bool m_done = false;
+};
+
+} // namespace detail
+
+/**
+ * @brief This class implements the file transfer service with the
+ *      callback-based gRPC API.
+ *
+ * Unlike FileTransferServiceImpl, the operations do not occupy a thread
+ * while waiting for the network. The requests are processed by the same
+ * session types as in the synchronous service. Once a read or write on the
+ * stream has completed, the next step of the session runs on the session
+ * thread pool, see detail::session_reactor.
+ **/
+class FileTransferCallbackServiceImpl final
+    : public ::ansys::api::tools::filetransfer::v1::FileTransferService::
+          CallbackService {
+
+public:
+    using ::ansys::api::tools::filetransfer::v1::FileTransferService::
+        CallbackService::DownloadFile;
+    using ::ansys::api::tools::filetransfer::v1::FileTransferService::
+        CallbackService::UploadFile;
+
+    /**
+     * @brief Construct the service.
+     * @param options Options which configure the service.
+     */
+    explicit FileTransferCallbackServiceImpl(ServiceOptions options = {})
+        : m_options{options} {}
+
+    // ---------- RPC services [file transfer] ----------
+
+    /**
+     * @brief Implements the "DownloadFile" operation.
+     * @param context Server context to use.
+     * @return Reactor which handles the stream of requests and responses.
+     */
+    auto DownloadFile(::grpc::CallbackServerContext* context)
+        -> ::grpc::ServerBidiReactor<
+            ::ansys::api::tools::filetransfer::v1::DownloadFileRequest,
+            ::ansys::api::tools::filetransfer::v1::DownloadFileResponse>*
+        override;
+
+    /**
+     * @brief Implements the "UploadFile" operation.
+     * @param context Server context to use.
+     * @return Reactor which handles the stream of requests and responses.
+     */
+    auto UploadFile(::grpc::CallbackServerContext* context)
+        -> ::grpc::ServerBidiReactor<
+            ::ansys::api::tools::filetransfer::v1::UploadFileRequest,
+            ::ansys::api::tools::filetransfer::v1::UploadFileResponse>*
+        override;
+
+private:
+    ServiceOptions m_options;
+};
+
+} // namespace file_transfer
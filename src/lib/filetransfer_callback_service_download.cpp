@@ -0,0 +1,186 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "filetransfer_callback_service.h"
+
+#include "filetransfer_service_batch.h"
+#include "filetransfer_service_download.h"
+#include "filetransfer_service_operations.h"
+#include "metrics.h"
+
+namespace file_transfer {
+namespace download_impl {
+namespace {
+
+using reactor_base_t =
+    detail::session_reactor<api::DownloadFileRequest, api::DownloadFileResponse>;
+
+/**
+ * @brief Reactor which drives a download session from the gRPC callbacks.
+ */
+class reactor final : public reactor_base_t {
+public:
+    reactor(
+        const ServiceOptions& options_, ::grpc::CallbackServerContext& context_
+    )
+        : reactor_base_t{options_}, m_session{options_, context_} {
+        start_read(&m_request);
+    }
+
+    auto OnReadDone(bool ok_) -> void override {
+        stop_network_timer();
+        run_step([this, ok_]() {
+            check_read(ok_);
+            m_response.Clear();
+            switch (m_step) {
+            case step::initialize:
+                m_session.initialize(m_request, m_response);
+                start_write(&m_response);
+                break;
+            case step::transfer:
+                m_session.start_transfer(m_request);
+                send_next_chunk();
+                break;
+            case step::finalize:
+                m_session.finalize(m_request, m_response);
+                start_write(&m_response);
+                break;
+            }
+        });
+    }
+
+    auto OnWriteDone(bool ok_) -> void override {
+        stop_network_timer();
+        if (!check_write(ok_)) {
+            return;
+        }
+        switch (m_step) {
+        case step::initialize:
+            m_step = step::transfer;
+            start_read(&m_request);
+            break;
+        case step::transfer:
+            run_step([this]() { send_next_chunk(); });
+            break;
+        case step::finalize:
+            Finish(::grpc::Status::OK);
+            break;
+        }
+    }
+
+private:
+    enum class step { initialize, transfer, finalize };
+
+    auto send_next_chunk() -> void {
+        if (m_session.next_chunk(m_response)) {
+            start_write(&m_response);
+        } else {
+            m_step = step::finalize;
+            start_read(&m_request);
+        }
+    }
+
+    metrics::stream_tracker m_tracker{metrics::direction::download};
+    step m_step = step::initialize;
+    session m_session;
+    api::DownloadFileRequest m_request;
+    api::DownloadFileResponse m_response;
+};
+
+} // namespace
+} // namespace download_impl
+
+namespace {
+
+/**
+ * @brief Reactor which drives a session of many responses from the gRPC
+ *      callbacks, for batch downloads and operations on server files.
+ *
+ * @tparam Session Session type, with the interface of
+ *      batch_impl::download_session.
+ */
+template <typename Session>
+class stepped_reactor final : public download_impl::reactor_base_t {
+public:
+    stepped_reactor(
+        const ServiceOptions& options_, ::grpc::CallbackServerContext& context_
+    )
+        : download_impl::reactor_base_t{options_},
+          m_session{options_, context_} {
+        start_read(&m_request);
+    }
+
+    auto OnReadDone(bool ok_) -> void override {
+        stop_network_timer();
+        run_step([this, ok_]() {
+            check_read(ok_);
+            m_session.receive(m_request);
+            send_next_response();
+        });
+    }
+
+    auto OnWriteDone(bool ok_) -> void override {
+        stop_network_timer();
+        if (check_write(ok_)) {
+            run_step([this]() { send_next_response(); });
+        }
+    }
+
+private:
+    auto send_next_response() -> void {
+        if (m_session.next_response(m_response)) {
+            start_write(&m_response);
+        } else if (m_session.finished()) {
+            Finish(::grpc::Status::OK);
+        } else {
+            start_read(&m_request);
+        }
+    }
+
+    metrics::stream_tracker m_tracker{metrics::direction::download};
+    Session m_session;
+    download_impl::api::DownloadFileRequest m_request;
+    download_impl::api::DownloadFileResponse m_response;
+};
+
+} // namespace
+
+auto FileTransferCallbackServiceImpl::DownloadFile(
+    ::grpc::CallbackServerContext* context
+)
+    -> ::grpc::ServerBidiReactor<
+        ::ansys::api::tools::filetransfer::v1::DownloadFileRequest,
+        ::ansys::api::tools::filetransfer::v1::DownloadFileResponse>* {
+    if (operation_impl::is_operation(*context)) {
+        return new stepped_reactor<operation_impl::session>(
+            m_options, *context
+        );
+    }
+    if (batch_impl::is_batch(*context)) {
+        return new stepped_reactor<batch_impl::download_session>(
+            m_options, *context
+        );
+    }
+    return new download_impl::reactor(m_options, *context);
+}
+
+} // namespace file_transfer
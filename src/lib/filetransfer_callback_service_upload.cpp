@@ -0,0 +1,177 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "filetransfer_callback_service.h"
+
+#include "filetransfer_service_batch.h"
+#include "filetransfer_service_upload.h"
+#include "metrics.h"
+
+namespace file_transfer {
+namespace upload_impl {
+namespace {
+
+using reactor_base_t =
+    detail::session_reactor<api::UploadFileRequest, api::UploadFileResponse>;
+
+/**
+ * @brief Reactor which drives an upload session from the gRPC callbacks.
+ */
+class reactor final : public reactor_base_t {
+public:
+    reactor(
+        const ServiceOptions& options_, ::grpc::CallbackServerContext& context_
+    )
+        : reactor_base_t{options_}, m_session{options_, context_} {
+        start_read(&m_request);
+    }
+
+    auto OnReadDone(bool ok_) -> void override {
+        stop_network_timer();
+        run_step([this, ok_]() {
+            check_read(ok_);
+            switch (m_step) {
+            case step::initialize:
+                m_session.initialize(m_request, m_response);
+                break;
+            case step::transfer:
+                if (!m_session.receive(m_request, m_response)) {
+                    // The progress of this chunk is reported later.
+                    read_next_request();
+                    return;
+                }
+                break;
+            case step::finalize:
+                m_session.finalize(m_request, m_response);
+                break;
+            }
+            start_write(&m_response);
+        });
+    }
+
+    auto OnWriteDone(bool ok_) -> void override {
+        stop_network_timer();
+        if (!check_write(ok_)) {
+            return;
+        }
+        switch (m_step) {
+        case step::initialize:
+            run_step([this]() {
+                m_session.start_transfer();
+                m_step = step::transfer;
+                read_next_request();
+            });
+            break;
+        case step::transfer:
+            run_step([this]() { read_next_request(); });
+            break;
+        case step::finalize:
+            Finish(::grpc::Status::OK);
+            break;
+        }
+    }
+
+private:
+    enum class step { initialize, transfer, finalize };
+
+    auto read_next_request() -> void {
+        if (m_session.transfer_complete()) {
+            m_session.end_transfer();
+            m_step = step::finalize;
+        }
+        start_read(&m_request);
+    }
+
+    metrics::stream_tracker m_tracker{metrics::direction::upload};
+    step m_step = step::initialize;
+    session m_session;
+    api::UploadFileRequest m_request;
+    api::UploadFileResponse m_response;
+};
+
+} // namespace
+} // namespace upload_impl
+
+namespace batch_impl {
+namespace {
+
+/**
+ * @brief Reactor which drives a batch upload session from the gRPC
+ *      callbacks.
+ */
+class upload_reactor final : public upload_impl::reactor_base_t {
+public:
+    upload_reactor(
+        const ServiceOptions& options_, ::grpc::CallbackServerContext& context_
+    )
+        : upload_impl::reactor_base_t{options_},
+          m_session{options_, context_} {
+        start_read(&m_request);
+    }
+
+    auto OnReadDone(bool ok_) -> void override {
+        stop_network_timer();
+        run_step([this, ok_]() {
+            check_read(ok_);
+            if (m_session.receive(m_request, m_response)) {
+                start_write(&m_response);
+            } else {
+                start_read(&m_request);
+            }
+        });
+    }
+
+    auto OnWriteDone(bool ok_) -> void override {
+        stop_network_timer();
+        if (!check_write(ok_)) {
+            return;
+        }
+        if (m_session.finished()) {
+            Finish(::grpc::Status::OK);
+        } else {
+            start_read(&m_request);
+        }
+    }
+
+private:
+    metrics::stream_tracker m_tracker{metrics::direction::upload};
+    upload_session m_session;
+    api::UploadFileRequest m_request;
+    api::UploadFileResponse m_response;
+};
+
+} // namespace
+} // namespace batch_impl
+
+auto FileTransferCallbackServiceImpl::UploadFile(
+    ::grpc::CallbackServerContext* context
+)
+    -> ::grpc::ServerBidiReactor<
+        ::ansys::api::tools::filetransfer::v1::UploadFileRequest,
+        ::ansys::api::tools::filetransfer::v1::UploadFileResponse>* {
+    if (batch_impl::is_batch(*context)) {
+        return new batch_impl::upload_reactor(m_options, *context);
+    }
+    return new upload_impl::reactor(m_options, *context);
+}
+
+} // namespace file_transfer
@@ -37,6 +37,8 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "service_options.h"
+
 namespace file_transfer {
 
 using pb_progress_t =
@@ -59,6 +61,13 @@ class FileTransferServiceImpl final : public ::ansys::api::tools::filetransfer::
                                           v1::FileTransferService::Service {
 
 public:
+    /**
+     * @brief Construct the service.
+     * @param options Options which configure the service.
+     */
+    explicit FileTransferServiceImpl(ServiceOptions options = {})
+        : m_options{options} {}
+
     // ---------- RPC services [file transfer] ----------
 
     /**
@@ -88,6 +97,7 @@ public:
     ) -> ::grpc::Status override;
 
 private:
+    ServiceOptions m_options;
 };
 
 } // namespace file_transfer
@@ -0,0 +1,591 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "filetransfer_service_batch.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <ios>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "atomic_file.h"
+#include "digest_cache.h"
+#include "exception_handling.h"
+#include "exception_types.h"
+#include "metrics.h"
+#include "transfer_metadata.h"
+
+namespace file_transfer {
+namespace batch_impl {
+
+namespace {
+
+/// Number of failed files listed in the trailing metadata, which would
+/// otherwise grow without bound.
+constexpr std::size_t max_listed_errors = 100;
+
+/// Chunk size of a batch download, if the client does not request one.
+constexpr std::uint64_t default_chunk_size = std::uint64_t{1} << 16;
+
+/// Validate and confirm the keys of a batch transfer.
+/// @return Whether it is a directory transfer.
+auto start_batch(::grpc::ServerContextBase& context_) -> bool {
+    for (const auto* key : {metadata::batch_key, metadata::directory_key}) {
+        const auto value = metadata::get_client_metadata(context_, key);
+        if (!value) {
+            continue;
+        }
+        if (*value != "true") {
+            throw exceptions::invalid_argument(
+                "Unknown value '" + *value + "' of the metadata key '" + key +
+                "'."
+            );
+        }
+        context_.AddInitialMetadata(key, *value);
+    }
+    return metadata::get_client_metadata(context_, metadata::directory_key)
+        .has_value();
+}
+
+auto finish_batch(
+    ::grpc::ServerContextBase& context_,
+    const batch_errors& errors_,
+    std::size_t num_files_,
+    const char* direction_
+) -> void {
+    if (errors_.size() > 0) {
+        context_.AddTrailingMetadata(
+            metadata::batch_errors_key, errors_.to_string()
+        );
+    }
+    BOOST_LOG_TRIVIAL(info) << "Batch " << direction_ << " of " << num_files_
+                            << " files complete, " << errors_.size()
+                            << " failed.";
+}
+
+} // namespace
+
+auto is_batch(const ::grpc::ServerContextBase& context_) -> bool {
+    return metadata::get_client_metadata(context_, metadata::batch_key) ||
+           metadata::get_client_metadata(context_, metadata::directory_key);
+}
+
+auto batch_errors::add(std::size_t index_, const ::grpc::Status& status_)
+    -> void {
+    ++m_num_errors;
+    if (m_errors.size() < max_listed_errors) {
+        m_errors.emplace_back(index_, static_cast<int>(status_.error_code()));
+    }
+}
+
+auto batch_errors::to_string() const -> std::string {
+    std::string result;
+    for (const auto& [index, code] : m_errors) {
+        if (!result.empty()) {
+            result += ',';
+        }
+        result += std::to_string(index) + ':' + std::to_string(code);
+    }
+    return result;
+}
+
+auto upload_session::start() -> void {
+    m_directory = start_batch(m_context);
+    // The algorithm is negotiated for the whole batch, and only used for
+    // the files which come with a checksum.
+    m_checksum_algorithm = metadata::negotiate_checksum_algorithm(m_context);
+    const auto compression = metadata::negotiate_compression(
+        m_context, m_options.compression_algorithms
+    );
+    if (compression) {
+        m_codec.emplace(*compression);
+    }
+    m_started = true;
+}
+
+auto upload_session::receive(
+    const api::UploadFileRequest& request_,
+    api::UploadFileResponse& response_
+) -> bool {
+    if (!m_started) {
+        start();
+    }
+    switch (request_.sub_step_case()) {
+    case api::UploadFileRequest::kInitialize:
+        if (m_in_file) {
+            throw exceptions::invalid_argument(
+                "File " + std::to_string(m_num_files - 1) +
+                " of the batch is incomplete."
+            );
+        }
+        start_file(request_.initialize().file_info());
+        break;
+    case api::UploadFileRequest::kSendData:
+        if (!m_in_file) {
+            throw exceptions::invalid_argument(
+                "Received data outside of a file of the batch."
+            );
+        }
+        receive_data(request_.send_data().file_data());
+        break;
+    case api::UploadFileRequest::kFinalize:
+        if (m_in_file) {
+            throw exceptions::invalid_argument(
+                "File " + std::to_string(m_num_files - 1) +
+                " of the batch is incomplete."
+            );
+        }
+        finish_batch(m_context, m_errors, m_num_files, "upload");
+        response_.mutable_progress()->set_state(Progress::COMPLETED);
+        m_finished = true;
+        return true;
+    default:
+        throw exceptions::invalid_argument("Incorrect request step.");
+    }
+    if (m_in_file && m_num_bytes_received == m_file_size) {
+        complete_file(response_);
+        return true;
+    }
+    return false;
+}
+
+auto upload_session::start_file(const api::FileInfo& file_info_) -> void {
+    ++m_num_files;
+    m_in_file = true;
+    m_file_status.reset();
+    m_file_path = file_info_.name();
+    m_file_size = boost::numeric_cast<std::uint64_t>(file_info_.size());
+    m_num_bytes_received = 0;
+    m_source_hex_digest = file_info_.sha1().hex_digest();
+    m_hasher = m_source_hex_digest.empty()
+                   ? nullptr
+                   : detail::make_hasher(m_checksum_algorithm);
+    m_write_path = m_options.atomic_uploads &&
+                           detail::can_replace_atomically(m_file_path)
+                       ? detail::get_temporary_path(m_file_path)
+                       : m_file_path;
+    BOOST_LOG_TRIVIAL(debug)
+        << "Receiving file " << m_file_path.generic_string()
+        << " of the batch, " << m_file_size << " bytes.";
+
+    const auto status = exceptions::convert_exceptions_to_status_codes([&]() {
+        if (m_options.digest_cache) {
+            m_options.digest_cache->invalidate(m_file_path);
+        }
+        try {
+            if (m_directory && m_file_path.has_parent_path()) {
+                boost::filesystem::create_directories(
+                    m_file_path.parent_path()
+                );
+            }
+            m_out_buffer = detail::open_file_writer(
+                m_write_path,
+                std::ios_base::out | std::ios_base::binary,
+                m_options.io_backend,
+                m_options.upload_page_cache
+            );
+        } catch (const std::exception&) {
+            throw exceptions::failed_precondition("Could not open output file."
+            );
+        }
+    });
+    if (!status.ok()) {
+        m_file_status = status;
+    }
+}
+
+auto upload_session::receive_data(const api::FileChunk& file_data_) -> void {
+    const auto* chunk = &file_data_.data();
+    if (m_codec) {
+        const metrics::phase_timer timer{metrics::phase::compression};
+        m_codec->decode(*chunk, m_decoded_chunk);
+        chunk = &m_decoded_chunk;
+    }
+    if (chunk->empty()) {
+        throw exceptions::invalid_argument("Received empty file chunk.");
+    }
+    // The chunks of each file arrive in order, such that the end of the
+    // file is known without a finalize step.
+    if (file_data_.offset() !=
+        boost::numeric_cast<pb_filesize_t>(m_num_bytes_received)) {
+        throw exceptions::invalid_argument(
+            "Expected a chunk at offset " +
+            std::to_string(m_num_bytes_received) + ", but got offset " +
+            std::to_string(file_data_.offset()) + "."
+        );
+    }
+    if (chunk->size() > m_file_size - m_num_bytes_received) {
+        throw exceptions::invalid_argument(
+            "The chunk at offset " + std::to_string(file_data_.offset()) +
+            " exceeds the size of the file."
+        );
+    }
+    m_num_bytes_received += chunk->size();
+    metrics::add_bytes(metrics::direction::upload, chunk->size());
+    if (m_file_status) {
+        return;
+    }
+    const auto size = boost::numeric_cast<std::streamsize>(chunk->size());
+    const auto written = [&]() {
+        const metrics::phase_timer timer{metrics::phase::disk_write};
+        return m_out_buffer->sputn(chunk->data(), size);
+    }();
+    if (written != size) {
+        m_file_status = ::grpc::Status{
+            ::grpc::INTERNAL, "Could not write to the output file."
+        };
+        return;
+    }
+    if (m_hasher) {
+        const metrics::phase_timer timer{metrics::phase::hashing};
+        m_hasher->update(chunk->data(), chunk->size());
+    }
+}
+
+auto upload_session::complete_file(api::UploadFileResponse& response_)
+    -> void {
+    if (!m_file_status) {
+        const auto status =
+            exceptions::convert_exceptions_to_status_codes([&]() {
+                const auto flushed = m_out_buffer->pubsync() == 0;
+                m_out_buffer.reset();
+                if (!flushed) {
+                    throw exceptions::internal(
+                        "Could not write to the output file."
+                    );
+                }
+                std::string dest_hex_digest;
+                if (m_hasher) {
+                    dest_hex_digest = m_hasher->hex_digest();
+                    if (m_source_hex_digest != dest_hex_digest) {
+                        throw exceptions::data_loss(
+                            "Checksum of the received file does not match "
+                            "expected value."
+                        );
+                    }
+                }
+                const auto sync = m_options.upload_durability !=
+                                  detail::upload_durability::none;
+                if (sync) {
+                    detail::sync_file(m_write_path);
+                }
+                if (m_write_path != m_file_path) {
+                    detail::commit_file(m_write_path, m_file_path, sync);
+                }
+                if (m_options.digest_cache && !dest_hex_digest.empty()) {
+                    m_options.digest_cache->insert(
+                        m_file_path, m_checksum_algorithm, dest_hex_digest
+                    );
+                }
+            });
+        if (!status.ok()) {
+            m_file_status = status;
+        }
+    }
+    if (m_file_status) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "File " << m_file_path.generic_string()
+            << " of the batch failed: "
+            << m_file_status->error_message();
+        m_errors.add(m_num_files - 1, *m_file_status);
+        close_file();
+    }
+    m_out_buffer.reset();
+    m_in_file = false;
+    response_.mutable_progress()->set_state(
+        m_file_status ? Progress::INITIALIZED : Progress::COMPLETED
+    );
+}
+
+auto upload_session::close_file() noexcept -> void {
+    // The output is closed first, since open files can not be removed on
+    // all platforms.
+    m_out_buffer.reset();
+    if (m_write_path != m_file_path) {
+        detail::discard_file(m_write_path);
+    }
+}
+
+upload_session::~upload_session() {
+    if (m_in_file) {
+        close_file();
+    }
+}
+
+auto download_session::start() -> void {
+    m_directory = start_batch(m_context);
+    if (m_directory) {
+        const auto include =
+            metadata::get_client_metadata(m_context, metadata::include_key);
+        const auto exclude =
+            metadata::get_client_metadata(m_context, metadata::exclude_key);
+        m_filter = detail::path_filter{
+            include ? metadata::parse_glob_patterns(*include)
+                    : std::vector<std::string>{},
+            exclude ? metadata::parse_glob_patterns(*exclude)
+                    : std::vector<std::string>{}
+        };
+    }
+    m_checksum_algorithm = metadata::negotiate_checksum_algorithm(m_context);
+    const auto compression = metadata::negotiate_compression(
+        m_context, m_options.compression_algorithms
+    );
+    if (compression) {
+        m_codec.emplace(*compression);
+    }
+    m_started = true;
+}
+
+auto download_session::receive(const api::DownloadFileRequest& request_)
+    -> void {
+    if (!m_started) {
+        start();
+    }
+    if (m_finalize_received) {
+        throw exceptions::invalid_argument(
+            "Received a request after the end of the batch."
+        );
+    }
+    switch (request_.sub_step_case()) {
+    case api::DownloadFileRequest::kInitialize: {
+        const auto& initialize = request_.initialize();
+        m_chunk_size =
+            initialize.chunk_size() > 0
+                ? boost::numeric_cast<std::uint64_t>(initialize.chunk_size())
+                : default_chunk_size;
+        m_compute_checksum = initialize.compute_sha1_checksum();
+        if (m_directory) {
+            m_directory_path = initialize.filename();
+            start_directory();
+        } else {
+            start_file(
+                initialize.filename(), initialize.filename(), std::nullopt
+            );
+        }
+        break;
+    }
+    case api::DownloadFileRequest::kFinalize:
+        m_finalize_received = true;
+        break;
+    default:
+        throw exceptions::invalid_argument("Incorrect request step.");
+    }
+}
+
+auto download_session::start_directory() -> void {
+    boost::system::error_code error_code;
+    if (!boost::filesystem::is_directory(m_directory_path, error_code)) {
+        // The directory is reported like a file which can not be read.
+        start_file(
+            m_directory_path,
+            m_directory_path.string(),
+            "The desired directory " + m_directory_path.string() +
+                " does not exist."
+        );
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info)
+        << "Sending directory " << m_directory_path.generic_string();
+    m_walker = std::make_unique<detail::directory_walker>(
+        m_directory_path, m_filter, m_options.io_thread_pool.get()
+    );
+}
+
+auto download_session::start_file(
+    const boost::filesystem::path& path_,
+    std::string name_,
+    const std::optional<std::string>& error_
+) -> void {
+    ++m_num_files;
+    m_info_pending = true;
+    m_file_failed = false;
+    m_file_path = path_;
+    m_file_name = std::move(name_);
+    m_file_size = 0;
+    m_position = 0;
+    m_hex_digest.reset();
+    m_first_chunk.reset();
+    m_reader.reset();
+
+    const auto status = exceptions::convert_exceptions_to_status_codes([&]() {
+        if (error_) {
+            // A directory which could not be listed, or which does not exist.
+            if (m_walker) {
+                throw exceptions::failed_precondition(*error_);
+            }
+            throw exceptions::not_found(*error_);
+        }
+        boost::system::error_code error_code;
+        m_file_size = boost::filesystem::file_size(m_file_path, error_code);
+        if (error_code) {
+            throw exceptions::not_found(
+                "The desired file " + m_file_path.string() + " does not exist."
+            );
+        }
+        m_reader = detail::open_file_reader(
+            m_file_path, m_file_size, m_options.io_backend
+        );
+        if (!m_compute_checksum) {
+            return;
+        }
+        if (m_file_size <= m_chunk_size) {
+            // A small file is read once, and hashed from the chunk which
+            // is sent.
+            m_first_chunk.emplace();
+            {
+                const metrics::phase_timer timer{metrics::phase::disk_read};
+                m_reader->read(
+                    0,
+                    boost::numeric_cast<std::size_t>(m_file_size),
+                    *m_first_chunk
+                );
+            }
+            const metrics::phase_timer timer{metrics::phase::hashing};
+            auto hasher = detail::make_hasher(m_checksum_algorithm);
+            hasher->update(m_first_chunk->data(), m_first_chunk->size());
+            m_hex_digest = hasher->hex_digest();
+        } else if (m_options.digest_cache) {
+            m_hex_digest = m_options.digest_cache->get_hex_digest(
+                m_file_path, m_checksum_algorithm, m_options.io_backend
+            );
+        } else {
+            m_hex_digest = detail::get_hex_digest(
+                m_file_path, m_checksum_algorithm, m_options.io_backend
+            );
+        }
+    });
+    if (!status.ok()) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "File " << m_file_path.generic_string()
+            << " of the batch failed: " << status.error_message();
+        m_errors.add(m_num_files - 1, status);
+        m_file_failed = true;
+        m_reader.reset();
+    }
+}
+
+auto download_session::next_response(api::DownloadFileResponse& response_)
+    -> bool {
+    response_.Clear();
+    if (m_info_pending) {
+        m_info_pending = false;
+        auto& file_info = *response_.mutable_file_info();
+        file_info.set_name(m_file_name);
+        file_info.set_size(
+            m_file_failed ? pb_filesize_t{-1}
+                          : boost::numeric_cast<pb_filesize_t>(m_file_size)
+        );
+        if (m_hex_digest) {
+            file_info.mutable_sha1()->set_hex_digest(*m_hex_digest);
+        }
+        response_.mutable_progress()->set_state(Progress::INITIALIZED);
+        return true;
+    }
+    if (m_reader && m_position < m_file_size) {
+        const auto status = exceptions::convert_exceptions_to_status_codes(
+            [&]() { next_chunk(response_); }
+        );
+        if (status.ok()) {
+            return true;
+        }
+        // The file changed or could not be read while it was sent. Its
+        // remaining chunks are skipped, and the batch goes on.
+        BOOST_LOG_TRIVIAL(warning)
+            << "File " << m_file_path.generic_string()
+            << " of the batch failed at offset " << m_position << ": "
+            << status.error_message();
+        m_errors.add(m_num_files - 1, status);
+        response_.Clear();
+    }
+    m_reader.reset();
+    if (m_walker) {
+        if (auto entry = m_walker->next()) {
+            const auto path = m_directory_path / entry->relative_path;
+            start_file(path, std::move(entry->relative_path), entry->error);
+            return next_response(response_);
+        }
+        m_walker.reset();
+    }
+    if (m_finalize_received && !m_finished) {
+        finish_batch(m_context, m_errors, m_num_files, "download");
+        response_.mutable_progress()->set_state(Progress::COMPLETED);
+        m_finished = true;
+        return true;
+    }
+    return false;
+}
+
+auto download_session::next_chunk(api::DownloadFileResponse& response_)
+    -> void {
+    auto& file_chunk = *response_.mutable_file_data();
+    auto& frame = *file_chunk.mutable_data();
+    auto& data = m_codec ? m_raw_chunk : frame;
+    if (m_first_chunk) {
+        data.swap(*m_first_chunk);
+        m_first_chunk.reset();
+    } else {
+        const metrics::phase_timer timer{metrics::phase::disk_read};
+        m_reader->read(
+            m_position,
+            boost::numeric_cast<std::size_t>(
+                std::min(m_chunk_size, m_file_size - m_position)
+            ),
+            data
+        );
+    }
+    if (m_codec) {
+        const metrics::phase_timer timer{metrics::phase::compression};
+        m_codec->encode(data.data(), data.size(), frame);
+    }
+    metrics::add_bytes(metrics::direction::download, data.size());
+    file_chunk.set_offset(boost::numeric_cast<pb_filesize_t>(m_position));
+    m_position += data.size();
+    response_.mutable_progress()->set_state(
+        m_position == m_file_size
+            ? Progress::COMPLETED
+            : boost::numeric_cast<pb_progress_t>(
+                  (100 * m_position) / m_file_size
+              )
+    );
+}
+
+} // namespace batch_impl
+} // namespace file_transfer
@@ -0,0 +1,293 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "checksum.h"
+#include "chunk_compression.h"
+#include "directory_walker.h"
+#include "file_io.h"
+#include "filetransfer_service.h"
+#include "service_options.h"
+
+namespace file_transfer {
+namespace batch_impl {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+
+/**
+ * @brief Check whether the client requested a batch transfer, or a
+ *      directory transfer.
+ *
+ * The values of the keys are validated when the batch session starts,
+ * such that an invalid value is reported as the status of the call.
+ * @param context_ Server context of the call.
+ */
+auto is_batch(const ::grpc::ServerContextBase& context_) -> bool;
+
+/**
+ * @brief Files of a batch which failed, and how they are reported.
+ */
+class batch_errors {
+public:
+    /**
+     * @brief Record a failed file.
+     * @param index_ Index of the file in the batch.
+     * @param status_ Status of the file.
+     */
+    auto add(std::size_t index_, const ::grpc::Status& status_) -> void;
+
+    /**
+     * @brief Get the number of failed files.
+     */
+    [[nodiscard]] auto size() const -> std::size_t { return m_num_errors; }
+
+    /**
+     * @brief Get the value of the batch_errors_key in the trailing
+     *      metadata, which lists the index and status code of the first
+     *      failed files.
+     */
+    [[nodiscard]] auto to_string() const -> std::string;
+
+private:
+    std::vector<std::pair<std::size_t, int>> m_errors;
+    std::size_t m_num_errors = 0;
+};
+
+/**
+ * @brief State of an "UploadFile" operation which carries a batch of files.
+ *
+ * Each file starts with an initialize request, followed by the send_data
+ * requests with its chunks, in order. Once all bytes of a file have been
+ * received, it is verified and committed, and a response reports its
+ * status: COMPLETED if it was stored, INITIALIZED if it failed. A failed
+ * file does not end the call. The finalize request ends the batch.
+ *
+ * In a directory transfer, the missing parent directories of each file are
+ * created.
+ *
+ * Like upload_impl::session, the batch session does not access the stream
+ * itself, such that both services can drive it.
+ */
+class upload_session {
+public:
+    /**
+     * @brief Construct the session.
+     * @param options_ Options of the service which handles the upload.
+     * @param context_ Server context of the call.
+     */
+    upload_session(
+        const ServiceOptions& options_, ::grpc::ServerContextBase& context_
+    )
+        : m_options{options_}, m_context{context_} {}
+
+    upload_session(const upload_session&) = delete;
+    upload_session& operator=(const upload_session&) = delete;
+    upload_session(upload_session&&) = delete;
+    upload_session& operator=(upload_session&&) = delete;
+
+    /**
+     * @brief Remove the temporary file of an incomplete file.
+     */
+    ~upload_session();
+
+    /**
+     * @brief Process a request.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     * @return Whether the response should be sent.
+     * @throws exceptions::invalid_argument if the requests do not follow
+     *      the protocol of the batch.
+     */
+    auto receive(
+        const api::UploadFileRequest& request_,
+        api::UploadFileResponse& response_
+    ) -> bool;
+
+    /**
+     * @brief Whether the finalize request has been processed.
+     */
+    [[nodiscard]] auto finished() const -> bool { return m_finished; }
+
+private:
+    auto start() -> void;
+    auto start_file(const api::FileInfo& file_info_) -> void;
+    auto receive_data(const api::FileChunk& file_data_) -> void;
+    auto complete_file(api::UploadFileResponse& response_) -> void;
+    auto close_file() noexcept -> void;
+
+    const ServiceOptions& m_options;
+    ::grpc::ServerContextBase& m_context;
+    bool m_started = false;
+    bool m_finished = false;
+    bool m_directory = false;
+    detail::checksum_algorithm m_checksum_algorithm =
+        detail::checksum_algorithm::sha1;
+    /// Decompresses the received chunks, if the client requested it.
+    std::optional<detail::chunk_codec> m_codec;
+    std::string m_decoded_chunk;
+    std::size_t m_num_files = 0;
+    batch_errors m_errors;
+
+    /// Whether a file has been started, and not all of its bytes received.
+    bool m_in_file = false;
+    /// Status of the current file, once it has failed. Its remaining chunks
+    /// are skipped.
+    std::optional<::grpc::Status> m_file_status;
+    boost::filesystem::path m_file_path;
+    boost::filesystem::path m_write_path;
+    std::uint64_t m_file_size = 0;
+    std::uint64_t m_num_bytes_received = 0;
+    std::string m_source_hex_digest;
+    std::unique_ptr<detail::hasher> m_hasher;
+    std::unique_ptr<std::streambuf> m_out_buffer;
+};
+
+/**
+ * @brief State of a "DownloadFile" operation which carries a batch of
+ *      files.
+ *
+ * The client sends an initialize request for each file, and a finalize
+ * request after the last one, without waiting for the responses. For
+ * each file, the server sends its file info, followed by its chunks.
+ * A file which can not be read has a size of -1, and no chunks. A file
+ * which fails while it is sent gets no further chunks. Either way, the
+ * file is listed among the failed files, and the batch goes on. After
+ * the last file, the response to the finalize request ends the batch.
+ *
+ * In a directory transfer, each initialize request names a directory. Its
+ * tree is walked ahead of the sender on the I/O thread pool, and each
+ * file which the include and exclude patterns select is sent, with its
+ * path relative to the directory as name. A directory which can not be
+ * listed is sent like a file which can not be read.
+ *
+ * Like download_impl::session, the batch session does not access the
+ * stream itself, such that both services can drive it.
+ */
+class download_session {
+public:
+    /**
+     * @brief Construct the session.
+     * @param options_ Options of the service which handles the download.
+     * @param context_ Server context of the call.
+     */
+    download_session(
+        const ServiceOptions& options_, ::grpc::ServerContextBase& context_
+    )
+        : m_options{options_}, m_context{context_} {}
+
+    /**
+     * @brief Process a request. Must only be called once next_response has
+     *      returned false.
+     * @param request_ Request to process.
+     * @throws exceptions::invalid_argument if the requests do not follow
+     *      the protocol of the batch.
+     */
+    auto receive(const api::DownloadFileRequest& request_) -> void;
+
+    /**
+     * @brief Fill in the next response.
+     * @param response_ Response to fill in.
+     * @return True if the response should be sent, false if the next
+     *      request is needed first, or the batch is finished.
+     */
+    auto next_response(api::DownloadFileResponse& response_) -> bool;
+
+    /**
+     * @brief Whether the response to the finalize request has been filled
+     *      in.
+     */
+    [[nodiscard]] auto finished() const -> bool { return m_finished; }
+
+private:
+    auto start() -> void;
+    auto start_directory() -> void;
+    auto start_file(
+        const boost::filesystem::path& path_,
+        std::string name_,
+        const std::optional<std::string>& error_
+    ) -> void;
+    auto next_chunk(api::DownloadFileResponse& response_) -> void;
+
+    const ServiceOptions& m_options;
+    ::grpc::ServerContextBase& m_context;
+    bool m_started = false;
+    bool m_finalize_received = false;
+    bool m_finished = false;
+    bool m_directory = false;
+    detail::path_filter m_filter;
+    detail::checksum_algorithm m_checksum_algorithm =
+        detail::checksum_algorithm::sha1;
+    /// Compresses the chunks, if the client requested it.
+    std::optional<detail::chunk_codec> m_codec;
+    std::string m_raw_chunk;
+    std::size_t m_num_files = 0;
+    batch_errors m_errors;
+
+    /// Directory of the current initialize request, in a directory
+    /// transfer.
+    boost::filesystem::path m_directory_path;
+    std::unique_ptr<detail::directory_walker> m_walker;
+    /// Options of the current initialize request.
+    std::uint64_t m_chunk_size = 0;
+    bool m_compute_checksum = false;
+
+    /// Whether the file info of the current file is still to be sent.
+    bool m_info_pending = false;
+    bool m_file_failed = false;
+    boost::filesystem::path m_file_path;
+    /// Name of the current file in its file info.
+    std::string m_file_name;
+    std::uint64_t m_file_size = 0;
+    std::uint64_t m_position = 0;
+    std::optional<std::string> m_hex_digest;
+    /// First chunk of the file, if it was read to compute the checksum.
+    std::optional<std::string> m_first_chunk;
+    std::unique_ptr<detail::file_reader> m_reader;
+};
+
+} // namespace batch_impl
+} // namespace file_transfer
@@ -20,13 +20,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include "filetransfer_service.h"
+#include "filetransfer_service_download.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <exception>
 #include <ios>
 #include <string>
-#include <tuple>
 #include <utility>
 
 #ifdef _MSC_VER
@@ -53,162 +53,578 @@
 
 #include "exception_handling.h"
 #include "exception_types.h"
-#include "sha1_digest.h"
+#include "checksum.h"
+#include "chunk_store.h"
+#include "delta_transfer.h"
+#include "filetransfer_service_batch.h"
+#include "filetransfer_service_operations.h"
+#include "metrics.h"
+#include "transfer_metadata.h"
 
 namespace file_transfer {
 namespace download_impl {
 
-namespace api = ::ansys::api::tools::filetransfer::v1;
 using stream_t = ::grpc::
     ServerReaderWriter<api::DownloadFileResponse, api::DownloadFileRequest>;
 
-auto get_request_checked(
-    google::protobuf::Arena& arena_,
-    stream_t* stream_,
+auto check_request_step(
+    const api::DownloadFileRequest& request_,
     const api::DownloadFileRequest::SubStepCase& expected_step_
-) -> api::DownloadFileRequest* {
-    auto* request =
-        google::protobuf::Arena::Create<api::DownloadFileRequest>(&arena_);
-    if (!stream_->Read(request)) {
-        throw exceptions::invalid_argument("Request stream stopped prematurely."
-        );
-    }
-    if (request->sub_step_case() != expected_step_) {
+) -> void {
+    if (request_.sub_step_case() != expected_step_) {
         throw exceptions::invalid_argument("Incorrect request step.");
     }
-    return request;
 }
 
-auto initialize(google::protobuf::Arena& arena_, stream_t* stream_)
-    -> std::tuple<
-        const boost::filesystem::path,
-        const std::size_t,
-        const std::streamsize> {
-
-    auto& request = *get_request_checked(
-        arena_, stream_, api::DownloadFileRequest::kInitialize
-    );
+auto session::initialize(
+    const api::DownloadFileRequest& request_,
+    api::DownloadFileResponse& response_
+) -> void {
+    check_request_step(request_, api::DownloadFileRequest::kInitialize);
 
-    const auto& initialize = request.initialize();
-    const boost::filesystem::path file_path{initialize.filename()};
-    const auto chunk_size = boost::numeric_cast<std::streamsize>(
+    const auto& initialize = request_.initialize();
+    m_file_path = initialize.filename();
+    m_chunk_size = boost::numeric_cast<std::streamsize>(
         initialize.chunk_size() > 0 ? initialize.chunk_size() : 1 << 16
     );
 
-    if (!boost::filesystem::exists(file_path)) {
+    if (!boost::filesystem::exists(m_file_path)) {
         throw exceptions::not_found(
-            "The desired file " + file_path.string() + " does not exist."
+            "The desired file " + m_file_path.string() + " does not exist."
         );
     }
 
-    auto& response =
-        *google::protobuf::Arena::Create<api::DownloadFileResponse>(&arena_);
+    const auto requested_chunk_size =
+        metadata::get_client_metadata(m_context, metadata::chunk_size_key);
+    if (requested_chunk_size) {
+        if (*requested_chunk_size != "auto") {
+            throw exceptions::invalid_argument(
+                "Unknown chunk size '" + *requested_chunk_size + "'."
+            );
+        }
+        m_adaptive_chunk_size.emplace();
+        m_chunk_size =
+            boost::numeric_cast<std::streamsize>(m_adaptive_chunk_size->current());
+        m_context.AddInitialMetadata(
+            metadata::chunk_size_key, *requested_chunk_size
+        );
+    }
 
-    auto& file_info = *(response.mutable_file_info());
+    const auto download_mode =
+        metadata::get_client_metadata(m_context, metadata::download_mode_key)
+            .value_or("file");
+    if (download_mode == "signatures") {
+        initialize_signatures();
+    } else if (download_mode == "manifest") {
+        initialize_manifest();
+    } else if (download_mode == "file") {
+        m_file_size = boost::filesystem::file_size(m_file_path);
+    } else {
+        throw exceptions::invalid_argument(
+            "Unknown download mode '" + download_mode + "'."
+        );
+    }
+
+    const auto requested_ranges =
+        metadata::get_client_metadata(m_context, metadata::ranges_key);
+    const auto requested_stripe =
+        metadata::get_client_metadata(m_context, metadata::stripe_key);
+    if (requested_ranges && requested_stripe) {
+        throw exceptions::invalid_argument(
+            "Ranges and stripes cannot be combined in one download."
+        );
+    }
+    const auto is_partial = requested_ranges || requested_stripe;
+    if (requested_ranges) {
+        m_ranges = metadata::parse_byte_ranges(*requested_ranges, m_file_size);
+    } else if (requested_stripe) {
+        const auto stripe = metadata::get_stripe_range(
+            *requested_stripe,
+            m_file_size,
+            boost::numeric_cast<std::uint64_t>(m_chunk_size)
+        );
+        if (stripe.length > 0) {
+            m_ranges = {stripe};
+        }
+        m_context.AddInitialMetadata(metadata::stripe_key, *requested_stripe);
+    } else if (m_file_size > 0) {
+        m_ranges = {{0, m_file_size}};
+    }
+    if (is_partial) {
+        m_context.AddInitialMetadata(
+            metadata::ranges_key, metadata::to_string(m_ranges)
+        );
+    }
+    m_num_bytes_total = 0;
+    for (const auto& range : m_ranges) {
+        m_num_bytes_total += range.length;
+    }
+
+    const auto compression = metadata::negotiate_compression(
+        m_context, m_options.compression_algorithms
+    );
+    if (compression) {
+        m_codec.emplace(*compression);
+    }
+
+    auto& file_info = *(response_.mutable_file_info());
     if (initialize.compute_sha1_checksum()) {
-        const auto hex_digest = detail::get_sha1_hex_digest(file_path);
-        file_info.mutable_sha1()->set_hex_digest(hex_digest);
+        // The signatures have negotiated the algorithm already.
+        if (download_mode != "signatures") {
+            m_checksum_algorithm =
+                metadata::negotiate_checksum_algorithm(m_context);
+        }
+        // The digests of generated data are not cached, since the data are
+        // generated anew for each download.
+        const auto digest_cache =
+            m_generated_data ? nullptr : m_options.digest_cache;
+        const auto requested_mode = metadata::get_client_metadata(
+            m_context, metadata::checksum_mode_key
+        );
+        const auto checksum_mode = requested_mode.value_or("upfront");
+        if (checksum_mode == "streaming") {
+            if (is_partial) {
+                throw exceptions::invalid_argument(
+                    "A streaming checksum can only be computed if the whole "
+                    "file is downloaded."
+                );
+            }
+            // Hash the chunks as they are sent, to avoid reading the file
+            // twice. The digest is sent in the finalize step.
+            // The identity is taken first, such that a cached digest
+            // belongs to it even if the file is replaced meanwhile.
+            if (digest_cache) {
+                m_streamed_file_identity =
+                    detail::get_file_identity(m_file_path);
+                if (m_streamed_file_identity) {
+                    m_finalize_hex_digest = digest_cache->lookup(
+                        *m_streamed_file_identity, m_checksum_algorithm
+                    );
+                }
+            }
+            if (!m_finalize_hex_digest) {
+                m_streaming_hasher = detail::make_hasher(m_checksum_algorithm);
+            }
+            m_context.AddInitialMetadata(
+                metadata::checksum_mode_key, checksum_mode
+            );
+        } else if (checksum_mode == "upfront") {
+            std::string hex_digest;
+            if (m_generated_data) {
+                hex_digest = get_generated_hex_digest();
+            } else if (digest_cache) {
+                hex_digest = digest_cache->get_hex_digest(
+                    m_file_path, m_checksum_algorithm, m_options.io_backend
+                );
+            } else {
+                hex_digest = detail::get_hex_digest(
+                    m_file_path, m_checksum_algorithm, m_options.io_backend
+                );
+            }
+            file_info.mutable_sha1()->set_hex_digest(hex_digest);
+        } else {
+            throw exceptions::invalid_argument(
+                "Unknown checksum mode '" + checksum_mode + "'."
+            );
+        }
     }
 
-    file_info.set_name(file_path.string());
-    const std::size_t file_size = boost::filesystem::file_size(file_path);
-    file_info.set_size(boost::numeric_cast<pb_filesize_t>(file_size));
-    response.mutable_progress()->set_state(Progress::INITIALIZED);
+    file_info.set_name(m_file_path.string());
+    file_info.set_size(boost::numeric_cast<pb_filesize_t>(m_file_size));
+    response_.mutable_progress()->set_state(Progress::INITIALIZED);
 
     BOOST_LOG_TRIVIAL(info)
-        << "Initializing download of file " << file_path.generic_string()
-        << "\n  file size: " << file_size << "\n  chunk size: " << chunk_size;
-
-    stream_->Write(response);
-    return std::make_tuple(file_path, file_size, chunk_size);
+        << "Initializing download of file " << m_file_path.generic_string()
+        << "\n  file size: " << m_file_size
+        << "\n  chunk size: " << m_chunk_size
+        << (m_adaptive_chunk_size ? " (adaptive)" : "");
+    if (requested_stripe) {
+        BOOST_LOG_TRIVIAL(info) << "  stripe: " << *requested_stripe;
+    }
+    if (is_partial) {
+        BOOST_LOG_TRIVIAL(info) << "  ranges: " << metadata::to_string(m_ranges);
+    }
+    if (m_codec) {
+        BOOST_LOG_TRIVIAL(info)
+            << "  compression: " << detail::to_string(m_codec->settings());
+    }
+    if (download_mode == "signatures") {
+        BOOST_LOG_TRIVIAL(info)
+            << "  mode: signatures, block size " << m_delta_block_size;
+    } else if (download_mode == "manifest") {
+        BOOST_LOG_TRIVIAL(info) << "  mode: manifest";
+    }
 }
 
-auto transfer(
-    const boost::filesystem::path& file_path_,
-    const std::size_t file_size_,
-    const std::streamsize chunk_size_,
-    google::protobuf::Arena& arena_,
-    stream_t* stream_
-) -> void {
+auto session::initialize_signatures() -> void {
+    // The strong checksums of the blocks use the algorithm of the transfer.
+    m_checksum_algorithm = metadata::negotiate_checksum_algorithm(m_context);
+    const auto basis_size = boost::filesystem::file_size(m_file_path);
+    const auto requested_block_size =
+        metadata::get_client_metadata(m_context, metadata::delta_block_size_key);
+    m_delta_block_size =
+        requested_block_size
+            ? metadata::parse_delta_block_size(*requested_block_size)
+            : detail::get_default_delta_block_size(basis_size);
+    const auto reader =
+        detail::open_file_reader(m_file_path, basis_size, m_options.io_backend);
+    m_generated_data = detail::compute_block_signatures(
+        *reader, basis_size, m_delta_block_size, m_checksum_algorithm
+    );
+    m_file_size = m_generated_data->size();
+    m_context.AddInitialMetadata(metadata::download_mode_key, "signatures");
+    m_context.AddInitialMetadata(
+        metadata::delta_block_size_key, std::to_string(m_delta_block_size)
+    );
+}
 
-    get_request_checked(
-        arena_, stream_, api::DownloadFileRequest::kReceiveData
+auto session::initialize_manifest() -> void {
+    if (!m_options.chunk_store) {
+        throw exceptions::failed_precondition(
+            "The server does not have a chunk store."
+        );
+    }
+    m_generated_data = detail::encode_manifest(
+        m_options.chunk_store->get_manifest(m_file_path, m_options.io_backend)
     );
+    m_file_size = m_generated_data->size();
+    m_context.AddInitialMetadata(metadata::download_mode_key, "manifest");
+}
 
-    auto input_file_stream =
-        boost::filesystem::ifstream{file_path_, std::ios_base::binary};
-
-    const auto num_full_chunks =
-        boost::numeric_cast<std::streamsize>(file_size_ / chunk_size_);
-    const auto partial_chunk_size =
-        boost::numeric_cast<std::streamsize>(file_size_ % chunk_size_);
-
-    auto& transfer_response =
-        *(google::protobuf::Arena::Create<api::DownloadFileResponse>(&arena_));
-    auto& file_chunk = *transfer_response.mutable_file_data();
-    auto buffer = std::string(chunk_size_, '\0');
-
-    auto chunk_index = std::streamsize{0};
-    for (; chunk_index < num_full_chunks; ++chunk_index) {
-        BOOST_LOG_TRIVIAL(debug) << "Sending chunk " << chunk_index;
-        transfer_response.mutable_progress()->set_state(
-            boost::numeric_cast<pb_progress_t>(
-                (100 * chunk_index) / num_full_chunks
-            )
+auto session::get_generated_hex_digest() const -> std::string {
+    auto hasher = detail::make_hasher(m_checksum_algorithm);
+    hasher->update(m_generated_data->data(), m_generated_data->size());
+    return hasher->hex_digest();
+}
+
+auto session::start_transfer(const api::DownloadFileRequest& request_)
+    -> void {
+    check_request_step(request_, api::DownloadFileRequest::kReceiveData);
+
+    // Concurrent downloads of the same file, such as the stripes of a
+    // striped download, share the reader if the backend supports it.
+    if (m_generated_data) {
+        // The data are not needed anymore once the reader holds them.
+        m_reader = std::make_shared<detail::memory_file_reader>(
+            std::move(*m_generated_data)
         );
+    } else {
+        m_reader = m_options.file_readers
+                       ? m_options.file_readers->acquire(
+                             m_file_path, m_file_size, m_options.io_backend
+                         )
+                       : detail::open_file_reader(
+                             m_file_path, m_file_size, m_options.io_backend
+                         );
+    }
 
-        file_chunk.set_offset(chunk_index * chunk_size_);
+    // If the file changed between the initialize step and its opening,
+    // the cached digest may not match the data which are sent. Hash the
+    // data instead, and do not cache the result.
+    if (m_streamed_file_identity &&
+        detail::get_file_identity(m_file_path) != m_streamed_file_identity) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "File " << m_file_path.generic_string()
+            << " changed before it was opened, hashing it while streaming";
+        m_streamed_file_identity.reset();
+        if (m_finalize_hex_digest) {
+            m_finalize_hex_digest.reset();
+            m_streaming_hasher = detail::make_hasher(m_checksum_algorithm);
+        }
+    }
 
-        input_file_stream.read(buffer.data(), chunk_size_);
-        file_chunk.set_data(buffer);
-        stream_->Write(transfer_response);
+    m_range_index = 0;
+    m_range_position = 0;
+    m_num_bytes_sent = 0;
+    if (m_options.read_ahead_depth > 0 && m_options.io_thread_pool) {
+        m_read_ahead = std::make_unique<detail::read_ahead>(
+            m_reader, *m_options.io_thread_pool, m_codec ? &*m_codec : nullptr
+        );
+        fill_read_ahead();
+    } else if (const auto chunk = peek_chunk()) {
+        m_reader->prefetch(chunk->offset, chunk->length);
     }
-    if (partial_chunk_size != 0) {
-        BOOST_LOG_TRIVIAL(debug) << "Sending final partial chunk.";
-        transfer_response.mutable_progress()->set_state(Progress::COMPLETED);
+}
 
-        file_chunk.set_offset(chunk_index * chunk_size_);
+auto session::next_chunk(api::DownloadFileResponse& response_) -> bool {
+    if (m_num_bytes_sent == m_num_bytes_total) {
+        return false;
+    }
+    if (m_adaptive_chunk_size) {
+        adapt_chunk_size();
+    }
 
-        buffer.resize(partial_chunk_size);
-        input_file_stream.read(buffer.data(), partial_chunk_size);
-        file_chunk.set_data(buffer);
+    auto& file_chunk = *response_.mutable_file_data();
+    // Compressed chunks are read into a separate buffer, and the message
+    // receives their frame.
+    auto& frame = *file_chunk.mutable_data();
+    auto& data = m_codec ? m_raw_chunk : frame;
+    std::uint64_t offset = 0;
+    if (m_read_ahead) {
+        {
+            const metrics::phase_timer timer{metrics::phase::disk_read};
+            offset = m_codec ? m_read_ahead->take(data, frame)
+                             : m_read_ahead->take(data);
+        }
+        // Keep the reads going while this chunk is sent.
+        fill_read_ahead();
+    } else {
+        const auto chunk = plan_chunk(m_range_index, m_range_position);
+        offset = chunk->offset;
+        {
+            // Read directly into the message, instead of copying the chunk
+            // through an intermediate buffer.
+            const metrics::phase_timer timer{metrics::phase::disk_read};
+            m_reader->read(
+                offset, boost::numeric_cast<std::size_t>(chunk->length), data
+            );
+        }
+        // Let the backend load the next chunk while this one is sent.
+        if (const auto next = peek_chunk()) {
+            m_reader->prefetch(next->offset, next->length);
+        }
+        if (m_codec) {
+            const metrics::phase_timer timer{metrics::phase::compression};
+            m_codec->encode(data.data(), data.size(), frame);
+        }
+    }
+    const auto size = data.size();
+    metrics::add_bytes(metrics::direction::download, size);
+    m_num_frame_bytes_sent += frame.size();
+    BOOST_LOG_TRIVIAL(debug)
+        << "Sending " << size << " bytes at offset " << offset;
+    file_chunk.set_offset(boost::numeric_cast<pb_filesize_t>(offset));
+
+    // The progress is relative to the requested bytes, and only reaches
+    // 100 with the last chunk.
+    response_.mutable_progress()->set_state(
+        m_num_bytes_sent + size == m_num_bytes_total
+            ? Progress::COMPLETED
+            : boost::numeric_cast<pb_progress_t>(
+                  (100 * m_num_bytes_sent) / m_num_bytes_total
+              )
+    );
+    m_num_bytes_sent += size;
+    m_last_chunk_size = size;
+    update_streaming_hasher(data);
+    return true;
+}
 
-        stream_->Write(transfer_response);
+auto session::plan_chunk(std::size_t& range_index_, std::uint64_t& position_)
+    const -> std::optional<metadata::byte_range> {
+    while (range_index_ < m_ranges.size() &&
+           position_ == m_ranges[range_index_].length) {
+        ++range_index_;
+        position_ = 0;
+    }
+    if (range_index_ == m_ranges.size()) {
+        return std::nullopt;
     }
+    const auto& range = m_ranges[range_index_];
+    const auto size = std::min(
+        boost::numeric_cast<std::uint64_t>(m_chunk_size), range.length - position_
+    );
+    const metadata::byte_range chunk{range.offset + position_, size};
+    position_ += size;
+    return chunk;
 }
 
-auto finalize(google::protobuf::Arena& arena_, stream_t* stream_) -> void {
-    get_request_checked(arena_, stream_, api::DownloadFileRequest::kFinalize);
+auto session::peek_chunk() const -> std::optional<metadata::byte_range> {
+    auto range_index = m_range_index;
+    auto position = m_range_position;
+    return plan_chunk(range_index, position);
+}
 
-    auto& response =
-        *(google::protobuf::Arena::Create<api::DownloadFileResponse>(&arena_));
-    response.mutable_progress()->set_state(Progress::COMPLETED);
+auto session::fill_read_ahead() -> void {
+    while (m_read_ahead->num_scheduled() < m_options.read_ahead_depth) {
+        const auto chunk = plan_chunk(m_range_index, m_range_position);
+        if (!chunk) {
+            return;
+        }
+        m_read_ahead->schedule(
+            chunk->offset, boost::numeric_cast<std::size_t>(chunk->length)
+        );
+    }
+}
 
-    stream_->Write(response);
+auto session::finalize(
+    const api::DownloadFileRequest& request_,
+    api::DownloadFileResponse& response_
+) -> void {
+    check_request_step(request_, api::DownloadFileRequest::kFinalize);
+
+    if (m_streaming_hasher) {
+        m_finalize_hex_digest = m_streaming_hasher->hex_digest();
+        if (m_options.digest_cache && m_streamed_file_identity) {
+            m_options.digest_cache->insert(
+                m_file_path,
+                *m_streamed_file_identity,
+                m_checksum_algorithm,
+                *m_finalize_hex_digest
+            );
+        }
+    }
+    if (m_finalize_hex_digest) {
+        response_.mutable_file_info()->mutable_sha1()->set_hex_digest(
+            *m_finalize_hex_digest
+        );
+    }
+    if (m_adaptive_chunk_size) {
+        m_context.AddTrailingMetadata(
+            metadata::chunk_size_key, std::to_string(m_chunk_size)
+        );
+    }
+    response_.mutable_progress()->set_state(Progress::COMPLETED);
+    if (m_codec) {
+        BOOST_LOG_TRIVIAL(info)
+            << "Sent " << m_num_bytes_sent << " bytes as "
+            << m_num_frame_bytes_sent << " compressed bytes.";
+    }
     BOOST_LOG_TRIVIAL(info) << "Download complete.";
 }
 
+auto session::adapt_chunk_size() -> void {
+    // The time between the starts of two chunks includes reading the
+    // previous chunk and waiting until the stream accepted it.
+    const auto now = std::chrono::steady_clock::now();
+    if (m_last_chunk_size > 0) {
+        const auto chunk_size = boost::numeric_cast<std::streamsize>(
+            m_adaptive_chunk_size->on_chunk_sent(
+                boost::numeric_cast<std::size_t>(m_last_chunk_size),
+                now - m_last_chunk_start
+            )
+        );
+        if (chunk_size != m_chunk_size) {
+            BOOST_LOG_TRIVIAL(debug) << "Chunk size changed to " << chunk_size;
+            m_chunk_size = chunk_size;
+        }
+    }
+    m_last_chunk_start = now;
+}
+
+auto session::update_streaming_hasher(const std::string& data_) -> void {
+    if (m_streaming_hasher) {
+        const metrics::phase_timer timer{metrics::phase::hashing};
+        m_streaming_hasher->update(data_.data(), data_.size());
+    }
+}
+
+auto read_request(api::DownloadFileRequest* request_, stream_t* stream_)
+    -> void {
+    const metrics::phase_timer timer{metrics::phase::network_read};
+    if (!stream_->Read(request_)) {
+        throw exceptions::invalid_argument("Request stream stopped prematurely."
+        );
+    }
+}
+
+auto read_request(google::protobuf::Arena& arena_, stream_t* stream_)
+    -> api::DownloadFileRequest* {
+    auto* request =
+        google::protobuf::Arena::Create<api::DownloadFileRequest>(&arena_);
+    read_request(request, stream_);
+    return request;
+}
+
+auto write_response(
+    const api::DownloadFileResponse& response_, stream_t* stream_
+) -> void {
+    const metrics::phase_timer timer{metrics::phase::network_write};
+    stream_->Write(response_);
+}
+
+/**
+ * @brief Drive a session of many responses, for batch downloads and
+ *      operations on server files, until it is finished.
+ * @tparam Session Session type, with the interface of
+ *      batch_impl::download_session.
+ * @param session_ Session to drive.
+ * @param message_arena_ Arena which holds the request and response.
+ * @param stream_ Stream of the call.
+ */
+template <typename Session>
+auto run_stepped_session(
+    Session& session_,
+    google::protobuf::Arena& message_arena_,
+    stream_t* stream_
+) -> void {
+    auto& request =
+        *google::protobuf::Arena::Create<api::DownloadFileRequest>(
+            &message_arena_
+        );
+    auto& response =
+        *google::protobuf::Arena::Create<api::DownloadFileResponse>(
+            &message_arena_
+        );
+    while (!session_.finished()) {
+        read_request(&request, stream_);
+        session_.receive(request);
+        while (session_.next_response(response)) {
+            write_response(response, stream_);
+        }
+    }
+}
+
 } // namespace download_impl
 
 auto FileTransferServiceImpl::DownloadFile(
-    ::grpc::ServerContext* /*unused*/,
+    ::grpc::ServerContext* context,
     ::grpc::ServerReaderWriter<
         ::ansys::api::tools::filetransfer::v1::DownloadFileResponse /*unused*/,
         ::ansys::api::tools::filetransfer::v1::DownloadFileRequest>* stream
 ) -> ::grpc::Status {
+    namespace api = download_impl::api;
 
+    const metrics::stream_tracker tracker{metrics::direction::download};
     return exceptions::convert_exceptions_to_status_codes(
         std::function<void()>([&]() {
             google::protobuf::Arena message_arena;
-
-            auto [file_path, file_size, chunk_size] =
-                download_impl::initialize(message_arena, stream);
-
-            download_impl::transfer(
-                file_path, file_size, chunk_size, message_arena, stream
+            if (operation_impl::is_operation(*context)) {
+                operation_impl::session operations{m_options, *context};
+                download_impl::run_stepped_session(
+                    operations, message_arena, stream
+                );
+                return;
+            }
+            if (batch_impl::is_batch(*context)) {
+                batch_impl::download_session batch{m_options, *context};
+                download_impl::run_stepped_session(
+                    batch, message_arena, stream
+                );
+                return;
+            }
+            download_impl::session session{m_options, *context};
+
+            auto& initialize_response =
+                *google::protobuf::Arena::Create<api::DownloadFileResponse>(
+                    &message_arena
+                );
+            session.initialize(
+                *download_impl::read_request(message_arena, stream),
+                initialize_response
             );
+            download_impl::write_response(initialize_response, stream);
 
-            download_impl::finalize(message_arena, stream);
+            session.start_transfer(
+                *download_impl::read_request(message_arena, stream)
+            );
+            auto& transfer_response =
+                *google::protobuf::Arena::Create<api::DownloadFileResponse>(
+                    &message_arena
+                );
+            while (session.next_chunk(transfer_response)) {
+                download_impl::write_response(transfer_response, stream);
+            }
+
+            auto& finalize_response =
+                *google::protobuf::Arena::Create<api::DownloadFileResponse>(
+                    &message_arena
+                );
+            session.finalize(
+                *download_impl::read_request(message_arena, stream),
+                finalize_response
+            );
+            download_impl::write_response(finalize_response, stream);
         })
     );
 }
@@ -0,0 +1,214 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "adaptive_chunk_size.h"
+#include "checksum.h"
+#include "chunk_compression.h"
+#include "digest_cache.h"
+#include "file_io.h"
+#include "filetransfer_service.h"
+#include "read_ahead.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+
+namespace file_transfer {
+namespace download_impl {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+
+/**
+ * @brief Check that a request belongs to the expected step of the download.
+ * @param request_ Request to check.
+ * @param expected_step_ Step which the request is expected to belong to.
+ */
+auto check_request_step(
+    const api::DownloadFileRequest& request_,
+    const api::DownloadFileRequest::SubStepCase& expected_step_
+) -> void;
+
+/**
+ * @brief State of a single "DownloadFile" operation.
+ *
+ * The session processes the requests of the initialize, transfer, and
+ * finalize steps, and fills in the responses to send. It does not read
+ * from or write to the stream itself, such that it can be driven both by
+ * the synchronous and the callback-based service.
+ */
+class session {
+public:
+    /**
+     * @brief Construct the session.
+     * @param options_ Options of the service which handles the download.
+     * @param context_ Server context of the call.
+     */
+    session(const ServiceOptions& options_, ::grpc::ServerContextBase& context_)
+        : m_options{options_}, m_context{context_} {}
+
+    /**
+     * @brief Process the request of the "initialize" step.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     */
+    auto initialize(
+        const api::DownloadFileRequest& request_,
+        api::DownloadFileResponse& response_
+    ) -> void;
+
+    /**
+     * @brief Process the "receive_data" request which starts the transfer.
+     * @param request_ Request to process.
+     */
+    auto start_transfer(const api::DownloadFileRequest& request_) -> void;
+
+    /**
+     * @brief Fill in the response with the next chunk of the file.
+     *
+     * If the client requested ranges of the file, only these are sent.
+     * @param response_ Response to fill in.
+     * @return True if a chunk was added to the response, false if all
+     *      requested bytes have already been sent.
+     */
+    auto next_chunk(api::DownloadFileResponse& response_) -> bool;
+
+    /**
+     * @brief Process the request of the "finalize" step.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     */
+    auto finalize(
+        const api::DownloadFileRequest& request_,
+        api::DownloadFileResponse& response_
+    ) -> void;
+
+private:
+    /**
+     * @brief Compute the block signatures of the file, which are sent in
+     *      place of its content.
+     */
+    auto initialize_signatures() -> void;
+    /**
+     * @brief Get the chunk manifest of the file, which is sent in place of
+     *      its content.
+     */
+    auto initialize_manifest() -> void;
+    /**
+     * @brief Get the hex digest of the data sent in place of the file.
+     */
+    [[nodiscard]] auto get_generated_hex_digest() const -> std::string;
+    /**
+     * @brief Adapt the chunk size to the time the previous chunk took.
+     */
+    auto adapt_chunk_size() -> void;
+    /**
+     * @brief Get the next chunk to read, and advance the position.
+     * @param range_index_ Index of the range which contains the chunk.
+     * @param position_ Position of the chunk in its range.
+     * @return The chunk, or an empty optional after the last chunk.
+     */
+    auto plan_chunk(std::size_t& range_index_, std::uint64_t& position_) const
+        -> std::optional<metadata::byte_range>;
+    /**
+     * @brief Get the next chunk to read, without advancing the position.
+     */
+    [[nodiscard]] auto peek_chunk() const
+        -> std::optional<metadata::byte_range>;
+    /**
+     * @brief Schedule reads until the read-ahead depth is reached.
+     */
+    auto fill_read_ahead() -> void;
+    auto update_streaming_hasher(const std::string& data_) -> void;
+
+    const ServiceOptions& m_options;
+    ::grpc::ServerContextBase& m_context;
+
+    boost::filesystem::path m_file_path;
+    /// Size of the sent data, which may be generated from the file.
+    std::size_t m_file_size = 0;
+    /// Data which are sent in place of the content of the file, such as its
+    /// block signatures. They are moved into the reader when the transfer
+    /// starts.
+    std::optional<std::string> m_generated_data;
+    std::size_t m_delta_block_size = 0;
+    std::streamsize m_chunk_size = 0;
+    /// Adapts the chunk size, if the client requested it.
+    std::optional<detail::adaptive_chunk_size> m_adaptive_chunk_size;
+    std::chrono::steady_clock::time_point m_last_chunk_start;
+    std::uint64_t m_last_chunk_size = 0;
+
+    std::shared_ptr<detail::file_reader> m_reader;
+    /// Compresses the chunks, if the client requested it. It is declared
+    /// before the read-ahead stage, which uses it.
+    std::optional<detail::chunk_codec> m_codec;
+    /// Raw data of the current chunk, if the chunks are compressed.
+    std::string m_raw_chunk;
+    /// Number of bytes of the sent frames, if the chunks are compressed.
+    std::uint64_t m_num_frame_bytes_sent = 0;
+    /// Reads chunks ahead of the sender, if enabled in the options.
+    std::unique_ptr<detail::read_ahead> m_read_ahead;
+    /// Parts of the file which are sent, in order.
+    std::vector<metadata::byte_range> m_ranges;
+    std::uint64_t m_num_bytes_total = 0;
+    /// Range of the next chunk which is read.
+    std::size_t m_range_index = 0;
+    /// Position of the next chunk which is read, in its range.
+    std::uint64_t m_range_position = 0;
+    std::uint64_t m_num_bytes_sent = 0;
+
+    detail::checksum_algorithm m_checksum_algorithm =
+        detail::checksum_algorithm::sha1;
+    /// Hasher for the checksum which is computed while streaming, if any.
+    std::unique_ptr<detail::hasher> m_streaming_hasher;
+    /// Identity of the file when the streaming hasher was started.
+    std::optional<detail::file_identity> m_streamed_file_identity;
+    /// Checksum which is sent in the finalize step, either taken from the
+    /// digest cache or computed by the streaming hasher.
+    std::optional<std::string> m_finalize_hex_digest;
+};
+
+} // namespace download_impl
+} // namespace file_transfer
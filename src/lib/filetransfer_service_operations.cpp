@@ -0,0 +1,391 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "filetransfer_service_operations.h"
+
+#include <exception>
+#include <functional>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "atomic_file.h"
+#include "digest_cache.h"
+#include "exception_handling.h"
+#include "exception_types.h"
+#include "file_operations.h"
+#include "transfer_metadata.h"
+
+namespace file_transfer {
+namespace operation_impl {
+
+auto operation_from_string(const std::string& name_) -> operation {
+    if (name_ == "stat") {
+        return operation::stat;
+    }
+    if (name_ == "exists") {
+        return operation::exists;
+    }
+    if (name_ == "list") {
+        return operation::list;
+    }
+    if (name_ == "remove") {
+        return operation::remove;
+    }
+    if (name_ == "rename") {
+        return operation::rename;
+    }
+    if (name_ == "copy") {
+        return operation::copy;
+    }
+    throw exceptions::invalid_argument("Unknown operation '" + name_ + "'.");
+}
+
+auto takes_target(operation operation_) -> bool {
+    return operation_ == operation::rename || operation_ == operation::copy;
+}
+
+auto is_operation(const ::grpc::ServerContextBase& context_) -> bool {
+    return metadata::get_client_metadata(context_, metadata::operation_key)
+        .has_value();
+}
+
+auto session::start() -> void {
+    const auto name =
+        metadata::get_client_metadata(m_context, metadata::operation_key);
+    m_operation = operation_from_string(name.value_or(""));
+    const auto batch =
+        metadata::get_client_metadata(m_context, metadata::batch_key);
+    if (batch && *batch != "true") {
+        throw exceptions::invalid_argument(
+            "Unknown batch value '" + *batch + "'."
+        );
+    }
+    m_batch = batch.has_value();
+    m_checksum_algorithm = metadata::negotiate_checksum_algorithm(m_context);
+    m_context.AddInitialMetadata(metadata::operation_key, *name);
+    if (m_batch) {
+        m_context.AddInitialMetadata(metadata::batch_key, *batch);
+    }
+    m_started = true;
+}
+
+auto session::receive(const api::DownloadFileRequest& request_) -> void {
+    if (!m_started) {
+        start();
+    }
+    if (m_finalize_received) {
+        throw exceptions::invalid_argument(
+            "Received a request after the end of the batch."
+        );
+    }
+    switch (request_.sub_step_case()) {
+    case api::DownloadFileRequest::kInitialize:
+        m_compute_checksum = request_.initialize().compute_sha1_checksum();
+        run(request_.initialize().filename());
+        break;
+    case api::DownloadFileRequest::kFinalize:
+        if (!m_batch) {
+            throw exceptions::invalid_argument(
+                "Only a batch of operations has a finalize step."
+            );
+        }
+        if (m_source) {
+            throw exceptions::invalid_argument(
+                "The target of the last operation is missing."
+            );
+        }
+        m_finalize_received = true;
+        break;
+    default:
+        throw exceptions::invalid_argument("Incorrect request step.");
+    }
+}
+
+auto session::run(const boost::filesystem::path& path_) -> void {
+    if (takes_target(m_operation) && !m_source) {
+        // The target follows in the next request.
+        m_source = path_;
+        return;
+    }
+    const auto source = std::exchange(m_source, std::nullopt);
+    ++m_num_operations;
+    m_result.emplace();
+    const auto run_operation = [&]() {
+        switch (m_operation) {
+        case operation::stat:
+        case operation::exists:
+            run_stat(path_);
+            break;
+        case operation::list:
+            run_list(path_);
+            break;
+        case operation::remove:
+            run_remove(path_);
+            break;
+        case operation::rename:
+            run_rename(*source, path_);
+            break;
+        case operation::copy:
+            run_copy(*source, path_);
+            break;
+        }
+        m_result->mutable_progress()->set_state(Progress::COMPLETED);
+    };
+    if (!m_batch) {
+        run_operation();
+        return;
+    }
+    const auto status =
+        exceptions::convert_exceptions_to_status_codes(run_operation);
+    if (!status.ok()) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Operation " << m_num_operations - 1
+            << " of the batch failed: " << status.error_message();
+        m_errors.add(m_num_operations - 1, status);
+        m_result.emplace();
+        auto& file_info = *m_result->mutable_file_info();
+        file_info.set_name(path_.string());
+        file_info.set_size(-1);
+        m_result->mutable_progress()->set_state(Progress::INITIALIZED);
+    }
+}
+
+auto session::run_stat(const boost::filesystem::path& path_) -> void {
+    auto& file_info = *m_result->mutable_file_info();
+    file_info.set_name(path_.string());
+    boost::system::error_code error_code;
+    const auto status = boost::filesystem::status(path_, error_code);
+    if (!boost::filesystem::exists(status)) {
+        if (m_operation == operation::exists) {
+            file_info.set_size(-1);
+            return;
+        }
+        throw exceptions::not_found(
+            "The file " + path_.string() + " does not exist."
+        );
+    }
+    if (boost::filesystem::is_directory(status)) {
+        // Directories are marked by a trailing separator.
+        if (!path_.empty() && path_.string().back() != '/') {
+            file_info.set_name(path_.string() + '/');
+        }
+        return;
+    }
+    if (!boost::filesystem::is_regular_file(status)) {
+        return;
+    }
+    file_info.set_size(boost::numeric_cast<pb_filesize_t>(
+        boost::filesystem::file_size(path_)
+    ));
+    if (m_compute_checksum) {
+        file_info.mutable_sha1()->set_hex_digest(get_hex_digest(path_));
+    }
+}
+
+auto session::run_list(const boost::filesystem::path& path_) -> void {
+    // The file info and data are exclusive, so the listing is sent alone.
+    auto& file_data = *m_result->mutable_file_data();
+    file_data.set_offset(0);
+    *file_data.mutable_data() = detail::list_directory(path_);
+}
+
+auto session::run_remove(const boost::filesystem::path& path_) -> void {
+    boost::system::error_code error_code;
+    const auto status = boost::filesystem::symlink_status(path_, error_code);
+    if (!boost::filesystem::exists(status)) {
+        throw exceptions::not_found(
+            "The file " + path_.string() + " does not exist."
+        );
+    }
+    if (boost::filesystem::is_directory(status) &&
+        !boost::filesystem::is_empty(path_, error_code)) {
+        throw exceptions::failed_precondition(
+            "The directory " + path_.string() + " is not empty."
+        );
+    }
+    if (m_options.digest_cache) {
+        m_options.digest_cache->invalidate(path_);
+    }
+    boost::filesystem::remove(path_, error_code);
+    if (error_code) {
+        throw exceptions::failed_precondition(
+            "Could not remove " + path_.string() + ": " + error_code.message()
+        );
+    }
+    m_result->mutable_file_info()->set_name(path_.string());
+    BOOST_LOG_TRIVIAL(info) << "Removed " << path_.generic_string();
+}
+
+auto session::run_rename(
+    const boost::filesystem::path& source_,
+    const boost::filesystem::path& target_
+) -> void {
+    boost::system::error_code error_code;
+    if (!boost::filesystem::exists(
+            boost::filesystem::symlink_status(source_, error_code)
+        )) {
+        throw exceptions::not_found(
+            "The file " + source_.string() + " does not exist."
+        );
+    }
+    // The renamed file keeps its identity, so only the digest of the
+    // replaced target becomes stale.
+    if (m_options.digest_cache) {
+        m_options.digest_cache->invalidate(target_);
+    }
+    boost::filesystem::rename(source_, target_, error_code);
+    if (error_code) {
+        throw exceptions::failed_precondition(
+            "Could not rename " + source_.string() + " to " +
+            target_.string() + ": " + error_code.message()
+        );
+    }
+    m_result->mutable_file_info()->set_name(target_.string());
+    BOOST_LOG_TRIVIAL(info) << "Renamed " << source_.generic_string()
+                            << " to " << target_.generic_string();
+}
+
+auto session::run_copy(
+    const boost::filesystem::path& source_,
+    const boost::filesystem::path& target_
+) -> void {
+    boost::system::error_code error_code;
+    const auto status = boost::filesystem::status(source_, error_code);
+    if (!boost::filesystem::exists(status)) {
+        throw exceptions::not_found(
+            "The file " + source_.string() + " does not exist."
+        );
+    }
+    if (!boost::filesystem::is_regular_file(status)) {
+        throw exceptions::failed_precondition(
+            source_.string() + " is not a regular file."
+        );
+    }
+    // Checked here as well, since a copy into a temporary file would not
+    // notice it.
+    if (boost::filesystem::equivalent(source_, target_, error_code)) {
+        throw exceptions::invalid_argument(
+            "Can not copy " + source_.string() + " onto itself."
+        );
+    }
+    if (m_options.digest_cache) {
+        m_options.digest_cache->invalidate(target_);
+    }
+    // Like an upload, the copy only replaces the target once it is
+    // complete.
+    const auto write_path = m_options.atomic_uploads &&
+                                    detail::can_replace_atomically(target_)
+                                ? detail::get_temporary_path(target_)
+                                : target_;
+    detail::copy_method method{};
+    try {
+        method = detail::copy_file_contents(source_, write_path);
+        const auto sync =
+            m_options.upload_durability != detail::upload_durability::none;
+        if (sync) {
+            detail::sync_file(write_path);
+        }
+        if (write_path != target_) {
+            detail::commit_file(write_path, target_, sync);
+        }
+    } catch (...) {
+        if (write_path != target_) {
+            detail::discard_file(write_path);
+        }
+        throw;
+    }
+
+    auto& file_info = *m_result->mutable_file_info();
+    file_info.set_name(target_.string());
+    file_info.set_size(boost::numeric_cast<pb_filesize_t>(
+        boost::filesystem::file_size(target_)
+    ));
+    if (m_compute_checksum) {
+        // The copy has the digest of the source, which may be cached.
+        const auto hex_digest = get_hex_digest(source_);
+        if (m_options.digest_cache) {
+            m_options.digest_cache->insert(
+                target_, m_checksum_algorithm, hex_digest
+            );
+        }
+        file_info.mutable_sha1()->set_hex_digest(hex_digest);
+    }
+    BOOST_LOG_TRIVIAL(info)
+        << "Copied " << source_.generic_string() << " to "
+        << target_.generic_string() << " (" << detail::to_string(method) << ")";
+}
+
+auto session::get_hex_digest(const boost::filesystem::path& path_) const
+    -> std::string {
+    if (m_options.digest_cache) {
+        return m_options.digest_cache->get_hex_digest(
+            path_, m_checksum_algorithm, m_options.io_backend
+        );
+    }
+    return detail::get_hex_digest(
+        path_, m_checksum_algorithm, m_options.io_backend
+    );
+}
+
+auto session::next_response(api::DownloadFileResponse& response_) -> bool {
+    if (m_result) {
+        response_ = std::move(*m_result);
+        m_result.reset();
+        // A single operation ends the call.
+        m_finished = !m_batch;
+        return true;
+    }
+    if (m_finalize_received && !m_finished) {
+        response_.Clear();
+        if (m_errors.size() > 0) {
+            m_context.AddTrailingMetadata(
+                metadata::batch_errors_key, m_errors.to_string()
+            );
+        }
+        BOOST_LOG_TRIVIAL(info)
+            << "Batch of " << m_num_operations << " operations complete, "
+            << m_errors.size() << " failed.";
+        response_.mutable_progress()->set_state(Progress::COMPLETED);
+        m_finished = true;
+        return true;
+    }
+    return false;
+}
+
+} // namespace operation_impl
+} // namespace file_transfer
@@ -0,0 +1,166 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "checksum.h"
+#include "filetransfer_service.h"
+#include "filetransfer_service_batch.h"
+#include "service_options.h"
+
+namespace file_transfer {
+namespace operation_impl {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+
+/**
+ * @brief Operation on server files, selected by the operation_key.
+ */
+enum class operation { stat, exists, list, remove, rename, copy };
+
+/**
+ * @brief Get an operation by its name.
+ * @throws exceptions::invalid_argument if the name is unknown.
+ */
+auto operation_from_string(const std::string& name_) -> operation;
+
+/**
+ * @brief Whether an operation takes a source and a target path.
+ */
+auto takes_target(operation operation_) -> bool;
+
+/**
+ * @brief Check whether the client requested an operation instead of a
+ *      download.
+ * @param context_ Server context of the call.
+ */
+auto is_operation(const ::grpc::ServerContextBase& context_) -> bool;
+
+/**
+ * @brief State of a "DownloadFile" call which runs operations on server
+ *      files, instead of downloading them.
+ *
+ * Each initialize request names the path of an operation. A rename or a
+ * copy takes two initialize requests, with the source and the target.
+ * Each operation gets one response, whose file info describes the result,
+ * except for a list, whose response holds the listing of
+ * detail::list_directory as file data.
+ *
+ * Without the batch_key, the call runs a single operation, whose errors
+ * end the call, and ends after its response. With it, the call runs
+ * operations until the finalize request, as a batch: a failed operation
+ * gets a response with progress INITIALIZED and size -1, and is listed in
+ * the trailing metadata.
+ *
+ * The session does not access the stream itself, such that both services
+ * can drive it.
+ */
+class session {
+public:
+    /**
+     * @brief Construct the session.
+     * @param options_ Options of the service which handles the call.
+     * @param context_ Server context of the call.
+     */
+    session(const ServiceOptions& options_, ::grpc::ServerContextBase& context_)
+        : m_options{options_}, m_context{context_} {}
+
+    /**
+     * @brief Process a request. Must only be called once next_response has
+     *      returned false.
+     * @param request_ Request to process.
+     * @throws exceptions::invalid_argument if the requests do not follow
+     *      the protocol.
+     * @throws The error of the operation, if the call runs a single
+     *      operation.
+     */
+    auto receive(const api::DownloadFileRequest& request_) -> void;
+
+    /**
+     * @brief Fill in the next response.
+     * @param response_ Response to fill in.
+     * @return True if the response should be sent, false if the next
+     *      request is needed first, or the call is finished.
+     */
+    auto next_response(api::DownloadFileResponse& response_) -> bool;
+
+    /**
+     * @brief Whether the last response has been filled in.
+     */
+    [[nodiscard]] auto finished() const -> bool { return m_finished; }
+
+private:
+    auto start() -> void;
+    auto run(const boost::filesystem::path& path_) -> void;
+    auto run_stat(const boost::filesystem::path& path_) -> void;
+    auto run_list(const boost::filesystem::path& path_) -> void;
+    auto run_remove(const boost::filesystem::path& path_) -> void;
+    auto run_rename(
+        const boost::filesystem::path& source_,
+        const boost::filesystem::path& target_
+    ) -> void;
+    auto run_copy(
+        const boost::filesystem::path& source_,
+        const boost::filesystem::path& target_
+    ) -> void;
+    auto get_hex_digest(const boost::filesystem::path& path_) const
+        -> std::string;
+
+    const ServiceOptions& m_options;
+    ::grpc::ServerContextBase& m_context;
+    bool m_started = false;
+    bool m_batch = false;
+    bool m_finalize_received = false;
+    bool m_finished = false;
+    operation m_operation = operation::stat;
+    detail::checksum_algorithm m_checksum_algorithm =
+        detail::checksum_algorithm::sha1;
+    bool m_compute_checksum = false;
+    /// Source of a rename or copy, until its target is received.
+    std::optional<boost::filesystem::path> m_source;
+    std::size_t m_num_operations = 0;
+    batch_impl::batch_errors m_errors;
+    /// Response of the last operation, until it is sent.
+    std::optional<api::DownloadFileResponse> m_result;
+};
+
+} // namespace operation_impl
+} // namespace file_transfer
@@ -20,12 +20,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include "filetransfer_service.h"
+#include "filetransfer_service_upload.h"
 
 #include <cstdint>
 #include <exception>
+#include <mutex>
 #include <string>
-#include <tuple>
 #include <utility>
 
 #ifdef _MSC_VER
@@ -35,7 +35,7 @@
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #endif
 
-#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/numeric/conversion/cast.hpp>
@@ -48,164 +48,796 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "atomic_file.h"
 #include "exception_handling.h"
 #include "exception_types.h"
-#include "sha1_digest.h"
+#include "filetransfer_service_batch.h"
+#include "metrics.h"
+#include "transfer_metadata.h"
 
 namespace file_transfer {
 
 namespace upload_impl {
 
-namespace api = ::ansys::api::tools::filetransfer::v1;
 using stream_t =
     ::grpc::ServerReaderWriter<api::UploadFileResponse, api::UploadFileRequest>;
 
-auto get_request_checked(
-    api::UploadFileRequest* request_,
-    stream_t* stream_,
+auto check_request_step(
+    const api::UploadFileRequest& request_,
     const api::UploadFileRequest::SubStepCase& expected_step_
 ) -> void {
-    if (!stream_->Read(request_)) {
-        throw exceptions::invalid_argument("Request stream stopped prematurely."
-        );
-    }
-    if (request_->sub_step_case() != expected_step_) {
+    if (request_.sub_step_case() != expected_step_) {
         throw exceptions::invalid_argument(
             "Incorrect request step. Expected " +
             std::to_string(expected_step_) + ", but got " +
-            std::to_string(request_->sub_step_case()) + "."
+            std::to_string(request_.sub_step_case()) + "."
         );
     }
 }
 
-auto get_request_checked(
-    google::protobuf::Arena& arena_,
-    stream_t* stream_,
-    const api::UploadFileRequest::SubStepCase& expected_step_
-) -> api::UploadFileRequest* {
-    auto* request =
-        google::protobuf::Arena::Create<api::UploadFileRequest>(&arena_);
-    get_request_checked(request, stream_, expected_step_);
-    return request;
-}
+auto session::initialize(
+    const api::UploadFileRequest& request_,
+    api::UploadFileResponse& response_
+) -> void {
+    check_request_step(request_, api::UploadFileRequest::kInitialize);
+
+    const auto& file_info = request_.initialize().file_info();
 
-auto initialize(google::protobuf::Arena& arena_, stream_t* stream_) -> std::
-    tuple<const boost::filesystem::path, const std::size_t, const std::string> {
-    auto& request = *get_request_checked(
-        arena_, stream_, api::UploadFileRequest::kInitialize
+    m_file_path = file_info.name();
+    m_file_size = boost::numeric_cast<std::size_t>(file_info.size());
+    m_source_sha1_hex = file_info.sha1().hex_digest();
+    if (!m_source_sha1_hex.empty()) {
+        m_checksum_algorithm = metadata::negotiate_checksum_algorithm(m_context);
+        m_hasher = detail::make_hasher(m_checksum_algorithm);
+    }
+
+    const auto requested_cadence = metadata::get_client_metadata(
+        m_context, metadata::progress_cadence_key
     );
+    if (requested_cadence) {
+        m_progress_cadence = detail::parse_progress_cadence(*requested_cadence);
+        m_context.AddInitialMetadata(
+            metadata::progress_cadence_key, *requested_cadence
+        );
+    }
 
-    const auto& file_info = request.initialize().file_info();
+    const auto compression = metadata::negotiate_compression(
+        m_context, m_options.compression_algorithms
+    );
+    if (compression) {
+        m_codec.emplace(*compression);
+    }
 
-    const boost::filesystem::path file_path{file_info.name()};
-    const auto file_size = boost::numeric_cast<std::size_t>(file_info.size());
-    const std::string source_sha1_hex = file_info.sha1().hex_digest();
+    const auto upload_mode =
+        metadata::get_client_metadata(m_context, metadata::upload_mode_key)
+            .value_or("sequential");
+    const auto session_id =
+        metadata::get_client_metadata(m_context, metadata::upload_session_key);
+    if (upload_mode == "positional") {
+        if (session_id) {
+            throw exceptions::invalid_argument(
+                "Positional uploads cannot be combined with upload sessions."
+            );
+        }
+        initialize_positional();
+    } else if (upload_mode == "delta") {
+        if (session_id) {
+            throw exceptions::invalid_argument(
+                "Delta uploads cannot be combined with upload sessions."
+            );
+        }
+        initialize_delta();
+    } else if (upload_mode == "chunked") {
+        if (session_id) {
+            throw exceptions::invalid_argument(
+                "Chunked uploads cannot be combined with upload sessions."
+            );
+        }
+        if (!m_options.chunk_store) {
+            throw exceptions::failed_precondition(
+                "The server does not have a chunk store."
+            );
+        }
+        m_delta = std::make_unique<detail::delta_decoder>(m_options.chunk_store);
+        m_context.AddInitialMetadata(metadata::upload_mode_key, "chunked");
+    } else if (upload_mode != "sequential") {
+        throw exceptions::invalid_argument(
+            "Unknown upload mode '" + upload_mode + "'."
+        );
+    }
 
-    auto& response =
-        *(google::protobuf::Arena::Create<api::UploadFileResponse>(&arena_));
-    auto& progress = *response.mutable_progress();
+    if (m_options.upload_sessions && session_id) {
+        detail::upload_session_store::check_session_id(*session_id);
+        // Concurrent uploads of a session would write to the same file,
+        // and overwrite each other's checkpoints.
+        m_session_lease = m_options.upload_sessions->acquire(*session_id);
+        m_session_id = session_id;
+    } else if (session_id) {
+        static std::once_flag flag;
+        std::call_once(flag, []() {
+            BOOST_LOG_TRIVIAL(warning)
+                << "A client requested a resumable upload, but the server "
+                   "has no --upload-session-dir. Uploads are not resumable.";
+        });
+    }
+    // The temporary file of a positional upload is shared by its streams.
+    m_write_path = m_file_path;
+    // A delta upload reads the existing file while the new one is written,
+    // so it is never written in place.
+    const auto atomic = m_options.atomic_uploads &&
+                        detail::can_replace_atomically(m_file_path);
+    if ((atomic || upload_mode == "delta") && !m_positional) {
+        // A resumable upload continues in the same temporary file.
+        m_write_path = m_session_id
+                           ? detail::upload_session_store::get_temporary_path(
+                                 m_file_path, *m_session_id
+                             )
+                           : detail::get_temporary_path(m_file_path);
+    }
+    if (m_session_id) {
+        resume_from_checkpoint();
+        m_context.AddInitialMetadata(
+            metadata::upload_session_key, *m_session_id
+        );
+        m_context.AddInitialMetadata(
+            metadata::upload_offset_key, std::to_string(m_resume_offset)
+        );
+    }
+
+    auto& progress = *response_.mutable_progress();
     progress.set_state(Progress::INITIALIZED);
-    stream_->Write(response);
 
     BOOST_LOG_TRIVIAL(info)
-        << "Initializing upload of file:" << file_path.generic_string()
-        << "\n  file size: " << file_size
-        << "\n  SHA1 checksum: " << source_sha1_hex;
+        << "Initializing upload of file:" << m_file_path.generic_string()
+        << "\n  file size: " << m_file_size
+        << "\n  checksum (" << detail::to_string(m_checksum_algorithm)
+        << "): " << m_source_sha1_hex;
+    if (m_resume_offset > 0) {
+        BOOST_LOG_TRIVIAL(info) << "Resuming upload session " << *m_session_id
+                                << " at offset " << m_resume_offset;
+    }
+    if (upload_mode == "positional") {
+        BOOST_LOG_TRIVIAL(info)
+            << "Positional upload of part " << metadata::to_string({m_part});
+    }
+    if (m_codec) {
+        BOOST_LOG_TRIVIAL(info)
+            << "Compression: " << detail::to_string(m_codec->settings());
+    }
+    if (upload_mode == "delta") {
+        BOOST_LOG_TRIVIAL(info) << "Delta upload against the existing file.";
+    }
+}
+
+auto session::initialize_delta() -> void {
+    // The file is reconstructed from the chunks and the existing file, so
+    // only the checksum shows whether the existing file was the one whose
+    // signatures the client used.
+    if (m_source_sha1_hex.empty()) {
+        throw exceptions::invalid_argument(
+            "Delta uploads require the checksum of the file."
+        );
+    }
+    const auto requested_block_size =
+        metadata::get_client_metadata(m_context, metadata::delta_block_size_key);
+    if (!requested_block_size) {
+        throw exceptions::invalid_argument(
+            "Delta uploads require the block size of the signatures."
+        );
+    }
+    const auto block_size =
+        metadata::parse_delta_block_size(*requested_block_size);
+    boost::system::error_code error_code;
+    const auto basis_size =
+        boost::filesystem::file_size(m_file_path, error_code);
+    if (error_code) {
+        throw exceptions::failed_precondition(
+            "The file " + m_file_path.string() +
+            " does not exist, so it can not be the basis of a delta upload."
+        );
+    }
+    m_delta = std::make_unique<detail::delta_decoder>(
+        detail::open_file_reader(
+            m_file_path, basis_size, m_options.io_backend
+        ),
+        basis_size,
+        block_size,
+        m_options.chunk_store
+    );
+    m_context.AddInitialMetadata(metadata::upload_mode_key, "delta");
+    m_context.AddInitialMetadata(
+        metadata::delta_block_size_key, std::to_string(block_size)
+    );
+}
 
-    return std::make_tuple(file_path, file_size, source_sha1_hex);
+auto session::initialize_positional() -> void {
+    m_positional = true;
+    m_part = {0, m_file_size};
+    const auto requested_range =
+        metadata::get_client_metadata(m_context, metadata::upload_range_key);
+    if (requested_range) {
+        const auto ranges =
+            metadata::parse_byte_ranges(*requested_range, m_file_size);
+        if (ranges.size() > 1) {
+            throw exceptions::invalid_argument(
+                "The part of a positional upload must be a single range."
+            );
+        }
+        m_part = ranges.empty() ? metadata::byte_range{} : ranges.front();
+    }
+    // The chunks can not be hashed in order, so the checksum is computed
+    // from the file once all parts have been received.
+    m_hasher.reset();
+    m_context.AddInitialMetadata(metadata::upload_mode_key, "positional");
+    m_context.AddInitialMetadata(
+        metadata::upload_range_key, metadata::to_string({m_part})
+    );
 }
 
-auto transfer(
-    const boost::filesystem::path& file_path_,
-    const std::size_t file_size_,
-    google::protobuf::Arena& arena_,
-    stream_t* stream_
-) -> void {
-    boost::filesystem::ofstream out_file;
+auto session::resume_from_checkpoint() -> void {
+    const auto checkpoint = m_options.upload_sessions->load(*m_session_id);
+    if (!checkpoint) {
+        return;
+    }
+    const auto algorithm_name =
+        m_hasher ? detail::to_string(m_checksum_algorithm) : std::string{};
+    boost::system::error_code error_code;
+    const auto existing_size =
+        boost::filesystem::file_size(m_write_path, error_code);
+    if (checkpoint->file_name != m_file_path.string() ||
+        checkpoint->file_size != m_file_size ||
+        checkpoint->checksum_algorithm != algorithm_name ||
+        checkpoint->source_hex_digest != m_source_sha1_hex || error_code ||
+        existing_size < checkpoint->offset ||
+        checkpoint->offset > m_file_size) {
+        BOOST_LOG_TRIVIAL(info)
+            << "Discarding the checkpoint of upload session " << *m_session_id
+            << ", since it does not match the upload.";
+        return;
+    }
+    if (m_hasher) {
+        try {
+            m_hasher->restore_state(checkpoint->hash_state);
+        } catch (const std::invalid_argument& e) {
+            BOOST_LOG_TRIVIAL(warning)
+                << "Discarding the checkpoint of upload session "
+                << *m_session_id << ": " << e.what();
+            m_hasher = detail::make_hasher(m_checksum_algorithm);
+            return;
+        }
+    }
+    m_resume_offset = boost::numeric_cast<std::size_t>(checkpoint->offset);
+}
+
+auto session::start_transfer() -> void {
+    if (m_options.digest_cache) {
+        m_options.digest_cache->invalidate(m_file_path);
+    }
+    m_progress_throttle = detail::progress_throttle{
+        m_progress_cadence, detail::progress_throttle::clock_t_::now()
+    };
+    if (m_positional) {
+        start_positional_transfer();
+        return;
+    }
     try {
-        out_file.open(file_path_, std::ios_base::binary);
+        if (m_resume_offset > 0) {
+            // Drop any data after the checkpoint, which may be incomplete.
+            boost::filesystem::resize_file(m_write_path, m_resume_offset);
+            open_output(std::ios_base::in | std::ios_base::out);
+            m_out_file.seekp(
+                boost::numeric_cast<std::streamoff>(m_resume_offset)
+            );
+        } else {
+            open_output(std::ios_base::out);
+        }
     } catch (const std::exception&) {
         throw exceptions::failed_precondition("Could not open output file.");
     }
+    m_num_bytes_received = m_resume_offset;
+    m_checkpoint_offset = m_resume_offset;
+    m_transfer_started = true;
+    // The chunks of a resumed upload can not be determined, since the start
+    // of the file is not received again.
+    if (m_options.chunk_store && m_resume_offset == 0) {
+        m_staged_chunks = std::make_unique<detail::chunk_store::transaction>(
+            *m_options.chunk_store
+        );
+        m_chunker = std::make_unique<detail::content_chunker>(
+            [this](const char* data_, std::size_t size_) {
+                m_manifest.push_back(m_staged_chunks->insert(data_, size_));
+            }
+        );
+    }
+    // The file is allocated in one go, instead of growing with each chunk.
+    detail::preallocate_file(m_write_path, m_file_size);
+    if (m_options.upload_page_cache == detail::page_cache_mode::drop_behind) {
+        m_drop_behind = std::make_unique<detail::drop_behind>(
+            m_write_path, m_resume_offset
+        );
+    }
+    if (m_options.write_behind_depth > 0 && m_options.io_thread_pool) {
+        m_write_behind = std::make_unique<detail::write_behind>(
+            m_out_file,
+            *m_options.io_thread_pool,
+            m_resume_offset,
+            m_options.write_block_size,
+            m_options.write_behind_depth
+        );
+    }
+}
 
-    std::size_t num_bytes_received = 0;
+auto session::start_positional_transfer() -> void {
+    // Streams which upload parts of the same file share its state.
+    const auto atomic = m_options.atomic_uploads &&
+                        detail::can_replace_atomically(m_file_path);
+    m_parallel_upload =
+        m_options.parallel_uploads
+            ? m_options.parallel_uploads->attach(
+                  m_file_path,
+                  m_file_size,
+                  atomic,
+                  detail::to_string(m_checksum_algorithm),
+                  m_source_sha1_hex
+              )
+            : std::make_shared<detail::parallel_upload>(
+                  m_file_path, m_file_size, atomic
+              );
+    m_write_path = m_parallel_upload->write_path();
+    try {
+        open_output(std::ios_base::in | std::ios_base::out);
+    } catch (const std::exception&) {
+        throw exceptions::failed_precondition("Could not open output file.");
+    }
+    m_write_position = 0;
+    m_transfer_started = true;
+}
 
-    auto& request =
-        *google::protobuf::Arena::Create<api::UploadFileRequest>(&arena_);
-    auto& response =
-        *google::protobuf::Arena::Create<api::UploadFileResponse>(&arena_);
-    auto& progress = *response.mutable_progress();
+auto session::transfer_complete() const -> bool {
+    if (m_positional) {
+        return m_part_coverage.covers(m_part.offset, m_part.length);
+    }
+    return m_num_bytes_received >= m_file_size;
+}
 
-    while (num_bytes_received < file_size_) {
-        get_request_checked(
-            &request, stream_, api::UploadFileRequest::kSendData
+auto session::receive(
+    const api::UploadFileRequest& request_,
+    api::UploadFileResponse& response_
+) -> bool {
+    check_request_step(request_, api::UploadFileRequest::kSendData);
+
+    const auto& file_data = request_.send_data().file_data();
+    const auto* chunk = &file_data.data();
+    if (m_codec) {
+        const metrics::phase_timer timer{metrics::phase::compression};
+        m_codec->decode(*chunk, m_decoded_chunk);
+        chunk = &m_decoded_chunk;
+    }
+    if (m_delta) {
+        m_delta->decode(*chunk, m_delta_chunk);
+        chunk = &m_delta_chunk;
+    }
+    const auto current_chunk_size = chunk->size();
+    if (current_chunk_size <= 0) {
+        throw exceptions::invalid_argument("Received empty file chunk.");
+    }
+    metrics::add_bytes(metrics::direction::upload, current_chunk_size);
+    const auto num_bytes_done = m_positional
+                                    ? receive_positional(file_data, *chunk)
+                                    : receive_sequential(file_data, *chunk);
+    if (m_options.upload_durability == detail::upload_durability::periodic) {
+        m_num_bytes_unsynced += current_chunk_size;
+        if (m_num_bytes_unsynced >= m_options.upload_sync_interval) {
+            sync_output();
+        }
+    }
+
+    const auto progress = boost::numeric_cast<pb_progress_t>(
+        (100 * num_bytes_done) / m_file_size
+    );
+    response_.mutable_progress()->set_state(progress);
+    // The response to the last chunk is always sent, such that the client
+    // knows that the transfer step has ended.
+    const auto send_response = m_progress_throttle.on_chunk(
+        boost::numeric_cast<std::uint32_t>(progress),
+        detail::progress_throttle::clock_t_::now()
+    );
+    return send_response || transfer_complete();
+}
+
+auto session::receive_sequential(
+    const api::FileChunk& file_data_, const std::string& chunk_
+) -> std::uint64_t {
+    // Resumed, delta, and chunked uploads rely on the chunks arriving in
+    // order.
+    if ((m_session_id || m_delta) &&
+        file_data_.offset() !=
+            boost::numeric_cast<pb_filesize_t>(m_num_bytes_received)) {
+        throw exceptions::invalid_argument(
+            "Expected a chunk at offset " +
+            std::to_string(m_num_bytes_received) + ", but got offset " +
+            std::to_string(file_data_.offset()) + "."
         );
-        const auto chunk = request.send_data().file_data().data();
-        const auto current_chunk_size = chunk.size();
-        if (current_chunk_size <= 0) {
-            throw exceptions::invalid_argument("Received empty file chunk.");
+    }
+    m_num_bytes_received += chunk_.size();
+
+    BOOST_LOG_TRIVIAL(debug) << "Received " << m_num_bytes_received << " of "
+                             << m_file_size << " bytes.";
+
+    {
+        const metrics::phase_timer timer{metrics::phase::disk_write};
+        if (m_write_behind) {
+            m_write_behind->write(chunk_);
+        } else {
+            m_out_file << chunk_;
+        }
+    }
+    if (m_hasher) {
+        const metrics::phase_timer timer{metrics::phase::hashing};
+        m_hasher->update(chunk_.data(), chunk_.size());
+    }
+    if (m_chunker) {
+        m_chunker->update(chunk_.data(), chunk_.size());
+    }
+    if (m_drop_behind &&
+        m_drop_behind->window_complete(m_num_bytes_received)) {
+        flush_output();
+        m_drop_behind->on_flushed(m_num_bytes_received);
+    }
+    if (m_session_id && m_num_bytes_received - m_checkpoint_offset >=
+                            m_options.upload_checkpoint_interval) {
+        checkpoint();
+    }
+    return m_num_bytes_received;
+}
+
+auto session::receive_positional(
+    const api::FileChunk& file_data_, const std::string& chunk_
+) -> std::uint64_t {
+    if (file_data_.offset() < 0 ||
+        boost::numeric_cast<std::uint64_t>(file_data_.offset()) < m_part.offset ||
+        boost::numeric_cast<std::uint64_t>(file_data_.offset()) +
+                chunk_.size() >
+            m_part.offset + m_part.length) {
+        throw exceptions::invalid_argument(
+            "The chunk at offset " + std::to_string(file_data_.offset()) +
+            " is not within the uploaded part " +
+            metadata::to_string({m_part}) + "."
+        );
+    }
+    const auto offset = boost::numeric_cast<std::uint64_t>(file_data_.offset());
+    BOOST_LOG_TRIVIAL(debug)
+        << "Received " << chunk_.size() << " bytes at offset " << offset;
+
+    {
+        const metrics::phase_timer timer{metrics::phase::disk_write};
+        if (offset != m_write_position) {
+            m_out_file.seekp(boost::numeric_cast<std::streamoff>(offset));
         }
-        num_bytes_received += current_chunk_size;
+        m_out_file.write(
+            chunk_.data(), boost::numeric_cast<std::streamsize>(chunk_.size())
+        );
+        // Other streams may read the file as soon as it is complete, so
+        // the chunk must be written through before it is recorded.
+        m_out_file.flush();
+    }
+    if (!m_out_file.good()) {
+        throw exceptions::internal("Could not write to the output file.");
+    }
+    m_write_position = offset + chunk_.size();
+    m_part_coverage.add(offset, chunk_.size());
+    return m_parallel_upload->add(offset, chunk_.size());
+}
 
-        BOOST_LOG_TRIVIAL(debug) << "Received " << num_bytes_received << " of "
-                                 << file_size_ << " bytes.";
+auto session::open_output(std::ios_base::openmode mode_) -> void {
+    m_out_buffer = detail::open_file_writer(
+        m_write_path,
+        mode_ | std::ios_base::binary,
+        m_options.io_backend,
+        m_options.upload_page_cache
+    );
+    m_out_file.rdbuf(m_out_buffer.get());
+}
 
-        out_file << chunk;
-        progress.set_state(boost::numeric_cast<pb_progress_t>(
-            (100 * num_bytes_received) / file_size_
-        ));
-        stream_->Write(response);
+auto session::flush_output() -> void {
+    if (m_write_behind) {
+        m_write_behind->flush();
+    }
+    if (m_out_buffer) {
+        m_out_file.flush();
+        if (!m_out_file.good()) {
+            throw exceptions::internal("Could not write to the output file.");
+        }
     }
-    if (num_bytes_received != file_size_) {
+}
+
+auto session::sync_output() -> void {
+    flush_output();
+    detail::sync_file(m_write_path);
+    m_num_bytes_unsynced = 0;
+}
+
+auto session::close_output() -> void {
+    m_out_file.flush();
+    const auto written = m_out_file.good();
+    m_out_file.rdbuf(nullptr);
+    m_out_buffer.reset();
+    if (!written) {
+        throw exceptions::internal("Could not write to the output file.");
+    }
+}
+
+auto session::commit_output() -> void {
+    const auto sync =
+        m_options.upload_durability != detail::upload_durability::none;
+    if (sync) {
+        detail::sync_file(m_write_path);
+    }
+    if (m_write_path != m_file_path) {
+        detail::commit_file(m_write_path, m_file_path, sync);
+    }
+    m_committed = true;
+}
+
+auto session::end_transfer() -> void {
+    if (m_positional) {
+        close_output();
+        return;
+    }
+    if (m_num_bytes_received != m_file_size) {
         throw exceptions::invalid_argument(
             "Received an incorrect number of bytes."
         );
     }
+    if (m_write_behind) {
+        m_write_behind->flush();
+        m_write_behind.reset();
+    }
+    close_output();
+    // The existing file is closed before it is replaced.
+    m_delta.reset();
+    if (m_drop_behind) {
+        m_drop_behind->on_flushed(m_file_size);
+        m_drop_behind->finish();
+        m_drop_behind.reset();
+    }
 }
 
-auto finalize(
-    const boost::filesystem::path& file_path_,
-    const std::string& source_sha1_hex_,
-    google::protobuf::Arena& arena_,
-    stream_t* stream_
+auto session::finalize(
+    const api::UploadFileRequest& request_,
+    api::UploadFileResponse& response_
 ) -> void {
-    get_request_checked(arena_, stream_, api::UploadFileRequest::kFinalize);
-    auto& response =
-        *google::protobuf::Arena::Create<api::UploadFileResponse>(&arena_);
-    auto& progress = *response.mutable_progress();
-
-    if (!source_sha1_hex_.empty()) {
-        const auto dest_sha1_hex = detail::get_sha1_hex_digest(file_path_);
-        if (source_sha1_hex_ != dest_sha1_hex) {
+    check_request_step(request_, api::UploadFileRequest::kFinalize);
+
+    if (m_session_id) {
+        // Whether or not the checksum matches, the upload can not be resumed
+        // anymore.
+        m_options.upload_sessions->remove(*m_session_id);
+        m_session_id.reset();
+    }
+    if (m_positional) {
+        finalize_positional(response_);
+        return;
+    }
+
+    std::string dest_sha1_hex;
+    if (!m_source_sha1_hex.empty()) {
+        // The chunks have been hashed as they were received, unless the
+        // written file should be verified.
+        dest_sha1_hex =
+            m_options.verify_uploads_from_disk
+                ? detail::get_hex_digest(
+                      m_write_path, m_checksum_algorithm, m_options.io_backend
+                  )
+                : m_hasher->hex_digest();
+        if (m_source_sha1_hex != dest_sha1_hex) {
             throw exceptions::data_loss("Checksum of the received file "
                                         "does not match expected value.");
         }
     }
+    // Only a verified file replaces the target.
+    commit_output();
+    // The chunks are only added to the store once the file is verified.
+    if (m_chunker) {
+        m_chunker->finish();
+        if (const auto identity = detail::get_file_identity(m_file_path)) {
+            m_staged_chunks->commit(m_file_path, *identity, m_manifest);
+        }
+    }
+    if (m_options.digest_cache && !dest_sha1_hex.empty()) {
+        m_options.digest_cache->insert(
+            m_file_path, m_checksum_algorithm, dest_sha1_hex
+        );
+    }
 
-    progress.set_state(Progress::COMPLETED);
-    stream_->Write(response);
+    response_.mutable_progress()->set_state(Progress::COMPLETED);
     BOOST_LOG_TRIVIAL(info) << "Upload complete.";
 }
 
+auto session::finalize_positional(api::UploadFileResponse& response_)
+    -> void {
+    if (!m_parallel_upload->complete()) {
+        // Other streams are still sending their parts.
+        const auto num_bytes_written = m_parallel_upload->num_bytes_written();
+        response_.mutable_progress()->set_state(
+            boost::numeric_cast<pb_progress_t>(
+                (100 * num_bytes_written) / m_file_size
+            )
+        );
+        BOOST_LOG_TRIVIAL(info)
+            << "Part " << metadata::to_string({m_part}) << " received, "
+            << num_bytes_written << " of " << m_file_size
+            << " bytes of the file are complete.";
+        return;
+    }
+
+    // The upload is only forgotten once it is verified and committed, such
+    // that no new upload of the file starts before.
+    const auto release = [&]() {
+        if (m_options.parallel_uploads) {
+            m_options.parallel_uploads->release(m_file_path, m_parallel_upload);
+        }
+    };
+    std::string dest_sha1_hex;
+    if (!m_source_sha1_hex.empty()) {
+        // If several streams complete at the same time, the file is only
+        // hashed once.
+        dest_sha1_hex = m_parallel_upload->get_hex_digest([&]() {
+            return detail::get_hex_digest(
+                m_write_path, m_checksum_algorithm, m_options.io_backend
+            );
+        });
+        if (m_source_sha1_hex != dest_sha1_hex) {
+            // The received data are not used, so the file is uploaded anew.
+            release();
+            throw exceptions::data_loss("Checksum of the received file "
+                                        "does not match expected value.");
+        }
+    }
+    m_parallel_upload->commit([&]() { commit_output(); });
+    release();
+    if (m_options.digest_cache && !dest_sha1_hex.empty()) {
+        m_options.digest_cache->insert(
+            m_file_path, m_checksum_algorithm, dest_sha1_hex
+        );
+    }
+
+    response_.mutable_progress()->set_state(Progress::COMPLETED);
+    BOOST_LOG_TRIVIAL(info) << "Upload complete.";
+}
+
+session::~session() {
+    if (!m_session_id) {
+        if (!m_positional && m_transfer_started && !m_committed &&
+            m_write_path != m_file_path) {
+            // The output is closed first, since open files can not be
+            // removed on all platforms.
+            m_write_behind.reset();
+            m_drop_behind.reset();
+            m_out_file.rdbuf(nullptr);
+            m_out_buffer.reset();
+            detail::discard_file(m_write_path);
+        }
+        return;
+    }
+    if (!m_transfer_started || m_num_bytes_received == m_checkpoint_offset) {
+        return;
+    }
+    try {
+        checkpoint();
+        BOOST_LOG_TRIVIAL(info)
+            << "Upload session " << *m_session_id << " interrupted at offset "
+            << m_num_bytes_received;
+    } catch (const std::exception& e) {
+        BOOST_LOG_TRIVIAL(warning) << "Could not checkpoint upload session "
+                                   << *m_session_id << ": " << e.what();
+    }
+}
+
+auto session::checkpoint() -> void {
+    // Without synchronizing, a checkpoint may outlive the data it records.
+    const auto sync =
+        m_options.upload_durability != detail::upload_durability::none;
+    if (sync) {
+        sync_output();
+    } else {
+        flush_output();
+    }
+    detail::upload_checkpoint checkpoint;
+    checkpoint.file_name = m_file_path.string();
+    checkpoint.file_size = m_file_size;
+    if (m_hasher) {
+        checkpoint.checksum_algorithm = detail::to_string(m_checksum_algorithm);
+        checkpoint.hash_state = m_hasher->save_state();
+    }
+    checkpoint.source_hex_digest = m_source_sha1_hex;
+    checkpoint.offset = m_num_bytes_received;
+    m_options.upload_sessions->save(*m_session_id, checkpoint, sync);
+    m_checkpoint_offset = m_num_bytes_received;
+}
+
+auto read_request(api::UploadFileRequest* request_, stream_t* stream_)
+    -> void {
+    const metrics::phase_timer timer{metrics::phase::network_read};
+    if (!stream_->Read(request_)) {
+        throw exceptions::invalid_argument("Request stream stopped prematurely."
+        );
+    }
+}
+
+auto read_request(google::protobuf::Arena& arena_, stream_t* stream_)
+    -> api::UploadFileRequest* {
+    auto* request =
+        google::protobuf::Arena::Create<api::UploadFileRequest>(&arena_);
+    read_request(request, stream_);
+    return request;
+}
+
+auto write_response(const api::UploadFileResponse& response_, stream_t* stream_)
+    -> void {
+    const metrics::phase_timer timer{metrics::phase::network_write};
+    stream_->Write(response_);
+}
+
 } // namespace upload_impl
 
 auto FileTransferServiceImpl::UploadFile(
-    ::grpc::ServerContext* /*unused*/,
+    ::grpc::ServerContext* context_,
     ::grpc::ServerReaderWriter<
         ::ansys::api::tools::filetransfer::v1::UploadFileResponse,
         ::ansys::api::tools::filetransfer::v1::UploadFileRequest>* stream_
 ) -> ::grpc::Status {
+    namespace api = upload_impl::api;
 
+    const metrics::stream_tracker tracker{metrics::direction::upload};
     return exceptions::convert_exceptions_to_status_codes(
         std::function<void()>([&]() {
             google::protobuf::Arena arena;
-
-            auto [file_path, file_size, source_sha1_hex] =
-                upload_impl::initialize(arena, stream_);
-
-            upload_impl::transfer(file_path, file_size, arena, stream_);
-
-            upload_impl::finalize(file_path, source_sha1_hex, arena, stream_);
+            if (batch_impl::is_batch(*context_)) {
+                batch_impl::upload_session batch{m_options, *context_};
+                auto& request =
+                    *google::protobuf::Arena::Create<api::UploadFileRequest>(
+                        &arena
+                    );
+                auto& response =
+                    *google::protobuf::Arena::Create<api::UploadFileResponse>(
+                        &arena
+                    );
+                while (!batch.finished()) {
+                    upload_impl::read_request(&request, stream_);
+                    if (batch.receive(request, response)) {
+                        upload_impl::write_response(response, stream_);
+                    }
+                }
+                return;
+            }
+            upload_impl::session session{m_options, *context_};
+
+            auto& response =
+                *google::protobuf::Arena::Create<api::UploadFileResponse>(
+                    &arena
+                );
+            session.initialize(
+                *upload_impl::read_request(arena, stream_), response
+            );
+            upload_impl::write_response(response, stream_);
+
+            session.start_transfer();
+            auto& request =
+                *google::protobuf::Arena::Create<api::UploadFileRequest>(&arena
+                );
+            while (!session.transfer_complete()) {
+                upload_impl::read_request(&request, stream_);
+                if (session.receive(request, response)) {
+                    upload_impl::write_response(response, stream_);
+                }
+            }
+            session.end_transfer();
+
+            session.finalize(
+                *upload_impl::read_request(arena, stream_), response
+            );
+            upload_impl::write_response(response, stream_);
         })
     );
 }
@@ -0,0 +1,258 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "checksum.h"
+#include "chunk_compression.h"
+#include "chunk_store.h"
+#include "content_chunker.h"
+#include "delta_transfer.h"
+#include "file_io.h"
+#include "filetransfer_service.h"
+#include "parallel_upload.h"
+#include "progress_throttle.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+#include "upload_session_store.h"
+#include "write_behind.h"
+
+namespace file_transfer {
+namespace upload_impl {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+
+/**
+ * @brief Check that a request belongs to the expected step of the upload.
+ * @param request_ Request to check.
+ * @param expected_step_ Step which the request is expected to belong to.
+ */
+auto check_request_step(
+    const api::UploadFileRequest& request_,
+    const api::UploadFileRequest::SubStepCase& expected_step_
+) -> void;
+
+/**
+ * @brief State of a single "UploadFile" operation.
+ *
+ * The session processes the requests of the initialize, transfer, and
+ * finalize steps, and fills in the responses to send. It does not read
+ * from or write to the stream itself, such that it can be driven both by
+ * the synchronous and the callback-based service.
+ */
+class session {
+public:
+    /**
+     * @brief Construct the session.
+     * @param options_ Options of the service which handles the upload.
+     * @param context_ Server context of the call.
+     */
+    session(
+        const ServiceOptions& options_, ::grpc::ServerContextBase& context_
+    )
+        : m_options{options_}, m_context{context_} {}
+
+    session(const session&) = delete;
+    session& operator=(const session&) = delete;
+    session(session&&) = delete;
+    session& operator=(session&&) = delete;
+
+    /**
+     * @brief Destroy the session.
+     *
+     * If a resumable upload is interrupted, its progress is checkpointed,
+     * such that the client can resume it later. Otherwise, the temporary
+     * file of an incomplete atomic upload is removed.
+     */
+    ~session();
+
+    /**
+     * @brief Process the request of the "initialize" step.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     */
+    auto initialize(
+        const api::UploadFileRequest& request_,
+        api::UploadFileResponse& response_
+    ) -> void;
+
+    /**
+     * @brief Open the output file, before the first chunk is received.
+     */
+    auto start_transfer() -> void;
+
+    /**
+     * @brief Check whether all bytes of the file have been received.
+     *
+     * For a positional upload, only the part of the file which this
+     * stream sends is checked.
+     */
+    [[nodiscard]] auto transfer_complete() const -> bool;
+
+    /**
+     * @brief Process a "send_data" request, and write its chunk to the file.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     * @return Whether the response is sent. Depending on the progress
+     *      cadence requested by the client, the progress of some chunks
+     *      is only reported with a later response.
+     */
+    auto receive(
+        const api::UploadFileRequest& request_,
+        api::UploadFileResponse& response_
+    ) -> bool;
+
+    /**
+     * @brief Check the number of received bytes, and close the output file.
+     */
+    auto end_transfer() -> void;
+
+    /**
+     * @brief Process the request of the "finalize" step.
+     * @param request_ Request to process.
+     * @param response_ Response to fill in.
+     */
+    auto finalize(
+        const api::UploadFileRequest& request_,
+        api::UploadFileResponse& response_
+    ) -> void;
+
+private:
+    auto resume_from_checkpoint() -> void;
+    auto checkpoint() -> void;
+    auto open_output(std::ios_base::openmode mode_) -> void;
+    auto flush_output() -> void;
+    auto sync_output() -> void;
+    auto close_output() -> void;
+    auto commit_output() -> void;
+    auto initialize_positional() -> void;
+    auto initialize_delta() -> void;
+    auto start_positional_transfer() -> void;
+    auto receive_sequential(
+        const api::FileChunk& file_data_, const std::string& chunk_
+    ) -> std::uint64_t;
+    auto receive_positional(
+        const api::FileChunk& file_data_, const std::string& chunk_
+    ) -> std::uint64_t;
+    auto finalize_positional(api::UploadFileResponse& response_) -> void;
+
+    const ServiceOptions& m_options;
+    ::grpc::ServerContextBase& m_context;
+    /// Marks the upload session as used by this upload, if it is
+    /// resumable. Since it is destroyed last, the session is only released
+    /// once its checkpoint is saved and the output file is closed.
+    detail::upload_session_store::lease m_session_lease;
+
+    boost::filesystem::path m_file_path;
+    /// File which the chunks are written to: a temporary sibling of
+    /// m_file_path for atomic uploads, m_file_path itself otherwise.
+    boost::filesystem::path m_write_path;
+    /// Whether the written file has been committed to m_file_path.
+    bool m_committed = false;
+    std::size_t m_file_size = 0;
+    std::string m_source_sha1_hex;
+    detail::checksum_algorithm m_checksum_algorithm =
+        detail::checksum_algorithm::sha1;
+
+    /// Buffer of the output file, which depends on the I/O backend.
+    std::unique_ptr<std::streambuf> m_out_buffer;
+    std::ostream m_out_file{nullptr};
+    /// Writes the chunks behind the receiver, if enabled in the options.
+    std::unique_ptr<detail::write_behind> m_write_behind;
+    /// Drops the written data from the page cache, if enabled in the
+    /// options.
+    std::unique_ptr<detail::drop_behind> m_drop_behind;
+    std::size_t m_num_bytes_received = 0;
+    /// Bytes received since the output file was last synchronized to disk.
+    std::uint64_t m_num_bytes_unsynced = 0;
+
+    detail::progress_cadence m_progress_cadence;
+    detail::progress_throttle m_progress_throttle;
+
+    /// Decompresses the received chunks, if the client requested it.
+    std::optional<detail::chunk_codec> m_codec;
+    /// Data of the current chunk, if the chunks are compressed.
+    std::string m_decoded_chunk;
+    /// Reconstructs the chunks from the existing file and the chunk store,
+    /// in a delta or chunked upload.
+    std::unique_ptr<detail::delta_decoder> m_delta;
+    /// Reconstructed data of the current chunk, in a delta upload.
+    std::string m_delta_chunk;
+    /// Chunks of the received data, which are only added to the chunk
+    /// store once the upload is verified.
+    std::unique_ptr<detail::chunk_store::transaction> m_staged_chunks;
+    /// Splits the received data into the chunks of the chunk store, if the
+    /// server has one.
+    std::unique_ptr<detail::content_chunker> m_chunker;
+    /// Chunks of the received data, which become the manifest of the file.
+    detail::chunk_manifest m_manifest;
+
+    /// Hasher for the checksum of the received chunks.
+    std::unique_ptr<detail::hasher> m_hasher;
+
+    /// Id of the session, if the upload is resumable.
+    std::optional<std::string> m_session_id;
+    /// Offset at which a resumed upload continues.
+    std::size_t m_resume_offset = 0;
+    /// Offset of the last checkpoint of a resumable upload.
+    std::size_t m_checkpoint_offset = 0;
+    bool m_transfer_started = false;
+
+    /// Whether the chunks are written at their offsets.
+    bool m_positional = false;
+    /// Shared state of a positional upload, which other streams may
+    /// write to as well.
+    std::shared_ptr<detail::parallel_upload> m_parallel_upload;
+    /// Part of the file which this stream of a positional upload sends.
+    metadata::byte_range m_part;
+    /// Bytes of the part which this stream has received.
+    detail::byte_coverage m_part_coverage;
+    /// Position of the output file, to avoid seeking for sequential chunks.
+    std::uint64_t m_write_position = 0;
+};
+
+} // namespace upload_impl
+} // namespace file_transfer
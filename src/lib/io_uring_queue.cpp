@@ -0,0 +1,349 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "io_uring_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef FILE_TRANSFER_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace file_transfer::detail {
+
+namespace {
+
+std::atomic<std::uint64_t> enter_call_counter{0};
+
+} // namespace
+
+auto io_uring_queue::num_enter_calls() -> std::uint64_t {
+    return enter_call_counter.load(std::memory_order_relaxed);
+}
+
+#ifdef FILE_TRANSFER_HAS_IO_URING
+
+namespace {
+
+auto load_acquire(unsigned* value_) -> unsigned {
+    return std::atomic_ref<unsigned>(*value_).load(std::memory_order_acquire);
+}
+
+auto store_release(unsigned* value_, unsigned new_value_) -> void {
+    std::atomic_ref<unsigned>(*value_).store(
+        new_value_, std::memory_order_release
+    );
+}
+
+auto map_ring(int fd_, std::size_t size_, off_t offset_) -> void* {
+    void* address = ::mmap(
+        nullptr,
+        size_,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd_,
+        offset_
+    );
+    if (address == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category());
+    }
+    return address;
+}
+
+template <typename T>
+auto at_offset(void* base_, std::uint32_t offset_) -> T* {
+    return reinterpret_cast<T*>(static_cast<char*>(base_) + offset_);
+}
+
+} // namespace
+
+io_uring_queue::io_uring_queue(unsigned depth_) : m_depth{depth_} {
+    io_uring_params params{};
+    m_ring_fd =
+        static_cast<int>(::syscall(__NR_io_uring_setup, depth_, &params));
+    if (m_ring_fd < 0) {
+        throw std::system_error(errno, std::generic_category());
+    }
+    try {
+        m_ring_size =
+            params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_completion_ring_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+            m_ring_size = std::max(m_ring_size, m_completion_ring_size);
+            m_ring = map_ring(m_ring_fd, m_ring_size, IORING_OFF_SQ_RING);
+            m_completion_ring = m_ring;
+        } else {
+            m_ring = map_ring(m_ring_fd, m_ring_size, IORING_OFF_SQ_RING);
+            m_completion_ring = map_ring(
+                m_ring_fd, m_completion_ring_size, IORING_OFF_CQ_RING
+            );
+        }
+        m_entries_size = params.sq_entries * sizeof(io_uring_sqe);
+        m_entries = map_ring(m_ring_fd, m_entries_size, IORING_OFF_SQES);
+    } catch (...) {
+        release();
+        throw;
+    }
+
+    m_sq_head = at_offset<unsigned>(m_ring, params.sq_off.head);
+    m_sq_tail = at_offset<unsigned>(m_ring, params.sq_off.tail);
+    m_sq_mask = *at_offset<unsigned>(m_ring, params.sq_off.ring_mask);
+    m_sq_array = at_offset<unsigned>(m_ring, params.sq_off.array);
+    m_cq_head = at_offset<unsigned>(m_completion_ring, params.cq_off.head);
+    m_cq_tail = at_offset<unsigned>(m_completion_ring, params.cq_off.tail);
+    m_cq_mask =
+        *at_offset<unsigned>(m_completion_ring, params.cq_off.ring_mask);
+    m_cqes = at_offset<void>(m_completion_ring, params.cq_off.cqes);
+}
+
+io_uring_queue::~io_uring_queue() {
+    // Operations still in flight would write to buffers which the owner
+    // is about to free, so they are waited for.
+    while (m_num_in_flight > 0) {
+        try {
+            static_cast<void>(wait());
+        } catch (const std::exception&) {
+            break;
+        }
+    }
+    release();
+}
+
+auto io_uring_queue::release() -> void {
+    if (m_entries != nullptr) {
+        ::munmap(m_entries, m_entries_size);
+    }
+    if (m_completion_ring != nullptr && m_completion_ring != m_ring) {
+        ::munmap(m_completion_ring, m_completion_ring_size);
+    }
+    if (m_ring != nullptr) {
+        ::munmap(m_ring, m_ring_size);
+    }
+    if (m_ring_fd >= 0) {
+        ::close(m_ring_fd);
+    }
+}
+
+auto io_uring_queue::is_supported() -> bool {
+    static const bool supported = []() {
+        try {
+            const io_uring_queue queue{1};
+            return queue.supports_operations();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }();
+    return supported;
+}
+
+auto io_uring_queue::supports_operations() const -> bool {
+    // The probe was added in Linux 5.6, together with the plain read and
+    // write operations, so older kernels are reported as unsupported.
+    constexpr unsigned num_ops = 64;
+    const auto probe_size =
+        sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op);
+    const auto storage = std::make_unique<unsigned char[]>(probe_size);
+    std::memset(storage.get(), 0, probe_size);
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.get());
+    if (::syscall(
+            __NR_io_uring_register,
+            m_ring_fd,
+            IORING_REGISTER_PROBE,
+            probe,
+            num_ops
+        ) < 0) {
+        return false;
+    }
+    for (const unsigned opcode :
+         {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC}) {
+        if (opcode > probe->last_op ||
+            (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto io_uring_queue::next_entry() -> void* {
+    if (m_num_in_flight >= m_depth) {
+        throw std::logic_error("The io_uring queue is full.");
+    }
+    // Only this thread writes the tail, so it can be read directly.
+    const auto tail = *m_sq_tail;
+    const auto index = tail & m_sq_mask;
+    auto* entry = static_cast<io_uring_sqe*>(m_entries) + index;
+    std::memset(entry, 0, sizeof(io_uring_sqe));
+    m_sq_array[index] = index;
+    store_release(m_sq_tail, tail + 1);
+    ++m_num_unsubmitted;
+    ++m_num_in_flight;
+    return entry;
+}
+
+auto io_uring_queue::prepare_read(
+    int fd_,
+    char* buffer_,
+    std::size_t size_,
+    std::uint64_t offset_,
+    std::uint64_t user_data_
+) -> void {
+    auto* entry = static_cast<io_uring_sqe*>(next_entry());
+    entry->opcode = IORING_OP_READ;
+    entry->fd = fd_;
+    entry->addr = reinterpret_cast<std::uint64_t>(buffer_);
+    entry->len = static_cast<std::uint32_t>(size_);
+    entry->off = offset_;
+    entry->user_data = user_data_;
+}
+
+auto io_uring_queue::prepare_write(
+    int fd_,
+    const char* buffer_,
+    std::size_t size_,
+    std::uint64_t offset_,
+    std::uint64_t user_data_
+) -> void {
+    auto* entry = static_cast<io_uring_sqe*>(next_entry());
+    entry->opcode = IORING_OP_WRITE;
+    entry->fd = fd_;
+    entry->addr = reinterpret_cast<std::uint64_t>(buffer_);
+    entry->len = static_cast<std::uint32_t>(size_);
+    entry->off = offset_;
+    entry->user_data = user_data_;
+}
+
+auto io_uring_queue::prepare_fsync(int fd_, std::uint64_t user_data_) -> void {
+    auto* entry = static_cast<io_uring_sqe*>(next_entry());
+    entry->opcode = IORING_OP_FSYNC;
+    entry->fd = fd_;
+    entry->user_data = user_data_;
+}
+
+auto io_uring_queue::enter(unsigned min_complete_) -> void {
+    while (true) {
+        enter_call_counter.fetch_add(1, std::memory_order_relaxed);
+        const auto result = ::syscall(
+            __NR_io_uring_enter,
+            m_ring_fd,
+            m_num_unsubmitted,
+            min_complete_,
+            min_complete_ > 0 ? IORING_ENTER_GETEVENTS : 0U,
+            nullptr,
+            0
+        );
+        if (result >= 0) {
+            m_num_unsubmitted -= static_cast<unsigned>(result);
+            return;
+        }
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category());
+        }
+    }
+}
+
+auto io_uring_queue::submit() -> void {
+    if (m_num_unsubmitted > 0) {
+        enter(0);
+    }
+}
+
+auto io_uring_queue::wait() -> io_completion {
+    if (m_num_in_flight == 0) {
+        throw std::logic_error("No io_uring operation is in flight.");
+    }
+    const auto head = *m_cq_head;
+    while (head == load_acquire(m_cq_tail)) {
+        enter(1);
+    }
+    const auto* entry =
+        static_cast<const io_uring_cqe*>(m_cqes) + (head & m_cq_mask);
+    const io_completion completion{entry->user_data, entry->res};
+    store_release(m_cq_head, head + 1);
+    --m_num_in_flight;
+    return completion;
+}
+
+#else
+
+io_uring_queue::io_uring_queue(unsigned depth_) : m_depth{depth_} {
+    throw std::system_error(ENOSYS, std::generic_category());
+}
+
+io_uring_queue::~io_uring_queue() = default;
+
+auto io_uring_queue::release() -> void {}
+
+auto io_uring_queue::is_supported() -> bool { return false; }
+
+auto io_uring_queue::supports_operations() const -> bool { return false; }
+
+auto io_uring_queue::next_entry() -> void* {
+    throw std::logic_error("io_uring is not available.");
+}
+
+auto io_uring_queue::prepare_read(
+    int /* fd_ */,
+    char* /* buffer_ */,
+    std::size_t /* size_ */,
+    std::uint64_t /* offset_ */,
+    std::uint64_t /* user_data_ */
+) -> void {
+    next_entry();
+}
+
+auto io_uring_queue::prepare_write(
+    int /* fd_ */,
+    const char* /* buffer_ */,
+    std::size_t /* size_ */,
+    std::uint64_t /* offset_ */,
+    std::uint64_t /* user_data_ */
+) -> void {
+    next_entry();
+}
+
+auto io_uring_queue::prepare_fsync(
+    int /* fd_ */, std::uint64_t /* user_data_ */
+) -> void {
+    next_entry();
+}
+
+auto io_uring_queue::enter(unsigned /* min_complete_ */) -> void {}
+
+auto io_uring_queue::submit() -> void {}
+
+auto io_uring_queue::wait() -> io_completion {
+    throw std::logic_error("io_uring is not available.");
+}
+
+#endif
+
+} // namespace file_transfer::detail
@@ -0,0 +1,181 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FILE_TRANSFER_HAS_IO_URING 1
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Result of an operation submitted to an io_uring_queue.
+ */
+struct io_completion {
+    /// Value passed when the operation was prepared.
+    std::uint64_t user_data = 0;
+    /// Number of bytes transferred, or the negated errno on failure.
+    std::int32_t result = 0;
+};
+
+/**
+ * @brief Submission and completion queues of a Linux io_uring instance.
+ *
+ * Operations are prepared without a system call, and all prepared
+ * operations are submitted by a single io_uring_enter call. This allows
+ * keeping several reads or writes in flight for one file.
+ *
+ * The queue uses the system calls directly, since liburing is not
+ * required to build the server. It is not thread-safe.
+ */
+class io_uring_queue {
+public:
+    /**
+     * @brief Set up the queue.
+     * @param depth_ Maximum number of operations in flight.
+     * @throws std::system_error If the kernel does not support io_uring.
+     */
+    explicit io_uring_queue(unsigned depth_);
+
+    io_uring_queue(const io_uring_queue&) = delete;
+    io_uring_queue& operator=(const io_uring_queue&) = delete;
+    io_uring_queue(io_uring_queue&&) = delete;
+    io_uring_queue& operator=(io_uring_queue&&) = delete;
+    ~io_uring_queue();
+
+    /**
+     * @brief Whether the kernel supports the operations used by the queue.
+     *
+     * The kernel is probed once. io_uring may be missing, disabled, or
+     * blocked by a seccomp profile, in which case other backends must be
+     * used.
+     */
+    static auto is_supported() -> bool;
+
+    /**
+     * @brief Total number of io_uring_enter calls made by all queues.
+     */
+    static auto num_enter_calls() -> std::uint64_t;
+
+    /**
+     * @brief Maximum number of operations in flight.
+     */
+    [[nodiscard]] auto depth() const -> unsigned { return m_depth; }
+
+    /**
+     * @brief Number of prepared operations which have not been submitted.
+     */
+    [[nodiscard]] auto num_unsubmitted() const -> unsigned {
+        return m_num_unsubmitted;
+    }
+
+    /**
+     * @brief Number of prepared operations which have not completed yet.
+     */
+    [[nodiscard]] auto num_in_flight() const -> unsigned {
+        return m_num_in_flight;
+    }
+
+    /**
+     * @brief Prepare a read of the file at the given offset.
+     * @throws std::logic_error If the queue is full.
+     */
+    auto prepare_read(
+        int fd_,
+        char* buffer_,
+        std::size_t size_,
+        std::uint64_t offset_,
+        std::uint64_t user_data_
+    ) -> void;
+
+    /**
+     * @brief Prepare a write to the file at the given offset.
+     * @throws std::logic_error If the queue is full.
+     */
+    auto prepare_write(
+        int fd_,
+        const char* buffer_,
+        std::size_t size_,
+        std::uint64_t offset_,
+        std::uint64_t user_data_
+    ) -> void;
+
+    /**
+     * @brief Prepare an fsync of the file.
+     *
+     * The fsync is not ordered with respect to other operations in
+     * flight, so the writes must have completed before it is prepared.
+     *
+     * @throws std::logic_error If the queue is full.
+     */
+    auto prepare_fsync(int fd_, std::uint64_t user_data_) -> void;
+
+    /**
+     * @brief Submit all prepared operations, without waiting for them.
+     */
+    auto submit() -> void;
+
+    /**
+     * @brief Wait for the next completed operation.
+     *
+     * Prepared operations are submitted by the same system call.
+     *
+     * @throws std::logic_error If no operation is in flight.
+     */
+    auto wait() -> io_completion;
+
+private:
+    [[nodiscard]] auto supports_operations() const -> bool;
+    auto release() -> void;
+    auto next_entry() -> void*;
+    auto enter(unsigned min_complete_) -> void;
+
+    unsigned m_depth;
+    int m_ring_fd = -1;
+
+    void* m_ring = nullptr;
+    std::size_t m_ring_size = 0;
+    void* m_completion_ring = nullptr;
+    std::size_t m_completion_ring_size = 0;
+    void* m_entries = nullptr;
+    std::size_t m_entries_size = 0;
+
+    unsigned* m_sq_head = nullptr;
+    unsigned* m_sq_tail = nullptr;
+    unsigned m_sq_mask = 0;
+    unsigned* m_sq_array = nullptr;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned m_cq_mask = 0;
+    void* m_cqes = nullptr;
+
+    unsigned m_num_unsubmitted = 0;
+    unsigned m_num_in_flight = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
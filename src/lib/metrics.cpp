@@ -0,0 +1,427 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "metrics.h"
+
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace file_transfer::metrics {
+
+namespace {
+
+// Layout of the counters of a shard.
+constexpr std::size_t bytes_offset = 0;
+constexpr std::size_t streams_started_offset = bytes_offset + num_directions;
+constexpr std::size_t streams_finished_offset =
+    streams_started_offset + num_directions;
+constexpr std::size_t errors_offset = streams_finished_offset + num_directions;
+constexpr std::size_t num_counters = errors_offset + num_status_codes;
+
+// A histogram holds its buckets, followed by the sum of the durations.
+constexpr std::size_t histogram_sum_offset = num_buckets;
+constexpr std::size_t histogram_size = num_buckets + 1;
+
+constexpr std::array<const char*, num_status_codes> status_code_names{
+    "OK",
+    "CANCELLED",
+    "UNKNOWN",
+    "INVALID_ARGUMENT",
+    "DEADLINE_EXCEEDED",
+    "NOT_FOUND",
+    "ALREADY_EXISTS",
+    "PERMISSION_DENIED",
+    "RESOURCE_EXHAUSTED",
+    "FAILED_PRECONDITION",
+    "ABORTED",
+    "OUT_OF_RANGE",
+    "UNIMPLEMENTED",
+    "INTERNAL",
+    "UNAVAILABLE",
+    "DATA_LOSS",
+    "UNAUTHENTICATED"
+};
+
+using value_t = std::atomic<std::uint64_t>;
+
+/**
+ * @brief Metrics recorded by one thread.
+ *
+ * Only the owning thread writes to a shard, so its values are updated
+ * with plain loads and stores instead of atomic increments. They are
+ * atomic only such that collect can read them concurrently.
+ */
+struct shard {
+    std::array<value_t, num_counters> counters{};
+    std::array<std::array<value_t, histogram_size>, num_phases> histograms{};
+};
+
+auto increment(value_t& value_, std::uint64_t amount_) noexcept -> void {
+    value_.store(
+        value_.load(std::memory_order_relaxed) + amount_,
+        std::memory_order_relaxed
+    );
+}
+
+auto add_to(const shard& shard_, snapshot& snapshot_) -> void {
+    const auto get = [&](std::size_t index_) {
+        return shard_.counters[index_].load(std::memory_order_relaxed);
+    };
+    for (std::size_t i = 0; i < num_directions; ++i) {
+        snapshot_.bytes[i] += get(bytes_offset + i);
+        snapshot_.streams_started[i] += get(streams_started_offset + i);
+        snapshot_.streams_finished[i] += get(streams_finished_offset + i);
+    }
+    for (std::size_t i = 0; i < num_status_codes; ++i) {
+        snapshot_.errors[i] += get(errors_offset + i);
+    }
+    for (std::size_t i = 0; i < num_phases; ++i) {
+        const auto& histogram = shard_.histograms[i];
+        auto& result = snapshot_.phases[i];
+        for (std::size_t j = 0; j < num_buckets; ++j) {
+            result.buckets[j] += histogram[j].load(std::memory_order_relaxed);
+        }
+        result.sum +=
+            histogram[histogram_sum_offset].load(std::memory_order_relaxed);
+    }
+}
+
+auto fold_into(const shard& source_, shard& target_) -> void {
+    for (std::size_t i = 0; i < num_counters; ++i) {
+        increment(
+            target_.counters[i],
+            source_.counters[i].load(std::memory_order_relaxed)
+        );
+    }
+    for (std::size_t i = 0; i < num_phases; ++i) {
+        for (std::size_t j = 0; j < histogram_size; ++j) {
+            increment(
+                target_.histograms[i][j],
+                source_.histograms[i][j].load(std::memory_order_relaxed)
+            );
+        }
+    }
+}
+
+/**
+ * @brief Shards of the running threads, and the totals of the exited ones.
+ */
+class registry {
+public:
+    auto add(const shard* shard_) -> void {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_shards.push_back(shard_);
+    }
+
+    auto retire(const shard* shard_) -> void {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        fold_into(*shard_, m_retired);
+        std::erase(m_shards, shard_);
+    }
+
+    auto collect() -> snapshot {
+        snapshot result;
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        add_to(m_retired, result);
+        for (const auto* shard : m_shards) {
+            add_to(*shard, result);
+        }
+        return result;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<const shard*> m_shards;
+    shard m_retired;
+};
+
+auto get_registry() -> registry& {
+    // Never destroyed, such that threads which exit after main can still
+    // retire their shards.
+    static auto* const instance = new registry;
+    return *instance;
+}
+
+/**
+ * @brief Registers the shard of a thread for its lifetime.
+ */
+struct thread_shard {
+    thread_shard() { get_registry().add(&value); }
+    ~thread_shard() { get_registry().retire(&value); }
+
+    thread_shard(const thread_shard&) = delete;
+    auto operator=(const thread_shard&) -> thread_shard& = delete;
+    thread_shard(thread_shard&&) = delete;
+    auto operator=(thread_shard&&) -> thread_shard& = delete;
+
+    shard value;
+};
+
+/**
+ * @brief Get the shard of the calling thread.
+ * @return The shard, or nullptr if it could not be registered, in which
+ *      case nothing is recorded. The recording functions must not throw,
+ *      since they are called in destructors and by the reactors.
+ */
+auto local_shard() noexcept -> shard* {
+    try {
+        thread_local thread_shard instance;
+        return &instance.value;
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+auto to_index(direction direction_) -> std::size_t {
+    return static_cast<std::size_t>(direction_);
+}
+
+auto format_seconds(std::uint64_t nanoseconds_) -> std::string {
+    std::ostringstream stream;
+    stream << std::setprecision(9)
+           << static_cast<double>(nanoseconds_) / 1e9;
+    return stream.str();
+}
+
+} // namespace
+
+auto to_string(direction direction_) -> std::string {
+    switch (direction_) {
+    case direction::upload:
+        return "upload";
+    case direction::download:
+        return "download";
+    }
+    return "unknown";
+}
+
+auto to_string(phase phase_) -> std::string {
+    switch (phase_) {
+    case phase::hashing:
+        return "hashing";
+    case phase::disk_read:
+        return "disk_read";
+    case phase::disk_write:
+        return "disk_write";
+    case phase::compression:
+        return "compression";
+    case phase::network_read:
+        return "network_read";
+    case phase::network_write:
+        return "network_write";
+    }
+    return "unknown";
+}
+
+auto bucket_index(std::uint64_t nanoseconds_) -> std::size_t {
+    std::size_t index = 0;
+    while (index + 1 < num_buckets &&
+           nanoseconds_ > bucket_upper_bound(index)) {
+        ++index;
+    }
+    return index;
+}
+
+auto bucket_upper_bound(std::size_t index_) -> std::uint64_t {
+    return std::uint64_t{1} << (10 + 2 * index_);
+}
+
+auto histogram_snapshot::count() const -> std::uint64_t {
+    std::uint64_t result = 0;
+    for (const auto bucket : buckets) {
+        result += bucket;
+    }
+    return result;
+}
+
+auto enable() -> void {
+    detail::enabled_flag.store(true, std::memory_order_relaxed);
+}
+
+auto add_bytes(direction direction_, std::uint64_t num_bytes_) noexcept
+    -> void {
+    if (!enabled()) {
+        return;
+    }
+    if (auto* const values = local_shard()) {
+        increment(
+            values->counters[bytes_offset + to_index(direction_)], num_bytes_
+        );
+    }
+}
+
+auto count_error(::grpc::StatusCode code_) noexcept -> void {
+    const auto index = static_cast<std::size_t>(code_);
+    if (!enabled() || index >= num_status_codes) {
+        return;
+    }
+    if (auto* const values = local_shard()) {
+        increment(values->counters[errors_offset + index], 1);
+    }
+}
+
+auto record(phase phase_, std::chrono::nanoseconds duration_) noexcept
+    -> void {
+    if (!enabled()) {
+        return;
+    }
+    auto* const values = local_shard();
+    if (!values) {
+        return;
+    }
+    const auto nanoseconds = duration_.count() > 0
+                                 ? static_cast<std::uint64_t>(duration_.count())
+                                 : std::uint64_t{0};
+    auto& histogram = values->histograms[static_cast<std::size_t>(phase_)];
+    increment(histogram[bucket_index(nanoseconds)], 1);
+    increment(histogram[histogram_sum_offset], nanoseconds);
+}
+
+auto collect() -> snapshot { return get_registry().collect(); }
+
+auto to_prometheus_text(const snapshot& snapshot_) -> std::string {
+    std::ostringstream out;
+    const auto header = [&](const char* name_, const char* type_,
+                            const char* help_) {
+        out << "# HELP " << name_ << ' ' << help_ << '\n'
+            << "# TYPE " << name_ << ' ' << type_ << '\n';
+    };
+    const auto per_direction = [&](const char* name_, const auto& values_) {
+        for (const auto direction_value :
+             {direction::upload, direction::download}) {
+            out << name_ << "{direction=\"" << to_string(direction_value)
+                << "\"} " << values_[to_index(direction_value)] << '\n';
+        }
+    };
+
+    header(
+        "file_transfer_bytes_total",
+        "counter",
+        "File bytes transferred, before compression."
+    );
+    per_direction("file_transfer_bytes_total", snapshot_.bytes);
+    header(
+        "file_transfer_streams_total", "counter", "Transfer calls started."
+    );
+    per_direction("file_transfer_streams_total", snapshot_.streams_started);
+    header(
+        "file_transfer_active_streams", "gauge", "Transfer calls in progress."
+    );
+    std::array<std::int64_t, num_directions> active_streams{};
+    for (std::size_t i = 0; i < num_directions; ++i) {
+        active_streams[i] = static_cast<std::int64_t>(
+            snapshot_.streams_started[i] - snapshot_.streams_finished[i]
+        );
+    }
+    per_direction("file_transfer_active_streams", active_streams);
+    header(
+        "file_transfer_errors_total",
+        "counter",
+        "Errors which ended a call or a file of a batch, by status code."
+    );
+    for (std::size_t i = 1; i < num_status_codes; ++i) {
+        out << "file_transfer_errors_total{code=\"" << status_code_names[i]
+            << "\"} " << snapshot_.errors[i] << '\n';
+    }
+    header(
+        "file_transfer_phase_seconds",
+        "histogram",
+        "Time spent in each phase of the transfers."
+    );
+    for (std::size_t i = 0; i < num_phases; ++i) {
+        const auto& histogram = snapshot_.phases[i];
+        const auto label =
+            "phase=\"" + to_string(static_cast<phase>(i)) + "\"";
+        std::uint64_t cumulative = 0;
+        for (std::size_t j = 0; j < num_buckets; ++j) {
+            cumulative += histogram.buckets[j];
+            out << "file_transfer_phase_seconds_bucket{" << label << ",le=\""
+                << (j + 1 < num_buckets
+                        ? format_seconds(bucket_upper_bound(j))
+                        : "+Inf")
+                << "\"} " << cumulative << '\n';
+        }
+        out << "file_transfer_phase_seconds_sum{" << label << "} "
+            << format_seconds(histogram.sum) << '\n'
+            << "file_transfer_phase_seconds_count{" << label << "} "
+            << cumulative << '\n';
+    }
+    return out.str();
+}
+
+stream_tracker::stream_tracker(direction direction_) noexcept
+    : m_direction{direction_}, m_counted{false} {
+    if (!enabled()) {
+        return;
+    }
+    // The call is only counted as finished if it was counted as started.
+    if (auto* const values = local_shard()) {
+        const auto index = streams_started_offset + to_index(direction_);
+        increment(values->counters[index], 1);
+        m_counted = true;
+    }
+}
+
+stream_tracker::~stream_tracker() {
+    // A call of the callback engine may end on another thread than the one
+    // which started it, so the gauge is the difference of two counters.
+    if (!m_counted) {
+        return;
+    }
+    if (auto* const values = local_shard()) {
+        const auto index = streams_finished_offset + to_index(m_direction);
+        increment(values->counters[index], 1);
+    }
+}
+
+phase_timer::phase_timer(phase phase_) noexcept
+    : m_phase{phase_}, m_running{enabled()} {
+    if (m_running) {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+phase_timer::~phase_timer() {
+    if (m_running) {
+        record(m_phase, std::chrono::steady_clock::now() - m_start);
+    }
+}
+
+auto async_timer::start(phase phase_) noexcept -> void {
+    m_running = enabled();
+    if (m_running) {
+        m_phase = phase_;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+auto async_timer::stop() noexcept -> void {
+    if (m_running) {
+        record(m_phase, std::chrono::steady_clock::now() - m_start);
+        m_running = false;
+    }
+}
+
+} // namespace file_transfer::metrics
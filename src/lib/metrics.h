@@ -0,0 +1,252 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <grpcpp/support/status.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace metrics {
+
+/**
+ * @brief Direction of a transfer, as seen from the client.
+ */
+enum class direction { upload, download };
+
+/**
+ * @brief Phase of a transfer, whose time is recorded in a histogram.
+ */
+enum class phase {
+    /// Updating a checksum.
+    hashing,
+    /// Reading file data, including the wait for read-ahead chunks.
+    disk_read,
+    /// Writing file data, including the wait for write-behind blocks.
+    disk_write,
+    /// Compressing or decompressing chunks.
+    compression,
+    /// Waiting for a request of the client.
+    network_read,
+    /// Waiting until the stream accepted a response.
+    network_write
+};
+
+inline constexpr std::size_t num_directions = 2;
+inline constexpr std::size_t num_phases = 6;
+inline constexpr std::size_t num_status_codes = 17;
+
+/**
+ * @brief Number of buckets of a phase histogram.
+ *
+ * The upper bound of bucket i is 4^i microseconds, more precisely
+ * 2^(10 + 2i) nanoseconds, up to about 17 seconds. The last bucket has no
+ * upper bound.
+ */
+inline constexpr std::size_t num_buckets = 14;
+
+auto to_string(direction direction_) -> std::string;
+auto to_string(phase phase_) -> std::string;
+
+/**
+ * @brief Get the bucket of a duration.
+ * @param nanoseconds_ Duration in nanoseconds.
+ */
+auto bucket_index(std::uint64_t nanoseconds_) -> std::size_t;
+
+/**
+ * @brief Get the upper bound of a bucket which is not the last one.
+ * @param index_ Index of the bucket.
+ * @return Upper bound in nanoseconds, inclusive.
+ */
+auto bucket_upper_bound(std::size_t index_) -> std::uint64_t;
+
+/**
+ * @brief Recorded durations of one phase.
+ */
+struct histogram_snapshot {
+    /// Number of durations per bucket, not cumulative.
+    std::array<std::uint64_t, num_buckets> buckets{};
+    /// Sum of the durations in nanoseconds.
+    std::uint64_t sum = 0;
+
+    [[nodiscard]] auto count() const -> std::uint64_t;
+};
+
+/**
+ * @brief Totals of the metrics of all threads.
+ */
+struct snapshot {
+    /// File bytes transferred, by direction.
+    std::array<std::uint64_t, num_directions> bytes{};
+    /// Transfer calls started, by direction.
+    std::array<std::uint64_t, num_directions> streams_started{};
+    /// Transfer calls ended, by direction.
+    std::array<std::uint64_t, num_directions> streams_finished{};
+    /// Errors, by gRPC status code.
+    std::array<std::uint64_t, num_status_codes> errors{};
+    /// Durations, by phase.
+    std::array<histogram_snapshot, num_phases> phases{};
+};
+
+namespace detail {
+inline std::atomic<bool> enabled_flag{false};
+} // namespace detail
+
+/**
+ * @brief Start recording metrics. Until then, recording is a no-op, and
+ *      the durations of the phases are not measured.
+ */
+auto enable() -> void;
+
+/**
+ * @brief Whether metrics are recorded.
+ */
+inline auto enabled() noexcept -> bool {
+    return detail::enabled_flag.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Record transferred file bytes.
+ *
+ * Like all recording functions, this only updates a shard of the calling
+ * thread, without atomic read-modify-write operations, and is safe to
+ * call in the chunk loops. If the shard can not be allocated, nothing is
+ * recorded.
+ * @param direction_ Direction of the transfer.
+ * @param num_bytes_ Number of bytes, before compression.
+ */
+auto add_bytes(direction direction_, std::uint64_t num_bytes_) noexcept
+    -> void;
+
+/**
+ * @brief Record an error which ends a call, or a file of a batch.
+ * @param code_ Status code of the error.
+ */
+auto count_error(::grpc::StatusCode code_) noexcept -> void;
+
+/**
+ * @brief Record the duration of a phase.
+ * @param phase_ The phase.
+ * @param duration_ Its duration.
+ */
+auto record(phase phase_, std::chrono::nanoseconds duration_) noexcept
+    -> void;
+
+/**
+ * @brief Sum the metrics of all threads, including those which have
+ *      exited.
+ *
+ * The counters of other threads are read while they are updated, so the
+ * totals may miss the latest updates.
+ */
+auto collect() -> snapshot;
+
+/**
+ * @brief Format metrics in the Prometheus text exposition format.
+ * @param snapshot_ The metrics.
+ */
+auto to_prometheus_text(const snapshot& snapshot_) -> std::string;
+
+/**
+ * @brief Counts a transfer call as active while it exists.
+ */
+class stream_tracker {
+public:
+    explicit stream_tracker(direction direction_) noexcept;
+    ~stream_tracker();
+
+    stream_tracker(const stream_tracker&) = delete;
+    auto operator=(const stream_tracker&) -> stream_tracker& = delete;
+    stream_tracker(stream_tracker&&) = delete;
+    auto operator=(stream_tracker&&) -> stream_tracker& = delete;
+
+private:
+    direction m_direction;
+    bool m_counted;
+};
+
+/**
+ * @brief Records the time between its construction and destruction as a
+ *      phase.
+ */
+class phase_timer {
+public:
+    explicit phase_timer(phase phase_) noexcept;
+    ~phase_timer();
+
+    phase_timer(const phase_timer&) = delete;
+    auto operator=(const phase_timer&) -> phase_timer& = delete;
+    phase_timer(phase_timer&&) = delete;
+    auto operator=(phase_timer&&) -> phase_timer& = delete;
+
+private:
+    phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_running;
+};
+
+/**
+ * @brief Records the time of asynchronous operations, which end in a
+ *      different callback than the one which starts them. At most one
+ *      operation is timed at a time.
+ */
+class async_timer {
+public:
+    /**
+     * @brief Start timing an operation.
+     * @param phase_ Phase of the operation.
+     */
+    auto start(phase phase_) noexcept -> void;
+
+    /**
+     * @brief Record the time of the started operation, if any.
+     */
+    auto stop() noexcept -> void;
+
+private:
+    phase m_phase = phase::network_read;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_running = false;
+};
+
+} // namespace metrics
+} // namespace file_transfer
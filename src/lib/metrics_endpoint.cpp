@@ -0,0 +1,211 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "metrics_endpoint.h"
+
+#include <chrono>
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "metrics.h"
+
+namespace file_transfer::metrics {
+
+namespace {
+
+using boost::asio::ip::tcp;
+
+/// Scrapers send short requests, so anything longer is rejected.
+constexpr std::size_t max_request_size = std::size_t{1} << 14;
+/// Time after which a connection is closed, whether it was answered or
+/// not, such that idle clients do not hold it open.
+constexpr auto connection_timeout = std::chrono::seconds{5};
+/// Maximum number of connections which are open at a time. Further
+/// connections are closed right away.
+constexpr std::size_t max_connections = 16;
+
+auto make_response(const std::string& status_, const std::string& body_)
+    -> std::string {
+    return "HTTP/1.1 " + status_ +
+           "\r\n"
+           "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+           "Content-Length: " +
+           std::to_string(body_.size()) +
+           "\r\n"
+           "Connection: close\r\n\r\n" +
+           body_;
+}
+
+/**
+ * @brief Answers a single request, then closes the connection.
+ */
+class connection : public std::enable_shared_from_this<connection> {
+public:
+    /**
+     * @brief Construct the connection.
+     * @param socket_ Socket of the accepted connection.
+     * @param num_connections_ Number of open connections, which includes
+     *      this one until it is destroyed.
+     */
+    connection(tcp::socket socket_, std::size_t& num_connections_)
+        : m_socket{std::move(socket_)},
+          m_timer{m_socket.get_executor()},
+          m_request{max_request_size},
+          m_num_connections{num_connections_} {
+        ++m_num_connections;
+    }
+
+    connection(const connection&) = delete;
+    auto operator=(const connection&) -> connection& = delete;
+    connection(connection&&) = delete;
+    auto operator=(connection&&) -> connection& = delete;
+
+    ~connection() { --m_num_connections; }
+
+    auto start() -> void {
+        m_timer.expires_after(connection_timeout);
+        m_timer.async_wait([self = shared_from_this()](
+                               const boost::system::error_code& error_
+                           ) {
+            if (!error_) {
+                // Closing the socket aborts the pending read or write.
+                boost::system::error_code ignored;
+                self->m_socket.close(ignored);
+            }
+        });
+        boost::asio::async_read_until(
+            m_socket,
+            m_request,
+            "\r\n\r\n",
+            [self = shared_from_this()](
+                const boost::system::error_code& error_, std::size_t /*unused*/
+            ) {
+                if (error_) {
+                    self->m_timer.cancel();
+                    return;
+                }
+                self->respond();
+            }
+        );
+    }
+
+private:
+    auto respond() -> void {
+        std::istream request{&m_request};
+        std::string method;
+        std::string target;
+        request >> method >> target;
+        target = target.substr(0, target.find('?'));
+        if (method != "GET") {
+            m_response = make_response("405 Method Not Allowed", "");
+        } else if (target == "/metrics" || target == "/") {
+            m_response =
+                make_response("200 OK", to_prometheus_text(collect()));
+        } else {
+            m_response = make_response("404 Not Found", "");
+        }
+        boost::asio::async_write(
+            m_socket,
+            boost::asio::buffer(m_response),
+            [self = shared_from_this()](
+                const boost::system::error_code& /*unused*/,
+                std::size_t /*unused*/
+            ) {
+                boost::system::error_code ignored;
+                self->m_socket.shutdown(tcp::socket::shutdown_both, ignored);
+                self->m_timer.cancel();
+            }
+        );
+    }
+
+    tcp::socket m_socket;
+    boost::asio::steady_timer m_timer;
+    boost::asio::streambuf m_request;
+    std::string m_response;
+    std::size_t& m_num_connections;
+};
+
+} // namespace
+
+http_endpoint::http_endpoint(const std::string& address_, std::uint16_t port_)
+    : m_acceptor{
+          m_io_context,
+          tcp::endpoint{boost::asio::ip::make_address(address_), port_}
+      } {
+    accept();
+    m_thread = std::thread{[this]() { m_io_context.run(); }};
+    BOOST_LOG_TRIVIAL(info) << "Serving metrics on http://" << address_
+                            << ':' << port() << "/metrics";
+}
+
+http_endpoint::~http_endpoint() {
+    m_io_context.stop();
+    m_thread.join();
+}
+
+auto http_endpoint::port() const -> std::uint16_t {
+    return m_acceptor.local_endpoint().port();
+}
+
+auto http_endpoint::accept() -> void {
+    m_acceptor.async_accept(
+        [this](const boost::system::error_code& error_, tcp::socket socket_) {
+            if (error_ == boost::asio::error::operation_aborted) {
+                return;
+            }
+            if (!error_ && m_num_connections < max_connections) {
+                std::make_shared<connection>(
+                    std::move(socket_), m_num_connections
+                )
+                    ->start();
+            } else if (!error_) {
+                BOOST_LOG_TRIVIAL(debug)
+                    << "Closing a metrics connection, since "
+                    << m_num_connections << " connections are open.";
+            }
+            accept();
+        }
+    );
+}
+
+} // namespace file_transfer::metrics
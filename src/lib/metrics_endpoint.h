@@ -0,0 +1,92 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace metrics {
+
+/**
+ * @brief HTTP endpoint which serves the metrics to Prometheus.
+ *
+ * "GET /metrics" returns the metrics in the text exposition format. The
+ * endpoint runs on its own thread, such that scrapes do not compete with
+ * the transfers for the threads of the service. Connections are closed
+ * after a few seconds, and only a limited number is open at a time.
+ */
+class http_endpoint {
+public:
+    /**
+     * @brief Start serving the metrics.
+     * @param address_ IP address on which the endpoint listens.
+     * @param port_ Port on which the endpoint listens, or 0 to pick a free
+     *      port.
+     * @throws boost::system::system_error if the address can not be bound.
+     */
+    http_endpoint(const std::string& address_, std::uint16_t port_);
+    ~http_endpoint();
+
+    http_endpoint(const http_endpoint&) = delete;
+    auto operator=(const http_endpoint&) -> http_endpoint& = delete;
+    http_endpoint(http_endpoint&&) = delete;
+    auto operator=(http_endpoint&&) -> http_endpoint& = delete;
+
+    /**
+     * @brief Get the port on which the endpoint listens.
+     */
+    [[nodiscard]] auto port() const -> std::uint16_t;
+
+private:
+    auto accept() -> void;
+
+    /// Number of open connections. It is only accessed by the thread of
+    /// the endpoint, and outlives the connections, which the io_context
+    /// may destroy.
+    std::size_t m_num_connections = 0;
+    boost::asio::io_context m_io_context;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    std::thread m_thread;
+};
+
+} // namespace metrics
+} // namespace file_transfer
@@ -0,0 +1,159 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "page_cache.h"
+
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace file_transfer::detail {
+
+auto page_cache_mode_from_string(const std::string& name_) -> page_cache_mode {
+    if (name_ == "keep") {
+        return page_cache_mode::keep;
+    }
+    if (name_ == "drop-behind") {
+        return page_cache_mode::drop_behind;
+    }
+    if (name_ == "direct") {
+        return page_cache_mode::direct;
+    }
+    throw std::invalid_argument("Unknown page cache mode '" + name_ + "'.");
+}
+
+#ifdef __linux__
+
+auto preallocate_file(const boost::filesystem::path& path_, std::uint64_t size_)
+    -> bool {
+    if (size_ == 0) {
+        return false;
+    }
+    const auto fd = ::open(path_.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // Unlike posix_fallocate, this does not extend the file, such that
+    // its size still shows how much data was written.
+    const auto result = ::fallocate(
+        fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size_)
+    );
+    ::close(fd);
+    return result == 0;
+}
+
+drop_behind::drop_behind(
+    const boost::filesystem::path& path_,
+    std::uint64_t offset_,
+    std::uint64_t window_size_
+)
+    : m_fd{::open(path_.c_str(), O_RDONLY | O_CLOEXEC)},
+      m_window_size{window_size_},
+      m_written{offset_},
+      m_dropped{offset_} {}
+
+drop_behind::~drop_behind() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+auto drop_behind::on_flushed(std::uint64_t offset_) -> void {
+    if (m_fd < 0 || offset_ <= m_written) {
+        return;
+    }
+    // Only start writing back the new data, the writer does not wait
+    // for it.
+    static_cast<void>(::sync_file_range(
+        m_fd,
+        static_cast<off_t>(m_written),
+        static_cast<off_t>(offset_ - m_written),
+        SYNC_FILE_RANGE_WRITE
+    ));
+    drop(m_dropped, m_written);
+    m_dropped = m_written;
+    m_written = offset_;
+}
+
+auto drop_behind::finish() -> void {
+    if (m_fd < 0) {
+        return;
+    }
+    drop(m_dropped, m_written);
+    m_dropped = m_written;
+}
+
+auto drop_behind::drop(std::uint64_t begin_, std::uint64_t end_) -> void {
+    if (end_ <= begin_) {
+        return;
+    }
+    // Dirty pages are not dropped, so the write-back must be complete.
+    // Errors only mean that the pages stay in the cache.
+    static_cast<void>(::sync_file_range(
+        m_fd,
+        static_cast<off_t>(begin_),
+        static_cast<off_t>(end_ - begin_),
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+            SYNC_FILE_RANGE_WAIT_AFTER
+    ));
+    static_cast<void>(::posix_fadvise(
+        m_fd,
+        static_cast<off_t>(begin_),
+        static_cast<off_t>(end_ - begin_),
+        POSIX_FADV_DONTNEED
+    ));
+}
+
+#else
+
+auto preallocate_file(
+    const boost::filesystem::path& /* path_ */, std::uint64_t /* size_ */
+) -> bool {
+    return false;
+}
+
+drop_behind::drop_behind(
+    const boost::filesystem::path& /* path_ */,
+    std::uint64_t offset_,
+    std::uint64_t window_size_
+)
+    : m_window_size{window_size_}, m_written{offset_}, m_dropped{offset_} {}
+
+drop_behind::~drop_behind() = default;
+
+auto drop_behind::on_flushed(std::uint64_t offset_) -> void {
+    if (offset_ > m_written) {
+        m_written = offset_;
+    }
+}
+
+auto drop_behind::finish() -> void { m_dropped = m_written; }
+
+auto drop_behind::drop(std::uint64_t /* begin_ */, std::uint64_t /* end_ */)
+    -> void {}
+
+#endif
+
+} // namespace file_transfer::detail
@@ -0,0 +1,145 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief How uploaded files use the page cache.
+ */
+enum class page_cache_mode {
+    /// Written pages stay in the page cache until the kernel evicts them.
+    keep,
+    /// Written pages are dropped from the page cache once they are on
+    /// disk, such that large uploads do not evict the files which are
+    /// being downloaded. Only affects sequential uploads on Linux.
+    drop_behind,
+    /// The data is written with O_DIRECT from aligned buffers, bypassing
+    /// the page cache. Falls back to `keep` if the file system does not
+    /// support it.
+    direct,
+};
+
+/**
+ * @brief Get the page cache mode from its name.
+ * @param name_ Name of the mode, as shown on the command line.
+ * @return The page cache mode.
+ */
+auto page_cache_mode_from_string(const std::string& name_) -> page_cache_mode;
+
+/**
+ * @brief Allocate the disk space of a file before it is written.
+ *
+ * The space is allocated in as few extents as possible, without changing
+ * the size of the file. This is a hint: if the file system does not
+ * support it, or the platform is not Linux, nothing is done.
+ *
+ * @param path_ Path of the file, which must exist.
+ * @param size_ Size to allocate, from the start of the file.
+ * @return Whether the space was allocated.
+ */
+auto preallocate_file(const boost::filesystem::path& path_, std::uint64_t size_)
+    -> bool;
+
+/**
+ * @brief Drops the pages of a sequentially written file from the page
+ *      cache, behind the writer.
+ *
+ * When the writer has written a window of data, the write-back of the
+ * window is started. The previous window, which had time to reach the
+ * disk, is waited for and dropped. On platforms other than Linux, nothing
+ * is done.
+ */
+class drop_behind {
+public:
+    /**
+     * @brief Start dropping the pages of a file.
+     * @param path_ Path of the file, which must exist.
+     * @param offset_ Offset at which the writer starts.
+     * @param window_size_ Number of bytes which are dropped at once.
+     */
+    drop_behind(
+        const boost::filesystem::path& path_,
+        std::uint64_t offset_,
+        std::uint64_t window_size_ = std::uint64_t{1} << 24
+    );
+
+    drop_behind(const drop_behind&) = delete;
+    drop_behind& operator=(const drop_behind&) = delete;
+    drop_behind(drop_behind&&) = delete;
+    drop_behind& operator=(drop_behind&&) = delete;
+    ~drop_behind();
+
+    /**
+     * @brief Whether the writer should flush its data, such that the next
+     *      window can be dropped.
+     * @param offset_ Offset up to which the writer has received data.
+     */
+    [[nodiscard]] auto window_complete(std::uint64_t offset_) const -> bool {
+        return offset_ >= m_written + m_window_size;
+    }
+
+    /**
+     * @brief Record that the writer has flushed its data to the kernel.
+     * @param offset_ Offset up to which the data was flushed.
+     */
+    auto on_flushed(std::uint64_t offset_) -> void;
+
+    /**
+     * @brief Wait for all flushed data to reach the disk, and drop it.
+     */
+    auto finish() -> void;
+
+private:
+    auto drop(std::uint64_t begin_, std::uint64_t end_) -> void;
+
+    int m_fd = -1;
+    std::uint64_t m_window_size;
+    /// End of the data which was flushed by the writer.
+    std::uint64_t m_written;
+    /// End of the data which was dropped from the page cache.
+    std::uint64_t m_dropped;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,251 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "parallel_upload.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "atomic_file.h"
+#include "exception_types.h"
+#include "page_cache.h"
+
+namespace file_transfer::detail {
+
+auto byte_coverage::add(std::uint64_t offset_, std::uint64_t length_)
+    -> void {
+    if (length_ == 0) {
+        return;
+    }
+    auto begin = offset_;
+    auto end = offset_ + length_;
+    // Merge with the ranges which overlap or touch the new one.
+    auto it = m_ranges.upper_bound(begin);
+    if (it != m_ranges.begin() && std::prev(it)->second >= begin) {
+        --it;
+    }
+    while (it != m_ranges.end() && it->first <= end) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        m_num_bytes -= it->second - it->first;
+        it = m_ranges.erase(it);
+    }
+    m_ranges.emplace(begin, end);
+    m_num_bytes += end - begin;
+}
+
+auto byte_coverage::covers(std::uint64_t offset_, std::uint64_t length_) const
+    -> bool {
+    if (length_ == 0) {
+        return true;
+    }
+    auto it = m_ranges.upper_bound(offset_);
+    if (it == m_ranges.begin()) {
+        return false;
+    }
+    --it;
+    return it->second >= offset_ + length_;
+}
+
+parallel_upload::parallel_upload(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    bool atomic_
+)
+    : m_write_path{atomic_ ? get_temporary_path(path_) : path_},
+      m_file_size{file_size_},
+      m_atomic{atomic_} {
+    try {
+        if (!boost::filesystem::exists(m_write_path)) {
+            boost::filesystem::ofstream{m_write_path, std::ios_base::binary};
+        }
+        // Existing content is kept, since every byte is overwritten
+        // before the upload is complete.
+        boost::filesystem::resize_file(m_write_path, m_file_size);
+    } catch (const std::exception&) {
+        if (atomic_) {
+            discard_file(m_write_path);
+        }
+        throw exceptions::failed_precondition("Could not open output file.");
+    }
+    // Resizing leaves holes, which the parts would fill in fragments.
+    preallocate_file(m_write_path, m_file_size);
+}
+
+parallel_upload::~parallel_upload() {
+    if (m_atomic && !m_committed) {
+        discard_file(m_write_path);
+    }
+}
+
+auto parallel_upload::add(std::uint64_t offset_, std::uint64_t length_)
+    -> std::uint64_t {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_coverage.add(offset_, length_);
+    return m_coverage.num_bytes();
+}
+
+auto parallel_upload::complete() const -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_coverage.num_bytes() == m_file_size;
+}
+
+auto parallel_upload::num_bytes_written() const -> std::uint64_t {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_coverage.num_bytes();
+}
+
+namespace {
+
+auto digests_match(
+    const std::pair<std::string, std::string>& expected_,
+    const std::string& algorithm_,
+    const std::string& hex_digest_
+) -> bool {
+    const auto& [algorithm, hex_digest] = expected_;
+    if (hex_digest.empty() || hex_digest_.empty()) {
+        return hex_digest.empty() == hex_digest_.empty();
+    }
+    return algorithm == algorithm_ && hex_digest == hex_digest_;
+}
+
+} // namespace
+
+auto parallel_upload::check_expected_digest(
+    const std::string& algorithm_, const std::string& hex_digest_
+) -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_expected_digest) {
+        m_expected_digest.emplace(algorithm_, hex_digest_);
+        return;
+    }
+    if (!digests_match(*m_expected_digest, algorithm_, hex_digest_)) {
+        throw exceptions::failed_precondition(
+            "An upload of the file with a different checksum is in progress."
+        );
+    }
+}
+
+auto parallel_upload::expects_digest(
+    const std::string& algorithm_, const std::string& hex_digest_
+) const -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return !m_expected_digest ||
+           digests_match(*m_expected_digest, algorithm_, hex_digest_);
+}
+
+auto parallel_upload_registry::attach(
+    const boost::filesystem::path& path_,
+    std::uint64_t file_size_,
+    bool atomic_,
+    const std::string& algorithm_,
+    const std::string& hex_digest_
+) -> std::shared_ptr<parallel_upload> {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto key = path_.lexically_normal().string();
+    auto it = m_uploads.find(key);
+    if (it != m_uploads.end()) {
+        const auto& upload = it->second.upload;
+        const std::string difference =
+            upload->file_size() != file_size_ ? "size"
+            : !upload->expects_digest(algorithm_, hex_digest_) ? "checksum"
+                                                               : "";
+        if (!difference.empty()) {
+            if (upload.use_count() > 1) {
+                throw exceptions::failed_precondition(
+                    "An upload of the file " + path_.string() +
+                    " with a different " + difference + " is in progress."
+                );
+            }
+            BOOST_LOG_TRIVIAL(info)
+                << "Discarding the incomplete upload of " << path_.string()
+                << ", since the file " << difference << " changed.";
+            m_uploads.erase(it);
+            it = m_uploads.end();
+        }
+    }
+    if (it == m_uploads.end()) {
+        evict_idle();
+        it = m_uploads
+                 .emplace(
+                     key,
+                     entry{std::make_shared<parallel_upload>(
+                         path_, file_size_, atomic_
+                     )}
+                 )
+                 .first;
+    }
+    it->second.upload->check_expected_digest(algorithm_, hex_digest_);
+    it->second.last_attached = ++m_num_attached;
+    return it->second.upload;
+}
+
+auto parallel_upload_registry::release(
+    const boost::filesystem::path& path_,
+    const std::shared_ptr<parallel_upload>& upload_
+) -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto it = m_uploads.find(path_.lexically_normal().string());
+    if (it != m_uploads.end() && it->second.upload == upload_) {
+        m_uploads.erase(it);
+    }
+}
+
+auto parallel_upload_registry::evict_idle() -> void {
+    std::vector<std::map<std::string, entry>::iterator> idle;
+    for (auto it = m_uploads.begin(); it != m_uploads.end(); ++it) {
+        if (it->second.upload.use_count() == 1) {
+            idle.push_back(it);
+        }
+    }
+    if (idle.size() < m_max_idle) {
+        return;
+    }
+    std::sort(idle.begin(), idle.end(), [](const auto& lhs_, const auto& rhs_) {
+        return lhs_->second.last_attached < rhs_->second.last_attached;
+    });
+    // Make room for the upload which is about to be added.
+    for (std::size_t i = 0; i + m_max_idle <= idle.size(); ++i) {
+        m_uploads.erase(idle[i]);
+    }
+}
+
+} // namespace file_transfer::detail
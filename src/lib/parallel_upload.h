@@ -0,0 +1,296 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Set of byte ranges of a file which have been written.
+ *
+ * Adjacent and overlapping ranges are merged, such that the set stays
+ * small when chunks arrive in arbitrary order.
+ */
+class byte_coverage {
+public:
+    /**
+     * @brief Add a range to the set.
+     * @param offset_ Start of the range.
+     * @param length_ Number of bytes in the range.
+     */
+    auto add(std::uint64_t offset_, std::uint64_t length_) -> void;
+
+    /**
+     * @brief Check whether a range is fully contained in the set.
+     * @param offset_ Start of the range.
+     * @param length_ Number of bytes in the range.
+     */
+    [[nodiscard]] auto covers(std::uint64_t offset_, std::uint64_t length_)
+        const -> bool;
+
+    /**
+     * @brief Get the total number of bytes in the set.
+     */
+    [[nodiscard]] auto num_bytes() const -> std::uint64_t {
+        return m_num_bytes;
+    }
+
+private:
+    /// Disjoint, non-adjacent ranges, from their start to their end.
+    std::map<std::uint64_t, std::uint64_t> m_ranges;
+    std::uint64_t m_num_bytes = 0;
+};
+
+/**
+ * @brief Shared state of an upload which several streams write to.
+ *
+ * Each stream writes disjoint parts of the preallocated file through its
+ * own file handle, and records them here. The file is complete once all
+ * of its bytes are covered. If the upload is atomic, the parts are
+ * written to a temporary file, which is committed once it is complete,
+ * and removed with the upload otherwise.
+ *
+ * All member functions are thread-safe.
+ */
+class parallel_upload {
+public:
+    /**
+     * @brief Construct the upload, and preallocate the file.
+     * @param path_ Path of the uploaded file.
+     * @param file_size_ Size of the uploaded file.
+     * @param atomic_ Whether the parts are written to a temporary file.
+     */
+    parallel_upload(
+        const boost::filesystem::path& path_,
+        std::uint64_t file_size_,
+        bool atomic_ = false
+    );
+
+    parallel_upload(const parallel_upload&) = delete;
+    parallel_upload& operator=(const parallel_upload&) = delete;
+    parallel_upload(parallel_upload&&) = delete;
+    parallel_upload& operator=(parallel_upload&&) = delete;
+    ~parallel_upload();
+
+    [[nodiscard]] auto file_size() const -> std::uint64_t { return m_file_size; }
+
+    /**
+     * @brief Get the path of the file which the parts are written to.
+     */
+    [[nodiscard]] auto write_path() const -> const boost::filesystem::path& {
+        return m_write_path;
+    }
+
+    /**
+     * @brief Record a range which has been written to the file.
+     * @param offset_ Start of the range.
+     * @param length_ Number of bytes in the range.
+     * @return The number of bytes of the file which have been written.
+     */
+    auto add(std::uint64_t offset_, std::uint64_t length_) -> std::uint64_t;
+
+    /**
+     * @brief Check whether all bytes of the file have been written.
+     */
+    [[nodiscard]] auto complete() const -> bool;
+
+    /**
+     * @brief Get the number of bytes of the file which have been written.
+     */
+    [[nodiscard]] auto num_bytes_written() const -> std::uint64_t;
+
+    /**
+     * @brief Check that a stream expects the same checksum of the file as
+     *      the other streams.
+     *
+     * The checksum of the first stream is recorded. Since the complete file
+     * is verified only once, a stream which expects another checksum, or
+     * none, could otherwise commit data which were not verified.
+     *
+     * @param algorithm_ Name of the checksum algorithm.
+     * @param hex_digest_ Expected hex digest, or an empty string if the
+     *      stream does not verify the file.
+     * @throws exceptions::failed_precondition if the checksum differs from
+     *      the one of the first stream.
+     */
+    auto check_expected_digest(
+        const std::string& algorithm_, const std::string& hex_digest_
+    ) -> void;
+
+    /**
+     * @brief Check whether a stream with the given checksum could attach
+     *      to the upload, without recording the checksum.
+     * @param algorithm_ Name of the checksum algorithm.
+     * @param hex_digest_ Expected hex digest, or an empty string.
+     */
+    [[nodiscard]] auto expects_digest(
+        const std::string& algorithm_, const std::string& hex_digest_
+    ) const -> bool;
+
+    /**
+     * @brief Get the verified checksum of the complete file, computing it
+     *      on the first call.
+     *
+     * Concurrent callers wait for the first one, such that the file is
+     * read only once.
+     *
+     * @param compute_ Function which computes the checksum.
+     */
+    template<typename Fun>
+    auto get_hex_digest(const Fun& compute_) -> std::string {
+        std::lock_guard<std::mutex> lock{m_digest_mutex};
+        if (!m_hex_digest) {
+            m_hex_digest = compute_();
+        }
+        return *m_hex_digest;
+    }
+
+    /**
+     * @brief Commit the complete file, on the first call.
+     *
+     * Concurrent callers wait for the first one, such that they only
+     * report the upload as complete once the file is in place.
+     *
+     * @param commit_ Function which commits the file. If it throws, the
+     *      next caller tries again.
+     */
+    template<typename Fun>
+    auto commit(const Fun& commit_) -> void {
+        std::lock_guard<std::mutex> lock{m_digest_mutex};
+        if (!m_committed) {
+            commit_();
+            m_committed = true;
+        }
+    }
+
+private:
+    boost::filesystem::path m_write_path;
+    std::uint64_t m_file_size;
+    mutable std::mutex m_mutex;
+    byte_coverage m_coverage;
+    /// Algorithm and hex digest which the first stream expects.
+    std::optional<std::pair<std::string, std::string>> m_expected_digest;
+
+    std::mutex m_digest_mutex;
+    std::optional<std::string> m_hex_digest;
+    bool m_atomic;
+    bool m_committed = false;
+};
+
+/**
+ * @brief Uploads which are in progress, by the path of their file.
+ *
+ * Streams which upload parts of the same file attach to the same
+ * parallel_upload. An upload is kept until it is complete, also while no
+ * stream is attached, such that a client can upload the parts one after
+ * the other. Only a limited number of incomplete, idle uploads is kept.
+ *
+ * All member functions are thread-safe.
+ */
+class parallel_upload_registry {
+public:
+    /**
+     * @brief Construct the registry.
+     * @param max_idle_ Maximum number of incomplete uploads which are kept
+     *      while no stream is attached.
+     */
+    explicit parallel_upload_registry(std::size_t max_idle_ = 64)
+        : m_max_idle{max_idle_} {}
+
+    /**
+     * @brief Attach to the upload of a file, starting it if necessary.
+     *
+     * An idle upload of the file with a different size or checksum is
+     * discarded, since it belongs to another version of the file. Uploads
+     * without a checksum can only be told apart by their size.
+     * @param path_ Path of the uploaded file.
+     * @param file_size_ Size of the uploaded file.
+     * @param atomic_ Whether a new upload writes to a temporary file.
+     * @param algorithm_ Name of the checksum algorithm of the stream.
+     * @param hex_digest_ Checksum which the stream expects, or an empty
+     *      string.
+     * @return The shared state of the upload.
+     * @throws exceptions::failed_precondition if an upload of the file
+     *      with a different size or checksum is in progress.
+     */
+    auto attach(
+        const boost::filesystem::path& path_,
+        std::uint64_t file_size_,
+        bool atomic_ = false,
+        const std::string& algorithm_ = {},
+        const std::string& hex_digest_ = {}
+    ) -> std::shared_ptr<parallel_upload>;
+
+    /**
+     * @brief Forget an upload once it is complete.
+     * @param path_ Path of the uploaded file.
+     * @param upload_ The upload, which is only removed if it is still the
+     *      current upload of the file.
+     */
+    auto release(
+        const boost::filesystem::path& path_,
+        const std::shared_ptr<parallel_upload>& upload_
+    ) -> void;
+
+private:
+    struct entry {
+        std::shared_ptr<parallel_upload> upload;
+        /// Value of m_num_attached when a stream last attached.
+        std::uint64_t last_attached = 0;
+    };
+
+    /// Remove the least recently attached idle uploads beyond the limit.
+    auto evict_idle() -> void;
+
+    std::size_t m_max_idle;
+    std::mutex m_mutex;
+    std::map<std::string, entry> m_uploads;
+    std::uint64_t m_num_attached = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,185 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "path_filter.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace file_transfer::detail {
+
+namespace {
+
+/// Match one character against the set of a "[...]" pattern, which
+/// starts after the "[". Returns the position after the "]", or npos if
+/// the set is not closed, in which case the "[" is literal.
+auto match_set(
+    std::string_view pattern_, std::size_t start_, char c_, bool& matched_
+) -> std::size_t {
+    auto position = start_;
+    const auto negated =
+        position < pattern_.size() &&
+        (pattern_[position] == '!' || pattern_[position] == '^');
+    if (negated) {
+        ++position;
+    }
+    auto found = false;
+    auto first = true;
+    while (position < pattern_.size() &&
+           (first || pattern_[position] != ']')) {
+        first = false;
+        const auto low = pattern_[position];
+        if (position + 2 < pattern_.size() && pattern_[position + 1] == '-' &&
+            pattern_[position + 2] != ']') {
+            const auto high = pattern_[position + 2];
+            found = found || (low <= c_ && c_ <= high);
+            position += 3;
+        } else {
+            found = found || low == c_;
+            ++position;
+        }
+    }
+    if (position >= pattern_.size()) {
+        return std::string_view::npos;
+    }
+    // A set never matches the separator.
+    matched_ = c_ != '/' && found != negated;
+    return position + 1;
+}
+
+auto matches(const std::string& pattern_, std::string_view relative_path_)
+    -> bool {
+    if (pattern_.find('/') == std::string::npos) {
+        const auto separator = relative_path_.rfind('/');
+        const auto name = separator == std::string_view::npos
+                              ? relative_path_
+                              : relative_path_.substr(separator + 1);
+        return glob_match(pattern_, name);
+    }
+    // Patterns are relative to the root, with or without a leading "/".
+    const auto pattern = std::string_view{pattern_};
+    return glob_match(
+        pattern.front() == '/' ? pattern.substr(1) : pattern, relative_path_
+    );
+}
+
+} // namespace
+
+auto glob_match(std::string_view pattern_, std::string_view path_) -> bool {
+    std::size_t p = 0;
+    std::size_t s = 0;
+    while (p < pattern_.size()) {
+        if (pattern_[p] == '*') {
+            if (p + 1 < pattern_.size() && pattern_[p + 1] == '*') {
+                p += 2;
+                if (p < pattern_.size() && pattern_[p] == '/') {
+                    // "**/" matches any number of whole directories.
+                    const auto rest = pattern_.substr(p + 1);
+                    for (auto i = s;; ++i) {
+                        if ((i == s || path_[i - 1] == '/') &&
+                            glob_match(rest, path_.substr(i))) {
+                            return true;
+                        }
+                        if (i == path_.size()) {
+                            return false;
+                        }
+                    }
+                }
+                for (auto i = s; i <= path_.size(); ++i) {
+                    if (glob_match(pattern_.substr(p), path_.substr(i))) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            ++p;
+            for (auto i = s;; ++i) {
+                if (glob_match(pattern_.substr(p), path_.substr(i))) {
+                    return true;
+                }
+                if (i == path_.size() || path_[i] == '/') {
+                    return false;
+                }
+            }
+        }
+        if (s == path_.size()) {
+            return false;
+        }
+        if (pattern_[p] == '?') {
+            if (path_[s] == '/') {
+                return false;
+            }
+            ++p;
+            ++s;
+            continue;
+        }
+        if (pattern_[p] == '[') {
+            bool matched = false;
+            const auto end = match_set(pattern_, p + 1, path_[s], matched);
+            if (end != std::string_view::npos) {
+                if (!matched) {
+                    return false;
+                }
+                p = end;
+                ++s;
+                continue;
+            }
+        }
+        if (pattern_[p] == '\\' && p + 1 < pattern_.size()) {
+            ++p;
+        }
+        if (pattern_[p] != path_[s]) {
+            return false;
+        }
+        ++p;
+        ++s;
+    }
+    return s == path_.size();
+}
+
+path_filter::path_filter(
+    std::vector<std::string> include_, std::vector<std::string> exclude_
+)
+    : m_include{std::move(include_)}, m_exclude{std::move(exclude_)} {}
+
+auto path_filter::includes_file(std::string_view relative_path_) const
+    -> bool {
+    const auto match = [&](const std::string& pattern_) {
+        return matches(pattern_, relative_path_);
+    };
+    return (m_include.empty() ||
+            std::any_of(m_include.begin(), m_include.end(), match)) &&
+           std::none_of(m_exclude.begin(), m_exclude.end(), match);
+}
+
+auto path_filter::includes_directory(std::string_view relative_path_) const
+    -> bool {
+    return std::none_of(
+        m_exclude.begin(),
+        m_exclude.end(),
+        [&](const std::string& pattern_) {
+            return matches(pattern_, relative_path_);
+        }
+    );
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,92 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Check whether a path matches a glob pattern.
+ *
+ * "*" matches any characters except "/", "?" matches one character
+ * except "/", and "[...]" matches one character of a set, which may
+ * contain ranges such as "a-z", and is negated by a leading "!". "**"
+ * matches any characters including "/", and "**" followed by "/" also
+ * matches no directories at all. A backslash matches the next character
+ * literally.
+ * @param pattern_ The glob pattern.
+ * @param path_ The path, with "/" as separator.
+ */
+auto glob_match(std::string_view pattern_, std::string_view path_) -> bool;
+
+/**
+ * @brief Selects the entries of a directory tree by include and exclude
+ *      glob patterns.
+ *
+ * The patterns are matched against the path relative to the root of the
+ * tree, with "/" as separator. A pattern without "/" is matched against
+ * the name of the entry instead, in any directory.
+ */
+class path_filter {
+public:
+    /**
+     * @brief Construct a filter which includes all entries.
+     */
+    path_filter() = default;
+
+    /**
+     * @brief Construct the filter.
+     * @param include_ Patterns of the files to include. If empty, all
+     *      files which are not excluded are included.
+     * @param exclude_ Patterns of the files and directories to exclude.
+     */
+    path_filter(
+        std::vector<std::string> include_, std::vector<std::string> exclude_
+    );
+
+    /**
+     * @brief Whether a file is included.
+     * @param relative_path_ Path of the file, relative to the root.
+     */
+    [[nodiscard]] auto includes_file(std::string_view relative_path_) const
+        -> bool;
+
+    /**
+     * @brief Whether the entries of a directory are walked. Only the
+     *      exclude patterns apply to directories.
+     * @param relative_path_ Path of the directory, relative to the root.
+     */
+    [[nodiscard]] auto includes_directory(std::string_view relative_path_
+    ) const -> bool;
+
+private:
+    std::vector<std::string> m_include;
+    std::vector<std::string> m_exclude;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,90 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "progress_throttle.h"
+
+#include <algorithm>
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+auto parse_progress_cadence(const std::string& value_) -> progress_cadence {
+    progress_cadence cadence{0, 0, std::chrono::milliseconds{0}};
+    std::size_t begin = 0;
+    while (begin <= value_.size()) {
+        auto end = value_.find(',', begin);
+        if (end == std::string::npos) {
+            end = value_.size();
+        }
+        const auto criterion = value_.substr(begin, end - begin);
+        begin = end + 1;
+
+        const auto invalid = [&criterion]() {
+            return exceptions::invalid_argument(
+                "Invalid progress cadence '" + criterion +
+                "', expected '<n>', '<n>%', or '<n>ms'."
+            );
+        };
+        const auto unit_begin =
+            std::min(criterion.find_first_not_of("0123456789"), criterion.size());
+        const auto number_string = criterion.substr(0, unit_begin);
+        const auto unit = criterion.substr(unit_begin);
+        if (number_string.empty() || number_string.size() > 9) {
+            throw invalid();
+        }
+        const auto number = std::stoul(number_string);
+        if (number == 0) {
+            throw invalid();
+        }
+        if (unit.empty()) {
+            cadence.chunks = number;
+        } else if (unit == "%") {
+            cadence.percent = static_cast<std::uint32_t>(std::min(number, 100UL));
+        } else if (unit == "ms") {
+            cadence.interval = std::chrono::milliseconds{number};
+        } else {
+            throw invalid();
+        }
+    }
+    return cadence;
+}
+
+auto progress_throttle::on_chunk(
+    std::uint32_t percent_, clock_t_::time_point now_
+) -> bool {
+    ++m_num_chunks;
+    const auto report =
+        (m_cadence.chunks > 0 && m_num_chunks >= m_cadence.chunks) ||
+        (m_cadence.percent > 0 &&
+         percent_ >= m_last_report_percent + m_cadence.percent) ||
+        (m_cadence.interval.count() > 0 &&
+         now_ - m_last_report_time >= m_cadence.interval);
+    if (report) {
+        m_num_chunks = 0;
+        m_last_report_percent = percent_;
+        m_last_report_time = now_;
+    }
+    return report;
+}
+
+} // namespace file_transfer::detail
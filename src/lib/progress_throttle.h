@@ -0,0 +1,95 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief How often progress responses are sent during a transfer.
+ *
+ * A response is sent when any of the enabled criteria is met. A value of
+ * zero disables a criterion.
+ */
+struct progress_cadence {
+    /// Number of chunks after which a response is sent.
+    std::uint64_t chunks = 1;
+    /// Increase of the progress, in percent, after which a response is
+    /// sent.
+    std::uint32_t percent = 0;
+    /// Time after which a response is sent.
+    std::chrono::milliseconds interval{0};
+};
+
+/**
+ * @brief Parse a progress cadence.
+ *
+ * The value is a comma-separated list of criteria: "<n>" for a number of
+ * chunks, "<n>%" for a percentage, and "<n>ms" for a time interval. For
+ * example, "64,5%,250ms" sends a response every 64 chunks, every 5
+ * percent, or every 250 milliseconds, whichever comes first.
+ *
+ * @param value_ The value to parse.
+ * @return The cadence. Criteria which are not given are disabled.
+ * @throws exceptions::invalid_argument if the value is malformed.
+ */
+auto parse_progress_cadence(const std::string& value_) -> progress_cadence;
+
+/**
+ * @brief Decides after which chunks progress is reported.
+ */
+class progress_throttle {
+public:
+    using clock_t_ = std::chrono::steady_clock;
+
+    /**
+     * @brief Construct the throttle.
+     * @param cadence_ How often progress is reported.
+     * @param start_ Start of the transfer.
+     */
+    explicit progress_throttle(
+        progress_cadence cadence_ = {}, clock_t_::time_point start_ = {}
+    )
+        : m_cadence{cadence_}, m_last_report_time{start_} {}
+
+    /**
+     * @brief Record a chunk, and check whether its progress is reported.
+     * @param percent_ Progress of the transfer after the chunk.
+     * @param now_ Current time.
+     * @return Whether a progress response is sent for the chunk.
+     */
+    auto on_chunk(std::uint32_t percent_, clock_t_::time_point now_) -> bool;
+
+private:
+    progress_cadence m_cadence;
+    std::uint64_t m_num_chunks = 0;
+    std::uint32_t m_last_report_percent = 0;
+    clock_t_::time_point m_last_report_time;
+};
+
+} // namespace detail
+} // namespace file_transfer
@@ -0,0 +1,147 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "read_ahead.h"
+
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/post.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer::detail {
+
+read_ahead::read_ahead(
+    std::shared_ptr<file_reader> reader_,
+    boost::asio::thread_pool& thread_pool_,
+    const chunk_codec* codec_
+)
+    : m_reader{std::move(reader_)},
+      m_codec{codec_},
+      m_executor{thread_pool_.get_executor()},
+      m_strand{boost::asio::make_strand(m_executor)} {}
+
+read_ahead::~read_ahead() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cancelled = true;
+    m_condition.wait(lock, [this]() { return m_num_running == 0; });
+}
+
+auto read_ahead::schedule(std::uint64_t offset_, std::size_t size_) -> void {
+    auto new_chunk = std::make_unique<chunk>();
+    new_chunk->offset = offset_;
+    new_chunk->size = size_;
+    if (!m_free_buffers.empty()) {
+        new_chunk->data = std::move(m_free_buffers.back());
+        m_free_buffers.pop_back();
+    }
+    if (m_codec && !m_free_frames.empty()) {
+        new_chunk->frame = std::move(m_free_frames.back());
+        m_free_frames.pop_back();
+    }
+    auto* target = new_chunk.get();
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_chunks.push_back(std::move(new_chunk));
+        ++m_num_running;
+    }
+    boost::asio::post(m_strand, [this, target]() {
+        bool cancelled = false;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            cancelled = m_cancelled;
+        }
+        if (!cancelled) {
+            try {
+                m_reader->read(target->offset, target->size, target->data);
+            } catch (...) {
+                target->error = std::current_exception();
+            }
+        }
+        if (cancelled || target->error || !m_codec) {
+            finish(*target);
+            return;
+        }
+        // The next read starts while this chunk is compressed.
+        boost::asio::post(m_executor, [this, target]() {
+            try {
+                m_codec->encode(
+                    target->data.data(), target->data.size(), target->frame
+                );
+            } catch (...) {
+                target->error = std::current_exception();
+            }
+            finish(*target);
+        });
+    });
+}
+
+auto read_ahead::finish(chunk& chunk_) -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    chunk_.done = true;
+    --m_num_running;
+    m_condition.notify_all();
+}
+
+auto read_ahead::take_oldest() -> std::unique_ptr<chunk> {
+    std::unique_ptr<chunk> oldest;
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_condition.wait(lock, [this]() { return m_chunks.front()->done; });
+        oldest = std::move(m_chunks.front());
+        m_chunks.pop_front();
+    }
+    if (oldest->error) {
+        std::rethrow_exception(oldest->error);
+    }
+    return oldest;
+}
+
+auto read_ahead::take(std::string& target_) -> std::uint64_t {
+    const auto oldest = take_oldest();
+    target_.swap(oldest->data);
+    m_free_buffers.push_back(std::move(oldest->data));
+    return oldest->offset;
+}
+
+auto read_ahead::take(std::string& data_, std::string& frame_)
+    -> std::uint64_t {
+    const auto oldest = take_oldest();
+    data_.swap(oldest->data);
+    frame_.swap(oldest->frame);
+    m_free_buffers.push_back(std::move(oldest->data));
+    m_free_frames.push_back(std::move(oldest->frame));
+    return oldest->offset;
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,169 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "chunk_compression.h"
+#include "file_io.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Reads the chunks of a download ahead of the sender.
+ *
+ * Chunks are scheduled in the order in which they are sent, and read on
+ * a thread pool while the previous chunks are sent. The reads of one
+ * download run one at a time, in order, such that readers which do not
+ * support concurrent reads can be used. The buffers of sent chunks are
+ * reused for later chunks.
+ *
+ * If the chunks are compressed, each chunk is compressed on the thread
+ * pool once it has been read, outside of the order of the reads, such
+ * that several chunks are compressed concurrently.
+ *
+ * The member functions must be called from a single thread.
+ */
+class read_ahead {
+public:
+    /**
+     * @brief Construct the read-ahead stage.
+     * @param reader_ Reader of the downloaded file.
+     * @param thread_pool_ Thread pool which runs the reads. It must
+     *      outlive the read-ahead stage.
+     * @param codec_ Codec which compresses the chunks, if any. It must
+     *      outlive the read-ahead stage.
+     */
+    read_ahead(
+        std::shared_ptr<file_reader> reader_,
+        boost::asio::thread_pool& thread_pool_,
+        const chunk_codec* codec_ = nullptr
+    );
+
+    read_ahead(const read_ahead&) = delete;
+    read_ahead& operator=(const read_ahead&) = delete;
+    read_ahead(read_ahead&&) = delete;
+    read_ahead& operator=(read_ahead&&) = delete;
+
+    /**
+     * @brief Destroy the read-ahead stage, after the running read ended.
+     *
+     * Scheduled reads which have not started yet are skipped.
+     */
+    ~read_ahead();
+
+    /**
+     * @brief Schedule the read of a chunk.
+     * @param offset_ Offset of the chunk in the file.
+     * @param size_ Size of the chunk.
+     */
+    auto schedule(std::uint64_t offset_, std::size_t size_) -> void;
+
+    /**
+     * @brief Get the number of chunks which are scheduled, and not taken
+     *      yet.
+     */
+    [[nodiscard]] auto num_scheduled() const -> std::size_t {
+        return m_chunks.size();
+    }
+
+    /**
+     * @brief Wait for the oldest scheduled chunk, and take its data.
+     * @param target_ String which receives the data. Its previous buffer
+     *      is reused for a later chunk.
+     * @return The offset of the chunk.
+     * @throws The exception raised while reading the chunk, if any.
+     */
+    auto take(std::string& target_) -> std::uint64_t;
+
+    /**
+     * @brief Wait for the oldest scheduled chunk, and take its data and
+     *      its compressed frame.
+     * @param data_ String which receives the data.
+     * @param frame_ String which receives the frame.
+     * @return The offset of the chunk.
+     * @throws The exception raised while reading or compressing the
+     *      chunk, if any.
+     */
+    auto take(std::string& data_, std::string& frame_) -> std::uint64_t;
+
+private:
+    struct chunk {
+        std::uint64_t offset = 0;
+        std::size_t size = 0;
+        std::string data;
+        std::string frame;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    /// Wait for the oldest scheduled chunk, and remove it.
+    auto take_oldest() -> std::unique_ptr<chunk>;
+    /// Mark a chunk as done.
+    auto finish(chunk& chunk_) -> void;
+
+    std::shared_ptr<file_reader> m_reader;
+    const chunk_codec* m_codec;
+    boost::asio::thread_pool::executor_type m_executor;
+    boost::asio::strand<boost::asio::thread_pool::executor_type> m_strand;
+
+    /// Scheduled chunks, oldest first. The chunks are allocated
+    /// separately, such that the reads can fill them while chunks are
+    /// added or removed.
+    std::deque<std::unique_ptr<chunk>> m_chunks;
+    std::vector<std::string> m_free_buffers;
+    std::vector<std::string> m_free_frames;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::size_t m_num_running = 0;
+    bool m_cancelled = false;
+};
+
+} // namespace detail
+} // namespace file_transfer
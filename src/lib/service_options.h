@@ -0,0 +1,146 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/thread_pool.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "atomic_file.h"
+#include "chunk_compression.h"
+#include "chunk_store.h"
+#include "digest_cache.h"
+#include "file_io.h"
+#include "file_reader_pool.h"
+#include "parallel_upload.h"
+#include "upload_session_store.h"
+
+namespace file_transfer {
+
+/**
+ * @brief Options which configure the file transfer services.
+ *
+ * The options apply to all transfers handled by a service instance.
+ */
+struct ServiceOptions {
+    /// Backend used to read and write the transferred files.
+    detail::io_backend io_backend = detail::io_backend::stream;
+
+    /// Readers shared by concurrent downloads of the same file, for
+    /// backends which support it. If empty, each download opens the file.
+    std::shared_ptr<detail::file_reader_pool> file_readers =
+        std::make_shared<detail::file_reader_pool>();
+
+    /// Number of chunks which a download reads ahead of the chunk being
+    /// sent, on the io_thread_pool. If zero, or if there is no thread
+    /// pool, each chunk is read right before it is sent.
+    std::size_t read_ahead_depth = 0;
+
+    /// Number of blocks which an upload may queue to be written behind
+    /// the receiver, on the io_thread_pool. If zero, or if there is no
+    /// thread pool, each chunk is written as it is received.
+    std::size_t write_behind_depth = 0;
+
+    /// Size of the blocks into which uploaded chunks are coalesced, if
+    /// they are written behind the receiver.
+    std::size_t write_block_size = std::size_t{1} << 20;
+
+    /// Threads which run the reads ahead of the sender, the writes behind
+    /// the receiver, and the directory walks of directory downloads, shared
+    /// by all transfers. Without it, directories are walked by the sender.
+    std::shared_ptr<boost::asio::thread_pool> io_thread_pool;
+
+    /// Threads which run the steps of the sessions of the callback-based
+    /// service, since they may block on the disk. They are separate from
+    /// the io_thread_pool, because the steps wait for the reads and writes
+    /// which run there. If empty, the steps run on the callback threads of
+    /// gRPC.
+    std::shared_ptr<boost::asio::thread_pool> session_thread_pool;
+
+    /// How uploaded files use the page cache.
+    detail::page_cache_mode upload_page_cache = detail::page_cache_mode::keep;
+
+    /// Whether uploads are written to a temporary sibling file, which is
+    /// renamed into place once the upload is complete and its checksum
+    /// matches. Otherwise, and for files which can not be replaced by a
+    /// rename, the file is written in place.
+    bool atomic_uploads = false;
+
+    /// When the data of uploaded files is synchronized to disk.
+    detail::upload_durability upload_durability =
+        detail::upload_durability::none;
+
+    /// Number of bytes after which an upload is synchronized to disk, if
+    /// the durability is periodic.
+    std::uint64_t upload_sync_interval = std::uint64_t{1} << 26;
+
+    /// Whether the checksum of an upload is verified by reading the file
+    /// back from disk, instead of hashing the chunks as they are received.
+    bool verify_uploads_from_disk = false;
+
+    /// Algorithms which clients may select to compress the chunks of a
+    /// transfer. If empty, chunks are always sent raw.
+    std::vector<detail::compression_algorithm> compression_algorithms =
+        detail::get_supported_compression_algorithms();
+
+    /// Cache for the checksums of downloaded and uploaded files, shared by
+    /// all transfers. If empty, checksums are always computed.
+    std::shared_ptr<detail::digest_cache> digest_cache;
+
+    /// Store of the content-defined chunks of uploaded files, which clients
+    /// can reference instead of sending the chunks again. If empty, files
+    /// are not split into chunks.
+    std::shared_ptr<detail::chunk_store> chunk_store;
+
+    /// Store for the checkpoints of resumable uploads. If empty, uploads
+    /// cannot be resumed.
+    std::shared_ptr<detail::upload_session_store> upload_sessions;
+
+    /// Positional uploads in progress, which several streams may write to.
+    /// If empty, each stream of a positional upload must send the whole
+    /// file.
+    std::shared_ptr<detail::parallel_upload_registry> parallel_uploads =
+        std::make_shared<detail::parallel_upload_registry>();
+
+    /// Number of bytes after which a resumable upload is checkpointed.
+    /// Uploads are also checkpointed when their stream is interrupted.
+    std::uint64_t upload_checkpoint_interval = std::uint64_t{1} << 24;
+};
+
+} // namespace file_transfer
@@ -22,52 +22,78 @@
 
 #include "sha1_digest.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
-#include <ios>
-#include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
-#ifdef _MSC_VER
-#pragma warning(push, 3)
-#else
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#endif
-
-#include <boost/filesystem/fstream.hpp>
-#include <boost/filesystem/path.hpp>
-#include <boost/uuid/detail/sha1.hpp>
+namespace file_transfer::detail {
+auto sha1_hasher::update(const char* data_, std::size_t size_) -> void {
+    const auto* data = reinterpret_cast<const unsigned char*>(data_);
+    m_total_size += size_;
 
-#ifdef _MSC_VER
-#pragma warning(pop)
-#else
-#pragma GCC diagnostic pop
-#endif
+    if (m_buffer_size > 0) {
+        const auto num_copied = std::min(size_, sha1_block_size - m_buffer_size);
+        std::memcpy(m_buffer.data() + m_buffer_size, data, num_copied);
+        m_buffer_size += num_copied;
+        data += num_copied;
+        size_ -= num_copied;
+        if (m_buffer_size < sha1_block_size) {
+            return;
+        }
+        m_kernel->compress(m_state, m_buffer.data(), 1);
+        m_buffer_size = 0;
+    }
 
-namespace file_transfer::detail {
-auto get_sha1_hex_digest(
-    const boost::filesystem::path& path_, const std::streamsize chunk_size_
-) -> std::string {
-    std::string buffer(chunk_size_, '\0');
-    boost::filesystem::ifstream in_file{path_, std::ios_base::binary};
-    boost::uuids::detail::sha1 sha_value{};
-    if (!in_file.good()) {
-        throw std::runtime_error("Could not open file.");
+    // Process the complete blocks directly from the input.
+    const auto num_blocks = size_ / sha1_block_size;
+    if (num_blocks > 0) {
+        m_kernel->compress(m_state, data, num_blocks);
+        data += num_blocks * sha1_block_size;
+        size_ -= num_blocks * sha1_block_size;
     }
-    while (in_file.good()) {
-        in_file.read(buffer.data(), chunk_size_);
-        sha_value.process_bytes(buffer.data(), in_file.gcount());
+
+    std::memcpy(m_buffer.data(), data, size_);
+    m_buffer_size = size_;
+}
+
+auto sha1_hasher::hex_digest() const -> std::string {
+    // Pad a copy of the state, such that more data can be added afterwards.
+    auto state = m_state;
+    std::array<unsigned char, 2 * sha1_block_size> padding{};
+    std::memcpy(padding.data(), m_buffer.data(), m_buffer_size);
+    padding[m_buffer_size] = 0x80;
+    const auto padded_size =
+        m_buffer_size < sha1_block_size - 8 ? sha1_block_size
+                                            : 2 * sha1_block_size;
+    const auto num_bits = m_total_size * 8;
+    for (std::size_t i = 0; i < 8; ++i) {
+        padding[padded_size - 1 - i] =
+            static_cast<unsigned char>(num_bits >> (8 * i));
     }
-    boost::uuids::detail::sha1::digest_type res_int;
-    sha_value.get_digest(res_int);
+    m_kernel->compress(state, padding.data(), padded_size / sha1_block_size);
 
     // std::format not yet supported in our toolchains
     std::stringstream res_stream;
     res_stream << std::hex;
-    for (const auto& elem : res_int) {
+    for (const auto& elem : state) {
         res_stream << std::setfill('0') << std::setw(8) << elem;
     }
     return res_stream.str();
 }
+
+auto sha1_hasher::save_state() const -> std::string {
+    return save_trivial_state(m_state, m_buffer, m_buffer_size, m_total_size);
+}
+
+auto sha1_hasher::restore_state(const std::string& state_) -> void {
+    restore_trivial_state(
+        state_, m_state, m_buffer, m_buffer_size, m_total_size
+    );
+    if (m_buffer_size >= sha1_block_size) {
+        throw std::invalid_argument("Invalid SHA1 hasher state.");
+    }
+}
 } // namespace file_transfer::detail
@@ -22,37 +22,66 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
-#ifdef _MSC_VER
-#pragma warning(push, 3)
-#else
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#endif
-
-#include <boost/filesystem/path.hpp>
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#else
-#pragma GCC diagnostic pop
-#endif
+#include "checksum.h"
+#include "sha1_kernels.h"
 
 namespace file_transfer {
 namespace detail {
 
 /**
- * @brief Get the SHA1 hex digest of a file.
- * @param path_ Path to the file.
- * @param chunk_size_ Size of the chunks to read from the file.
- * @return SHA1 hex digest of the file.
+ * @brief Incremental computation of a SHA1 digest.
  *
- * @note This function is not thread-safe.
+ * The data can be passed in pieces of arbitrary size, for example the
+ * chunks of a file as they are transferred. The blocks are processed by
+ * the fastest SHA1 kernel which the CPU supports.
  */
-auto get_sha1_hex_digest(
-    const boost::filesystem::path& path_,
-    const std::streamsize chunk_size_ = 1024
-) -> std::string;
+class sha1_hasher final : public hasher {
+public:
+    /**
+     * @brief Construct the hasher.
+     * @param kernel_ Kernel which processes the blocks.
+     */
+    explicit sha1_hasher(const sha1_kernel& kernel_ = get_best_sha1_kernel())
+        : m_kernel{&kernel_} {}
+
+    /**
+     * @brief Add data to the digest.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    auto update(const char* data_, std::size_t size_) -> void override;
+
+    /**
+     * @brief Get the hex digest of all data added so far.
+     */
+    [[nodiscard]] auto hex_digest() const -> std::string override;
+
+    /**
+     * @brief Get the internal state, such that hashing can be resumed later.
+     */
+    [[nodiscard]] auto save_state() const -> std::string override;
+
+    /**
+     * @brief Restore an internal state returned by save_state.
+     * @param state_ The saved state.
+     */
+    auto restore_state(const std::string& state_) -> void override;
+
+private:
+    const sha1_kernel* m_kernel;
+    sha1_state_t m_state{
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+    };
+    /// Data which does not fill a complete block yet.
+    std::array<unsigned char, sha1_block_size> m_buffer{};
+    std::size_t m_buffer_size = 0;
+    std::uint64_t m_total_size = 0;
+};
+
 } // namespace detail
 } // namespace file_transfer
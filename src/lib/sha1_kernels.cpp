@@ -0,0 +1,284 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "sha1_kernels.h"
+
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||             \
+    defined(_M_IX86)
+#define FILE_TRANSFER_SHA1_X86
+#endif
+
+#ifdef FILE_TRANSFER_SHA1_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FILE_TRANSFER_SHA_NI_TARGET
+#else
+#include <cpuid.h>
+#define FILE_TRANSFER_SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+#endif
+#include <immintrin.h>
+#endif
+
+namespace file_transfer::detail {
+
+namespace {
+
+// ---------- Portable kernel ----------
+
+constexpr auto rotl(std::uint32_t value_, int shift_) -> std::uint32_t {
+    return (value_ << shift_) | (value_ >> (32 - shift_));
+}
+
+auto load_big_endian(const unsigned char* data_) -> std::uint32_t {
+    return (static_cast<std::uint32_t>(data_[0]) << 24) |
+           (static_cast<std::uint32_t>(data_[1]) << 16) |
+           (static_cast<std::uint32_t>(data_[2]) << 8) |
+           static_cast<std::uint32_t>(data_[3]);
+}
+
+/**
+ * @brief Process one round of the portable kernel.
+ *
+ * Instead of shifting the working variables after each round, their roles
+ * rotate through the elements of vars_. The message schedule is computed
+ * on the fly, in a ring of the last 16 words.
+ */
+template <int I>
+inline auto portable_round(
+    sha1_state_t& vars_, std::array<std::uint32_t, 16>& w_
+) -> void {
+    constexpr int a = (100 - I) % 5;
+    constexpr int b = (101 - I) % 5;
+    constexpr int c = (102 - I) % 5;
+    constexpr int d = (103 - I) % 5;
+    constexpr int e = (104 - I) % 5;
+
+    if constexpr (I >= 16) {
+        w_[I % 16] = rotl(
+            w_[(I + 13) % 16] ^ w_[(I + 8) % 16] ^ w_[(I + 2) % 16] ^
+                w_[I % 16],
+            1
+        );
+    }
+    std::uint32_t f = 0;
+    std::uint32_t k = 0;
+    if constexpr (I < 20) {
+        f = (vars_[b] & vars_[c]) | (~vars_[b] & vars_[d]);
+        k = 0x5A827999;
+    } else if constexpr (I < 40) {
+        f = vars_[b] ^ vars_[c] ^ vars_[d];
+        k = 0x6ED9EBA1;
+    } else if constexpr (I < 60) {
+        f = (vars_[b] & vars_[c]) | (vars_[b] & vars_[d]) |
+            (vars_[c] & vars_[d]);
+        k = 0x8F1BBCDC;
+    } else {
+        f = vars_[b] ^ vars_[c] ^ vars_[d];
+        k = 0xCA62C1D6;
+    }
+    vars_[e] += rotl(vars_[a], 5) + f + k + w_[I % 16];
+    vars_[b] = rotl(vars_[b], 30);
+}
+
+template <int... Is>
+inline auto portable_rounds(
+    sha1_state_t& vars_,
+    std::array<std::uint32_t, 16>& w_,
+    std::integer_sequence<int, Is...> /*unused*/
+) -> void {
+    (portable_round<Is>(vars_, w_), ...);
+}
+
+auto compress_portable(
+    sha1_state_t& state_,
+    const unsigned char* blocks_,
+    std::size_t num_blocks_
+) -> void {
+    for (std::size_t block = 0; block < num_blocks_; ++block) {
+        const auto* data = blocks_ + block * sha1_block_size;
+        std::array<std::uint32_t, 16> w{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            w[i] = load_big_endian(data + 4 * i);
+        }
+
+        auto vars = state_;
+        portable_rounds(vars, w, std::make_integer_sequence<int, 80>{});
+        for (std::size_t i = 0; i < state_.size(); ++i) {
+            state_[i] += vars[i];
+        }
+    }
+}
+
+#ifdef FILE_TRANSFER_SHA1_X86
+
+// ---------- SHA-NI kernel ----------
+
+auto cpu_supports_sha_ni() -> bool {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool has_sse41 = (info[2] & (1 << 19)) != 0;
+    __cpuidex(info, 7, 0);
+    const bool has_sha = (info[1] & (1 << 29)) != 0;
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    const bool has_sse41 = (ecx & bit_SSE4_1) != 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    const bool has_sha = (ebx & bit_SHA) != 0;
+#endif
+    return has_sse41 && has_sha;
+}
+
+/**
+ * @brief Process one group of four rounds with the SHA extensions.
+ *
+ * The 80 rounds of a block are split into 20 groups. The message words of
+ * group I are held in msg_[I % 4], and the words of the later groups are
+ * derived from them while the rounds progress. The roles of e0_ and e1_
+ * alternate between the groups.
+ */
+template <int I>
+FILE_TRANSFER_SHA_NI_TARGET inline auto sha_ni_round_group(
+    __m128i& abcd_,
+    __m128i& e0_,
+    __m128i& e1_,
+    __m128i (&msg_)[4],
+    const unsigned char* block_,
+    const __m128i& byte_swap_mask_
+) -> void {
+    auto& e_current = (I % 2 == 0) ? e0_ : e1_;
+    auto& e_next = (I % 2 == 0) ? e1_ : e0_;
+
+    if constexpr (I < 4) {
+        msg_[I] = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(block_ + 16 * I)
+            ),
+            byte_swap_mask_
+        );
+    }
+    if constexpr (I == 0) {
+        e_current = _mm_add_epi32(e_current, msg_[0]);
+    } else {
+        e_current = _mm_sha1nexte_epu32(e_current, msg_[I % 4]);
+    }
+    e_next = abcd_;
+    abcd_ = _mm_sha1rnds4_epu32(abcd_, e_current, I / 5);
+
+    if constexpr (I >= 3 && I <= 18) {
+        msg_[(I + 1) % 4] = _mm_sha1msg2_epu32(msg_[(I + 1) % 4], msg_[I % 4]);
+    }
+    if constexpr (I >= 1 && I <= 16) {
+        msg_[(I + 3) % 4] = _mm_sha1msg1_epu32(msg_[(I + 3) % 4], msg_[I % 4]);
+    }
+    if constexpr (I >= 2 && I <= 17) {
+        msg_[(I + 2) % 4] = _mm_xor_si128(msg_[(I + 2) % 4], msg_[I % 4]);
+    }
+}
+
+template <int... Is>
+FILE_TRANSFER_SHA_NI_TARGET inline auto sha_ni_rounds(
+    __m128i& abcd_,
+    __m128i& e0_,
+    __m128i& e1_,
+    __m128i (&msg_)[4],
+    const unsigned char* block_,
+    const __m128i& byte_swap_mask_,
+    std::integer_sequence<int, Is...> /*unused*/
+) -> void {
+    (sha_ni_round_group<Is>(abcd_, e0_, e1_, msg_, block_, byte_swap_mask_),
+     ...);
+}
+
+FILE_TRANSFER_SHA_NI_TARGET auto compress_sha_ni(
+    sha1_state_t& state_,
+    const unsigned char* blocks_,
+    std::size_t num_blocks_
+) -> void {
+    const auto byte_swap_mask =
+        _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    auto abcd = _mm_shuffle_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(state_.data())), 0x1B
+    );
+    auto e0 = _mm_set_epi32(static_cast<int>(state_[4]), 0, 0, 0);
+    auto e1 = _mm_setzero_si128();
+    __m128i msg[4];
+
+    for (std::size_t block = 0; block < num_blocks_; ++block) {
+        const auto abcd_save = abcd;
+        const auto e0_save = e0;
+
+        sha_ni_rounds(
+            abcd,
+            e0,
+            e1,
+            msg,
+            blocks_ + block * sha1_block_size,
+            byte_swap_mask,
+            std::make_integer_sequence<int, 20>{}
+        );
+
+        // After the last group, e0 holds the value of abcd before it.
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(state_.data()), _mm_shuffle_epi32(abcd, 0x1B)
+    );
+    state_[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#endif
+
+} // namespace
+
+auto get_supported_sha1_kernels() -> std::vector<sha1_kernel> {
+    std::vector<sha1_kernel> kernels{{"portable", &compress_portable}};
+#ifdef FILE_TRANSFER_SHA1_X86
+    if (cpu_supports_sha_ni()) {
+        kernels.push_back({"sha-ni", &compress_sha_ni});
+    }
+#endif
+    return kernels;
+}
+
+auto get_best_sha1_kernel() -> const sha1_kernel& {
+    static const sha1_kernel best_kernel = get_supported_sha1_kernels().back();
+    return best_kernel;
+}
+
+} // namespace file_transfer::detail
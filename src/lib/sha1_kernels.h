@@ -0,0 +1,74 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace file_transfer {
+namespace detail {
+
+/// Chaining state of the SHA1 compression function.
+using sha1_state_t = std::array<std::uint32_t, 5>;
+
+/// Size of the blocks processed by the SHA1 compression function.
+constexpr std::size_t sha1_block_size = 64;
+
+/**
+ * @brief Implementation of the SHA1 compression function.
+ *
+ * All kernels produce bit-identical results. The fastest one supported by
+ * the CPU is selected at runtime.
+ */
+struct sha1_kernel {
+    /// Name of the kernel, for logging and benchmarks.
+    const char* name;
+
+    /**
+     * @brief Process consecutive 64-byte blocks.
+     * @param state_ Chaining state, which is updated in place.
+     * @param blocks_ Pointer to the first block.
+     * @param num_blocks_ Number of blocks to process.
+     */
+    void (*compress)(
+        sha1_state_t& state_,
+        const unsigned char* blocks_,
+        std::size_t num_blocks_
+    );
+};
+
+/**
+ * @brief Get all SHA1 kernels which are supported by the CPU.
+ * @return The kernels, ordered from the slowest to the fastest.
+ */
+auto get_supported_sha1_kernels() -> std::vector<sha1_kernel>;
+
+/**
+ * @brief Get the fastest SHA1 kernel which is supported by the CPU.
+ */
+auto get_best_sha1_kernel() -> const sha1_kernel&;
+
+} // namespace detail
+} // namespace file_transfer
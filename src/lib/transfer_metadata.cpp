@@ -0,0 +1,268 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "transfer_metadata.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "exception_types.h"
+
+namespace file_transfer::metadata {
+
+auto get_client_metadata(
+    const ::grpc::ServerContextBase& context_, const std::string& key_
+) -> std::optional<std::string> {
+    const auto& client_metadata = context_.client_metadata();
+    const auto it = client_metadata.find(key_);
+    if (it == client_metadata.end()) {
+        return std::nullopt;
+    }
+    return std::string(it->second.data(), it->second.size());
+}
+
+namespace {
+
+/**
+ * @brief Parse a non-negative decimal number.
+ * @param value_ The number.
+ * @param context_ Description of the surrounding value, for the error
+ *      message.
+ */
+auto parse_number(const std::string& value_, const std::string& context_)
+    -> std::uint64_t {
+    const auto is_digit = [](char c_) { return c_ >= '0' && c_ <= '9'; };
+    if (value_.empty() || value_.size() > 19 ||
+        !std::all_of(value_.begin(), value_.end(), is_digit)) {
+        throw exceptions::invalid_argument("Invalid " + context_ + ".");
+    }
+    return std::stoull(value_);
+}
+
+} // namespace
+
+auto parse_delta_block_size(const std::string& value_) -> std::size_t {
+    const auto block_size = parse_number(value_, "delta block size");
+    if (block_size < detail::min_delta_block_size ||
+        block_size > detail::max_delta_block_size) {
+        throw exceptions::invalid_argument(
+            "The delta block size must be between " +
+            std::to_string(detail::min_delta_block_size) + " and " +
+            std::to_string(detail::max_delta_block_size) + "."
+        );
+    }
+    return static_cast<std::size_t>(block_size);
+}
+
+auto parse_glob_patterns(const std::string& value_)
+    -> std::vector<std::string> {
+    std::vector<std::string> patterns;
+    std::size_t begin = 0;
+    while (begin <= value_.size()) {
+        auto end = value_.find(',', begin);
+        if (end == std::string::npos) {
+            end = value_.size();
+        }
+        auto pattern = value_.substr(begin, end - begin);
+        begin = end + 1;
+        if (pattern.empty()) {
+            throw exceptions::invalid_argument(
+                "Invalid glob patterns '" + value_ + "'."
+            );
+        }
+        patterns.push_back(std::move(pattern));
+    }
+    return patterns;
+}
+
+auto parse_byte_ranges(const std::string& value_, std::uint64_t file_size_)
+    -> std::vector<byte_range> {
+    std::vector<byte_range> ranges;
+    std::size_t begin = 0;
+    while (begin <= value_.size()) {
+        auto end = value_.find(',', begin);
+        if (end == std::string::npos) {
+            end = value_.size();
+        }
+        const auto range = value_.substr(begin, end - begin);
+        begin = end + 1;
+
+        const auto separator = range.find(':');
+        if (separator == std::string::npos) {
+            throw exceptions::invalid_argument(
+                "Invalid range '" + range + "', expected 'offset:length'."
+            );
+        }
+        const auto context = "range '" + range + "'";
+        const auto offset = parse_number(range.substr(0, separator), context);
+        if (offset > file_size_) {
+            throw exceptions::invalid_argument(
+                "Range '" + range + "' starts after the end of the file."
+            );
+        }
+        const auto length_string = range.substr(separator + 1);
+        const auto length = length_string.empty()
+                                ? file_size_ - offset
+                                : parse_number(length_string, context);
+        if (length > file_size_ - offset) {
+            throw exceptions::invalid_argument(
+                "Range '" + range + "' extends past the end of the file."
+            );
+        }
+        if (length > 0) {
+            ranges.push_back({offset, length});
+        }
+    }
+    return ranges;
+}
+
+auto to_string(const std::vector<byte_range>& ranges_) -> std::string {
+    std::string result;
+    for (const auto& range : ranges_) {
+        if (!result.empty()) {
+            result += ',';
+        }
+        result +=
+            std::to_string(range.offset) + ":" + std::to_string(range.length);
+    }
+    return result;
+}
+
+auto get_stripe_range(
+    const std::string& value_,
+    std::uint64_t file_size_,
+    std::uint64_t chunk_size_
+) -> byte_range {
+    const auto separator = value_.find('/');
+    if (separator == std::string::npos) {
+        throw exceptions::invalid_argument(
+            "Invalid stripe '" + value_ + "', expected 'index/count'."
+        );
+    }
+    const auto context = "stripe '" + value_ + "'";
+    const auto index = parse_number(value_.substr(0, separator), context);
+    const auto count = parse_number(value_.substr(separator + 1), context);
+    if (index >= count) {
+        throw exceptions::invalid_argument(
+            "Invalid stripe '" + value_ + "', the index must be less than "
+            "the number of stripes."
+        );
+    }
+    // Split at chunk boundaries, such that only the last chunk of the
+    // file is partial. The first stripes get one more chunk if the
+    // chunks cannot be distributed evenly.
+    const auto num_chunks = (file_size_ + chunk_size_ - 1) / chunk_size_;
+    const auto chunks_per_stripe = num_chunks / count;
+    const auto remainder = num_chunks % count;
+    const auto first_chunk =
+        index * chunks_per_stripe + std::min(index, remainder);
+    const auto stripe_chunks = chunks_per_stripe + (index < remainder ? 1 : 0);
+    const auto begin = std::min(first_chunk * chunk_size_, file_size_);
+    const auto end =
+        std::min((first_chunk + stripe_chunks) * chunk_size_, file_size_);
+    return {begin, end - begin};
+}
+
+auto select_compression(
+    const std::string& value_,
+    const std::vector<detail::compression_algorithm>& enabled_
+) -> std::optional<detail::compression_settings> {
+    std::size_t begin = 0;
+    while (begin <= value_.size()) {
+        auto end = value_.find(',', begin);
+        if (end == std::string::npos) {
+            end = value_.size();
+        }
+        const auto offer = value_.substr(begin, end - begin);
+        begin = end + 1;
+
+        const auto separator = offer.find(':');
+        detail::compression_settings settings;
+        try {
+            settings.algorithm = detail::compression_algorithm_from_string(
+                offer.substr(0, separator)
+            );
+        } catch (const std::invalid_argument&) {
+            // The client may offer algorithms which this server does not
+            // know.
+            continue;
+        }
+        settings.level =
+            separator == std::string::npos
+                ? detail::get_default_compression_level(settings.algorithm)
+                : static_cast<int>(std::min<std::uint64_t>(
+                      parse_number(
+                          offer.substr(separator + 1),
+                          "compression level in '" + offer + "'"
+                      ),
+                      std::numeric_limits<int>::max()
+                  ));
+        if (std::find(enabled_.begin(), enabled_.end(), settings.algorithm) !=
+            enabled_.end()) {
+            // The confirmed level is the one which is actually used.
+            return detail::chunk_codec{settings}.settings();
+        }
+    }
+    return std::nullopt;
+}
+
+auto negotiate_checksum_algorithm(::grpc::ServerContextBase& context_)
+    -> detail::checksum_algorithm {
+    const auto requested_algorithm =
+        get_client_metadata(context_, checksum_algorithm_key);
+    if (!requested_algorithm) {
+        return detail::checksum_algorithm::sha1;
+    }
+    try {
+        const auto algorithm =
+            detail::checksum_algorithm_from_string(*requested_algorithm);
+        context_.AddInitialMetadata(checksum_algorithm_key, *requested_algorithm);
+        return algorithm;
+    } catch (const std::invalid_argument& e) {
+        throw exceptions::invalid_argument(e.what());
+    }
+}
+
+auto negotiate_compression(
+    ::grpc::ServerContextBase& context_,
+    const std::vector<detail::compression_algorithm>& enabled_
+) -> std::optional<detail::compression_settings> {
+    const auto requested_compression =
+        get_client_metadata(context_, compression_key);
+    if (!requested_compression) {
+        return std::nullopt;
+    }
+    const auto settings = select_compression(*requested_compression, enabled_);
+    if (settings) {
+        context_.AddInitialMetadata(
+            compression_key, detail::to_string(*settings)
+        );
+    }
+    return settings;
+}
+
+} // namespace file_transfer::metadata
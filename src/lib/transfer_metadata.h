@@ -0,0 +1,365 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <grpcpp/grpcpp.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "checksum.h"
+#include "chunk_compression.h"
+#include "delta_transfer.h"
+
+/**
+ * @brief Metadata which clients can attach to a transfer.
+ *
+ * The messages of the file transfer API are defined in a separate package.
+ * Optional features of a transfer are negotiated with gRPC metadata
+ * instead: the client sends the keys below with the call, and the server
+ * confirms the features it has enabled in its initial metadata, using the
+ * same keys. Clients which do not send the keys get the default behavior.
+ */
+namespace file_transfer::metadata {
+
+/**
+ * @brief Key selecting when the checksum of a download is computed.
+ *
+ * With "upfront" (the default), the checksum is sent in the response to
+ * the initialize step. With "streaming", the checksum is computed while the
+ * chunks are sent, and is returned in the response to the finalize step.
+ */
+inline constexpr const char* checksum_mode_key =
+    "ansys-filetransfer-checksum-mode";
+
+/**
+ * @brief Key selecting the algorithm of the transfer checksum.
+ *
+ * The value is the name of a detail::checksum_algorithm, for example
+ * "blake3". The default is "sha1". The digest of the selected algorithm is
+ * sent in the "sha1" field of the file info, in both directions.
+ */
+inline constexpr const char* checksum_algorithm_key =
+    "ansys-filetransfer-checksum-algorithm";
+
+/**
+ * @brief Key with the id of a resumable upload session.
+ *
+ * The id is chosen by the client, and may contain letters, digits, '-',
+ * and '_'. If the server supports resumable uploads, it confirms the id,
+ * and sends the number of bytes it has already received for the session
+ * with the upload_offset_key. The client then sends the remaining chunks
+ * of the file, starting at that offset.
+ */
+inline constexpr const char* upload_session_key =
+    "ansys-filetransfer-upload-session";
+
+/**
+ * @brief Key with the offset at which a resumed upload continues.
+ */
+inline constexpr const char* upload_offset_key =
+    "ansys-filetransfer-upload-offset";
+
+/**
+ * @brief Key selecting how the chunks of an upload are written.
+ *
+ * With "sequential" (the default), the chunks are appended in the order
+ * in which they arrive. With "positional", each chunk is written at its
+ * offset, so chunks may arrive in any order, and several streams may
+ * upload disjoint parts of the same file concurrently. With "delta", the
+ * data of each chunk are detail::delta_decoder instructions against the
+ * existing copy of the file, whose signatures the client downloaded with
+ * the download_mode_key, using the same delta_block_size_key. With
+ * "chunked", the data of each chunk are detail::delta_decoder instructions
+ * without a basis, which reference the chunks of the chunk store.
+ */
+inline constexpr const char* upload_mode_key = "ansys-filetransfer-upload-mode";
+
+/**
+ * @brief Key selecting what a download sends.
+ *
+ * With "file" (the default), the content of the file is sent. With
+ * "signatures", the detail::compute_block_signatures of the file are sent
+ * in its place, as if they were the content of a file. The strong
+ * checksums of the blocks use the checksum algorithm of the transfer.
+ * With "manifest", the detail::encode_manifest of the content-defined
+ * chunks of the file is sent, whose chunks the server then holds in its
+ * chunk store.
+ */
+inline constexpr const char* download_mode_key =
+    "ansys-filetransfer-download-mode";
+
+/**
+ * @brief Key with the block size of the signatures for a delta upload.
+ *
+ * It is optional for downloading the signatures, and the server confirms
+ * the block size it used. It is required for a delta upload.
+ */
+inline constexpr const char* delta_block_size_key =
+    "ansys-filetransfer-delta-block-size";
+
+/**
+ * @brief Parse the value of the delta_block_size_key.
+ * @param value_ Value sent by the client.
+ * @throws exceptions::invalid_argument if the value is malformed, or
+ *      outside of the range of detail::min_delta_block_size and
+ *      detail::max_delta_block_size.
+ */
+auto parse_delta_block_size(const std::string& value_) -> std::size_t;
+
+/**
+ * @brief Key selecting a batch transfer, which carries many files in one
+ *      stream.
+ *
+ * With "true", the steps of the transfer are repeated for each file, as
+ * described by batch_impl::upload_session and batch_impl::download_session.
+ * The server confirms the key in the initial metadata.
+ */
+inline constexpr const char* batch_key = "ansys-filetransfer-batch";
+
+/**
+ * @brief Key of the trailing metadata of a batch transfer, which lists the
+ *      files that failed.
+ *
+ * The value is a comma-separated list of "index:code", with the index of
+ * the file in the batch and its gRPC status code. Only the first failures
+ * are listed; the response for each file reports whether it failed.
+ */
+inline constexpr const char* batch_errors_key =
+    "ansys-filetransfer-batch-errors";
+
+/**
+ * @brief Key selecting an operation on server files, which a
+ *      "DownloadFile" call runs instead of downloading them.
+ *
+ * The value is "stat", "exists", "list", "remove", "rename", or "copy",
+ * as described by operation_impl::session. The server confirms the key in
+ * the initial metadata.
+ */
+inline constexpr const char* operation_key = "ansys-filetransfer-operation";
+
+/**
+ * @brief Key selecting a directory transfer, which is a batch transfer of
+ *      the files of directory trees.
+ *
+ * With "true", each initialize request of a batch download names a
+ * directory, whose files are sent as the files of the batch, with their
+ * path relative to the directory as name. A batch upload creates the
+ * missing parent directories of its files.
+ */
+inline constexpr const char* directory_key = "ansys-filetransfer-directory";
+
+/**
+ * @brief Key with the glob patterns of the files which a directory
+ *      download includes, as a comma-separated list.
+ *
+ * The patterns are described by detail::path_filter.
+ */
+inline constexpr const char* include_key = "ansys-filetransfer-include";
+
+/**
+ * @brief Key with the glob patterns of the files and directories which a
+ *      directory download excludes, as a comma-separated list.
+ */
+inline constexpr const char* exclude_key = "ansys-filetransfer-exclude";
+
+/**
+ * @brief Parse the value of the include_key or exclude_key.
+ * @param value_ Value sent by the client.
+ * @throws exceptions::invalid_argument if a pattern is empty.
+ */
+auto parse_glob_patterns(const std::string& value_)
+    -> std::vector<std::string>;
+
+/**
+ * @brief Key with the part of the file which a positional upload stream
+ *      sends, as a single range "offset:length".
+ *
+ * The stream's transfer step ends once the part is received. The upload
+ * of the file is complete once all parts are received, possibly over
+ * several streams. By default, a stream sends the whole file.
+ */
+inline constexpr const char* upload_range_key =
+    "ansys-filetransfer-upload-range";
+
+/**
+ * @brief Key selecting how often an upload sends progress responses.
+ *
+ * By default, a response is sent for every chunk. The value is a cadence
+ * as parsed by detail::parse_progress_cadence, for example "64,5%,250ms".
+ * The response to the last chunk is always sent. A client does not need
+ * to wait for a response before sending further chunks.
+ */
+inline constexpr const char* progress_cadence_key =
+    "ansys-filetransfer-progress-cadence";
+
+/**
+ * @brief Key selecting the chunk size of a download.
+ *
+ * With "auto", the server ignores the chunk size of the request, and
+ * adapts the size of each chunk to the measured throughput. The size of
+ * the last chunk it chose is sent in the trailing metadata, under the
+ * same key.
+ */
+inline constexpr const char* chunk_size_key = "ansys-filetransfer-chunk-size";
+
+/**
+ * @brief Key selecting the parts of the file which are downloaded.
+ *
+ * The value is a comma-separated list of ranges "offset:length", for
+ * example "0:1024,4096:512". If the length is omitted, the range extends
+ * to the end of the file, for example "1048576:" for all but the first
+ * MiB. Ranges are sent in the given order.
+ */
+inline constexpr const char* ranges_key = "ansys-filetransfer-ranges";
+
+/**
+ * @brief Contiguous range of bytes in a file.
+ */
+struct byte_range {
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+};
+
+/**
+ * @brief Parse the value of the ranges_key.
+ * @param value_ Value sent by the client.
+ * @param file_size_ Size of the downloaded file.
+ * @return The ranges. Empty ranges are omitted.
+ * @throws exceptions::invalid_argument if the value is malformed, or a
+ *      range extends past the end of the file.
+ */
+auto parse_byte_ranges(const std::string& value_, std::uint64_t file_size_)
+    -> std::vector<byte_range>;
+
+/**
+ * @brief Format ranges as the value of the ranges_key.
+ * @param ranges_ The ranges.
+ */
+auto to_string(const std::vector<byte_range>& ranges_) -> std::string;
+
+/**
+ * @brief Key selecting one stripe of a striped download.
+ *
+ * The value has the form "index/count", for example "2/8" for the third
+ * of eight stripes. The file is split into count contiguous slices at
+ * chunk boundaries, and the download only sends the slice with the given
+ * index. A client can download the slices over concurrent streams.
+ */
+inline constexpr const char* stripe_key = "ansys-filetransfer-stripe";
+
+/**
+ * @brief Parse the value of the stripe_key, and get the slice of the file.
+ * @param value_ Value sent by the client.
+ * @param file_size_ Size of the downloaded file.
+ * @param chunk_size_ Chunk size of the download.
+ * @return The slice of the file which belongs to the stripe. It is empty
+ *      if there are more stripes than chunks.
+ * @throws exceptions::invalid_argument if the value is malformed.
+ */
+auto get_stripe_range(
+    const std::string& value_,
+    std::uint64_t file_size_,
+    std::uint64_t chunk_size_
+) -> byte_range;
+
+/**
+ * @brief Key offering compression algorithms for the chunks of a transfer.
+ *
+ * The value is a comma-separated list of algorithms in the order of the
+ * client's preference, each optionally followed by a level, for example
+ * "zstd:5,lz4,zlib". The server selects the first algorithm which it
+ * supports, and confirms it with its level under the same key, for
+ * example "zstd:5". The chunks in both directions are then sent as frames
+ * of detail::chunk_codec. If the server does not confirm the key, the
+ * chunks are sent raw.
+ */
+inline constexpr const char* compression_key = "ansys-filetransfer-compression";
+
+/**
+ * @brief Select the compression of a transfer from the value of the
+ *      compression_key.
+ * @param value_ Value sent by the client.
+ * @param enabled_ Algorithms which the server may select.
+ * @return The selected settings, or an empty optional if none of the
+ *      offered algorithms is enabled. Unknown algorithms are skipped.
+ * @throws exceptions::invalid_argument if the value is malformed.
+ */
+auto select_compression(
+    const std::string& value_,
+    const std::vector<detail::compression_algorithm>& enabled_
+) -> std::optional<detail::compression_settings>;
+
+/**
+ * @brief Get the value of a metadata key sent by the client.
+ * @param context_ Server context of the call.
+ * @param key_ Key of the metadata.
+ * @return The value, or an empty optional if the client did not send the
+ *      key.
+ */
+auto get_client_metadata(
+    const ::grpc::ServerContextBase& context_, const std::string& key_
+) -> std::optional<std::string>;
+
+/**
+ * @brief Get the checksum algorithm selected by the client.
+ *
+ * If the client selected an algorithm, it is confirmed in the initial
+ * metadata. Unknown algorithms are rejected as invalid arguments.
+ * @param context_ Server context of the call.
+ */
+auto negotiate_checksum_algorithm(::grpc::ServerContextBase& context_)
+    -> detail::checksum_algorithm;
+
+/**
+ * @brief Get the compression selected for the chunks of a transfer.
+ *
+ * If the client offered an enabled algorithm, the selection is confirmed
+ * in the initial metadata.
+ * @param context_ Server context of the call.
+ * @param enabled_ Algorithms which the server may select.
+ * @return The selected settings, or an empty optional if the chunks are
+ *      sent raw.
+ */
+auto negotiate_compression(
+    ::grpc::ServerContextBase& context_,
+    const std::vector<detail::compression_algorithm>& enabled_
+) -> std::optional<detail::compression_settings>;
+
+} // namespace file_transfer::metadata
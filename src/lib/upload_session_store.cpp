@@ -0,0 +1,292 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "upload_session_store.h"
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "atomic_file.h"
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+namespace {
+
+constexpr std::size_t max_session_id_size = 128;
+
+constexpr const char* checkpoint_extension = ".upload-session";
+
+/// Bound on the stored length of a file name, so that a corrupt
+/// checkpoint does not cause a huge allocation.
+constexpr std::size_t max_file_name_size = std::size_t{1} << 16;
+
+/// Placeholder for empty fields, such that the fields stay separated.
+constexpr const char* empty_field = "-";
+
+auto to_hex(const std::string& data_) -> std::string {
+    std::stringstream res_stream;
+    res_stream << std::hex << std::setfill('0');
+    for (const auto byte : data_) {
+        res_stream << std::setw(2)
+                   << static_cast<unsigned int>(
+                          static_cast<unsigned char>(byte)
+                      );
+    }
+    return res_stream.str();
+}
+
+auto from_hex(const std::string& hex_) -> std::optional<std::string> {
+    if (hex_.size() % 2 != 0 ||
+        !std::all_of(hex_.begin(), hex_.end(), [](unsigned char c_) {
+            return std::isxdigit(c_) != 0;
+        })) {
+        return std::nullopt;
+    }
+    std::string data(hex_.size() / 2, '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] =
+            static_cast<char>(std::stoi(hex_.substr(2 * i, 2), nullptr, 16));
+    }
+    return data;
+}
+
+} // namespace
+
+upload_session_store::lease::lease(lease&& other_) noexcept
+    : m_store{std::exchange(other_.m_store, nullptr)},
+      m_session_id{std::move(other_.m_session_id)} {}
+
+auto upload_session_store::lease::operator=(lease&& other_) noexcept
+    -> lease& {
+    if (this != &other_) {
+        if (m_store) {
+            m_store->release(m_session_id);
+        }
+        m_store = std::exchange(other_.m_store, nullptr);
+        m_session_id = std::move(other_.m_session_id);
+    }
+    return *this;
+}
+
+upload_session_store::lease::~lease() {
+    if (m_store) {
+        m_store->release(m_session_id);
+    }
+}
+
+upload_session_store::upload_session_store(
+    boost::filesystem::path directory_, std::chrono::seconds max_age_
+)
+    : m_directory{std::move(directory_)} {
+    boost::filesystem::create_directories(m_directory);
+    if (max_age_ > std::chrono::seconds::zero()) {
+        remove_abandoned(max_age_);
+    }
+}
+
+auto upload_session_store::check_session_id(const std::string& session_id_)
+    -> void {
+    const auto valid_character = [](unsigned char c_) {
+        return std::isalnum(c_) != 0 || c_ == '-' || c_ == '_';
+    };
+    if (session_id_.empty() || session_id_.size() > max_session_id_size ||
+        !std::all_of(session_id_.begin(), session_id_.end(), valid_character)) {
+        throw exceptions::invalid_argument(
+            "Invalid upload session id. It must consist of 1 to " +
+            std::to_string(max_session_id_size) +
+            " letters, digits, '-', or '_'."
+        );
+    }
+}
+
+auto upload_session_store::get_temporary_path(
+    const boost::filesystem::path& file_path_, const std::string& session_id_
+) -> boost::filesystem::path {
+    return detail::get_temporary_path(file_path_, "session-" + session_id_);
+}
+
+auto upload_session_store::acquire(const std::string& session_id_) -> lease {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_active_sessions.insert(session_id_).second) {
+        throw exceptions::failed_precondition(
+            "Upload session " + session_id_ + " is used by another upload."
+        );
+    }
+    return lease{*this, session_id_};
+}
+
+auto upload_session_store::release(const std::string& session_id_) -> void {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    m_active_sessions.erase(session_id_);
+}
+
+auto upload_session_store::load(const std::string& session_id_) const
+    -> std::optional<upload_checkpoint> {
+    boost::filesystem::ifstream in_file{
+        get_path(session_id_), std::ios_base::binary
+    };
+    if (!in_file.good()) {
+        return std::nullopt;
+    }
+    upload_checkpoint checkpoint;
+    std::string hash_state_hex;
+    // The file name is prefixed with its length, since it may contain
+    // any character.
+    std::size_t file_name_size = 0;
+    in_file >> file_name_size;
+    if (in_file.get() == ' ' && file_name_size <= max_file_name_size) {
+        checkpoint.file_name.resize(file_name_size);
+        in_file.read(
+            checkpoint.file_name.data(),
+            static_cast<std::streamsize>(file_name_size)
+        );
+    } else {
+        in_file.setstate(std::ios_base::failbit);
+    }
+    in_file >> checkpoint.file_size >> checkpoint.offset >>
+        checkpoint.checksum_algorithm >> checkpoint.source_hex_digest >>
+        hash_state_hex;
+    for (auto* field :
+         {&checkpoint.checksum_algorithm,
+          &checkpoint.source_hex_digest,
+          &hash_state_hex}) {
+        if (*field == empty_field) {
+            field->clear();
+        }
+    }
+    auto hash_state = from_hex(hash_state_hex);
+    if (in_file.fail() || !hash_state) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Ignoring malformed checkpoint of upload session "
+            << session_id_;
+        return std::nullopt;
+    }
+    checkpoint.hash_state = *std::move(hash_state);
+    return checkpoint;
+}
+
+auto upload_session_store::save(
+    const std::string& session_id_,
+    const upload_checkpoint& checkpoint_,
+    bool sync_
+) const -> void {
+    const auto path = get_path(session_id_);
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        boost::filesystem::ofstream out_file{
+            temporary_path,
+            std::ios_base::out | std::ios_base::trunc | std::ios_base::binary
+        };
+        const auto field = [](const std::string& value_) {
+            return value_.empty() ? std::string(empty_field) : value_;
+        };
+        out_file << checkpoint_.file_name.size() << ' '
+                 << checkpoint_.file_name << '\n'
+                 << checkpoint_.file_size << ' ' << checkpoint_.offset << ' '
+                 << field(checkpoint_.checksum_algorithm) << ' '
+                 << field(checkpoint_.source_hex_digest) << ' '
+                 << field(to_hex(checkpoint_.hash_state)) << '\n';
+        if (!out_file.good()) {
+            throw exceptions::internal(
+                "Could not write the checkpoint of upload session " +
+                session_id_ + "."
+            );
+        }
+    }
+    if (sync_) {
+        sync_file(temporary_path);
+    }
+    commit_file(temporary_path, path, sync_);
+}
+
+auto upload_session_store::remove(const std::string& session_id_) const
+    -> void {
+    boost::system::error_code error_code;
+    boost::filesystem::remove(get_path(session_id_), error_code);
+}
+
+auto upload_session_store::get_path(const std::string& session_id_) const
+    -> boost::filesystem::path {
+    return m_directory / (session_id_ + checkpoint_extension);
+}
+
+auto upload_session_store::remove_abandoned(std::chrono::seconds max_age_)
+    -> void {
+    const auto now = std::time(nullptr);
+    boost::system::error_code error_code;
+    for (const auto& entry :
+         boost::filesystem::directory_iterator{m_directory, error_code}) {
+        const auto& path = entry.path();
+        // Checkpoints which were not completely written end in ".tmp".
+        const auto extension = path.extension().string();
+        if (extension != checkpoint_extension && extension != ".tmp") {
+            continue;
+        }
+        const auto modified =
+            boost::filesystem::last_write_time(path, error_code);
+        if (error_code || now - modified < max_age_.count()) {
+            continue;
+        }
+        if (extension == checkpoint_extension) {
+            // An atomic upload continues in its temporary file, which is
+            // removed with the session. An upload which was written in
+            // place keeps its partial file.
+            const auto session_id = path.stem().string();
+            if (const auto checkpoint = load(session_id)) {
+                discard_file(
+                    get_temporary_path(checkpoint->file_name, session_id)
+                );
+            }
+            BOOST_LOG_TRIVIAL(info)
+                << "Removing the abandoned upload session " << session_id;
+        }
+        boost::filesystem::remove(path, error_code);
+    }
+}
+
+} // namespace file_transfer::detail
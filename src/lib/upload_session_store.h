@@ -0,0 +1,189 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Progress of an interrupted upload, from which it can be resumed.
+ */
+struct upload_checkpoint {
+    /// Name of the uploaded file, as given by the client.
+    std::string file_name;
+    /// Total size of the uploaded file.
+    std::uint64_t file_size = 0;
+    /// Name of the checksum algorithm, if the client sent a checksum.
+    std::string checksum_algorithm;
+    /// Checksum which the client sent, if any.
+    std::string source_hex_digest;
+    /// Number of bytes which have been written to the file.
+    std::uint64_t offset = 0;
+    /// Saved state of the hasher after the first offset bytes.
+    std::string hash_state;
+};
+
+/**
+ * @brief Persistent storage for the checkpoints of resumable uploads.
+ *
+ * Each upload session is identified by an id which the client chooses.
+ * Its checkpoint is stored in a separate file in the store directory, and
+ * replaced atomically, such that a crash leaves either the old or the new
+ * checkpoint. A session is used by at most one upload at a time.
+ *
+ * All member functions are thread-safe.
+ */
+class upload_session_store {
+public:
+    /**
+     * @brief Marks a session as used by an upload, while it exists.
+     */
+    class lease {
+    public:
+        lease() = default;
+        lease(const lease&) = delete;
+        auto operator=(const lease&) -> lease& = delete;
+        lease(lease&& other_) noexcept;
+        auto operator=(lease&& other_) noexcept -> lease&;
+        ~lease();
+
+    private:
+        friend class upload_session_store;
+        lease(upload_session_store& store_, std::string session_id_)
+            : m_store{&store_}, m_session_id{std::move(session_id_)} {}
+
+        upload_session_store* m_store = nullptr;
+        std::string m_session_id;
+    };
+
+    /**
+     * @brief Construct the store, and create its directory if needed.
+     *
+     * Sessions which were abandoned are removed, together with the
+     * temporary files of their uploads.
+     *
+     * @param directory_ Directory in which the checkpoints are stored.
+     * @param max_age_ Time since its last checkpoint after which a session
+     *      is abandoned. If zero, sessions are kept forever.
+     */
+    explicit upload_session_store(
+        boost::filesystem::path directory_,
+        std::chrono::seconds max_age_ = std::chrono::seconds::zero()
+    );
+
+    /**
+     * @brief Check that a session id can be used as a file name.
+     * @param session_id_ The session id.
+     * @throws exceptions::invalid_argument if the id is not valid.
+     */
+    static auto check_session_id(const std::string& session_id_) -> void;
+
+    /**
+     * @brief Get the temporary file to which the upload of a session is
+     *      written, if it is not written in place.
+     *
+     * The file is kept while the session can be resumed.
+     *
+     * @param file_path_ Path of the uploaded file.
+     * @param session_id_ The session id.
+     */
+    static auto get_temporary_path(
+        const boost::filesystem::path& file_path_,
+        const std::string& session_id_
+    ) -> boost::filesystem::path;
+
+    /**
+     * @brief Mark a session as used by an upload.
+     * @param session_id_ The session id.
+     * @return A lease, which marks the session as unused once it is
+     *      destroyed.
+     * @throws exceptions::failed_precondition if another upload uses the
+     *      session.
+     */
+    [[nodiscard]] auto acquire(const std::string& session_id_) -> lease;
+
+    /**
+     * @brief Load the checkpoint of a session.
+     * @param session_id_ The session id.
+     * @return The checkpoint, or an empty optional if there is none.
+     */
+    [[nodiscard]] auto load(const std::string& session_id_) const
+        -> std::optional<upload_checkpoint>;
+
+    /**
+     * @brief Store the checkpoint of a session.
+     * @param session_id_ The session id.
+     * @param checkpoint_ The checkpoint.
+     * @param sync_ Whether the checkpoint is synchronized to disk before
+     *      it replaces the previous one, together with the rename.
+     */
+    auto save(
+        const std::string& session_id_,
+        const upload_checkpoint& checkpoint_,
+        bool sync_ = false
+    ) const -> void;
+
+    /**
+     * @brief Remove the checkpoint of a session.
+     * @param session_id_ The session id.
+     */
+    auto remove(const std::string& session_id_) const -> void;
+
+private:
+    [[nodiscard]] auto get_path(const std::string& session_id_) const
+        -> boost::filesystem::path;
+    auto release(const std::string& session_id_) -> void;
+    auto remove_abandoned(std::chrono::seconds max_age_) -> void;
+
+    boost::filesystem::path m_directory;
+
+    std::mutex m_mutex;
+    /// Ids of the sessions which are used by an upload.
+    std::set<std::string> m_active_sessions;
+};
+
+} // namespace detail
+} // namespace file_transfer
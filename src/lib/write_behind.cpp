@@ -0,0 +1,158 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "write_behind.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/post.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "exception_types.h"
+
+namespace file_transfer::detail {
+
+write_behind::write_behind(
+    std::ostream& out_,
+    boost::asio::thread_pool& thread_pool_,
+    std::uint64_t offset_,
+    std::size_t block_size_,
+    std::size_t max_queued_blocks_
+)
+    : m_out{out_},
+      m_strand{boost::asio::make_strand(thread_pool_.get_executor())},
+      m_block_size{std::max(block_size_, std::size_t{1})},
+      m_max_queued_blocks{std::max(max_queued_blocks_, std::size_t{1})},
+      m_block_start{offset_},
+      // The first block ends at the next block boundary, such that all
+      // later blocks are aligned.
+      m_block_end{(offset_ / m_block_size + 1) * m_block_size} {}
+
+write_behind::~write_behind() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cancelled = true;
+    m_condition.wait(lock, [this]() { return m_num_queued == 0; });
+}
+
+auto write_behind::write(const std::string& chunk_) -> void {
+    check_error();
+    std::size_t position = 0;
+    while (position < chunk_.size()) {
+        const auto block_capacity =
+            boost::numeric_cast<std::size_t>(m_block_end - m_block_start);
+        const auto num_bytes = std::min(
+            block_capacity - m_block.size(), chunk_.size() - position
+        );
+        m_block.append(chunk_, position, num_bytes);
+        position += num_bytes;
+        if (m_block.size() == block_capacity) {
+            submit_block();
+        }
+    }
+}
+
+auto write_behind::flush() -> void {
+    if (!m_block.empty()) {
+        submit_block();
+    }
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_condition.wait(lock, [this]() { return m_num_queued == 0; });
+    }
+    check_error();
+    m_out.flush();
+    if (!m_out.good()) {
+        throw exceptions::internal("Could not write to the output file.");
+    }
+}
+
+auto write_behind::submit_block() -> void {
+    auto block = std::move(m_block);
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        // Backpressure: wait until there is room in the queue.
+        m_condition.wait(lock, [this]() {
+            return m_num_queued < m_max_queued_blocks;
+        });
+        ++m_num_queued;
+        if (!m_free_buffers.empty()) {
+            m_block = std::move(m_free_buffers.back());
+            m_free_buffers.pop_back();
+        }
+    }
+    m_block.clear();
+    // After a flush, the block may end before the block boundary. The
+    // next block then fills up to the same boundary.
+    m_block_start += block.size();
+    if (m_block_start == m_block_end) {
+        m_block_end += m_block_size;
+    }
+
+    boost::asio::post(m_strand, [this, block = std::move(block)]() mutable {
+        bool skip = false;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            skip = m_cancelled || m_error;
+        }
+        std::exception_ptr error;
+        if (!skip) {
+            m_out.write(
+                block.data(), boost::numeric_cast<std::streamsize>(block.size())
+            );
+            if (!m_out.good()) {
+                error = std::make_exception_ptr(exceptions::internal(
+                    "Could not write to the output file."
+                ));
+            }
+        }
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (error) {
+            m_error = error;
+        }
+        m_free_buffers.push_back(std::move(block));
+        --m_num_queued;
+        m_condition.notify_all();
+    });
+}
+
+auto write_behind::check_error() -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,140 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push, 3)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Writes the chunks of an upload behind the receiver.
+ *
+ * Received chunks are collected into blocks, which are written on a
+ * thread pool while further chunks are received. The blocks end at
+ * multiples of the block size in the file, such that small chunks are
+ * coalesced into large, aligned writes. The writes of one upload run one
+ * at a time, in order.
+ *
+ * The number of blocks waiting to be written is bounded. When the queue
+ * is full, writing a chunk blocks until a block has been written, which
+ * stops reading from the stream and slows down the client.
+ *
+ * The member functions must be called from a single thread.
+ */
+class write_behind {
+public:
+    /**
+     * @brief Construct the write-behind stage.
+     * @param out_ Stream of the output file, positioned at the offset of
+     *      the next chunk. It must not be accessed otherwise until flush
+     *      returns, and it must outlive the stage.
+     * @param thread_pool_ Thread pool which runs the writes. It must
+     *      outlive the stage.
+     * @param offset_ Offset of the next chunk in the file.
+     * @param block_size_ Size of the blocks which are written.
+     * @param max_queued_blocks_ Maximum number of blocks waiting to be
+     *      written.
+     */
+    write_behind(
+        std::ostream& out_,
+        boost::asio::thread_pool& thread_pool_,
+        std::uint64_t offset_,
+        std::size_t block_size_,
+        std::size_t max_queued_blocks_
+    );
+
+    write_behind(const write_behind&) = delete;
+    write_behind& operator=(const write_behind&) = delete;
+    write_behind(write_behind&&) = delete;
+    write_behind& operator=(write_behind&&) = delete;
+
+    /**
+     * @brief Destroy the stage, after the running write ended.
+     *
+     * Blocks which have not been written yet are discarded. Call flush to
+     * write them.
+     */
+    ~write_behind();
+
+    /**
+     * @brief Append a chunk to the file.
+     * @param chunk_ Data of the chunk.
+     * @throws exceptions::internal if an earlier write failed.
+     */
+    auto write(const std::string& chunk_) -> void;
+
+    /**
+     * @brief Write all collected data, and wait until it has been written.
+     * @throws exceptions::internal if a write failed.
+     */
+    auto flush() -> void;
+
+private:
+    auto submit_block() -> void;
+    auto check_error() -> void;
+
+    std::ostream& m_out;
+    boost::asio::strand<boost::asio::thread_pool::executor_type> m_strand;
+    std::size_t m_block_size;
+    std::size_t m_max_queued_blocks;
+
+    /// Data which is collected for the next block.
+    std::string m_block;
+    /// Offsets of the start and end of the next block in the file.
+    std::uint64_t m_block_start;
+    std::uint64_t m_block_end;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::size_t m_num_queued = 0;
+    std::vector<std::string> m_free_buffers;
+    std::exception_ptr m_error;
+    bool m_cancelled = false;
+};
+
+} // namespace detail
+} // namespace file_transfer
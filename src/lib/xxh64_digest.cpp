@@ -0,0 +1,181 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "xxh64_digest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace file_transfer::detail {
+
+namespace {
+
+constexpr std::uint64_t prime_1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t prime_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t prime_3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t prime_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t prime_5 = 0x27D4EB2F165667C5ULL;
+
+constexpr auto rotl(std::uint64_t value_, int shift_) -> std::uint64_t {
+    return (value_ << shift_) | (value_ >> (64 - shift_));
+}
+
+auto load_little_endian_64(const unsigned char* data_) -> std::uint64_t {
+    std::uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data_[i];
+    }
+    return value;
+}
+
+auto load_little_endian_32(const unsigned char* data_) -> std::uint64_t {
+    std::uint64_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | data_[i];
+    }
+    return value;
+}
+
+constexpr auto round(std::uint64_t accumulator_, std::uint64_t input_)
+    -> std::uint64_t {
+    accumulator_ += input_ * prime_2;
+    accumulator_ = rotl(accumulator_, 31);
+    return accumulator_ * prime_1;
+}
+
+constexpr auto merge_round(std::uint64_t hash_, std::uint64_t accumulator_)
+    -> std::uint64_t {
+    hash_ ^= round(0, accumulator_);
+    return hash_ * prime_1 + prime_4;
+}
+
+auto process_stripes(
+    std::array<std::uint64_t, 4>& accumulators_,
+    const unsigned char* data_,
+    std::size_t num_stripes_
+) -> void {
+    auto acc_0 = accumulators_[0];
+    auto acc_1 = accumulators_[1];
+    auto acc_2 = accumulators_[2];
+    auto acc_3 = accumulators_[3];
+    for (std::size_t i = 0; i < num_stripes_; ++i, data_ += 32) {
+        acc_0 = round(acc_0, load_little_endian_64(data_));
+        acc_1 = round(acc_1, load_little_endian_64(data_ + 8));
+        acc_2 = round(acc_2, load_little_endian_64(data_ + 16));
+        acc_3 = round(acc_3, load_little_endian_64(data_ + 24));
+    }
+    accumulators_ = {acc_0, acc_1, acc_2, acc_3};
+}
+
+} // namespace
+
+xxh64_hasher::xxh64_hasher()
+    : m_accumulators{prime_1 + prime_2, prime_2, 0, 0 - prime_1} {}
+
+auto xxh64_hasher::update(const char* data_, std::size_t size_) -> void {
+    const auto* data = reinterpret_cast<const unsigned char*>(data_);
+    m_total_size += size_;
+
+    if (m_buffer_size > 0) {
+        const auto num_copied = std::min(size_, stripe_size - m_buffer_size);
+        std::memcpy(m_buffer.data() + m_buffer_size, data, num_copied);
+        m_buffer_size += num_copied;
+        data += num_copied;
+        size_ -= num_copied;
+        if (m_buffer_size < stripe_size) {
+            return;
+        }
+        process_stripes(m_accumulators, m_buffer.data(), 1);
+        m_buffer_size = 0;
+    }
+
+    const auto num_stripes = size_ / stripe_size;
+    process_stripes(m_accumulators, data, num_stripes);
+    data += num_stripes * stripe_size;
+    size_ -= num_stripes * stripe_size;
+
+    std::memcpy(m_buffer.data(), data, size_);
+    m_buffer_size = size_;
+}
+
+auto xxh64_hasher::hex_digest() const -> std::string {
+    std::uint64_t hash = 0;
+    if (m_total_size >= stripe_size) {
+        const auto& acc = m_accumulators;
+        hash = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) +
+               rotl(acc[3], 18);
+        for (const auto& elem : acc) {
+            hash = merge_round(hash, elem);
+        }
+    } else {
+        hash = prime_5;
+    }
+    hash += m_total_size;
+
+    const auto* data = m_buffer.data();
+    auto size = m_buffer_size;
+    for (; size >= 8; size -= 8, data += 8) {
+        hash ^= round(0, load_little_endian_64(data));
+        hash = rotl(hash, 27) * prime_1 + prime_4;
+    }
+    if (size >= 4) {
+        hash ^= load_little_endian_32(data) * prime_1;
+        hash = rotl(hash, 23) * prime_2 + prime_3;
+        size -= 4;
+        data += 4;
+    }
+    for (; size > 0; --size, ++data) {
+        hash ^= *data * prime_5;
+        hash = rotl(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+
+    std::stringstream res_stream;
+    res_stream << std::hex << std::setfill('0') << std::setw(16) << hash;
+    return res_stream.str();
+}
+
+auto xxh64_hasher::save_state() const -> std::string {
+    return save_trivial_state(
+        m_accumulators, m_buffer, m_buffer_size, m_total_size
+    );
+}
+
+auto xxh64_hasher::restore_state(const std::string& state_) -> void {
+    restore_trivial_state(
+        state_, m_accumulators, m_buffer, m_buffer_size, m_total_size
+    );
+    if (m_buffer_size >= stripe_size) {
+        throw std::invalid_argument("Invalid XXH64 hasher state.");
+    }
+}
+
+} // namespace file_transfer::detail
@@ -0,0 +1,80 @@
+// Copyright (C) 2022 - 2026 ANSYS, Inc. and/or its affiliates.
+// SPDX-License-Identifier: MIT
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "checksum.h"
+
+namespace file_transfer {
+namespace detail {
+
+/**
+ * @brief Incremental computation of a 64-bit xxHash (XXH64) with seed 0.
+ *
+ * The hex digest is the hash as a big-endian 64-bit number, matching the
+ * output of the reference "xxhsum -H64" tool.
+ */
+class xxh64_hasher final : public hasher {
+public:
+    xxh64_hasher();
+
+    /**
+     * @brief Add data to the checksum.
+     * @param data_ Pointer to the data.
+     * @param size_ Size of the data.
+     */
+    auto update(const char* data_, std::size_t size_) -> void override;
+
+    /**
+     * @brief Get the hex digest of all data added so far.
+     */
+    [[nodiscard]] auto hex_digest() const -> std::string override;
+
+    /**
+     * @brief Get the internal state, such that hashing can be resumed later.
+     */
+    [[nodiscard]] auto save_state() const -> std::string override;
+
+    /**
+     * @brief Restore an internal state returned by save_state.
+     * @param state_ The saved state.
+     */
+    auto restore_state(const std::string& state_) -> void override;
+
+private:
+    /// Size of the stripes processed by the four accumulators.
+    static constexpr std::size_t stripe_size = 32;
+
+    std::array<std::uint64_t, 4> m_accumulators{};
+    /// Data which does not fill a complete stripe yet.
+    std::array<unsigned char, stripe_size> m_buffer{};
+    std::size_t m_buffer_size = 0;
+    std::uint64_t m_total_size = 0;
+};
+
+} // namespace detail
+} // namespace file_transfer
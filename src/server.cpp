@@ -20,9 +20,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <locale>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #ifdef _MSC_VER
 #pragma warning(push, 3)
@@ -53,7 +60,14 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <chunk_compression.h>
+#include <chunk_store.h>
+#include <digest_cache.h>
+#include <filetransfer_callback_service.h>
 #include <filetransfer_service.h>
+#include <metrics.h>
+#include <metrics_endpoint.h>
+#include <upload_session_store.h>
 
 struct BoostLoggerAdapter : public grpctransportlib::LoggerInterface {
     void debug(const std::vector<std::string>& lines_) override {
@@ -79,8 +93,29 @@ struct BoostLoggerAdapter : public grpctransportlib::LoggerInterface {
     }
 };
 
+/**
+ * Create the file transfer service for the given engine name.
+ */
+auto make_file_transfer_service(
+    const std::string& engine_, const file_transfer::ServiceOptions& options_
+) -> std::unique_ptr<grpc::Service> {
+    if (engine_ == "sync") {
+        return std::make_unique<file_transfer::FileTransferServiceImpl>(
+            options_
+        );
+    }
+    if (engine_ == "callback") {
+        return std::make_unique<file_transfer::FileTransferCallbackServiceImpl>(
+            options_
+        );
+    }
+    throw std::invalid_argument("Unknown engine '" + engine_ + "'.");
+}
+
 auto run_server(
     const grpctransportlib::ValidatedTransportOptions& transport_options_,
+    const std::string& engine_,
+    const file_transfer::ServiceOptions& service_options_,
     const std::shared_ptr<grpctransportlib::LoggerInterface>& logger_
 ) -> void {
 // Set encoding for paths to UTF-8
@@ -95,8 +130,10 @@ auto run_server(
     grpc::reflection::InitProtoReflectionServerBuilderPlugin();
     auto builder = grpc::ServerBuilder{};
 
-    file_transfer::FileTransferServiceImpl file_transfer_service{};
-    builder.RegisterService(&file_transfer_service);
+    const auto file_transfer_service =
+        make_file_transfer_service(engine_, service_options_);
+    builder.RegisterService(file_transfer_service.get());
+    logger_->debug({"Service engine: " + engine_});
 
     // Configure transport options (ports, TLS, ...)
     const auto resource_handler = grpctransportlib::configure_server_builder(
@@ -115,6 +152,308 @@ auto run_server(
 
 namespace po = boost::program_options;
 
+/**
+ * Get the names of the compression algorithms the server was built with.
+ */
+auto get_supported_compression_names() -> std::string {
+    std::string names;
+    for (const auto algorithm :
+         file_transfer::detail::get_supported_compression_algorithms()) {
+        if (!names.empty()) {
+            names += ',';
+        }
+        names += file_transfer::detail::to_string(algorithm);
+    }
+    return names;
+}
+
+/**
+ * Parse a comma-separated list of compression algorithms, or "none".
+ */
+auto parse_compression_algorithms(const std::string& value_)
+    -> std::vector<file_transfer::detail::compression_algorithm> {
+    std::vector<file_transfer::detail::compression_algorithm> algorithms;
+    if (value_ == "none") {
+        return algorithms;
+    }
+    const auto supported =
+        file_transfer::detail::get_supported_compression_algorithms();
+    std::size_t begin = 0;
+    while (begin <= value_.size()) {
+        auto end = value_.find(',', begin);
+        if (end == std::string::npos) {
+            end = value_.size();
+        }
+        const auto algorithm =
+            file_transfer::detail::compression_algorithm_from_string(
+                value_.substr(begin, end - begin)
+            );
+        if (std::find(supported.begin(), supported.end(), algorithm) ==
+            supported.end()) {
+            throw std::invalid_argument(
+                "The compression algorithm '" +
+                file_transfer::detail::to_string(algorithm) +
+                "' is not supported by this build."
+            );
+        }
+        algorithms.push_back(algorithm);
+        begin = end + 1;
+    }
+    return algorithms;
+}
+
+/**
+ * Get the description of the command-line options which configure the file
+ * transfer service.
+ */
+auto get_service_options_description() -> po::options_description {
+    po::options_description service_description("Service options");
+    service_description.add_options()(
+        "engine",
+        po::value<std::string>()->default_value("sync"),
+        "Engine which handles the RPCs. Either 'sync', which occupies one "
+        "thread per active stream, or 'callback', which processes the "
+        "streams asynchronously."
+    )(
+        "io-backend",
+        po::value<std::string>()->default_value("stream"),
+        "Backend used to access the transferred files. Either 'stream', "
+        "'mmap' to copy the chunks directly from a memory mapping of the "
+        "file, 'pread' for positional reads which concurrent downloads of "
+        "the same file share (not available on Windows), or 'io_uring' to "
+        "keep several reads and writes in flight per transfer (Linux only, "
+        "falls back to 'pread' if the kernel does not support it). Only use "
+        "'mmap' if files are not truncated while they are downloaded."
+    )(
+        "read-ahead-depth",
+        po::value<std::size_t>()->default_value(0),
+        "Number of chunks which a download reads ahead of the chunk being "
+        "sent, such that reading from disk overlaps with sending. Use 0 to "
+        "read each chunk right before it is sent."
+    )(
+        "write-behind-depth",
+        po::value<std::size_t>()->default_value(0),
+        "Number of blocks which an upload may queue to be written while "
+        "further chunks are received. If the queue is full, receiving "
+        "waits for the disk. Use 0 to write each chunk as it is received."
+    )(
+        "write-block-size",
+        po::value<std::size_t>()->default_value(std::size_t{1} << 20),
+        "Size of the aligned blocks into which uploaded chunks are "
+        "coalesced, if they are written behind the receiver."
+    )(
+        "upload-page-cache",
+        po::value<std::string>()->default_value("keep"),
+        "How uploaded files use the page cache. Either 'keep', "
+        "'drop-behind' to drop the written data from the cache once it is "
+        "on disk, or 'direct' to bypass the cache with O_DIRECT. The last "
+        "two keep large uploads from evicting the files which are being "
+        "downloaded. 'drop-behind' only affects sequential uploads on "
+        "Linux, and 'direct' falls back to 'keep' if the file system does "
+        "not support it."
+    )(
+        "io-threads",
+        po::value<std::size_t>()->default_value(4),
+        "Number of threads which read chunks ahead of the sender, write "
+        "them behind the receiver, and walk the trees of directory "
+        "downloads, shared by all transfers."
+    )(
+        "session-threads",
+        po::value<std::size_t>()->default_value(8),
+        "Number of threads which process the requests of the 'callback' "
+        "engine, such that hashing or writing a file does not block the "
+        "callback threads of gRPC. Not used by the 'sync' engine."
+    )(
+        "verify-uploads-from-disk",
+        po::bool_switch(),
+        "Verify the checksum of uploaded files by reading them back from "
+        "disk, instead of hashing the chunks as they are received."
+    )(
+        "atomic-uploads",
+        po::bool_switch(),
+        "Write uploaded files to a hidden temporary file next to the "
+        "target, which is renamed into place once the upload is complete "
+        "and its checksum matches, such that readers never see partially "
+        "written files. The replaced file's mode, owner and access control "
+        "list are kept. Files with other hard links, and files in "
+        "directories which are not writable, are still written in place."
+    )(
+        "upload-durability",
+        po::value<std::string>()->default_value("none"),
+        "When uploaded files are synchronized to disk. Either 'none' to "
+        "leave it to the operating system, 'finalize' to synchronize the "
+        "file before it is renamed into place and before each checkpoint "
+        "of a resumable upload, together with the checkpoint, or "
+        "'periodic' to also synchronize it while it is written."
+    )(
+        "upload-sync-interval",
+        po::value<std::uint64_t>()->default_value(std::uint64_t{1} << 26),
+        "Number of bytes after which an upload is synchronized to disk, if "
+        "the upload durability is 'periodic'."
+    )(
+        "compression-algorithms",
+        po::value<std::string>()->default_value(
+            get_supported_compression_names()
+        ),
+        "Comma-separated algorithms which clients may select to compress "
+        "the chunks of a transfer, or 'none' to always send them raw. "
+        "Chunks of downloads are compressed by the read-ahead stage, on the "
+        "I/O threads, if the read-ahead depth is positive."
+    )(
+        "checksum-cache-size",
+        po::value<std::size_t>()->default_value(1024),
+        "Maximum number of files for which checksums are cached. Use 0 to "
+        "disable the cache."
+    )(
+        "checksum-cache-index",
+        po::value<std::string>()->default_value(""),
+        "Path of a file in which the checksum cache is persisted across "
+        "restarts. By default, the cache is only kept in memory."
+    )(
+        "chunk-store-dir",
+        po::value<std::string>()->default_value(""),
+        "Directory in which uploaded files are stored as content-defined "
+        "chunks, each unique chunk once. Clients can then reference the "
+        "chunks which the server holds, instead of sending them again. "
+        "Uploaded files are still written in full to their target path. By "
+        "default, there is no chunk store."
+    )(
+        "upload-session-dir",
+        po::value<std::string>()->default_value(""),
+        "Directory in which the progress of resumable uploads is stored. "
+        "Uploads can only be resumed if this option is set."
+    )(
+        "upload-checkpoint-interval",
+        po::value<std::uint64_t>()->default_value(std::uint64_t{1} << 24),
+        "Number of bytes after which the progress of a resumable upload is "
+        "stored. The progress is also stored when an upload is interrupted."
+    )(
+        "upload-session-max-age",
+        po::value<std::uint64_t>()->default_value(168),
+        "Number of hours after its last checkpoint after which an upload "
+        "session is abandoned. When the server starts, abandoned sessions "
+        "and the temporary files of their uploads are removed. Use 0 to "
+        "keep sessions forever."
+    )(
+        "metrics-port",
+        po::value<std::uint16_t>()->default_value(0),
+        "Port of an HTTP endpoint which serves metrics of the transfers to "
+        "Prometheus, at '/metrics'. Metrics are only recorded if the "
+        "endpoint is enabled. Use 0 to disable it."
+    )(
+        "metrics-address",
+        po::value<std::string>()->default_value("127.0.0.1"),
+        "IP address on which the metrics endpoint listens."
+    );
+    return service_description;
+}
+
+/**
+ * Start the metrics endpoint, if it is enabled by the command-line options.
+ */
+auto start_metrics_endpoint(const po::variables_map& variables_)
+    -> std::unique_ptr<file_transfer::metrics::http_endpoint> {
+    const auto port = variables_["metrics-port"].as<std::uint16_t>();
+    if (port == 0) {
+        return nullptr;
+    }
+    file_transfer::metrics::enable();
+    return std::make_unique<file_transfer::metrics::http_endpoint>(
+        variables_["metrics-address"].as<std::string>(), port
+    );
+}
+
+/**
+ * Get the file transfer service options from the parsed command-line options.
+ */
+auto get_service_options(const po::variables_map& variables_)
+    -> file_transfer::ServiceOptions {
+    file_transfer::ServiceOptions service_options;
+    service_options.io_backend = file_transfer::detail::io_backend_from_string(
+        variables_["io-backend"].as<std::string>()
+    );
+    service_options.read_ahead_depth =
+        variables_["read-ahead-depth"].as<std::size_t>();
+    service_options.write_behind_depth =
+        variables_["write-behind-depth"].as<std::size_t>();
+    service_options.write_block_size =
+        variables_["write-block-size"].as<std::size_t>();
+    if (service_options.write_block_size == 0) {
+        throw std::invalid_argument("The write block size must be positive.");
+    }
+    service_options.upload_page_cache =
+        file_transfer::detail::page_cache_mode_from_string(
+            variables_["upload-page-cache"].as<std::string>()
+        );
+    const auto num_io_threads = variables_["io-threads"].as<std::size_t>();
+    if (num_io_threads == 0) {
+        throw std::invalid_argument(
+            "The number of I/O threads must be positive."
+        );
+    }
+    service_options.io_thread_pool =
+        std::make_shared<boost::asio::thread_pool>(num_io_threads);
+    if (variables_["engine"].as<std::string>() == "callback") {
+        const auto num_session_threads =
+            variables_["session-threads"].as<std::size_t>();
+        if (num_session_threads == 0) {
+            throw std::invalid_argument(
+                "The number of session threads must be positive."
+            );
+        }
+        service_options.session_thread_pool =
+            std::make_shared<boost::asio::thread_pool>(num_session_threads);
+    }
+    service_options.verify_uploads_from_disk =
+        variables_["verify-uploads-from-disk"].as<bool>();
+    service_options.atomic_uploads = variables_["atomic-uploads"].as<bool>();
+    service_options.upload_durability =
+        file_transfer::detail::upload_durability_from_string(
+            variables_["upload-durability"].as<std::string>()
+        );
+    service_options.upload_sync_interval =
+        variables_["upload-sync-interval"].as<std::uint64_t>();
+    if (service_options.upload_sync_interval == 0) {
+        throw std::invalid_argument(
+            "The upload sync interval must be positive."
+        );
+    }
+    service_options.compression_algorithms = parse_compression_algorithms(
+        variables_["compression-algorithms"].as<std::string>()
+    );
+    const auto checksum_cache_size =
+        variables_["checksum-cache-size"].as<std::size_t>();
+    if (checksum_cache_size > 0) {
+        service_options.digest_cache =
+            std::make_shared<file_transfer::detail::digest_cache>(
+                checksum_cache_size,
+                variables_["checksum-cache-index"].as<std::string>()
+            );
+    }
+    const auto chunk_store_dir =
+        variables_["chunk-store-dir"].as<std::string>();
+    if (!chunk_store_dir.empty()) {
+        service_options.chunk_store =
+            std::make_shared<file_transfer::detail::chunk_store>(
+                chunk_store_dir
+            );
+    }
+    const auto upload_session_dir =
+        variables_["upload-session-dir"].as<std::string>();
+    if (!upload_session_dir.empty()) {
+        service_options.upload_sessions =
+            std::make_shared<file_transfer::detail::upload_session_store>(
+                upload_session_dir,
+                std::chrono::hours{
+                    variables_["upload-session-max-age"].as<std::uint64_t>()
+                }
+            );
+    }
+    service_options.upload_checkpoint_interval =
+        variables_["upload-checkpoint-interval"].as<std::uint64_t>();
+    return service_options;
+}
+
 /**
  * Parse command-line options and start the server.
  */
@@ -124,6 +463,8 @@ auto main(int argc, char** argv) -> int {
     po::options_description description("General options");
     description.add_options()("help", "Show CLI help.");
 
+    description.add(get_service_options_description());
+
     description.add(
         grpctransportlib::cli::bpo::get_transport_options_description(
             "ansys_tools_filetransfer"
@@ -161,9 +502,27 @@ auto main(int argc, char** argv) -> int {
         std::cout << "Invalid transport options: " << e.what() << '\n';
         return EXIT_FAILURE;
     }
+    const auto engine = variables["engine"].as<std::string>();
+    file_transfer::ServiceOptions service_options;
+    try {
+        service_options = get_service_options(variables);
+    } catch (std::exception& e) {
+        std::cout << "Invalid service options: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    std::unique_ptr<file_transfer::metrics::http_endpoint> metrics_endpoint;
+    try {
+        metrics_endpoint = start_metrics_endpoint(variables);
+    } catch (std::exception& e) {
+        std::cout << "Could not start the metrics endpoint: " << e.what()
+                  << '\n';
+        return EXIT_FAILURE;
+    }
     grpctransportlib::print_options(transport_options_validated, *logger);
     try {
-        run_server(transport_options_validated, logger);
+        run_server(
+            transport_options_validated, engine, service_options, logger
+        );
     } catch (std::exception& e) {
         logger->error({e.what()});
         return EXIT_FAILURE;
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+
+#include "adaptive_chunk_size.h"
+
+namespace {
+
+using file_transfer::detail::adaptive_chunk_size;
+using file_transfer::detail::chunk_size_limits;
+using namespace std::chrono_literals;
+
+/**
+ * Simulate sending chunks over a link with the given throughput, and
+ * return the chunk size the adaptation converges to.
+ */
+auto converge(adaptive_chunk_size& chunk_size_, double bytes_per_second_)
+    -> std::size_t {
+    for (int i = 0; i < 100; ++i) {
+        const auto size = chunk_size_.current();
+        const auto duration = std::chrono::duration<double>(
+            static_cast<double>(size) / bytes_per_second_
+        );
+        chunk_size_.on_chunk_sent(
+            size, std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+        );
+    }
+    return chunk_size_.current();
+}
+
+TEST(adaptive_chunk_size, converges_to_target_duration) {
+    // Test that the chunk size converges to the size which takes the
+    // target duration to send.
+    adaptive_chunk_size chunk_size;
+    EXPECT_EQ(chunk_size.current(), chunk_size_limits{}.initial);
+    // 50 MB/s and 20 ms give 1 MB.
+    const auto size = converge(chunk_size, 50e6);
+    EXPECT_NEAR(static_cast<double>(size), 1e6, 10e3);
+    EXPECT_EQ(size % 4096, 0);
+}
+
+TEST(adaptive_chunk_size, limits) {
+    // Test that the chunk size stays within its limits on very fast and
+    // very slow links.
+    const chunk_size_limits limits{};
+    adaptive_chunk_size fast;
+    EXPECT_EQ(converge(fast, 100e9), limits.max);
+    adaptive_chunk_size slow;
+    EXPECT_EQ(converge(slow, 1e3), limits.min);
+}
+
+TEST(adaptive_chunk_size, bounded_steps) {
+    // Test that the chunk size changes by at most a factor of two per
+    // chunk.
+    const auto initial = chunk_size_limits{}.initial;
+    adaptive_chunk_size growing;
+    EXPECT_EQ(growing.on_chunk_sent(initial, 1ns), 2 * initial);
+    adaptive_chunk_size shrinking;
+    EXPECT_EQ(shrinking.on_chunk_sent(initial, 1s), initial / 2);
+    // Empty chunks and zero durations are ignored.
+    EXPECT_EQ(shrinking.on_chunk_sent(0, 1s), initial / 2);
+    EXPECT_EQ(shrinking.on_chunk_sent(initial, 0ns), initial / 2);
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "atomic_file.h"
+#include "exception_types.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::upload_durability;
+using test_utils::read_file;
+using test_utils::write_file;
+
+class atomic_file_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+    }
+
+    boost::filesystem::path m_path;
+};
+
+TEST(upload_durability, from_string) {
+    EXPECT_EQ(
+        file_transfer::detail::upload_durability_from_string("none"),
+        upload_durability::none
+    );
+    EXPECT_EQ(
+        file_transfer::detail::upload_durability_from_string("finalize"),
+        upload_durability::finalize
+    );
+    EXPECT_EQ(
+        file_transfer::detail::upload_durability_from_string("periodic"),
+        upload_durability::periodic
+    );
+    EXPECT_THROW(
+        file_transfer::detail::upload_durability_from_string("always"),
+        std::invalid_argument
+    );
+}
+
+TEST(temporary_path, hidden_sibling) {
+    // Test that the temporary file is a hidden sibling of the target, and
+    // that only random tags differ between calls.
+    const boost::filesystem::path target{"dir/file.txt"};
+    EXPECT_EQ(
+        file_transfer::detail::get_temporary_path(target, "tag"),
+        boost::filesystem::path{"dir/.file.txt.tag.part"}
+    );
+    const auto random = file_transfer::detail::get_temporary_path(target);
+    EXPECT_EQ(random.parent_path(), target.parent_path());
+    EXPECT_NE(random, file_transfer::detail::get_temporary_path(target));
+}
+
+TEST_F(atomic_file_test, commit_replaces_target) {
+    // Test that committing a temporary file replaces the existing target.
+    write_file(m_path, "old content");
+    const auto temporary = file_transfer::detail::get_temporary_path(m_path);
+    write_file(temporary, "new content");
+    file_transfer::detail::sync_file(temporary);
+    file_transfer::detail::commit_file(temporary, m_path, true);
+    EXPECT_FALSE(boost::filesystem::exists(temporary));
+    EXPECT_EQ(read_file(m_path), "new content");
+}
+
+TEST_F(atomic_file_test, missing_file) {
+    // Test that failing to sync or commit a file is reported.
+    const auto temporary = file_transfer::detail::get_temporary_path(m_path);
+    EXPECT_THROW(
+        file_transfer::detail::sync_file(temporary),
+        file_transfer::exceptions::internal
+    );
+    EXPECT_THROW(
+        file_transfer::detail::commit_file(temporary, m_path, false),
+        file_transfer::exceptions::internal
+    );
+    file_transfer::detail::discard_file(temporary);
+    EXPECT_FALSE(boost::filesystem::exists(m_path));
+}
+
+TEST_F(atomic_file_test, commit_through_symlink) {
+    // Test that the file which a symbolic link points to is replaced, and
+    // the link is kept.
+    const auto link = m_dir / "link";
+    write_file(m_path, "old content");
+    boost::filesystem::create_symlink("file", link);
+    const auto temporary = file_transfer::detail::get_temporary_path(link);
+    EXPECT_EQ(temporary.parent_path(), m_dir);
+    EXPECT_NE(temporary.filename().string().find(".file."), std::string::npos);
+    write_file(temporary, "new content");
+    file_transfer::detail::commit_file(temporary, link, false);
+    EXPECT_TRUE(boost::filesystem::is_symlink(link));
+    EXPECT_EQ(read_file(m_path), "new content");
+}
+
+#ifndef _WIN32
+TEST_F(atomic_file_test, commit_keeps_mode) {
+    // Test that the committed file keeps the mode of the replaced file.
+    write_file(m_path, "old content");
+    boost::filesystem::permissions(
+        m_path,
+        boost::filesystem::owner_read | boost::filesystem::owner_write |
+            boost::filesystem::group_read
+    );
+    const auto temporary = file_transfer::detail::get_temporary_path(m_path);
+    write_file(temporary, "new content");
+    file_transfer::detail::commit_file(temporary, m_path, false);
+    EXPECT_EQ(
+        boost::filesystem::status(m_path).permissions(),
+        boost::filesystem::owner_read | boost::filesystem::owner_write |
+            boost::filesystem::group_read
+    );
+}
+
+TEST_F(atomic_file_test, hard_link_not_replaced_atomically) {
+    // Test that a file with other hard links is written in place.
+    EXPECT_TRUE(file_transfer::detail::can_replace_atomically(m_path));
+    write_file(m_path, "content");
+    EXPECT_TRUE(file_transfer::detail::can_replace_atomically(m_path));
+    boost::filesystem::create_hard_link(m_path, m_dir / "other-link");
+    EXPECT_FALSE(file_transfer::detail::can_replace_atomically(m_path));
+    // The rename fails for a directory anyway, but not due to its links.
+    boost::filesystem::create_directories(m_dir / "dir" / "subdir");
+    EXPECT_TRUE(file_transfer::detail::can_replace_atomically(m_dir / "dir"));
+}
+#endif
+
+} // namespace
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+
+#include "checksum.h"
+#include "crc32c_digest.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::checksum_algorithm;
+
+auto get_hex_digest(checksum_algorithm algorithm_, const std::string& data_)
+    -> std::string {
+    auto hasher = file_transfer::detail::make_hasher(algorithm_);
+    hasher->update(data_.data(), data_.size());
+    return hasher->hex_digest();
+}
+
+/**
+ * Get the input of the reference test vectors: the bytes 0, 1, ..., 250,
+ * repeated up to the given size.
+ */
+auto get_test_vector_input(std::size_t size_) -> std::string {
+    std::string data(size_, '\0');
+    for (std::size_t i = 0; i < size_; ++i) {
+        data[i] = static_cast<char>(i % 251);
+    }
+    return data;
+}
+
+TEST(checksum, names) {
+    // Test that the algorithms can be looked up by their names.
+    for (const auto algorithm :
+         {checksum_algorithm::sha1,
+          checksum_algorithm::crc32c,
+          checksum_algorithm::xxh64,
+          checksum_algorithm::blake3}) {
+        EXPECT_EQ(
+            file_transfer::detail::checksum_algorithm_from_string(
+                file_transfer::detail::to_string(algorithm)
+            ),
+            algorithm
+        );
+    }
+    EXPECT_THROW(
+        file_transfer::detail::checksum_algorithm_from_string("md5"),
+        std::invalid_argument
+    );
+}
+
+TEST(checksum, short_inputs) {
+    // Test the digests of short inputs against published values.
+    EXPECT_EQ(
+        get_hex_digest(checksum_algorithm::crc32c, "123456789"), "e3069283"
+    );
+    EXPECT_EQ(
+        get_hex_digest(checksum_algorithm::xxh64, ""), "ef46db3751d8e999"
+    );
+    EXPECT_EQ(
+        get_hex_digest(checksum_algorithm::xxh64, "abc"), "44bc2cf5ad770999"
+    );
+    EXPECT_EQ(
+        get_hex_digest(checksum_algorithm::blake3, ""),
+        "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"
+    );
+    EXPECT_EQ(
+        get_hex_digest(checksum_algorithm::blake3, "abc"),
+        "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85"
+    );
+}
+
+TEST(checksum, long_inputs) {
+    // Test inputs which span several stripes, blocks, and BLAKE3 chunks.
+    const std::tuple<std::size_t, std::string, std::string, std::string>
+        expected[] = {
+            {1023,
+             "39a4911a",
+             "d66738f081c25cf4",
+             "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"
+            },
+            {1024,
+             "2af62c0c",
+             "138e26c65048ce29",
+             "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"
+            },
+            {1025,
+             "c8d03add",
+             "cfd73aedd2d6a39d",
+             "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"
+            },
+            {2049,
+             "0be89406",
+             "27858160679416ba",
+             "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030"
+            },
+            {8193,
+             "e814309c",
+             "755e4befd10cccf4",
+             "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b"
+            },
+            {102400,
+             "7957da17",
+             "eb1adcdd9e1369a6",
+             "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"
+            },
+        };
+    for (const auto& [size, crc32c, xxh64, blake3] : expected) {
+        const auto data = get_test_vector_input(size);
+        EXPECT_EQ(get_hex_digest(checksum_algorithm::crc32c, data), crc32c)
+            << "size: " << size;
+        EXPECT_EQ(get_hex_digest(checksum_algorithm::xxh64, data), xxh64)
+            << "size: " << size;
+        EXPECT_EQ(get_hex_digest(checksum_algorithm::blake3, data), blake3)
+            << "size: " << size;
+    }
+}
+
+TEST(checksum, incremental) {
+    // Test that the digests do not depend on how the data is split up.
+    const auto data = get_test_vector_input(10000);
+    for (const auto algorithm :
+         {checksum_algorithm::sha1,
+          checksum_algorithm::crc32c,
+          checksum_algorithm::xxh64,
+          checksum_algorithm::blake3}) {
+        const auto whole_digest = get_hex_digest(algorithm, data);
+        for (const std::size_t piece_size : {1, 31, 64, 777, 1024, 4096}) {
+            auto pieces = file_transfer::detail::make_hasher(algorithm);
+            for (std::size_t offset = 0; offset < data.size();
+                 offset += piece_size) {
+                pieces->update(
+                    data.data() + offset,
+                    std::min(piece_size, data.size() - offset)
+                );
+            }
+            EXPECT_EQ(pieces->hex_digest(), whole_digest)
+                << "algorithm: " << file_transfer::detail::to_string(algorithm)
+                << ", piece size: " << piece_size;
+        }
+    }
+}
+
+TEST(checksum, resume) {
+    // Test that hashing can be resumed from a saved state.
+    const auto data = get_test_vector_input(5000);
+    for (const auto algorithm :
+         {checksum_algorithm::sha1,
+          checksum_algorithm::crc32c,
+          checksum_algorithm::xxh64,
+          checksum_algorithm::blake3}) {
+        auto first = file_transfer::detail::make_hasher(algorithm);
+        first->update(data.data(), 3001);
+        const auto state = first->save_state();
+
+        auto second = file_transfer::detail::make_hasher(algorithm);
+        second->restore_state(state);
+        second->update(data.data() + 3001, data.size() - 3001);
+        EXPECT_EQ(second->hex_digest(), get_hex_digest(algorithm, data))
+            << "algorithm: " << file_transfer::detail::to_string(algorithm);
+
+        EXPECT_THROW(
+            second->restore_state(state.substr(1)), std::invalid_argument
+        );
+    }
+}
+
+TEST(checksum, crc32c_kernels) {
+    // Test that all supported CRC-32C kernels agree, including the
+    // unaligned tails.
+    const auto data = get_test_vector_input(100);
+    for (std::size_t size = 0; size <= data.size(); ++size) {
+        const auto input = data.substr(0, size);
+        const auto expected = get_hex_digest(checksum_algorithm::crc32c, input);
+        for (const auto& kernel :
+             file_transfer::detail::get_supported_crc32c_kernels()) {
+            file_transfer::detail::crc32c_hasher hasher{kernel};
+            hasher.update(input.data(), input.size());
+            EXPECT_EQ(hasher.hex_digest(), expected)
+                << "kernel: " << kernel.name << ", size: " << size;
+        }
+    }
+}
+
+TEST(checksum, file) {
+    // Test the digest of a file, read in chunks.
+    const auto path = test_utils::get_test_data_dir() / "non-empty-file";
+    EXPECT_EQ(
+        file_transfer::detail::get_hex_digest(
+            path, checksum_algorithm::blake3, 7
+        ),
+        file_transfer::detail::get_hex_digest(path, checksum_algorithm::blake3)
+    );
+}
+
+} // namespace
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "chunk_compression.h"
+#include "exception_types.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::chunk_codec;
+using file_transfer::detail::compression_algorithm;
+using test_utils::make_random;
+
+auto make_text(std::size_t size_) -> std::string {
+    std::string text;
+    for (std::size_t i = 0; text.size() < size_; ++i) {
+        text += "node " + std::to_string(i) + " 0.000000e+00 1.000000e+00\n";
+    }
+    text.resize(size_);
+    return text;
+}
+
+class chunk_codec_test
+    : public ::testing::TestWithParam<compression_algorithm> {};
+
+TEST_P(chunk_codec_test, round_trip) {
+    // Test that compressible chunks shrink, and are restored exactly.
+    const chunk_codec codec{{GetParam(), 1}};
+    const auto text = make_text(100000);
+    std::string frame;
+    codec.encode(text.data(), text.size(), frame);
+    EXPECT_EQ(frame[0], static_cast<char>(GetParam()));
+    EXPECT_LT(frame.size(), text.size() / 2);
+    std::string decoded;
+    codec.decode(frame, decoded);
+    EXPECT_EQ(decoded, text);
+}
+
+TEST_P(chunk_codec_test, incompressible_chunk_sent_raw) {
+    // Test that chunks which do not shrink are sent raw.
+    const chunk_codec codec{{GetParam(), 1}};
+    for (const auto& data : {make_random(10000, 42), std::string{"abc"}}) {
+        std::string frame;
+        codec.encode(data.data(), data.size(), frame);
+        EXPECT_EQ(frame.size(), data.size() + 1);
+        EXPECT_EQ(frame[0], '\0');
+        std::string decoded;
+        codec.decode(frame, decoded);
+        EXPECT_EQ(decoded, data);
+    }
+}
+
+TEST_P(chunk_codec_test, malformed_frames) {
+    // Test that malformed frames are rejected.
+    const chunk_codec codec{{GetParam(), 1}};
+    const auto text = make_text(10000);
+    std::string frame;
+    codec.encode(text.data(), text.size(), frame);
+    std::string decoded;
+    for (const auto& malformed :
+         {std::string{}, frame.substr(0, 3), frame.substr(0, frame.size() / 2),
+          std::string{"\x7f"} + frame.substr(1)}) {
+        EXPECT_THROW(
+            codec.decode(malformed, decoded),
+            file_transfer::exceptions::invalid_argument
+        );
+    }
+}
+
+TEST_P(chunk_codec_test, oversized_frames) {
+    // Test that a small frame which claims a large raw chunk is rejected
+    // before the chunk is allocated.
+    const chunk_codec codec{{GetParam(), 1}};
+    const auto make_frame = [&](std::uint32_t raw_size_,
+                                const std::string& payload_) {
+        std::string frame{static_cast<char>(GetParam())};
+        for (std::size_t i = 0; i < 4; ++i) {
+            frame += static_cast<char>((raw_size_ >> (8 * i)) & 0xff);
+        }
+        return frame + payload_;
+    };
+    std::string decoded;
+    for (const auto& frame :
+         {make_frame(0xffffffff, "x"),
+          make_frame(std::uint32_t{1} << 30, std::string(1000, 'x')),
+          make_frame((std::uint32_t{4} << 20) + 1, std::string(4096, 'x')),
+          make_frame(std::uint32_t{4} << 20, "x")}) {
+        EXPECT_THROW(
+            codec.decode(frame, decoded),
+            file_transfer::exceptions::invalid_argument
+        );
+        EXPECT_LT(decoded.capacity(), std::size_t{1} << 20);
+    }
+
+    // The largest chunk which fits into a message is still accepted.
+    const auto text = make_text(std::size_t{4} << 20);
+    std::string frame;
+    codec.encode(text.data(), text.size(), frame);
+    EXPECT_NE(frame[0], '\0');
+    codec.decode(frame, decoded);
+    EXPECT_EQ(decoded, text);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    chunk_compression,
+    chunk_codec_test,
+    ::testing::ValuesIn(
+        file_transfer::detail::get_supported_compression_algorithms()
+    ),
+    [](const auto& info_) {
+        return file_transfer::detail::to_string(info_.param);
+    }
+);
+
+TEST(chunk_compression, names) {
+    // Test that algorithms are identified by their names.
+    for (const auto algorithm :
+         {compression_algorithm::zlib,
+          compression_algorithm::zstd,
+          compression_algorithm::lz4}) {
+        EXPECT_EQ(
+            file_transfer::detail::compression_algorithm_from_string(
+                file_transfer::detail::to_string(algorithm)
+            ),
+            algorithm
+        );
+    }
+    EXPECT_THROW(
+        file_transfer::detail::compression_algorithm_from_string("gzip"),
+        std::invalid_argument
+    );
+    EXPECT_EQ(
+        file_transfer::detail::to_string({compression_algorithm::zlib, 6}),
+        "zlib:6"
+    );
+}
+
+} // namespace
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "chunk_store.h"
+#include "exception_types.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::chunk_store;
+using file_transfer::detail::get_chunk_digest;
+using file_transfer::detail::io_backend;
+using test_utils::make_random;
+
+class chunk_store_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        boost::filesystem::create_directories(m_dir / "files");
+    }
+
+    auto write_file(const std::string& name_, const std::string& data_)
+        -> boost::filesystem::path {
+        const auto path = m_dir / "files" / name_;
+        test_utils::write_file(path, data_);
+        return path;
+    }
+};
+
+TEST_F(chunk_store_test, chunk_digest) {
+    // Test that the digest is the BLAKE3 hash of the chunk.
+    EXPECT_EQ(
+        file_transfer::detail::to_string(get_chunk_digest("abc", 3)),
+        "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85"
+    );
+}
+
+TEST_F(chunk_store_test, insert_read) {
+    // Test that chunks are stored once, and found after a restart while a
+    // manifest references them.
+    const auto data = make_random(5000, 1);
+    chunk_store store{m_dir / "store"};
+    const auto entry = store.insert(data.data(), data.size());
+    EXPECT_EQ(entry.size, data.size());
+    EXPECT_TRUE(store.contains(entry.digest));
+    EXPECT_EQ(store.insert(data.data(), data.size()), entry);
+    EXPECT_EQ(store.num_chunks(), 1U);
+    EXPECT_EQ(store.num_bytes(), data.size());
+    const auto path = write_file("a.bin", data);
+    store.save_manifest(
+        path, *file_transfer::detail::get_file_identity(path), {entry}
+    );
+
+    const chunk_store reopened{m_dir / "store"};
+    EXPECT_EQ(reopened.num_chunks(), 1U);
+    std::string chunk;
+    reopened.read(entry.digest, chunk);
+    EXPECT_EQ(chunk, data);
+
+    const auto missing = get_chunk_digest("other", 5);
+    EXPECT_FALSE(reopened.contains(missing));
+    EXPECT_THROW(
+        reopened.read(missing, chunk),
+        file_transfer::exceptions::failed_precondition
+    );
+}
+
+TEST_F(chunk_store_test, manifest) {
+    // Test that the manifest of a file lists its chunks, and that similar
+    // files share most of their chunks.
+    const auto data = make_random(1'500'000, 2);
+    auto modified = data;
+    modified.replace(700'000, 10, "0123456789");
+    const auto path = write_file("a.bin", data);
+    const auto modified_path = write_file("b.bin", modified);
+
+    chunk_store store{m_dir / "store"};
+    EXPECT_FALSE(store.load_manifest(path));
+    const auto manifest = store.get_manifest(path, io_backend::stream);
+    ASSERT_GT(manifest.size(), 2U);
+    std::string joined;
+    for (const auto& entry : manifest) {
+        std::string chunk;
+        store.read(entry.digest, chunk);
+        joined += chunk;
+    }
+    EXPECT_EQ(joined, data);
+    const auto loaded = store.load_manifest(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(*loaded, manifest);
+
+    const auto num_chunks = store.num_chunks();
+    store.get_manifest(modified_path, io_backend::stream);
+    EXPECT_LE(store.num_chunks(), num_chunks + 2);
+
+    // The manifest is not valid anymore once the file changes.
+    write_file("a.bin", data + "x");
+    EXPECT_FALSE(store.load_manifest(path));
+}
+
+TEST_F(chunk_store_test, transaction) {
+    // Test that the chunks of a transaction are only stored once it is
+    // committed, and removed otherwise.
+    const auto data = make_random(5000, 3);
+    const auto path = write_file("a.bin", data);
+    const auto identity = *file_transfer::detail::get_file_identity(path);
+    chunk_store store{m_dir / "store"};
+    {
+        chunk_store::transaction chunks{store};
+        const auto entry = chunks.insert(data.data(), data.size());
+        EXPECT_FALSE(store.contains(entry.digest));
+    }
+    EXPECT_EQ(store.num_chunks(), 0U);
+    const boost::filesystem::recursive_directory_iterator files{
+        m_dir / "store" / "chunks"
+    };
+    for (const auto& entry : files) {
+        EXPECT_FALSE(boost::filesystem::is_regular_file(entry.path()))
+            << entry.path();
+    }
+
+    chunk_store::transaction chunks{store};
+    const auto entry = chunks.insert(data.data(), data.size());
+    EXPECT_EQ(chunks.insert(data.data(), data.size()), entry);
+    chunks.commit(path, identity, {entry});
+    EXPECT_TRUE(store.contains(entry.digest));
+    EXPECT_EQ(
+        store.load_manifest(path),
+        file_transfer::detail::chunk_manifest{entry}
+    );
+}
+
+TEST_F(chunk_store_test, collect_garbage) {
+    // Test that chunks which no manifest of an unchanged file references
+    // are removed, also when the store is opened.
+    const auto data = make_random(300'000, 4);
+    const auto path = write_file("a.bin", data);
+    chunk_store store{m_dir / "store"};
+    const auto manifest = store.get_manifest(path, io_backend::stream);
+    const auto other = make_random(5000, 5);
+    const auto unreferenced = store.insert(other.data(), other.size());
+    store.collect_garbage();
+    EXPECT_FALSE(store.contains(unreferenced.digest));
+    EXPECT_EQ(store.num_bytes(), data.size());
+    for (const auto& entry : manifest) {
+        EXPECT_TRUE(store.contains(entry.digest));
+    }
+
+    store.insert(other.data(), other.size());
+    EXPECT_EQ(chunk_store{m_dir / "store"}.num_chunks(), manifest.size());
+
+    write_file("a.bin", other);
+    store.collect_garbage();
+    EXPECT_EQ(store.num_chunks(), 0U);
+    EXPECT_EQ(store.num_bytes(), 0U);
+    EXPECT_TRUE(boost::filesystem::is_empty(m_dir / "store" / "manifests"));
+}
+
+TEST_F(chunk_store_test, encode_manifest) {
+    const file_transfer::detail::chunk_manifest manifest{
+        {get_chunk_digest("a", 1), 1}, {get_chunk_digest("bc", 2), 2}
+    };
+    const auto encoded = file_transfer::detail::encode_manifest(manifest);
+    ASSERT_EQ(encoded.size(), 8 + 2 * 36);
+    EXPECT_EQ(encoded.substr(0, 8), std::string("\x03\0\0\0\0\0\0\0", 8));
+    EXPECT_EQ(
+        encoded.substr(44, 32),
+        std::string(
+            reinterpret_cast<const char*>(manifest[1].digest.data()), 32
+        )
+    );
+    EXPECT_EQ(encoded.substr(76, 4), std::string("\x02\0\0\0", 4));
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "content_chunker.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::content_chunker;
+using file_transfer::detail::max_content_chunk_size;
+using file_transfer::detail::min_content_chunk_size;
+using test_utils::make_random;
+
+auto split(const std::string& data_, std::size_t piece_size_)
+    -> std::vector<std::string> {
+    std::vector<std::string> chunks;
+    content_chunker chunker{[&](const char* chunk_, std::size_t size_) {
+        chunks.emplace_back(chunk_, size_);
+    }};
+    for (std::size_t offset = 0; offset < data_.size(); offset += piece_size_) {
+        const auto piece = data_.substr(offset, piece_size_);
+        chunker.update(piece.data(), piece.size());
+    }
+    chunker.finish();
+    return chunks;
+}
+
+TEST(content_chunker, gear_table) {
+    // Test the first entries, which clients must reproduce.
+    const auto& gear = file_transfer::detail::get_gear_table();
+    EXPECT_EQ(gear[0], 0xe220'a839'7b1d'cdafULL);
+    EXPECT_EQ(gear[1], 0x6e78'9e6a'a1b9'65f4ULL);
+}
+
+TEST(content_chunker, chunk_sizes) {
+    // Test that the chunks cover the data, within the size limits.
+    const auto data = make_random(3'000'000, 1);
+    const auto chunks = split(data, 1 << 20);
+    ASSERT_GT(chunks.size(), 10U);
+    std::string joined;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_LE(chunks[i].size(), max_content_chunk_size);
+        if (i + 1 < chunks.size()) {
+            EXPECT_GE(chunks[i].size(), min_content_chunk_size);
+        }
+        joined += chunks[i];
+    }
+    EXPECT_EQ(joined, data);
+
+    // Data without boundaries is cut at the maximum size.
+    const auto zeros = split(std::string(600'000, '\0'), 1 << 16);
+    ASSERT_EQ(zeros.size(), 3U);
+    EXPECT_EQ(zeros[0].size(), max_content_chunk_size);
+}
+
+TEST(content_chunker, independent_of_pieces) {
+    // Test that the boundaries do not depend on how the data is passed.
+    const auto data = make_random(1'000'000, 2);
+    EXPECT_EQ(split(data, 1000), split(data, data.size()));
+    EXPECT_EQ(split(data, 77777), split(data, 1));
+}
+
+TEST(content_chunker, insertion_is_local) {
+    // Test that an insertion only changes the chunks around it.
+    const auto data = make_random(2'000'000, 3);
+    auto modified = data;
+    modified.insert(1'000'000, "inserted");
+    const auto chunks = split(data, 1 << 16);
+    const auto modified_chunks = split(modified, 1 << 16);
+    std::size_t num_shared = 0;
+    for (const auto& chunk : modified_chunks) {
+        num_shared +=
+            std::find(chunks.begin(), chunks.end(), chunk) != chunks.end();
+    }
+    EXPECT_GE(num_shared + 2, chunks.size());
+}
+
+} // namespace
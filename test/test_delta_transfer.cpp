@@ -0,0 +1,307 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "checksum.h"
+#include "chunk_store.h"
+#include "delta_transfer.h"
+#include "exception_types.h"
+#include "file_io.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::checksum_algorithm;
+using file_transfer::detail::compute_block_signatures;
+using file_transfer::detail::delta_decoder;
+using file_transfer::detail::memory_file_reader;
+using file_transfer::detail::rolling_checksum;
+using test_utils::make_random;
+
+auto read_number(const std::string& data_, std::size_t position_, int size_)
+    -> std::uint64_t {
+    std::uint64_t value = 0;
+    for (int i = 0; i < size_; ++i) {
+        value |= static_cast<std::uint64_t>(
+                     static_cast<unsigned char>(data_[position_ + i])
+                 )
+                 << (8 * i);
+    }
+    return value;
+}
+
+auto append_number(std::string& target_, std::uint64_t value_, int size_)
+    -> void {
+    for (int i = 0; i < size_; ++i) {
+        target_.push_back(static_cast<char>((value_ >> (8 * i)) & 0xff));
+    }
+}
+
+auto to_hex(const std::string& bytes_) -> std::string {
+    std::string hex;
+    for (const auto c : bytes_) {
+        char digits[3];
+        std::snprintf(digits, sizeof(digits), "%02x", c & 0xff);
+        hex += digits;
+    }
+    return hex;
+}
+
+auto strong_hex_digest(const char* data_, std::size_t size_) -> std::string {
+    auto hasher = file_transfer::detail::make_hasher(checksum_algorithm::sha1);
+    hasher->update(data_, size_);
+    return hasher->hex_digest();
+}
+
+auto literal(const std::string& data_) -> std::string {
+    std::string instruction(1, '\0');
+    append_number(instruction, data_.size(), 4);
+    return instruction + data_;
+}
+
+auto copy(std::uint64_t first_block_, std::uint32_t num_blocks_)
+    -> std::string {
+    std::string instruction(1, '\1');
+    append_number(instruction, first_block_, 8);
+    append_number(instruction, num_blocks_, 4);
+    return instruction;
+}
+
+/**
+ * Reference encoder, as a client would implement it: matches the full
+ * blocks of the signatures at any offset of the new data.
+ */
+auto encode_delta(const std::string& signatures_, const std::string& data_)
+    -> std::string {
+    const auto block_size =
+        static_cast<std::size_t>(read_number(signatures_, 0, 4));
+    const auto basis_size = read_number(signatures_, 4, 8);
+    const auto digest_size = static_cast<std::size_t>(signatures_[12]);
+    std::unordered_multimap<std::uint32_t, std::pair<std::uint64_t, std::string>>
+        blocks;
+    std::uint64_t index = 0;
+    for (std::size_t position = 13; position < signatures_.size();
+         position += 4 + digest_size, ++index) {
+        // The last block only matches at the end of the data.
+        if ((index + 1) * block_size <= basis_size) {
+            blocks.emplace(
+                static_cast<std::uint32_t>(read_number(signatures_, position, 4)),
+                std::make_pair(
+                    index, to_hex(signatures_.substr(position + 4, digest_size))
+                )
+            );
+        }
+    }
+
+    std::string instructions;
+    std::string pending;
+    std::size_t position = 0;
+    rolling_checksum checksum;
+    bool valid = false;
+    while (position + block_size <= data_.size()) {
+        if (!valid) {
+            checksum = rolling_checksum(data_.data() + position, block_size);
+            valid = true;
+        }
+        bool matched = false;
+        const auto [begin, end] = blocks.equal_range(checksum.value());
+        for (auto it = begin; it != end; ++it) {
+            if (it->second.second ==
+                strong_hex_digest(data_.data() + position, block_size)) {
+                if (!pending.empty()) {
+                    instructions += literal(pending);
+                    pending.clear();
+                }
+                instructions += copy(it->second.first, 1);
+                position += block_size;
+                valid = false;
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            pending.push_back(data_[position]);
+            if (position + block_size < data_.size()) {
+                checksum.roll(data_[position], data_[position + block_size]);
+            }
+            ++position;
+        }
+    }
+    pending += data_.substr(position);
+    if (!pending.empty()) {
+        instructions += literal(pending);
+    }
+    return instructions;
+}
+
+TEST(delta_transfer, rolling_checksum) {
+    // Test that rolling the window gives the checksum of the new window.
+    const auto data = make_random(5000, 1);
+    constexpr std::size_t window = 700;
+    rolling_checksum checksum(data.data(), window);
+    for (std::size_t i = 0; i + window < data.size(); ++i) {
+        checksum.roll(data[i], data[i + window]);
+        ASSERT_EQ(
+            checksum.value(),
+            rolling_checksum(data.data() + i + 1, window).value()
+        );
+    }
+}
+
+TEST(delta_transfer, signatures) {
+    // Test the layout of the signatures, including a short last block.
+    const auto data = make_random(2500, 2);
+    memory_file_reader reader{data};
+    const auto signatures = compute_block_signatures(
+        reader, data.size(), 1024, checksum_algorithm::sha1
+    );
+    ASSERT_EQ(signatures.size(), 13 + 3 * (4 + 20));
+    EXPECT_EQ(read_number(signatures, 0, 4), 1024);
+    EXPECT_EQ(read_number(signatures, 4, 8), 2500);
+    EXPECT_EQ(signatures[12], 20);
+    const auto last = 13 + 2 * 24;
+    EXPECT_EQ(
+        read_number(signatures, last, 4),
+        rolling_checksum(data.data() + 2048, 452).value()
+    );
+    EXPECT_EQ(
+        to_hex(signatures.substr(last + 4, 20)),
+        strong_hex_digest(data.data() + 2048, 452)
+    );
+
+    memory_file_reader empty_reader{std::string{}};
+    const auto empty = compute_block_signatures(
+        empty_reader, 0, 1024, checksum_algorithm::blake3
+    );
+    ASSERT_EQ(empty.size(), 13);
+    EXPECT_EQ(empty[12], 32);
+}
+
+TEST(delta_transfer, round_trip) {
+    // Test that a modified file is reconstructed from a small delta.
+    constexpr std::size_t block_size = 1024;
+    const auto basis = make_random(200000, 3);
+    auto modified = basis;
+    modified.insert(50000, "inserted bytes");
+    modified.replace(120000, 100, make_random(100, 4));
+    modified.erase(160000, 3000);
+    modified += "appended bytes";
+
+    memory_file_reader reader{basis};
+    const auto signatures = compute_block_signatures(
+        reader, basis.size(), block_size, checksum_algorithm::sha1
+    );
+    const auto instructions = encode_delta(signatures, modified);
+    EXPECT_LT(instructions.size(), modified.size() / 20);
+
+    delta_decoder decoder{
+        std::make_shared<memory_file_reader>(basis), basis.size(), block_size
+    };
+    std::string data;
+    decoder.decode(instructions, data);
+    EXPECT_EQ(data, modified);
+}
+
+TEST(delta_transfer, copy_runs) {
+    // Test copies of several blocks, ending with the short last block.
+    const auto basis = make_random(3000, 5);
+    delta_decoder decoder{
+        std::make_shared<memory_file_reader>(basis), basis.size(), 1024
+    };
+    std::string data;
+    decoder.decode(copy(1, 2) + literal("x") + copy(0, 1), data);
+    EXPECT_EQ(data, basis.substr(1024) + "x" + basis.substr(0, 1024));
+    decoder.decode({}, data);
+    EXPECT_TRUE(data.empty());
+}
+
+TEST(delta_transfer, malformed_instructions) {
+    // Test that malformed instructions are rejected.
+    const auto basis = make_random(3000, 6);
+    delta_decoder decoder{
+        std::make_shared<memory_file_reader>(basis), basis.size(), 1024
+    };
+    std::string data;
+    for (const auto& instructions : std::vector<std::string>{
+             copy(3, 1),
+             copy(2, 2),
+             copy(0, 0),
+             copy(0, 1).substr(0, 5),
+             literal("abc").substr(0, 7),
+             std::string("\x02"),
+         }) {
+        EXPECT_THROW(
+            decoder.decode(instructions, data),
+            file_transfer::exceptions::invalid_argument
+        );
+    }
+
+    std::string oversized(1, '\0');
+    append_number(oversized, 0xffffffff, 4);
+    EXPECT_THROW(
+        decoder.decode(oversized, data),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+using delta_transfer_test = test_utils::temporary_directory_test<>;
+
+TEST_F(delta_transfer_test, chunk_references) {
+    // Test that chunks of the chunk store can be referenced, with or
+    // without a basis.
+    const auto store =
+        std::make_shared<file_transfer::detail::chunk_store>(m_dir / "store");
+    const auto chunk = make_random(2000, 7);
+    const auto entry = store->insert(chunk.data(), chunk.size());
+    const auto reference =
+        '\2' + std::string(
+                    reinterpret_cast<const char*>(entry.digest.data()),
+                    entry.digest.size()
+                );
+
+    delta_decoder decoder{store};
+    std::string data;
+    decoder.decode(literal("x") + reference, data);
+    EXPECT_EQ(data, "x" + chunk);
+    EXPECT_THROW(
+        decoder.decode(copy(0, 1), data),
+        file_transfer::exceptions::invalid_argument
+    );
+    auto missing = reference;
+    missing[1] ^= 1;
+    EXPECT_THROW(
+        decoder.decode(missing, data),
+        file_transfer::exceptions::failed_precondition
+    );
+
+    const auto basis = make_random(1024, 8);
+    delta_decoder basis_decoder{
+        std::make_shared<memory_file_reader>(basis), basis.size(), 1024, store
+    };
+    basis_decoder.decode(reference + copy(0, 1), data);
+    EXPECT_EQ(data, chunk + basis);
+    // Without a store, references are unknown instructions.
+    delta_decoder storeless_decoder{
+        std::make_shared<memory_file_reader>(basis), basis.size(), 1024
+    };
+    EXPECT_THROW(
+        storeless_decoder.decode(reference, data),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST(delta_transfer, default_block_size) {
+    using file_transfer::detail::get_default_delta_block_size;
+    EXPECT_EQ(get_default_delta_block_size(0), 2048);
+    EXPECT_EQ(get_default_delta_block_size(std::uint64_t{100} << 20), 10240);
+    EXPECT_EQ(get_default_delta_block_size(std::uint64_t{1} << 50), 1 << 20);
+}
+
+} // namespace
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "checksum.h"
+#include "digest_cache.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::checksum_algorithm;
+using file_transfer::detail::digest_cache;
+using test_utils::read_file;
+using test_utils::write_file;
+
+class digest_cache_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_file = m_dir / "file";
+        write_file(m_file, "content");
+    }
+
+    boost::filesystem::path m_file;
+};
+
+TEST_F(digest_cache_test, hit) {
+    // Test that a cached digest is returned without reading the file.
+    digest_cache cache{16};
+    const auto sha1 = cache.get_hex_digest(m_file, checksum_algorithm::sha1);
+    EXPECT_EQ(
+        sha1,
+        file_transfer::detail::get_hex_digest(m_file, checksum_algorithm::sha1)
+    );
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), sha1);
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::xxh64), std::nullopt);
+
+    cache.insert(m_file, checksum_algorithm::sha1, "cached");
+    EXPECT_EQ(cache.get_hex_digest(m_file, checksum_algorithm::sha1), "cached");
+}
+
+TEST_F(digest_cache_test, modified) {
+    // Test that digests are dropped when the file is modified.
+    digest_cache cache{16};
+    cache.insert(m_file, checksum_algorithm::sha1, "cached");
+    write_file(m_file, "modified content");
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), std::nullopt);
+    EXPECT_EQ(
+        cache.get_hex_digest(m_file, checksum_algorithm::sha1),
+        file_transfer::detail::get_hex_digest(m_file, checksum_algorithm::sha1)
+    );
+}
+
+TEST_F(digest_cache_test, lookup_identity) {
+    // Test that a digest is only returned for the identity it belongs to.
+    digest_cache cache{16};
+    cache.insert(m_file, checksum_algorithm::sha1, "cached");
+    const auto identity = file_transfer::detail::get_file_identity(m_file);
+    ASSERT_TRUE(identity);
+    EXPECT_EQ(cache.lookup(*identity, checksum_algorithm::sha1), "cached");
+
+    auto other_identity = *identity;
+    other_identity.size += 1;
+    EXPECT_EQ(
+        cache.lookup(other_identity, checksum_algorithm::sha1), std::nullopt
+    );
+}
+
+TEST_F(digest_cache_test, invalidate) {
+    // Test that digests can be dropped before a file is overwritten.
+    digest_cache cache{16};
+    cache.insert(m_file, checksum_algorithm::sha1, "cached");
+    cache.invalidate(m_file);
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), std::nullopt);
+}
+
+TEST_F(digest_cache_test, eviction) {
+    // Test that the least recently used file is evicted.
+    const auto other_file = m_dir / "other-file";
+    write_file(other_file, "other content");
+    const auto third_file = m_dir / "third-file";
+    write_file(third_file, "third content");
+
+    digest_cache cache{2};
+    cache.insert(m_file, checksum_algorithm::sha1, "first");
+    cache.insert(other_file, checksum_algorithm::sha1, "second");
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), "first");
+    cache.insert(third_file, checksum_algorithm::sha1, "third");
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), "first");
+    EXPECT_EQ(cache.lookup(other_file, checksum_algorithm::sha1), std::nullopt);
+    EXPECT_EQ(cache.lookup(third_file, checksum_algorithm::sha1), "third");
+}
+
+TEST_F(digest_cache_test, index) {
+    // Test that the digests are persisted in the index file.
+    const auto index_path = m_dir / "index";
+    const auto other_file = m_dir / "other-file";
+    write_file(other_file, "other content");
+    {
+        digest_cache cache{16, index_path};
+        cache.insert(m_file, checksum_algorithm::sha1, "sha1");
+        cache.insert(m_file, checksum_algorithm::blake3, "blake3");
+        cache.insert(other_file, checksum_algorithm::sha1, "other");
+        cache.invalidate(other_file);
+    }
+    digest_cache cache{16, index_path};
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), "sha1");
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::blake3), "blake3");
+    EXPECT_EQ(cache.lookup(other_file, checksum_algorithm::sha1), std::nullopt);
+}
+
+TEST_F(digest_cache_test, index_compaction) {
+    // Test that the index is compacted while the cache is in use, such that
+    // replaced digests do not accumulate.
+    const auto index_path = m_dir / "index";
+    {
+        digest_cache cache{16, index_path};
+        for (int i = 0; i < 5000; ++i) {
+            cache.insert(
+                m_file, checksum_algorithm::sha1, "sha1-" + std::to_string(i)
+            );
+        }
+    }
+    EXPECT_LT(read_file(index_path).size(), 2000U * 64U);
+    digest_cache cache{16, index_path};
+    EXPECT_EQ(cache.lookup(m_file, checksum_algorithm::sha1), "sha1-4999");
+}
+
+TEST_F(digest_cache_test, unwritable_index) {
+    // Test that an index which can not be written is reported when the
+    // cache is constructed.
+    try {
+        const digest_cache cache{16, m_dir / "missing" / "index"};
+        FAIL() << "Expected an exception.";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(
+            std::string{e.what()}.find("Could not write the checksum cache"),
+            std::string::npos
+        );
+    }
+}
+
+} // namespace
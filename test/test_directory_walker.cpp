@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "directory_walker.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::directory_walker;
+using file_transfer::detail::path_filter;
+
+class directory_walker_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        for (const auto* file :
+             {"a.txt", "b.dat", "sub/c.txt", "sub/deep/d.txt", "skip/e.txt"}) {
+            const auto path = m_dir / file;
+            boost::filesystem::create_directories(path.parent_path());
+            test_utils::write_file(path, file);
+        }
+        boost::filesystem::create_directories(m_dir / "empty");
+    }
+
+    /// Walk the tree, and return the sorted paths of the files.
+    auto walk(
+        const path_filter& filter_, boost::asio::thread_pool* thread_pool_
+    ) -> std::vector<std::string> {
+        directory_walker walker{m_dir, filter_, thread_pool_};
+        std::vector<std::string> files;
+        while (const auto entry = walker.next()) {
+            EXPECT_FALSE(entry->error);
+            files.push_back(entry->relative_path);
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+};
+
+TEST_F(directory_walker_test, all_files) {
+    // Test that all files of the tree are found, with or without a thread
+    // pool.
+    const std::vector<std::string> expected{
+        "a.txt", "b.dat", "skip/e.txt", "sub/c.txt", "sub/deep/d.txt"
+    };
+    EXPECT_EQ(walk({}, nullptr), expected);
+    boost::asio::thread_pool thread_pool{4};
+    EXPECT_EQ(walk({}, &thread_pool), expected);
+}
+
+TEST_F(directory_walker_test, filter) {
+    // Test that excluded directories are not walked.
+    boost::asio::thread_pool thread_pool{2};
+    EXPECT_EQ(
+        walk(path_filter{{"*.txt"}, {"skip"}}, &thread_pool),
+        (std::vector<std::string>{"a.txt", "sub/c.txt", "sub/deep/d.txt"})
+    );
+}
+
+TEST_F(directory_walker_test, missing_root) {
+    // Test that a root which can not be listed is reported as an error.
+    directory_walker walker{m_dir / "missing", {}, nullptr};
+    const auto entry = walker.next();
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->relative_path, "");
+    EXPECT_TRUE(entry->error);
+    EXPECT_FALSE(walker.next());
+}
+
+TEST_F(directory_walker_test, stop_early) {
+    // Test that the walker can be destroyed before the walk is complete.
+    boost::asio::thread_pool thread_pool{4};
+    for (int i = 0; i < 20; ++i) {
+        directory_walker walker{m_dir, {}, &thread_pool};
+        EXPECT_TRUE(walker.next());
+    }
+}
+
+} // namespace
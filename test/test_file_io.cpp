@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <ios>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "exception_types.h"
+#include "file_io.h"
+#include "file_reader_pool.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::io_backend;
+
+class file_reader : public test_utils::temporary_directory_test<
+                        ::testing::TestWithParam<io_backend>> {};
+
+class file_writer : public test_utils::temporary_directory_test<
+                        ::testing::TestWithParam<io_backend>> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+    }
+
+    auto write(
+        std::ios_base::openmode mode_,
+        std::streamoff offset_,
+        const std::string& data_
+    ) -> void {
+        const auto buffer = file_transfer::detail::open_file_writer(
+            m_path, mode_ | std::ios_base::binary, GetParam()
+        );
+        std::ostream out{buffer.get()};
+        out.seekp(offset_);
+        out << data_;
+        out.flush();
+        EXPECT_TRUE(out.good());
+        EXPECT_EQ(out.tellp(), offset_ + std::streamoff(data_.size()));
+    }
+
+    boost::filesystem::path m_path;
+};
+
+using test_utils::read_file;
+
+TEST_P(file_reader, chunks) {
+    // Test that chunks read in arbitrary order match the file content.
+    const auto path = test_utils::get_test_data_dir() / "non-empty-file";
+    const auto expected = read_file(path);
+    const auto reader = file_transfer::detail::open_file_reader(
+        path, expected.size(), GetParam()
+    );
+
+    std::string chunk;
+    reader->read(1000, 433, chunk);
+    EXPECT_EQ(chunk, expected.substr(1000, 433));
+    reader->read(0, 100, chunk);
+    EXPECT_EQ(chunk, expected.substr(0, 100));
+    reader->read(100, 900, chunk);
+    EXPECT_EQ(chunk, expected.substr(100, 900));
+}
+
+TEST_P(file_reader, past_end) {
+    // Test that reading past the end of the file fails.
+    const auto path = test_utils::get_test_data_dir() / "non-empty-file";
+    const auto reader = file_transfer::detail::open_file_reader(
+        path, boost::filesystem::file_size(path), GetParam()
+    );
+
+    std::string chunk;
+    EXPECT_THROW(
+        reader->read(1400, 100, chunk), file_transfer::exceptions::internal
+    );
+}
+
+TEST_P(file_reader, emptyfile) {
+    // Test that an empty file can be opened.
+    const auto path = test_utils::get_test_data_dir() / "empty-file";
+    EXPECT_NO_THROW(file_transfer::detail::open_file_reader(path, 0, GetParam())
+    );
+}
+
+TEST_P(file_reader, prefetch) {
+    // Test that prefetching, also past the end of the file, does not
+    // affect the reads.
+    const auto path = test_utils::get_test_data_dir() / "non-empty-file";
+    const auto expected = read_file(path);
+    const auto reader = file_transfer::detail::open_file_reader(
+        path, expected.size(), GetParam()
+    );
+
+    reader->prefetch(100, 500);
+    reader->prefetch(expected.size() - 10, 1000);
+    std::string chunk;
+    reader->read(100, 500, chunk);
+    EXPECT_EQ(chunk, expected.substr(100, 500));
+}
+
+TEST_P(file_reader, pool) {
+    // Test that readers are shared if they support concurrent reads, and
+    // only while they are in use.
+    const auto path = test_utils::get_test_data_dir() / "non-empty-file";
+    const auto file_size = boost::filesystem::file_size(path);
+    file_transfer::detail::file_reader_pool pool;
+
+    auto first = pool.acquire(path, file_size, GetParam());
+    const auto second = pool.acquire(path, file_size, GetParam());
+    if (first->supports_concurrent_reads()) {
+        EXPECT_EQ(first, second);
+        EXPECT_EQ(pool.size(), 1);
+    } else {
+        EXPECT_NE(first, second);
+        EXPECT_EQ(pool.size(), 0);
+    }
+    first.reset();
+    std::string chunk;
+    second->read(0, 10, chunk);
+    EXPECT_EQ(chunk, read_file(path).substr(0, 10));
+}
+
+TEST_P(file_reader, large_chunks) {
+    // Test chunks which are read in several parts, with prefetches which
+    // are used or discarded.
+    const auto path = m_dir / "file";
+    std::string expected(3'000'000, '\0');
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = static_cast<char>(i * 7 % 251);
+    }
+    test_utils::write_file(path, expected);
+    {
+        const auto reader = file_transfer::detail::open_file_reader(
+            path, expected.size(), GetParam()
+        );
+        std::string chunk;
+        reader->read(0, 1'000'000, chunk);
+        EXPECT_EQ(chunk, expected.substr(0, 1'000'000));
+        reader->prefetch(1'000'000, 1'500'000);
+        reader->read(1'000'000, 1'500'000, chunk);
+        EXPECT_EQ(chunk, expected.substr(1'000'000, 1'500'000));
+        reader->prefetch(2'500'000, 500'000);
+        reader->read(100, 2'999'900, chunk);
+        EXPECT_EQ(chunk, expected.substr(100));
+    }
+}
+
+TEST_P(file_writer, sequential) {
+    // Test that data spanning several blocks is written.
+    std::string data(1'000'000, '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i % 253);
+    }
+    write(std::ios_base::out, 0, data);
+    EXPECT_EQ(read_file(m_path), data);
+}
+
+TEST_P(file_writer, positional) {
+    // Test that an existing file is updated in place.
+    write(std::ios_base::out, 0, std::string(1000, 'a'));
+    write(std::ios_base::in | std::ios_base::out, 300, std::string(200, 'b'));
+    EXPECT_EQ(
+        read_file(m_path),
+        std::string(300, 'a') + std::string(200, 'b') + std::string(500, 'a')
+    );
+    write(std::ios_base::out, 0, "c");
+    EXPECT_EQ(read_file(m_path), "c");
+}
+
+TEST_P(file_writer, direct) {
+    // Test that direct writes at unaligned offsets, and of partial blocks,
+    // give the same content as buffered writes.
+    std::string data(3'000'000, '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i % 241);
+    }
+    const auto write_direct = [&](std::ios_base::openmode mode_,
+                                  std::streamoff offset_,
+                                  const std::string& data_) {
+        const auto buffer = file_transfer::detail::open_file_writer(
+            m_path,
+            mode_ | std::ios_base::binary,
+            GetParam(),
+            file_transfer::detail::page_cache_mode::direct
+        );
+        std::ostream out{buffer.get()};
+        out.seekp(offset_);
+        out << data_;
+        out.flush();
+        EXPECT_TRUE(out.good());
+    };
+    write_direct(std::ios_base::out, 0, data.substr(0, 1'000'001));
+    write_direct(
+        std::ios_base::in | std::ios_base::out,
+        1'000'001,
+        data.substr(1'000'001)
+    );
+    write_direct(
+        std::ios_base::in | std::ios_base::out, 5000, data.substr(5000, 10'000)
+    );
+    EXPECT_EQ(read_file(m_path), data);
+}
+
+TEST_P(file_writer, missing_file) {
+    // Test that updating a file which does not exist fails.
+    EXPECT_THROW(
+        file_transfer::detail::open_file_writer(
+            m_path, std::ios_base::in | std::ios_base::out, GetParam()
+        ),
+        file_transfer::exceptions::failed_precondition
+    );
+}
+
+#ifdef _WIN32
+INSTANTIATE_TEST_SUITE_P(
+    backends,
+    file_reader,
+    ::testing::Values(
+        io_backend::stream, io_backend::mmap, io_backend::io_uring
+    )
+);
+#else
+INSTANTIATE_TEST_SUITE_P(
+    backends,
+    file_reader,
+    ::testing::Values(
+        io_backend::stream,
+        io_backend::mmap,
+        io_backend::pread,
+        io_backend::io_uring
+    )
+);
+#endif
+
+INSTANTIATE_TEST_SUITE_P(
+    backends,
+    file_writer,
+    ::testing::Values(io_backend::stream, io_backend::io_uring)
+);
+
+} // namespace
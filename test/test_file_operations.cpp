@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "exception_types.h"
+#include "file_operations.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::copy_file_contents;
+using file_transfer::detail::list_directory;
+using test_utils::read_file;
+
+class file_operations_test : public test_utils::temporary_directory_test<> {
+protected:
+    auto write(const std::string& name_, const std::string& content_)
+        -> boost::filesystem::path {
+        const auto path = m_dir / name_;
+        test_utils::write_file(path, content_);
+        return path;
+    }
+};
+
+TEST_F(file_operations_test, copy_sizes) {
+    // Test that files of various sizes are copied exactly, including sizes
+    // which take more than one chunk of the stream copy.
+    for (const std::size_t size :
+         {std::size_t{0}, std::size_t{1}, std::size_t{4097},
+          std::size_t{3} << 20}) {
+        std::string content(size, '\0');
+        for (std::size_t i = 0; i < size; ++i) {
+            content[i] = static_cast<char>(i * 7 + i / 251);
+        }
+        const auto source = write("source", content);
+        const auto target = m_dir / "target";
+        copy_file_contents(source, target);
+        EXPECT_EQ(read_file(target), content) << "size " << size;
+    }
+}
+
+TEST_F(file_operations_test, copy_truncates_target) {
+    // Test that a larger target is truncated to the size of the source.
+    const auto source = write("source", "short");
+    const auto target = write("target", std::string(100000, 'x'));
+    copy_file_contents(source, target);
+    EXPECT_EQ(read_file(target), "short");
+}
+
+TEST_F(file_operations_test, copy_missing_source) {
+    EXPECT_THROW(
+        copy_file_contents(m_dir / "missing", m_dir / "target"),
+        file_transfer::exceptions::not_found
+    );
+    EXPECT_FALSE(boost::filesystem::exists(m_dir / "target"));
+}
+
+TEST_F(file_operations_test, copy_onto_itself) {
+    // Test that a file is not copied onto itself, which would truncate it,
+    // also through a link.
+    const auto source = write("source", "content");
+    EXPECT_THROW(
+        copy_file_contents(source, source),
+        file_transfer::exceptions::invalid_argument
+    );
+    boost::filesystem::create_hard_link(source, m_dir / "hard-link");
+    EXPECT_THROW(
+        copy_file_contents(source, m_dir / "hard-link"),
+        file_transfer::exceptions::invalid_argument
+    );
+    boost::filesystem::create_symlink("source", m_dir / "symlink");
+    EXPECT_THROW(
+        copy_file_contents(m_dir / "symlink", source),
+        file_transfer::exceptions::invalid_argument
+    );
+    EXPECT_EQ(read_file(source), "content");
+}
+
+TEST_F(file_operations_test, list_directory) {
+    // Test that the entries are sorted by name, with their kind and size.
+    write("b.txt", "12345");
+    write("a.txt", "");
+    boost::filesystem::create_directories(m_dir / "sub");
+    const std::string expected{
+        "f\t0\ta.txt\0f\t5\tb.txt\0d\t0\tsub\0", 28
+    };
+    EXPECT_EQ(list_directory(m_dir), expected);
+}
+
+TEST_F(file_operations_test, list_directory_errors) {
+    EXPECT_THROW(
+        list_directory(m_dir / "missing"), file_transfer::exceptions::not_found
+    );
+    const auto file = write("file", "content");
+    EXPECT_THROW(
+        list_directory(file), file_transfer::exceptions::failed_precondition
+    );
+}
+
+} // namespace
@@ -0,0 +1,369 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem/path.hpp>
+#include <grpcpp/client_context.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include "filetransfer_callback_service.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+
+#include "test_utils.h"
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+namespace metadata = file_transfer::metadata;
+
+using file_transfer::Progress;
+using test_utils::get_sha1;
+using test_utils::read_file;
+using test_utils::write_file;
+
+using client_metadata_t = std::map<std::string, std::string>;
+
+/**
+ * @brief Responses and outcome of a call.
+ */
+template <typename Response>
+struct call_result {
+    std::vector<Response> responses;
+    ::grpc::Status status;
+    /// Value of the batch_errors_key in the trailing metadata, if any.
+    std::optional<std::string> batch_errors;
+
+    /// Data of the chunks among the responses, in the order they were sent.
+    [[nodiscard]] auto data() const -> std::string {
+        std::string result;
+        for (const auto& response : responses) {
+            result += response.file_data().data();
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Send all requests of a call, and receive all responses.
+ *
+ * The requests are sent from another thread, since a write over the
+ * in-process channel only completes once the server has read it.
+ */
+template <typename Request, typename Response>
+auto complete_call(
+    ::grpc::ClientContext& context_,
+    ::grpc::ClientReaderWriter<Request, Response>& stream_,
+    const std::vector<Request>& requests_
+) -> call_result<Response> {
+    std::thread writer{[&]() {
+        for (const auto& request : requests_) {
+            if (!stream_.Write(request)) {
+                return;
+            }
+        }
+        stream_.WritesDone();
+    }};
+    call_result<Response> result;
+    Response response;
+    while (stream_.Read(&response)) {
+        result.responses.push_back(response);
+    }
+    writer.join();
+    result.status = stream_.Finish();
+    const auto& trailing_metadata = context_.GetServerTrailingMetadata();
+    const auto it = trailing_metadata.find(metadata::batch_errors_key);
+    if (it != trailing_metadata.end()) {
+        result.batch_errors = std::string{it->second.data(), it->second.size()};
+    }
+    return result;
+}
+
+auto make_download_initialize(
+    const boost::filesystem::path& path_, std::int64_t chunk_size_ = 4
+) -> api::DownloadFileRequest {
+    api::DownloadFileRequest request;
+    auto& initialize = *request.mutable_initialize();
+    initialize.set_filename(path_.string());
+    initialize.set_chunk_size(chunk_size_);
+    initialize.set_compute_sha1_checksum(true);
+    return request;
+}
+
+auto make_receive_data() -> api::DownloadFileRequest {
+    api::DownloadFileRequest request;
+    request.mutable_receive_data();
+    return request;
+}
+
+auto make_download_finalize() -> api::DownloadFileRequest {
+    api::DownloadFileRequest request;
+    request.mutable_finalize();
+    return request;
+}
+
+/// Requests of a download of a whole file.
+auto make_download(const boost::filesystem::path& path_)
+    -> std::vector<api::DownloadFileRequest> {
+    return {
+        make_download_initialize(path_),
+        make_receive_data(),
+        make_download_finalize()
+    };
+}
+
+/// Requests of an upload of a file in chunks of four bytes.
+auto make_upload(
+    const boost::filesystem::path& path_,
+    const std::string& content_,
+    const std::string& hex_digest_
+) -> std::vector<api::UploadFileRequest> {
+    std::vector<api::UploadFileRequest> requests(1);
+    auto& file_info = *requests[0].mutable_initialize()->mutable_file_info();
+    file_info.set_name(path_.string());
+    file_info.set_size(static_cast<std::int64_t>(content_.size()));
+    file_info.mutable_sha1()->set_hex_digest(hex_digest_);
+    for (std::size_t offset = 0; offset < content_.size(); offset += 4) {
+        auto& file_data =
+            *requests.emplace_back().mutable_send_data()->mutable_file_data();
+        file_data.set_offset(static_cast<std::int64_t>(offset));
+        file_data.set_data(content_.substr(offset, 4));
+    }
+    requests.emplace_back().mutable_finalize();
+    return requests;
+}
+
+/**
+ * @brief Fixture which serves the callback service in process.
+ *
+ * The parameter selects whether the steps of the sessions run on a session
+ * thread pool, or on the callback threads of gRPC.
+ */
+class callback_service_test : public test_utils::temporary_directory_test<
+                                  ::testing::TestWithParam<bool>> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        if (GetParam()) {
+            m_options.session_thread_pool =
+                std::make_shared<boost::asio::thread_pool>(2);
+        }
+        m_service =
+            std::make_unique<file_transfer::FileTransferCallbackServiceImpl>(
+                m_options
+            );
+        ::grpc::ServerBuilder builder;
+        builder.RegisterService(m_service.get());
+        m_server = builder.BuildAndStart();
+        m_stub = api::FileTransferService::NewStub(
+            m_server->InProcessChannel(::grpc::ChannelArguments{})
+        );
+    }
+
+    void TearDown() override {
+        // Shutting down waits until the reactors of all calls are done.
+        m_server->Shutdown();
+        m_server->Wait();
+        if (m_options.session_thread_pool) {
+            m_options.session_thread_pool->join();
+        }
+        temporary_directory_test::TearDown();
+    }
+
+    auto download(
+        const std::vector<api::DownloadFileRequest>& requests_,
+        const client_metadata_t& metadata_ = {}
+    ) -> call_result<api::DownloadFileResponse> {
+        ::grpc::ClientContext context;
+        for (const auto& [key, value] : metadata_) {
+            context.AddMetadata(key, value);
+        }
+        const auto stream = m_stub->DownloadFile(&context);
+        return complete_call(context, *stream, requests_);
+    }
+
+    auto upload(
+        const std::vector<api::UploadFileRequest>& requests_,
+        const client_metadata_t& metadata_ = {}
+    ) -> call_result<api::UploadFileResponse> {
+        ::grpc::ClientContext context;
+        for (const auto& [key, value] : metadata_) {
+            context.AddMetadata(key, value);
+        }
+        const auto stream = m_stub->UploadFile(&context);
+        return complete_call(context, *stream, requests_);
+    }
+
+    file_transfer::ServiceOptions m_options;
+    std::unique_ptr<file_transfer::FileTransferCallbackServiceImpl> m_service;
+    std::unique_ptr<::grpc::Server> m_server;
+    std::unique_ptr<api::FileTransferService::Stub> m_stub;
+};
+
+TEST_P(callback_service_test, download) {
+    // Test that a download sends the file info, the chunks, and the
+    // response to the finalize step, and then finishes the call.
+    const std::string content = "0123456789";
+    write_file(m_dir / "file", content);
+    const auto result = download(make_download(m_dir / "file"));
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+    ASSERT_EQ(result.responses.size(), 5U);
+    EXPECT_EQ(result.responses[0].file_info().size(), 10);
+    EXPECT_EQ(
+        result.responses[0].file_info().sha1().hex_digest(), get_sha1(content)
+    );
+    EXPECT_EQ(result.data(), content);
+    EXPECT_EQ(result.responses[4].progress().state(), Progress::COMPLETED);
+}
+
+TEST_P(callback_service_test, failed_steps) {
+    // Test that a step which throws finishes the call with its status.
+    const auto missing = download(make_download(m_dir / "missing"));
+    EXPECT_EQ(missing.status.error_code(), ::grpc::NOT_FOUND);
+    EXPECT_TRUE(missing.responses.empty());
+
+    write_file(m_dir / "file", "content");
+    const auto wrong_step = download({make_receive_data()});
+    EXPECT_EQ(wrong_step.status.error_code(), ::grpc::INVALID_ARGUMENT);
+
+    // The client stops sending after the initialize step.
+    const auto stopped = download({make_download_initialize(m_dir / "file")});
+    EXPECT_EQ(stopped.status.error_code(), ::grpc::INVALID_ARGUMENT);
+    EXPECT_EQ(stopped.responses.size(), 1U);
+}
+
+TEST_P(callback_service_test, upload) {
+    // Test that an upload is written, and its checksum verified.
+    const std::string content = "first part, second part";
+    const auto result =
+        upload(make_upload(m_dir / "file", content, get_sha1(content)));
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+    ASSERT_FALSE(result.responses.empty());
+    EXPECT_EQ(result.responses[0].progress().state(), Progress::INITIALIZED);
+    EXPECT_EQ(
+        result.responses.back().progress().state(), Progress::COMPLETED
+    );
+    EXPECT_EQ(read_file(m_dir / "file"), content);
+
+    const auto mismatch =
+        upload(make_upload(m_dir / "other", content, get_sha1("other")));
+    EXPECT_EQ(mismatch.status.error_code(), ::grpc::DATA_LOSS);
+}
+
+TEST_P(callback_service_test, cancelled_download) {
+    // Test that a download which the client cancels while chunks are sent
+    // ends, and that the server continues to serve other calls.
+    const auto content = test_utils::make_random(1 << 20, 1);
+    write_file(m_dir / "file", content);
+    {
+        ::grpc::ClientContext context;
+        const auto stream = m_stub->DownloadFile(&context);
+        ASSERT_TRUE(stream->Write(make_download_initialize(m_dir / "file", 1)));
+        api::DownloadFileResponse response;
+        ASSERT_TRUE(stream->Read(&response));
+        ASSERT_TRUE(stream->Write(make_receive_data()));
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(stream->Read(&response));
+        }
+        context.TryCancel();
+        while (stream->Read(&response)) {
+        }
+        EXPECT_EQ(stream->Finish().error_code(), ::grpc::CANCELLED);
+    }
+    const auto result = download(make_download(m_dir / "file"));
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+}
+
+TEST_P(callback_service_test, concurrent_calls) {
+    // Test that many concurrent calls, more than there are threads, are
+    // served.
+    const auto content = test_utils::make_random(10000, 2);
+    write_file(m_dir / "file", content);
+    std::atomic<int> num_failures{0};
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 32; ++i) {
+        clients.emplace_back([&, i]() {
+            const auto path = m_dir / ("upload-" + std::to_string(i));
+            if (i % 2 == 0) {
+                const auto result = download(make_download(m_dir / "file"));
+                if (!result.status.ok() || result.data() != content) {
+                    ++num_failures;
+                }
+            } else {
+                const auto result =
+                    upload(make_upload(path, content, get_sha1(content)));
+                if (!result.status.ok() || read_file(path) != content) {
+                    ++num_failures;
+                }
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    EXPECT_EQ(num_failures, 0);
+}
+
+TEST_P(callback_service_test, operation) {
+    // Test that an operation on a server file is answered, and finishes
+    // the call without a finalize step.
+    write_file(m_dir / "file", "content");
+    const auto result = download(
+        {make_download_initialize(m_dir / "file")},
+        {{metadata::operation_key, "stat"}}
+    );
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+    ASSERT_EQ(result.responses.size(), 1U);
+    EXPECT_EQ(result.responses[0].file_info().size(), 7);
+}
+
+TEST_P(callback_service_test, batch_download) {
+    // Test that a batch download sends all files, and reports the failed
+    // ones in the trailing metadata.
+    write_file(m_dir / "first", "first");
+    write_file(m_dir / "second", "second");
+    const auto result = download(
+        {make_download_initialize(m_dir / "first"),
+         make_download_initialize(m_dir / "missing"),
+         make_download_initialize(m_dir / "second"),
+         make_download_finalize()},
+        {{metadata::batch_key, "true"}}
+    );
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+    EXPECT_EQ(result.data(), "firstsecond");
+    EXPECT_EQ(result.batch_errors, "1:5");
+}
+
+TEST_P(callback_service_test, batch_upload) {
+    // Test that a batch upload writes all files in one call.
+    auto requests = make_upload(m_dir / "first", "first", get_sha1("first"));
+    requests.pop_back();
+    auto second = make_upload(m_dir / "second", "second", get_sha1("second"));
+    requests.insert(requests.end(), second.begin(), second.end());
+    const auto result = upload(requests, {{metadata::batch_key, "true"}});
+    ASSERT_TRUE(result.status.ok()) << result.status.error_message();
+    EXPECT_EQ(result.batch_errors, std::nullopt);
+    EXPECT_EQ(read_file(m_dir / "first"), "first");
+    EXPECT_EQ(read_file(m_dir / "second"), "second");
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    session_threads,
+    callback_service_test,
+    ::testing::Bool(),
+    [](const ::testing::TestParamInfo<bool>& info_) {
+        return info_.param ? "thread_pool" : "callback_threads";
+    }
+);
+
+} // namespace
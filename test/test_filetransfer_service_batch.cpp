@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "exception_types.h"
+#include "filetransfer_service_batch.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+
+#include "test_utils.h"
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+namespace metadata = file_transfer::metadata;
+
+using file_transfer::Progress;
+using file_transfer::batch_impl::batch_errors;
+using test_utils::get_sha1;
+using test_utils::get_temporary_files;
+using test_utils::read_file;
+using test_utils::server_context;
+using test_utils::write_file;
+
+TEST(batch_errors, empty) {
+    // Test that a batch without failures has an empty list.
+    const batch_errors errors;
+    EXPECT_EQ(errors.size(), 0U);
+    EXPECT_EQ(errors.to_string(), "");
+}
+
+TEST(batch_errors, to_string) {
+    // Test that the failed files are listed with their status codes.
+    batch_errors errors;
+    errors.add(3, ::grpc::Status{::grpc::NOT_FOUND, "missing"});
+    errors.add(17, ::grpc::Status{::grpc::DATA_LOSS, "checksum"});
+    EXPECT_EQ(errors.size(), 2U);
+    EXPECT_EQ(errors.to_string(), "3:5,17:15");
+}
+
+TEST(batch_errors, limit) {
+    // Test that only the first failures are listed, but all are counted.
+    batch_errors errors;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        errors.add(i, ::grpc::Status{::grpc::INTERNAL, ""});
+    }
+    EXPECT_EQ(errors.size(), 1000U);
+    const auto listed = errors.to_string();
+    EXPECT_EQ(listed.rfind("0:13,1:13", 0), 0U);
+    EXPECT_NE(listed.find("99:13"), std::string::npos);
+    EXPECT_EQ(listed.find("100:13"), std::string::npos);
+}
+
+/// Value of the batch_errors_key in the trailing metadata.
+auto get_errors(const server_context& context_)
+    -> std::optional<std::string> {
+    return context_.get_trailing_metadata(metadata::batch_errors_key);
+}
+
+class batch_upload_test : public test_utils::temporary_directory_test<> {
+protected:
+    /// Send an initialize request, and return whether a response is sent.
+    auto start_file(
+        const boost::filesystem::path& path_,
+        std::size_t size_,
+        const std::string& hex_digest_ = {}
+    ) -> bool {
+        api::UploadFileRequest request;
+        auto& file_info = *request.mutable_initialize()->mutable_file_info();
+        file_info.set_name(path_.string());
+        file_info.set_size(static_cast<std::int64_t>(size_));
+        file_info.mutable_sha1()->set_hex_digest(hex_digest_);
+        return m_session.receive(request, m_response);
+    }
+
+    auto send(std::size_t offset_, const std::string& data_) -> bool {
+        api::UploadFileRequest request;
+        auto& file_data = *request.mutable_send_data()->mutable_file_data();
+        file_data.set_offset(static_cast<std::int64_t>(offset_));
+        file_data.set_data(data_);
+        return m_session.receive(request, m_response);
+    }
+
+    auto finalize() -> bool {
+        api::UploadFileRequest request;
+        request.mutable_finalize();
+        return m_session.receive(request, m_response);
+    }
+
+    [[nodiscard]] auto state() const -> std::int32_t {
+        return m_response.progress().state();
+    }
+
+    file_transfer::ServiceOptions m_options;
+    server_context m_context{{{metadata::batch_key, "true"}}};
+    file_transfer::batch_impl::upload_session m_session{
+        m_options, m_context.get()
+    };
+    api::UploadFileResponse m_response;
+};
+
+TEST_F(batch_upload_test, failed_file_continues) {
+    // Test that a file with a wrong checksum fails without ending the
+    // batch, and is listed in the trailing metadata.
+    m_options.atomic_uploads = true;
+    EXPECT_FALSE(start_file(m_dir / "first", 5, get_sha1("first")));
+    EXPECT_TRUE(send(0, "first"));
+    EXPECT_EQ(state(), Progress::COMPLETED);
+
+    EXPECT_FALSE(start_file(m_dir / "second", 6, get_sha1("other")));
+    EXPECT_FALSE(send(0, "sec"));
+    EXPECT_TRUE(send(3, "ond"));
+    EXPECT_EQ(state(), Progress::INITIALIZED);
+    // The temporary file of the failed file is discarded.
+    EXPECT_FALSE(boost::filesystem::exists(m_dir / "second"));
+    EXPECT_TRUE(get_temporary_files(m_dir).empty());
+
+    EXPECT_FALSE(start_file(m_dir / "missing" / "third", 5));
+    EXPECT_TRUE(send(0, "third"));
+    EXPECT_EQ(state(), Progress::INITIALIZED);
+
+    EXPECT_FALSE(start_file(m_dir / "fourth", 6));
+    EXPECT_TRUE(send(0, "fourth"));
+    EXPECT_EQ(state(), Progress::COMPLETED);
+
+    EXPECT_TRUE(finalize());
+    EXPECT_EQ(state(), Progress::COMPLETED);
+    EXPECT_TRUE(m_session.finished());
+    EXPECT_EQ(read_file(m_dir / "first"), "first");
+    EXPECT_EQ(read_file(m_dir / "fourth"), "fourth");
+    EXPECT_EQ(get_errors(m_context), "1:15,2:9");
+}
+
+TEST_F(batch_upload_test, empty_file) {
+    // Test that a file without data is complete after its initialize
+    // request.
+    write_file(m_dir / "empty", "old content");
+    EXPECT_TRUE(start_file(m_dir / "empty", 0));
+    EXPECT_EQ(state(), Progress::COMPLETED);
+    EXPECT_TRUE(finalize());
+    EXPECT_EQ(read_file(m_dir / "empty"), "");
+    EXPECT_EQ(get_errors(m_context), std::nullopt);
+}
+
+TEST_F(batch_upload_test, protocol_violations) {
+    // Test that chunks at the wrong offset or beyond the end of the file
+    // end the batch.
+    EXPECT_THROW(send(0, "data"), file_transfer::exceptions::invalid_argument);
+    start_file(m_dir / "file", 4);
+    EXPECT_THROW(send(1, "data"), file_transfer::exceptions::invalid_argument);
+    EXPECT_THROW(
+        send(0, "too much data"), file_transfer::exceptions::invalid_argument
+    );
+    EXPECT_THROW(finalize(), file_transfer::exceptions::invalid_argument);
+    EXPECT_THROW(
+        start_file(m_dir / "other", 4),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(batch_upload_test, incomplete_file_discarded) {
+    // Test that the temporary file of a file which was not completed is
+    // removed with the session, and the target is kept.
+    m_options.atomic_uploads = true;
+    write_file(m_dir / "file", "old content");
+    {
+        file_transfer::batch_impl::upload_session session{
+            m_options, m_context.get()
+        };
+        api::UploadFileRequest request;
+        auto& file_info = *request.mutable_initialize()->mutable_file_info();
+        file_info.set_name((m_dir / "file").string());
+        file_info.set_size(8);
+        session.receive(request, m_response);
+        request.mutable_send_data()->mutable_file_data()->set_data("new");
+        session.receive(request, m_response);
+        EXPECT_EQ(get_temporary_files(m_dir).size(), 1U);
+    }
+    EXPECT_TRUE(get_temporary_files(m_dir).empty());
+    EXPECT_EQ(read_file(m_dir / "file"), "old content");
+}
+
+class batch_download_test : public test_utils::temporary_directory_test<> {
+protected:
+    auto request_file(
+        const boost::filesystem::path& path_, std::int64_t chunk_size_ = 4
+    ) -> void {
+        api::DownloadFileRequest request;
+        auto& initialize = *request.mutable_initialize();
+        initialize.set_filename(path_.string());
+        initialize.set_chunk_size(chunk_size_);
+        initialize.set_compute_sha1_checksum(true);
+        m_session.receive(request);
+    }
+
+    auto finalize() -> void {
+        api::DownloadFileRequest request;
+        request.mutable_finalize();
+        m_session.receive(request);
+    }
+
+    /// Collect the responses until the next request is needed.
+    auto responses() -> std::vector<api::DownloadFileResponse> {
+        std::vector<api::DownloadFileResponse> result;
+        api::DownloadFileResponse response;
+        while (m_session.next_response(response)) {
+            result.push_back(response);
+        }
+        return result;
+    }
+
+    file_transfer::ServiceOptions m_options;
+    server_context m_context{{{metadata::batch_key, "true"}}};
+    file_transfer::batch_impl::download_session m_session{
+        m_options, m_context.get()
+    };
+};
+
+TEST_F(batch_download_test, response_order) {
+    // Test that each file is sent as its file info followed by its chunks,
+    // and that the batch ends with the response to the finalize request.
+    write_file(m_dir / "file", "0123456789");
+    request_file(m_dir / "file");
+    const auto file = responses();
+    ASSERT_EQ(file.size(), 4U);
+    EXPECT_TRUE(file[0].has_file_info());
+    EXPECT_EQ(file[0].file_info().size(), 10);
+    EXPECT_EQ(file[0].file_info().sha1().hex_digest(), get_sha1("0123456789"));
+    EXPECT_EQ(file[0].progress().state(), Progress::INITIALIZED);
+    std::string data;
+    for (std::size_t i = 1; i < file.size(); ++i) {
+        ASSERT_TRUE(file[i].has_file_data());
+        EXPECT_EQ(
+            file[i].file_data().offset(), static_cast<std::int64_t>(data.size())
+        );
+        data += file[i].file_data().data();
+    }
+    EXPECT_EQ(data, "0123456789");
+    EXPECT_EQ(file.back().progress().state(), Progress::COMPLETED);
+
+    request_file(m_dir / "missing");
+    const auto missing = responses();
+    ASSERT_EQ(missing.size(), 1U);
+    EXPECT_EQ(missing[0].file_info().size(), -1);
+
+    write_file(m_dir / "empty", "");
+    request_file(m_dir / "empty");
+    const auto empty = responses();
+    ASSERT_EQ(empty.size(), 1U);
+    EXPECT_EQ(empty[0].file_info().size(), 0);
+
+    finalize();
+    const auto end = responses();
+    ASSERT_EQ(end.size(), 1U);
+    EXPECT_FALSE(end[0].has_file_info());
+    EXPECT_FALSE(end[0].has_file_data());
+    EXPECT_EQ(end[0].progress().state(), Progress::COMPLETED);
+    EXPECT_TRUE(m_session.finished());
+    EXPECT_EQ(get_errors(m_context), "1:5");
+    EXPECT_THROW(
+        request_file(m_dir / "file"),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(batch_download_test, file_shrinks) {
+    // Test that a file which fails while it is sent is reported, and does
+    // not end the batch. The chunks are larger than the buffer of the file
+    // stream, such that they are read from the file.
+    const std::int64_t chunk_size = 1 << 16;
+    write_file(m_dir / "file", std::string(4 * chunk_size, 'x'));
+    request_file(m_dir / "file", chunk_size);
+    api::DownloadFileResponse response;
+    ASSERT_TRUE(m_session.next_response(response));
+    EXPECT_EQ(response.file_info().size(), 4 * chunk_size);
+    ASSERT_TRUE(m_session.next_response(response));
+    EXPECT_EQ(response.file_data().offset(), 0);
+    boost::filesystem::resize_file(m_dir / "file", chunk_size + 10);
+    EXPECT_TRUE(responses().empty());
+
+    write_file(m_dir / "other", "other");
+    request_file(m_dir / "other");
+    const auto other = responses();
+    ASSERT_EQ(other.size(), 3U);
+    EXPECT_EQ(other.back().progress().state(), Progress::COMPLETED);
+
+    finalize();
+    ASSERT_EQ(responses().size(), 1U);
+    EXPECT_TRUE(m_session.finished());
+    EXPECT_EQ(get_errors(m_context), "0:13");
+}
+
+} // namespace
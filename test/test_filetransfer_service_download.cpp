@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "checksum.h"
+#include "digest_cache.h"
+#include "exception_types.h"
+#include "filetransfer_service_download.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+
+#include "test_utils.h"
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+namespace metadata = file_transfer::metadata;
+
+using file_transfer::Progress;
+using file_transfer::download_impl::session;
+using test_utils::get_sha1;
+using test_utils::server_context;
+using test_utils::write_file;
+
+/**
+ * @brief Responses of a download, by step.
+ */
+struct download_result {
+    api::DownloadFileResponse initialize;
+    std::vector<api::DownloadFileResponse> chunks;
+    api::DownloadFileResponse finalize;
+
+    /// Data of the chunks, in the order in which they were sent.
+    [[nodiscard]] auto data() const -> std::string {
+        std::string result;
+        for (const auto& chunk : chunks) {
+            result += chunk.file_data().data();
+        }
+        return result;
+    }
+
+    /// Offsets of the chunks, in the order in which they were sent.
+    [[nodiscard]] auto offsets() const -> std::vector<std::int64_t> {
+        std::vector<std::int64_t> result;
+        for (const auto& chunk : chunks) {
+            result.push_back(chunk.file_data().offset());
+        }
+        return result;
+    }
+};
+
+class download_session_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+        write_file(m_path, m_content);
+    }
+
+    /// Run all steps of a download of the file.
+    auto download(server_context& context_, std::int64_t chunk_size_)
+        -> download_result {
+        session download{m_options, context_.get()};
+        download_result result;
+        download.initialize(make_initialize(chunk_size_), result.initialize);
+        api::DownloadFileRequest request;
+        request.mutable_receive_data();
+        download.start_transfer(request);
+        api::DownloadFileResponse response;
+        while (download.next_chunk(response)) {
+            result.chunks.push_back(response);
+            response.Clear();
+        }
+        request.mutable_finalize();
+        download.finalize(request, result.finalize);
+        return result;
+    }
+
+    /// Run the initialize step of a download of the file.
+    auto initialize(server_context& context_) -> void {
+        session download{m_options, context_.get()};
+        api::DownloadFileResponse response;
+        download.initialize(make_initialize(4), response);
+    }
+
+    [[nodiscard]] auto make_initialize(std::int64_t chunk_size_) const
+        -> api::DownloadFileRequest {
+        api::DownloadFileRequest request;
+        auto& initialize = *request.mutable_initialize();
+        initialize.set_filename(m_path.string());
+        initialize.set_chunk_size(chunk_size_);
+        initialize.set_compute_sha1_checksum(true);
+        return request;
+    }
+
+    file_transfer::ServiceOptions m_options;
+    std::string m_content = "0123456789abcdef";
+    boost::filesystem::path m_path;
+};
+
+TEST_F(download_session_test, whole_file) {
+    // Test that the file is sent in chunks of the requested size, with its
+    // checksum in the response to the initialize step.
+    server_context context;
+    const auto result = download(context, 5);
+    EXPECT_EQ(result.initialize.file_info().size(), 16);
+    EXPECT_EQ(
+        result.initialize.file_info().sha1().hex_digest(), get_sha1(m_content)
+    );
+    EXPECT_EQ(result.initialize.progress().state(), Progress::INITIALIZED);
+    EXPECT_EQ(result.data(), m_content);
+    EXPECT_EQ(result.offsets(), (std::vector<std::int64_t>{0, 5, 10, 15}));
+    EXPECT_EQ(result.chunks[2].progress().state(), 62);
+    EXPECT_EQ(result.chunks.back().progress().state(), Progress::COMPLETED);
+    EXPECT_EQ(result.finalize.file_info().sha1().hex_digest(), "");
+    EXPECT_EQ(result.finalize.progress().state(), Progress::COMPLETED);
+    EXPECT_EQ(context.get_initial_metadata(metadata::ranges_key), std::nullopt);
+}
+
+TEST_F(download_session_test, missing_file) {
+    // Test that a download of a file which does not exist fails.
+    m_path = m_dir / "missing";
+    server_context context;
+    EXPECT_THROW(initialize(context), file_transfer::exceptions::not_found);
+}
+
+TEST_F(download_session_test, ranges) {
+    // Test that only the requested ranges are sent, in the given order,
+    // and that they are confirmed in the initial metadata.
+    server_context context{{{metadata::ranges_key, "10:3,0:2,14:"}}};
+    const auto result = download(context, 2);
+    EXPECT_EQ(result.initialize.file_info().size(), 16);
+    EXPECT_EQ(result.data(), "abc01ef");
+    EXPECT_EQ(result.offsets(), (std::vector<std::int64_t>{10, 12, 0, 14}));
+    EXPECT_EQ(result.chunks.back().progress().state(), Progress::COMPLETED);
+    EXPECT_EQ(
+        context.get_initial_metadata(metadata::ranges_key), "10:3,0:2,14:2"
+    );
+
+    server_context past_end{{{metadata::ranges_key, "10:10"}}};
+    EXPECT_THROW(
+        initialize(past_end), file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(download_session_test, stripes) {
+    // Test that the stripes of a download together cover the file once.
+    std::string assembled(m_content.size(), '\0');
+    std::size_t num_bytes = 0;
+    for (int i = 0; i < 3; ++i) {
+        const auto stripe = std::to_string(i) + "/3";
+        server_context context{{{metadata::stripe_key, stripe}}};
+        const auto result = download(context, 4);
+        EXPECT_EQ(context.get_initial_metadata(metadata::stripe_key), stripe);
+        EXPECT_TRUE(
+            context.get_initial_metadata(metadata::ranges_key).has_value()
+        );
+        for (const auto& chunk : result.chunks) {
+            const auto& data = chunk.file_data().data();
+            assembled.replace(
+                static_cast<std::size_t>(chunk.file_data().offset()),
+                data.size(),
+                data
+            );
+            num_bytes += data.size();
+        }
+    }
+    EXPECT_EQ(assembled, m_content);
+    EXPECT_EQ(num_bytes, m_content.size());
+
+    server_context both{
+        {{metadata::stripe_key, "0/2"}, {metadata::ranges_key, "0:4"}}
+    };
+    EXPECT_THROW(initialize(both), file_transfer::exceptions::invalid_argument);
+}
+
+TEST_F(download_session_test, streaming_checksum) {
+    // Test that a streaming checksum is sent in the response to the
+    // finalize step, and is cached for the next download.
+    m_options.digest_cache =
+        std::make_shared<file_transfer::detail::digest_cache>(16);
+    for (int i = 0; i < 2; ++i) {
+        server_context context{{{metadata::checksum_mode_key, "streaming"}}};
+        const auto result = download(context, 4);
+        EXPECT_EQ(
+            context.get_initial_metadata(metadata::checksum_mode_key),
+            "streaming"
+        );
+        EXPECT_EQ(result.initialize.file_info().sha1().hex_digest(), "");
+        EXPECT_EQ(result.data(), m_content);
+        EXPECT_EQ(
+            result.finalize.file_info().sha1().hex_digest(),
+            get_sha1(m_content)
+        );
+        EXPECT_EQ(
+            m_options.digest_cache->lookup(
+                m_path, file_transfer::detail::checksum_algorithm::sha1
+            ),
+            get_sha1(m_content)
+        );
+    }
+
+    server_context partial{
+        {{metadata::checksum_mode_key, "streaming"},
+         {metadata::ranges_key, "0:4"}}
+    };
+    EXPECT_THROW(
+        initialize(partial), file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(download_session_test, auto_chunk_size) {
+    // Test that an adaptive chunk size is confirmed, and that the last
+    // chunk size is sent in the trailing metadata.
+    server_context context{{{metadata::chunk_size_key, "auto"}}};
+    const auto result = download(context, 4);
+    EXPECT_EQ(context.get_initial_metadata(metadata::chunk_size_key), "auto");
+    EXPECT_EQ(result.data(), m_content);
+    const auto chunk_size =
+        context.get_trailing_metadata(metadata::chunk_size_key);
+    ASSERT_TRUE(chunk_size.has_value());
+    EXPECT_GT(std::stoll(*chunk_size), 0);
+
+    server_context unknown{{{metadata::chunk_size_key, "large"}}};
+    EXPECT_THROW(
+        initialize(unknown), file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(download_session_test, read_ahead) {
+    // Test that chunks which are read ahead are sent in order, for the
+    // whole file and for ranges.
+    m_content = test_utils::make_random(100000, 1);
+    write_file(m_path, m_content);
+    m_options.io_thread_pool = std::make_shared<boost::asio::thread_pool>(2);
+    m_options.read_ahead_depth = 3;
+    {
+        server_context context;
+        EXPECT_EQ(download(context, 4096).data(), m_content);
+    }
+    server_context context{{{metadata::ranges_key, "5000:20000,0:100"}}};
+    const auto result = download(context, 4096);
+    EXPECT_EQ(
+        result.data(), m_content.substr(5000, 20000) + m_content.substr(0, 100)
+    );
+    EXPECT_EQ(result.chunks.back().progress().state(), Progress::COMPLETED);
+}
+
+} // namespace
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "exception_types.h"
+#include "filetransfer_service_operations.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+
+#include "test_utils.h"
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+namespace metadata = file_transfer::metadata;
+
+using file_transfer::Progress;
+using file_transfer::operation_impl::session;
+using test_utils::get_temporary_files;
+using test_utils::read_file;
+using test_utils::server_context;
+using test_utils::write_file;
+
+/// Context of a call which runs operations.
+auto make_context(const std::string& operation_, bool batch_)
+    -> server_context {
+    std::map<std::string, std::string> client_metadata{
+        {metadata::operation_key, operation_}
+    };
+    if (batch_) {
+        client_metadata.emplace(metadata::batch_key, "true");
+    }
+    return server_context{client_metadata};
+}
+
+auto make_initialize(const boost::filesystem::path& path_)
+    -> api::DownloadFileRequest {
+    api::DownloadFileRequest request;
+    request.mutable_initialize()->set_filename(path_.string());
+    return request;
+}
+
+auto make_finalize() -> api::DownloadFileRequest {
+    api::DownloadFileRequest request;
+    request.mutable_finalize();
+    return request;
+}
+
+/// Collect the responses until the next request is needed.
+auto get_responses(session& session_)
+    -> std::vector<api::DownloadFileResponse> {
+    std::vector<api::DownloadFileResponse> result;
+    api::DownloadFileResponse response;
+    while (session_.next_response(response)) {
+        result.push_back(response);
+    }
+    return result;
+}
+
+using operation_session_test = test_utils::temporary_directory_test<>;
+
+TEST_F(operation_session_test, remove_non_empty_directory) {
+    // Test that only empty directories are removed.
+    const auto directory = m_dir / "dir";
+    boost::filesystem::create_directories(directory / "subdir");
+    file_transfer::ServiceOptions options;
+    {
+        auto context = make_context("remove", false);
+        session operation{options, context.get()};
+        EXPECT_THROW(
+            operation.receive(make_initialize(directory)),
+            file_transfer::exceptions::failed_precondition
+        );
+    }
+    EXPECT_TRUE(boost::filesystem::exists(directory / "subdir"));
+
+    auto context = make_context("remove", false);
+    session operation{options, context.get()};
+    operation.receive(make_initialize(directory / "subdir"));
+    const auto responses = get_responses(operation);
+    ASSERT_EQ(responses.size(), 1U);
+    EXPECT_EQ(responses[0].progress().state(), Progress::COMPLETED);
+    EXPECT_TRUE(operation.finished());
+    EXPECT_FALSE(boost::filesystem::exists(directory / "subdir"));
+}
+
+TEST_F(operation_session_test, rename_over_target) {
+    // Test that a rename replaces an existing target.
+    write_file(m_dir / "source", "new content");
+    write_file(m_dir / "target", "old content");
+    file_transfer::ServiceOptions options;
+    auto context = make_context("rename", false);
+    session operation{options, context.get()};
+    operation.receive(make_initialize(m_dir / "source"));
+    // The operation waits for its target.
+    EXPECT_TRUE(get_responses(operation).empty());
+    operation.receive(make_initialize(m_dir / "target"));
+    const auto responses = get_responses(operation);
+    ASSERT_EQ(responses.size(), 1U);
+    EXPECT_EQ(responses[0].file_info().name(), (m_dir / "target").string());
+    EXPECT_FALSE(boost::filesystem::exists(m_dir / "source"));
+    EXPECT_EQ(read_file(m_dir / "target"), "new content");
+}
+
+TEST_F(operation_session_test, failed_copy_discards_temporary_file) {
+    // Test that the temporary file of a copy which could not be committed
+    // is removed.
+    write_file(m_dir / "source", "content");
+    boost::filesystem::create_directories(m_dir / "target" / "subdir");
+    file_transfer::ServiceOptions options;
+    options.atomic_uploads = true;
+    auto context = make_context("copy", false);
+    session operation{options, context.get()};
+    operation.receive(make_initialize(m_dir / "source"));
+    EXPECT_THROW(
+        operation.receive(make_initialize(m_dir / "target")),
+        file_transfer::exceptions::internal
+    );
+    EXPECT_TRUE(get_temporary_files(m_dir).empty());
+    EXPECT_TRUE(boost::filesystem::is_directory(m_dir / "target" / "subdir"));
+}
+
+TEST_F(operation_session_test, copy_onto_itself) {
+    // Test that a file is not copied onto itself, also when the copy goes
+    // through a temporary file.
+    write_file(m_dir / "source", "content");
+    for (const bool atomic_uploads : {false, true}) {
+        file_transfer::ServiceOptions options;
+        options.atomic_uploads = atomic_uploads;
+        auto context = make_context("copy", false);
+        session operation{options, context.get()};
+        operation.receive(make_initialize(m_dir / "source"));
+        EXPECT_THROW(
+            operation.receive(make_initialize(m_dir / "source")),
+            file_transfer::exceptions::invalid_argument
+        );
+        EXPECT_EQ(read_file(m_dir / "source"), "content");
+    }
+    EXPECT_TRUE(get_temporary_files(m_dir).empty());
+}
+
+TEST_F(operation_session_test, batch_errors) {
+    // Test that failed operations of a batch get a response with size -1,
+    // and are listed in the trailing metadata once the batch ends.
+    write_file(m_dir / "file", "content");
+    boost::filesystem::create_directories(m_dir / "dir" / "subdir");
+    file_transfer::ServiceOptions options;
+    auto context = make_context("remove", true);
+    session operation{options, context.get()};
+    const std::vector<boost::filesystem::path> paths{
+        m_dir / "missing", m_dir / "file", m_dir / "dir"
+    };
+    std::vector<api::DownloadFileResponse> responses;
+    for (const auto& path : paths) {
+        operation.receive(make_initialize(path));
+        for (auto& response : get_responses(operation)) {
+            responses.push_back(std::move(response));
+        }
+    }
+    ASSERT_EQ(responses.size(), 3U);
+    EXPECT_EQ(responses[0].file_info().size(), -1);
+    EXPECT_EQ(responses[0].progress().state(), Progress::INITIALIZED);
+    EXPECT_EQ(responses[1].progress().state(), Progress::COMPLETED);
+    EXPECT_EQ(responses[2].file_info().size(), -1);
+    EXPECT_FALSE(operation.finished());
+    EXPECT_EQ(
+        context.get_trailing_metadata(metadata::batch_errors_key), std::nullopt
+    );
+
+    operation.receive(make_finalize());
+    const auto end = get_responses(operation);
+    ASSERT_EQ(end.size(), 1U);
+    EXPECT_EQ(end[0].progress().state(), Progress::COMPLETED);
+    EXPECT_TRUE(operation.finished());
+    EXPECT_EQ(
+        context.get_trailing_metadata(metadata::batch_errors_key), "0:5,2:9"
+    );
+    EXPECT_FALSE(boost::filesystem::exists(m_dir / "file"));
+    EXPECT_THROW(
+        operation.receive(make_initialize(m_dir / "dir")),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST_F(operation_session_test, finalize_outside_batch) {
+    // Test that only a batch of operations has a finalize step, and that
+    // a batch does not end between the source and target of a rename.
+    file_transfer::ServiceOptions options;
+    {
+        auto context = make_context("stat", false);
+        session operation{options, context.get()};
+        EXPECT_THROW(
+            operation.receive(make_finalize()),
+            file_transfer::exceptions::invalid_argument
+        );
+    }
+    auto context = make_context("rename", true);
+    session operation{options, context.get()};
+    operation.receive(make_initialize(m_dir / "source"));
+    EXPECT_THROW(
+        operation.receive(make_finalize()),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+} // namespace
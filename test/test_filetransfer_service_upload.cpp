@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "chunk_store.h"
+#include "exception_types.h"
+#include "filetransfer_service_upload.h"
+#include "service_options.h"
+#include "transfer_metadata.h"
+#include "upload_session_store.h"
+
+#include "test_utils.h"
+
+namespace {
+
+namespace api = ::ansys::api::tools::filetransfer::v1;
+namespace metadata = file_transfer::metadata;
+
+using file_transfer::upload_impl::session;
+using test_utils::get_sha1;
+using test_utils::read_file;
+
+class upload_session_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+        m_options.upload_sessions =
+            std::make_shared<file_transfer::detail::upload_session_store>(
+                m_dir / "sessions"
+            );
+        m_options.upload_checkpoint_interval = 8;
+    }
+
+    /// Context of a call of a resumable upload.
+    static auto make_call(const std::string& session_id_)
+        -> test_utils::server_context {
+        return test_utils::server_context{
+            {{metadata::upload_session_key, session_id_}}
+        };
+    }
+
+    /// Offset at which the server resumes the upload.
+    static auto resume_offset(const test_utils::server_context& call_)
+        -> std::optional<std::string> {
+        return call_.get_initial_metadata(metadata::upload_offset_key);
+    }
+
+    auto initialize(
+        session& session_, std::size_t size_, const std::string& hex_digest_
+    ) -> void {
+        api::UploadFileRequest request;
+        auto& file_info = *request.mutable_initialize()->mutable_file_info();
+        file_info.set_name(m_path.string());
+        file_info.set_size(static_cast<std::int64_t>(size_));
+        file_info.mutable_sha1()->set_hex_digest(hex_digest_);
+        api::UploadFileResponse response;
+        session_.initialize(request, response);
+        EXPECT_EQ(
+            response.progress().state(), file_transfer::Progress::INITIALIZED
+        );
+    }
+
+    static auto send(
+        session& session_, std::size_t offset_, const std::string& data_
+    ) -> void {
+        api::UploadFileRequest request;
+        auto& file_data = *request.mutable_send_data()->mutable_file_data();
+        file_data.set_offset(static_cast<std::int64_t>(offset_));
+        file_data.set_data(data_);
+        api::UploadFileResponse response;
+        session_.receive(request, response);
+    }
+
+    static auto finish(session& session_) -> api::UploadFileResponse {
+        session_.end_transfer();
+        api::UploadFileRequest request;
+        request.mutable_finalize();
+        api::UploadFileResponse response;
+        session_.finalize(request, response);
+        return response;
+    }
+
+    file_transfer::ServiceOptions m_options;
+    boost::filesystem::path m_path;
+};
+
+const std::string content = "first part, second part";
+const std::string first_part = content.substr(0, 15);
+
+TEST_F(upload_session_test, resume) {
+    // Test that an interrupted upload is checkpointed when its session is
+    // destroyed, and continues from the checkpoint with the state of the
+    // hasher restored.
+    const auto sha1 = get_sha1(content);
+    {
+        auto interrupted = make_call("session");
+        session upload{m_options, interrupted.get()};
+        initialize(upload, content.size(), sha1);
+        EXPECT_EQ(resume_offset(interrupted), "0");
+        upload.start_transfer();
+        send(upload, 0, first_part.substr(0, 6));
+        // Checkpointed after 8 bytes.
+        send(upload, 6, first_part.substr(6, 6));
+        // Only checkpointed when the upload is interrupted.
+        send(upload, 12, first_part.substr(12));
+    }
+    const auto checkpoint = m_options.upload_sessions->load("session");
+    ASSERT_TRUE(checkpoint.has_value());
+    EXPECT_EQ(checkpoint->offset, first_part.size());
+
+    auto resumed = make_call("session");
+    session upload{m_options, resumed.get()};
+    initialize(upload, content.size(), sha1);
+    EXPECT_EQ(resume_offset(resumed), std::to_string(first_part.size()));
+    upload.start_transfer();
+    send(upload, first_part.size(), content.substr(first_part.size()));
+    // The checksum only matches if the hasher continued from the
+    // checkpoint.
+    EXPECT_EQ(
+        finish(upload).progress().state(), file_transfer::Progress::COMPLETED
+    );
+    EXPECT_EQ(read_file(m_path), content);
+    EXPECT_FALSE(m_options.upload_sessions->load("session").has_value());
+}
+
+TEST_F(upload_session_test, mismatching_checkpoint) {
+    // Test that a checkpoint of another file is discarded, and the upload
+    // starts from the beginning.
+    {
+        auto interrupted = make_call("session");
+        session upload{m_options, interrupted.get()};
+        initialize(upload, content.size() + 1, get_sha1(content + "!"));
+        upload.start_transfer();
+        send(upload, 0, first_part);
+    }
+    ASSERT_TRUE(m_options.upload_sessions->load("session").has_value());
+
+    auto restarted = make_call("session");
+    session upload{m_options, restarted.get()};
+    initialize(upload, content.size(), get_sha1(content));
+    EXPECT_EQ(resume_offset(restarted), "0");
+    upload.start_transfer();
+    send(upload, 0, content);
+    EXPECT_EQ(
+        finish(upload).progress().state(), file_transfer::Progress::COMPLETED
+    );
+    EXPECT_EQ(read_file(m_path), content);
+}
+
+TEST_F(upload_session_test, chunk_store) {
+    // Test that the chunks of an upload are only stored once its checksum
+    // is verified.
+    m_options.chunk_store =
+        std::make_shared<file_transfer::detail::chunk_store>(m_dir / "store");
+    {
+        auto failed = make_call("failed");
+        session upload{m_options, failed.get()};
+        initialize(upload, content.size(), get_sha1(content + "!"));
+        upload.start_transfer();
+        send(upload, 0, content);
+        EXPECT_THROW(finish(upload), file_transfer::exceptions::data_loss);
+    }
+    EXPECT_EQ(m_options.chunk_store->num_chunks(), 0U);
+
+    auto verified = make_call("verified");
+    session upload{m_options, verified.get()};
+    initialize(upload, content.size(), get_sha1(content));
+    upload.start_transfer();
+    send(upload, 0, content);
+    EXPECT_EQ(
+        finish(upload).progress().state(), file_transfer::Progress::COMPLETED
+    );
+    EXPECT_EQ(m_options.chunk_store->num_bytes(), content.size());
+    EXPECT_TRUE(m_options.chunk_store->load_manifest(m_path).has_value());
+}
+
+TEST_F(upload_session_test, session_in_use) {
+    // Test that a session can not be used by two uploads at a time.
+    auto first = make_call("session");
+    session upload{m_options, first.get()};
+    initialize(upload, content.size(), get_sha1(content));
+
+    auto second = make_call("session");
+    session other_upload{m_options, second.get()};
+    EXPECT_THROW(
+        initialize(other_upload, content.size(), get_sha1(content)),
+        file_transfer::exceptions::failed_precondition
+    );
+}
+
+} // namespace
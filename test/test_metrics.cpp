@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "metrics.h"
+#include "metrics_endpoint.h"
+
+namespace {
+
+namespace metrics = file_transfer::metrics;
+
+class metrics_test : public ::testing::Test {
+protected:
+    void SetUp() override { metrics::enable(); }
+};
+
+TEST(metrics, bucket_index) {
+    EXPECT_EQ(metrics::bucket_index(0), 0U);
+    EXPECT_EQ(metrics::bucket_index(1024), 0U);
+    EXPECT_EQ(metrics::bucket_index(1025), 1U);
+    EXPECT_EQ(metrics::bucket_index(4096), 1U);
+    EXPECT_EQ(metrics::bucket_index(4097), 2U);
+    for (std::size_t i = 0; i + 1 < metrics::num_buckets; ++i) {
+        EXPECT_EQ(metrics::bucket_index(metrics::bucket_upper_bound(i)), i);
+    }
+    EXPECT_EQ(
+        metrics::bucket_index(std::uint64_t{1} << 40), metrics::num_buckets - 1
+    );
+}
+
+TEST_F(metrics_test, totals_of_all_threads) {
+    // Test that the counters of running and exited threads are summed.
+    const auto before = metrics::collect();
+    const std::size_t num_threads = 4;
+    const std::uint64_t num_chunks = 1000;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&]() {
+            const metrics::stream_tracker tracker{metrics::direction::upload};
+            for (std::uint64_t j = 0; j < num_chunks; ++j) {
+                metrics::add_bytes(metrics::direction::upload, 10);
+                metrics::record(
+                    metrics::phase::disk_write, std::chrono::microseconds{2}
+                );
+            }
+            metrics::count_error(::grpc::StatusCode::DATA_LOSS);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const metrics::stream_tracker tracker{metrics::direction::download};
+    metrics::add_bytes(metrics::direction::download, 7);
+
+    const auto after = metrics::collect();
+    const auto upload = static_cast<std::size_t>(metrics::direction::upload);
+    const auto download =
+        static_cast<std::size_t>(metrics::direction::download);
+    EXPECT_EQ(
+        after.bytes[upload] - before.bytes[upload],
+        num_threads * num_chunks * 10
+    );
+    EXPECT_EQ(after.bytes[download] - before.bytes[download], 7U);
+    EXPECT_EQ(
+        after.streams_started[upload] - before.streams_started[upload],
+        num_threads
+    );
+    EXPECT_EQ(
+        after.streams_finished[upload] - before.streams_finished[upload],
+        num_threads
+    );
+    EXPECT_EQ(
+        after.streams_started[download] - after.streams_finished[download],
+        before.streams_started[download] - before.streams_finished[download] +
+            1
+    );
+    const auto data_loss = static_cast<std::size_t>(::grpc::DATA_LOSS);
+    EXPECT_EQ(
+        after.errors[data_loss] - before.errors[data_loss], num_threads
+    );
+    const auto& disk_write =
+        after.phases[static_cast<std::size_t>(metrics::phase::disk_write)];
+    const auto& disk_write_before =
+        before.phases[static_cast<std::size_t>(metrics::phase::disk_write)];
+    EXPECT_EQ(
+        disk_write.count() - disk_write_before.count(),
+        num_threads * num_chunks
+    );
+    EXPECT_EQ(
+        disk_write.buckets[1] - disk_write_before.buckets[1],
+        num_threads * num_chunks
+    );
+    EXPECT_EQ(
+        disk_write.sum - disk_write_before.sum, num_threads * num_chunks * 2000
+    );
+}
+
+TEST(metrics, prometheus_text) {
+    metrics::snapshot snapshot;
+    snapshot.bytes[static_cast<std::size_t>(metrics::direction::download)] =
+        42;
+    snapshot.streams_started[0] = 3;
+    snapshot.streams_finished[0] = 1;
+    snapshot.errors[static_cast<std::size_t>(::grpc::NOT_FOUND)] = 5;
+    auto& hashing =
+        snapshot.phases[static_cast<std::size_t>(metrics::phase::hashing)];
+    hashing.buckets[0] = 1;
+    hashing.buckets[2] = 2;
+    hashing.sum = 1500000000;
+
+    const auto text = metrics::to_prometheus_text(snapshot);
+    for (const auto* line :
+         {"# TYPE file_transfer_bytes_total counter\n",
+          "file_transfer_bytes_total{direction=\"download\"} 42\n",
+          "file_transfer_active_streams{direction=\"upload\"} 2\n",
+          "file_transfer_errors_total{code=\"NOT_FOUND\"} 5\n",
+          "# TYPE file_transfer_phase_seconds histogram\n",
+          "file_transfer_phase_seconds_bucket{phase=\"hashing\",le="
+          "\"1.024e-06\"} 1\n",
+          "file_transfer_phase_seconds_bucket{phase=\"hashing\",le="
+          "\"4.096e-06\"} 1\n",
+          "file_transfer_phase_seconds_bucket{phase=\"hashing\",le="
+          "\"1.6384e-05\"} 3\n",
+          "file_transfer_phase_seconds_bucket{phase=\"hashing\",le="
+          "\"+Inf\"} 3\n",
+          "file_transfer_phase_seconds_sum{phase=\"hashing\"} 1.5\n",
+          "file_transfer_phase_seconds_count{phase=\"hashing\"} 3\n"}) {
+        EXPECT_NE(text.find(line), std::string::npos) << line;
+    }
+    // OK is not an error.
+    EXPECT_EQ(text.find("code=\"OK\""), std::string::npos);
+}
+
+auto http_get(std::uint16_t port_, const std::string& target_)
+    -> std::string {
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::socket socket{io_context};
+    socket.connect({boost::asio::ip::make_address("127.0.0.1"), port_});
+    const auto request =
+        "GET " + target_ + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(request));
+    std::string response;
+    boost::system::error_code error;
+    boost::asio::read(socket, boost::asio::dynamic_buffer(response), error);
+    return response;
+}
+
+TEST_F(metrics_test, http_endpoint) {
+    const metrics::http_endpoint endpoint{"127.0.0.1", 0};
+    ASSERT_NE(endpoint.port(), 0);
+
+    const auto response = http_get(endpoint.port(), "/metrics");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0U);
+    EXPECT_NE(
+        response.find("file_transfer_bytes_total{direction=\"upload\"}"),
+        std::string::npos
+    );
+    const auto not_found = http_get(endpoint.port(), "/other");
+    EXPECT_EQ(not_found.rfind("HTTP/1.1 404 Not Found\r\n", 0), 0U);
+}
+
+TEST_F(metrics_test, http_endpoint_idle_connections) {
+    // Test that idle connections are limited, and closed after a timeout.
+    const metrics::http_endpoint endpoint{"127.0.0.1", 0};
+    boost::asio::io_context io_context;
+    const auto connect = [&]() {
+        boost::asio::ip::tcp::socket socket{io_context};
+        socket.connect(
+            {boost::asio::ip::make_address("127.0.0.1"), endpoint.port()}
+        );
+        return socket;
+    };
+    const auto read_all = [](boost::asio::ip::tcp::socket& socket_) {
+        std::string data;
+        boost::system::error_code error;
+        boost::asio::read(socket_, boost::asio::dynamic_buffer(data), error);
+        return error;
+    };
+    std::vector<boost::asio::ip::tcp::socket> idle;
+    for (int i = 0; i < 16; ++i) {
+        idle.push_back(connect());
+    }
+    auto rejected = connect();
+    EXPECT_EQ(read_all(rejected), boost::asio::error::eof);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(read_all(idle.front()), boost::asio::error::eof);
+    EXPECT_LT(
+        std::chrono::steady_clock::now() - start, std::chrono::seconds{10}
+    );
+    idle.clear();
+    // Wait until the endpoint noticed that the connections are closed.
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    EXPECT_EQ(
+        http_get(endpoint.port(), "/metrics").rfind("HTTP/1.1 200 OK\r\n", 0),
+        0U
+    );
+}
+
+} // namespace
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <ios>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "page_cache.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::page_cache_mode;
+using test_utils::read_file;
+
+class page_cache_test : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+    }
+
+    boost::filesystem::path m_path;
+};
+
+TEST(page_cache_mode, from_string) {
+    EXPECT_EQ(
+        file_transfer::detail::page_cache_mode_from_string("keep"),
+        page_cache_mode::keep
+    );
+    EXPECT_EQ(
+        file_transfer::detail::page_cache_mode_from_string("drop-behind"),
+        page_cache_mode::drop_behind
+    );
+    EXPECT_EQ(
+        file_transfer::detail::page_cache_mode_from_string("direct"),
+        page_cache_mode::direct
+    );
+    EXPECT_THROW(
+        file_transfer::detail::page_cache_mode_from_string("none"),
+        std::invalid_argument
+    );
+}
+
+TEST_F(page_cache_test, preallocate_keeps_size) {
+    // Test that preallocating a file does not change its size or content.
+    test_utils::write_file(m_path, "0123456789");
+    file_transfer::detail::preallocate_file(m_path, std::uint64_t{1} << 20);
+    EXPECT_EQ(boost::filesystem::file_size(m_path), 10);
+    EXPECT_EQ(read_file(m_path), "0123456789");
+}
+
+TEST_F(page_cache_test, drop_behind_keeps_content) {
+    // Test that dropping the written pages does not affect the file.
+    std::string expected;
+    {
+        boost::filesystem::ofstream out_file{m_path, std::ios_base::binary};
+        file_transfer::detail::drop_behind dropper{m_path, 0, 8192};
+        for (int i = 0; i < 10; ++i) {
+            const std::string chunk(3000, static_cast<char>('a' + i));
+            out_file << chunk;
+            expected += chunk;
+            if (dropper.window_complete(expected.size())) {
+                out_file.flush();
+                dropper.on_flushed(expected.size());
+            }
+        }
+        out_file.flush();
+        dropper.on_flushed(expected.size());
+        dropper.finish();
+    }
+    EXPECT_EQ(read_file(m_path), expected);
+}
+
+} // namespace
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "exception_types.h"
+#include "parallel_upload.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::byte_coverage;
+using file_transfer::detail::parallel_upload_registry;
+
+TEST(byte_coverage, out_of_order) {
+    // Test that ranges added in arbitrary order are merged.
+    byte_coverage coverage;
+    EXPECT_TRUE(coverage.covers(10, 0));
+    EXPECT_FALSE(coverage.covers(0, 1));
+
+    coverage.add(20, 10);
+    coverage.add(0, 10);
+    EXPECT_EQ(coverage.num_bytes(), 20);
+    EXPECT_TRUE(coverage.covers(0, 10));
+    EXPECT_TRUE(coverage.covers(22, 5));
+    EXPECT_FALSE(coverage.covers(5, 20));
+
+    coverage.add(10, 10);
+    EXPECT_EQ(coverage.num_bytes(), 30);
+    EXPECT_TRUE(coverage.covers(0, 30));
+    EXPECT_FALSE(coverage.covers(0, 31));
+}
+
+TEST(byte_coverage, overlapping) {
+    // Test that bytes which are written twice are counted once.
+    byte_coverage coverage;
+    coverage.add(0, 10);
+    coverage.add(5, 10);
+    coverage.add(40, 10);
+    coverage.add(30, 30);
+    coverage.add(2, 3);
+    EXPECT_EQ(coverage.num_bytes(), 45);
+    EXPECT_TRUE(coverage.covers(0, 15));
+    EXPECT_TRUE(coverage.covers(30, 30));
+    EXPECT_FALSE(coverage.covers(14, 17));
+}
+
+class parallel_upload_registry_test
+    : public test_utils::temporary_directory_test<> {
+protected:
+    void SetUp() override {
+        temporary_directory_test::SetUp();
+        m_path = m_dir / "file";
+    }
+
+    boost::filesystem::path m_path;
+};
+
+TEST_F(parallel_upload_registry_test, shared_upload) {
+    // Test that streams uploading the same file share its state, until
+    // the upload is complete.
+    parallel_upload_registry registry;
+    const auto first = registry.attach(m_path, 100);
+    EXPECT_EQ(boost::filesystem::file_size(m_path), 100);
+    first->add(0, 50);
+    EXPECT_FALSE(first->complete());
+
+    const auto second = registry.attach(m_path, 100);
+    EXPECT_EQ(first, second);
+    EXPECT_THROW(
+        registry.attach(m_path, 200),
+        file_transfer::exceptions::failed_precondition
+    );
+    EXPECT_EQ(second->add(50, 50), 100);
+    EXPECT_TRUE(first->complete());
+
+    registry.release(m_path, first);
+    EXPECT_NE(registry.attach(m_path, 100), first);
+}
+
+TEST_F(parallel_upload_registry_test, idle_upload) {
+    // Test that an incomplete upload is kept while no stream is attached,
+    // and replaced if the file size changes.
+    parallel_upload_registry registry;
+    registry.attach(m_path, 100)->add(0, 10);
+    EXPECT_EQ(registry.attach(m_path, 100)->num_bytes_written(), 10);
+    EXPECT_EQ(registry.attach(m_path, 50)->num_bytes_written(), 0);
+    EXPECT_EQ(boost::filesystem::file_size(m_path), 50);
+}
+
+TEST_F(parallel_upload_registry_test, evict_idle) {
+    // Test that only a limited number of idle uploads is kept.
+    parallel_upload_registry registry{1};
+    const auto other_path = m_dir / "other-file";
+    registry.attach(m_path, 100)->add(0, 10);
+    registry.attach(other_path, 100);
+    EXPECT_EQ(registry.attach(m_path, 100)->num_bytes_written(), 0);
+}
+
+TEST_F(parallel_upload_registry_test, digest_computed_once) {
+    // Test that the checksum of the complete file is computed only once.
+    parallel_upload_registry registry;
+    const auto upload = registry.attach(m_path, 0);
+    int num_calls = 0;
+    const auto compute = [&]() {
+        ++num_calls;
+        return std::string{"digest"};
+    };
+    EXPECT_EQ(upload->get_hex_digest(compute), "digest");
+    EXPECT_EQ(upload->get_hex_digest(compute), "digest");
+    EXPECT_EQ(num_calls, 1);
+}
+
+TEST_F(parallel_upload_registry_test, expected_digest) {
+    // Test that all streams of an upload must expect the same checksum.
+    parallel_upload_registry registry;
+    const auto upload = registry.attach(m_path, 100, false, "sha1", "digest");
+    upload->check_expected_digest("sha1", "digest");
+    EXPECT_THROW(
+        upload->check_expected_digest("sha1", "other"),
+        file_transfer::exceptions::failed_precondition
+    );
+    EXPECT_THROW(
+        upload->check_expected_digest("blake3", "digest"),
+        file_transfer::exceptions::failed_precondition
+    );
+    EXPECT_THROW(
+        upload->check_expected_digest("sha1", ""),
+        file_transfer::exceptions::failed_precondition
+    );
+
+    const auto unverified = registry.attach(m_dir / "other-file", 100);
+    unverified->check_expected_digest("sha1", "");
+    unverified->check_expected_digest("blake3", "");
+    EXPECT_THROW(
+        unverified->check_expected_digest("sha1", "digest"),
+        file_transfer::exceptions::failed_precondition
+    );
+}
+
+TEST_F(parallel_upload_registry_test, idle_upload_other_digest) {
+    // Test that an idle upload which expects another checksum is replaced,
+    // while an attached one is kept.
+    parallel_upload_registry registry;
+    registry.attach(m_path, 100, false, "sha1", "digest")->add(0, 10);
+    EXPECT_EQ(
+        registry.attach(m_path, 100, false, "sha1", "digest")
+            ->num_bytes_written(),
+        10
+    );
+    const auto upload = registry.attach(m_path, 100, false, "sha1", "other");
+    EXPECT_EQ(upload->num_bytes_written(), 0);
+    upload->add(0, 10);
+    EXPECT_THROW(
+        registry.attach(m_path, 100, false, "sha1", "digest"),
+        file_transfer::exceptions::failed_precondition
+    );
+    EXPECT_THROW(
+        registry.attach(m_path, 100),
+        file_transfer::exceptions::failed_precondition
+    );
+    EXPECT_EQ(
+        registry.attach(m_path, 100, false, "sha1", "other")
+            ->num_bytes_written(),
+        10
+    );
+}
+
+TEST_F(parallel_upload_registry_test, atomic_upload) {
+    // Test that an atomic upload writes to a temporary file, which is
+    // committed once, or removed with the upload.
+    parallel_upload_registry registry;
+    auto upload = registry.attach(m_path, 100, true);
+    const auto write_path = upload->write_path();
+    EXPECT_NE(write_path, m_path);
+    EXPECT_EQ(boost::filesystem::file_size(write_path), 100);
+    EXPECT_FALSE(boost::filesystem::exists(m_path));
+    int num_calls = 0;
+    upload->commit([&]() { ++num_calls; });
+    upload->commit([&]() { ++num_calls; });
+    EXPECT_EQ(num_calls, 1);
+
+    registry.release(m_path, upload);
+    upload = registry.attach(m_path, 100, true);
+    const auto other_write_path = upload->write_path();
+    registry.release(m_path, upload);
+    upload.reset();
+    EXPECT_FALSE(boost::filesystem::exists(other_write_path));
+}
+
+} // namespace
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "path_filter.h"
+
+namespace {
+
+using file_transfer::detail::glob_match;
+using file_transfer::detail::path_filter;
+
+TEST(glob_match, wildcards) {
+    // Test that "*" and "?" do not match the separator.
+    EXPECT_TRUE(glob_match("*.txt", "a.txt"));
+    EXPECT_TRUE(glob_match("*.txt", ".txt"));
+    EXPECT_FALSE(glob_match("*.txt", "a.txt.bak"));
+    EXPECT_FALSE(glob_match("*.txt", "dir/a.txt"));
+    EXPECT_TRUE(glob_match("a?c", "abc"));
+    EXPECT_FALSE(glob_match("a?c", "a/c"));
+    EXPECT_FALSE(glob_match("a?c", "ac"));
+    EXPECT_TRUE(glob_match("dir/*/x", "dir/sub/x"));
+    EXPECT_FALSE(glob_match("dir/*/x", "dir/a/b/x"));
+}
+
+TEST(glob_match, double_star) {
+    // Test that "**" matches across directories, and that "**/" also
+    // matches no directory.
+    EXPECT_TRUE(glob_match("**", "a/b/c"));
+    EXPECT_TRUE(glob_match("results/**", "results/a/b.h5"));
+    EXPECT_TRUE(glob_match("results/**/*.h5", "results/b.h5"));
+    EXPECT_TRUE(glob_match("results/**/*.h5", "results/x/y/b.h5"));
+    EXPECT_FALSE(glob_match("results/**/*.h5", "results/x/b.h5.tmp"));
+    EXPECT_FALSE(glob_match("results/**/*.h5", "other/b.h5"));
+    EXPECT_TRUE(glob_match("**/b", "b"));
+    EXPECT_FALSE(glob_match("**/b", "ab"));
+}
+
+TEST(glob_match, sets_and_escapes) {
+    // Test character sets, negated sets, and escaped characters.
+    EXPECT_TRUE(glob_match("file[0-9].txt", "file7.txt"));
+    EXPECT_FALSE(glob_match("file[0-9].txt", "fileA.txt"));
+    EXPECT_TRUE(glob_match("file[!0-9].txt", "fileA.txt"));
+    EXPECT_FALSE(glob_match("file[!0-9].txt", "file7.txt"));
+    EXPECT_TRUE(glob_match("[]]", "]"));
+    EXPECT_TRUE(glob_match("a[", "a["));
+    EXPECT_TRUE(glob_match("\\*", "*"));
+    EXPECT_FALSE(glob_match("\\*", "a"));
+    EXPECT_FALSE(glob_match("a[/]b", "a/b"));
+}
+
+TEST(path_filter, default_includes_all) {
+    // Test that a filter without patterns includes all entries.
+    const path_filter filter;
+    EXPECT_TRUE(filter.includes_file("a/b/c.txt"));
+    EXPECT_TRUE(filter.includes_directory("a/b"));
+}
+
+TEST(path_filter, include_and_exclude) {
+    // Test that patterns without a separator match the name at any depth,
+    // and that patterns with a separator match the relative path.
+    const path_filter filter{{"*.rst", "results/**/*.h5"}, {"tmp*", ".git"}};
+    EXPECT_TRUE(filter.includes_file("index.rst"));
+    EXPECT_TRUE(filter.includes_file("doc/source/intro.rst"));
+    EXPECT_TRUE(filter.includes_file("results/run1/out.h5"));
+    EXPECT_FALSE(filter.includes_file("other/out.h5"));
+    EXPECT_FALSE(filter.includes_file("doc/tmp_notes.rst"));
+    EXPECT_FALSE(filter.includes_file("readme.md"));
+
+    EXPECT_TRUE(filter.includes_directory("results"));
+    EXPECT_FALSE(filter.includes_directory(".git"));
+    EXPECT_FALSE(filter.includes_directory("doc/tmp"));
+}
+
+TEST(path_filter, leading_separator) {
+    // Test that a leading separator anchors a pattern at the root.
+    const path_filter filter{{}, {"/build"}};
+    EXPECT_FALSE(filter.includes_directory("build"));
+    EXPECT_TRUE(filter.includes_directory("src/build"));
+}
+
+} // namespace
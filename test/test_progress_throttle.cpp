@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "exception_types.h"
+#include "progress_throttle.h"
+
+namespace {
+
+using file_transfer::detail::parse_progress_cadence;
+using file_transfer::detail::progress_throttle;
+using namespace std::chrono_literals;
+
+TEST(progress_throttle, default_cadence) {
+    // Test that by default, the progress of every chunk is reported.
+    progress_throttle throttle;
+    const auto now = progress_throttle::clock_t_::now();
+    EXPECT_TRUE(throttle.on_chunk(0, now));
+    EXPECT_TRUE(throttle.on_chunk(0, now));
+}
+
+TEST(progress_throttle, chunks) {
+    // Test that the progress is reported every n chunks.
+    const auto now = progress_throttle::clock_t_::now();
+    progress_throttle throttle{parse_progress_cadence("3"), now};
+    EXPECT_FALSE(throttle.on_chunk(10, now));
+    EXPECT_FALSE(throttle.on_chunk(20, now));
+    EXPECT_TRUE(throttle.on_chunk(30, now));
+    EXPECT_FALSE(throttle.on_chunk(40, now));
+}
+
+TEST(progress_throttle, percent_and_interval) {
+    // Test that the progress is reported when either the percentage or
+    // the time interval is reached.
+    const auto start = progress_throttle::clock_t_::now();
+    progress_throttle throttle{parse_progress_cadence("10%,100ms"), start};
+    EXPECT_FALSE(throttle.on_chunk(5, start));
+    EXPECT_TRUE(throttle.on_chunk(10, start));
+    EXPECT_FALSE(throttle.on_chunk(19, start + 50ms));
+    EXPECT_TRUE(throttle.on_chunk(19, start + 100ms));
+    EXPECT_FALSE(throttle.on_chunk(28, start + 150ms));
+    EXPECT_TRUE(throttle.on_chunk(29, start + 150ms));
+}
+
+TEST(progress_throttle, parse) {
+    // Test that the criteria are parsed, and malformed ones rejected.
+    const auto cadence = parse_progress_cadence("64,5%,250ms");
+    EXPECT_EQ(cadence.chunks, 64);
+    EXPECT_EQ(cadence.percent, 5);
+    EXPECT_EQ(cadence.interval, 250ms);
+    EXPECT_EQ(parse_progress_cadence("1000%").percent, 100);
+    for (const auto* value : {"", "0", "5,", "ms", "10s", "-1", "1%%"}) {
+        EXPECT_THROW(
+            parse_progress_cadence(value),
+            file_transfer::exceptions::invalid_argument
+        ) << value;
+    }
+}
+
+} // namespace
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "chunk_compression.h"
+#include "file_io.h"
+#include "read_ahead.h"
+
+namespace {
+
+using file_transfer::detail::read_ahead;
+
+/**
+ * Reader of a virtual file in which each byte is its offset modulo 256.
+ * Reads fail past the given size, and can be slowed down.
+ */
+class fake_reader final : public file_transfer::detail::file_reader {
+public:
+    explicit fake_reader(
+        std::uint64_t file_size_,
+        std::chrono::milliseconds delay_ = std::chrono::milliseconds{0}
+    )
+        : m_file_size{file_size_}, m_delay{delay_} {}
+
+    auto read(std::uint64_t offset_, std::size_t size_, std::string& target_)
+        -> void override {
+        // The reads of one download must not overlap.
+        EXPECT_EQ(m_num_active.fetch_add(1), 0);
+        std::this_thread::sleep_for(m_delay);
+        ++num_reads;
+        m_num_active.fetch_sub(1);
+        if (offset_ + size_ > m_file_size) {
+            throw std::runtime_error("read past the end");
+        }
+        target_.resize(size_);
+        for (std::size_t i = 0; i < size_; ++i) {
+            target_[i] = static_cast<char>((offset_ + i) % 256);
+        }
+    }
+
+    std::atomic<int> num_reads{0};
+
+private:
+    std::uint64_t m_file_size;
+    std::chrono::milliseconds m_delay;
+    std::atomic<int> m_num_active{0};
+};
+
+auto expected_chunk(std::uint64_t offset_, std::size_t size_) -> std::string {
+    std::string chunk(size_, '\0');
+    for (std::size_t i = 0; i < size_; ++i) {
+        chunk[i] = static_cast<char>((offset_ + i) % 256);
+    }
+    return chunk;
+}
+
+TEST(read_ahead, chunks_in_order) {
+    // Test that chunks are returned in the order they are scheduled.
+    boost::asio::thread_pool pool{4};
+    auto reader = std::make_shared<fake_reader>(10000);
+    read_ahead stage{reader, pool};
+    for (std::uint64_t offset : {0, 5000, 1000, 9000}) {
+        stage.schedule(offset, 1000);
+    }
+    EXPECT_EQ(stage.num_scheduled(), 4);
+
+    std::string chunk;
+    for (std::uint64_t offset : {0, 5000, 1000}) {
+        EXPECT_EQ(stage.take(chunk), offset);
+        EXPECT_EQ(chunk, expected_chunk(offset, 1000));
+    }
+    // Buffers of taken chunks are reused for later ones.
+    stage.schedule(2000, 10);
+    EXPECT_EQ(stage.take(chunk), 9000);
+    EXPECT_EQ(stage.take(chunk), 2000);
+    EXPECT_EQ(chunk, expected_chunk(2000, 10));
+    EXPECT_EQ(stage.num_scheduled(), 0);
+}
+
+TEST(read_ahead, error) {
+    // Test that errors of a read are raised when its chunk is taken.
+    boost::asio::thread_pool pool{2};
+    read_ahead stage{std::make_shared<fake_reader>(100), pool};
+    stage.schedule(0, 100);
+    stage.schedule(50, 100);
+    std::string chunk;
+    EXPECT_EQ(stage.take(chunk), 0);
+    EXPECT_THROW(stage.take(chunk), std::runtime_error);
+}
+
+TEST(read_ahead, destroy_while_reading) {
+    // Test that pending reads are skipped when the stage is destroyed.
+    boost::asio::thread_pool pool{1};
+    auto reader =
+        std::make_shared<fake_reader>(100, std::chrono::milliseconds{20});
+    {
+        read_ahead stage{reader, pool};
+        for (int i = 0; i < 10; ++i) {
+            stage.schedule(0, 10);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    EXPECT_LT(reader->num_reads, 10);
+}
+
+TEST(read_ahead, compressed_chunks) {
+    // Test that each chunk is returned with its compressed frame.
+    boost::asio::thread_pool pool{4};
+    const file_transfer::detail::chunk_codec codec{{}};
+    read_ahead stage{std::make_shared<fake_reader>(100000), pool, &codec};
+    for (std::uint64_t offset : {0, 40000, 20000}) {
+        stage.schedule(offset, 20000);
+    }
+    std::string chunk;
+    std::string frame;
+    std::string decoded;
+    for (std::uint64_t offset : {0, 40000, 20000}) {
+        EXPECT_EQ(stage.take(chunk, frame), offset);
+        EXPECT_EQ(chunk, expected_chunk(offset, 20000));
+        EXPECT_LT(frame.size(), chunk.size());
+        codec.decode(frame, decoded);
+        EXPECT_EQ(decoded, chunk);
+    }
+}
+
+} // namespace
@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <boost/uuid/detail/sha1.hpp>
+
+#include "checksum.h"
 #include "sha1_digest.h"
 
 #include "test_utils.h"
@@ -10,7 +19,9 @@ TEST(sha, emptyfile) {
     // Test the SHA1 hex digest of an empty file.
     const auto empty_file = test_utils::get_test_data_dir() / "empty-file";
     const auto sha1_digest_res =
-        file_transfer::detail::get_sha1_hex_digest(empty_file);
+        file_transfer::detail::get_hex_digest(
+            empty_file, file_transfer::detail::checksum_algorithm::sha1
+        );
     EXPECT_EQ(sha1_digest_res, "da39a3ee5e6b4b0d3255bfef95601890afd80709");
 }
 
@@ -19,8 +30,63 @@ TEST(sha, nonemptyfile) {
     const auto non_empty_file =
         test_utils::get_test_data_dir() / "non-empty-file";
     const auto sha1_digest_res =
-        file_transfer::detail::get_sha1_hex_digest(non_empty_file);
+        file_transfer::detail::get_hex_digest(
+            non_empty_file, file_transfer::detail::checksum_algorithm::sha1
+        );
     EXPECT_EQ(sha1_digest_res, "2817cb94c81232aa658716f369baf775c9707b11");
 }
 
+TEST(sha, incremental) {
+    // Test that the digest does not depend on how the data is split up.
+    const std::string data(10000, 'a');
+    file_transfer::detail::sha1_hasher whole{};
+    whole.update(data.data(), data.size());
+
+    file_transfer::detail::sha1_hasher pieces{};
+    for (std::size_t offset = 0; offset < data.size(); offset += 777) {
+        pieces.update(
+            data.data() + offset,
+            std::min<std::size_t>(777, data.size() - offset)
+        );
+    }
+    const auto pieces_digest = pieces.hex_digest();
+    EXPECT_EQ(whole.hex_digest(), pieces_digest);
+    EXPECT_EQ(pieces_digest, "a080cbda64850abb7b7f67ee875ba068074ff6fe");
+}
+
+auto get_reference_hex_digest(const std::string& data_) -> std::string {
+    boost::uuids::detail::sha1 sha_value{};
+    sha_value.process_bytes(data_.data(), data_.size());
+    boost::uuids::detail::sha1::digest_type res_int;
+    sha_value.get_digest(res_int);
+    std::stringstream res_stream;
+    res_stream << std::hex;
+    for (const auto& elem : res_int) {
+        res_stream << std::setfill('0') << std::setw(8) << elem;
+    }
+    return res_stream.str();
+}
+
+TEST(sha, kernels) {
+    // Test that all supported kernels match the reference implementation,
+    // for sizes around the block and padding boundaries.
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 255};
+    std::string data(3 * 64 + 1, '\0');
+    for (auto& elem : data) {
+        elem = static_cast<char>(distribution(generator));
+    }
+
+    for (const auto& kernel :
+         file_transfer::detail::get_supported_sha1_kernels()) {
+        for (std::size_t size = 0; size <= data.size(); ++size) {
+            const auto input = data.substr(0, size);
+            file_transfer::detail::sha1_hasher hasher{kernel};
+            hasher.update(input.data(), input.size());
+            EXPECT_EQ(hasher.hex_digest(), get_reference_hex_digest(input))
+                << "kernel: " << kernel.name << ", size: " << size;
+        }
+    }
+}
+
 } // namespace
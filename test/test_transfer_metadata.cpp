@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "exception_types.h"
+#include "transfer_metadata.h"
+
+namespace {
+
+using file_transfer::metadata::byte_range;
+using file_transfer::metadata::get_stripe_range;
+using file_transfer::metadata::parse_byte_ranges;
+using file_transfer::metadata::select_compression;
+
+auto expect_ranges(
+    const std::vector<byte_range>& ranges_,
+    const std::vector<byte_range>& expected_
+) -> void {
+    ASSERT_EQ(ranges_.size(), expected_.size());
+    for (std::size_t i = 0; i < ranges_.size(); ++i) {
+        EXPECT_EQ(ranges_[i].offset, expected_[i].offset);
+        EXPECT_EQ(ranges_[i].length, expected_[i].length);
+    }
+}
+
+TEST(transfer_metadata, parse_byte_ranges) {
+    // Test that ranges are parsed in the given order.
+    expect_ranges(parse_byte_ranges("0:10", 100), {{0, 10}});
+    expect_ranges(
+        parse_byte_ranges("50:10,0:5,99:1", 100), {{50, 10}, {0, 5}, {99, 1}}
+    );
+    // An omitted length extends the range to the end of the file.
+    expect_ranges(parse_byte_ranges("30:", 100), {{30, 70}});
+    expect_ranges(parse_byte_ranges("0:", 100), {{0, 100}});
+    // Empty ranges are dropped.
+    expect_ranges(parse_byte_ranges("100:,5:0,1:1", 100), {{1, 1}});
+    EXPECT_EQ(file_transfer::metadata::to_string({{50, 10}, {0, 5}}), "50:10,0:5");
+}
+
+TEST(transfer_metadata, parse_invalid_byte_ranges) {
+    // Test that malformed ranges, and ranges past the end of the file,
+    // are rejected.
+    for (const auto* value : {"", "10", "a:1", "1:b", "-1:1", "0:10,", "0:101",
+                              "101:", "50:51"}) {
+        EXPECT_THROW(
+            parse_byte_ranges(value, 100),
+            file_transfer::exceptions::invalid_argument
+        ) << value;
+    }
+}
+
+TEST(transfer_metadata, stripes) {
+    // Test that the stripes cover the file at chunk boundaries, without
+    // gaps or overlaps.
+    for (const std::uint64_t file_size : {0, 1, 999, 1000, 1001, 10'000}) {
+        for (const std::uint64_t count : {1, 2, 3, 7, 20}) {
+            std::uint64_t next_offset = 0;
+            for (std::uint64_t index = 0; index < count; ++index) {
+                const auto range = get_stripe_range(
+                    std::to_string(index) + "/" + std::to_string(count),
+                    file_size,
+                    100
+                );
+                EXPECT_EQ(range.offset, next_offset);
+                if (range.offset + range.length < file_size) {
+                    EXPECT_EQ(range.length % 100, 0);
+                }
+                next_offset = range.offset + range.length;
+            }
+            EXPECT_EQ(next_offset, file_size);
+        }
+    }
+    const auto range = get_stripe_range("1/3", 1000, 100);
+    EXPECT_EQ(range.offset, 400);
+    EXPECT_EQ(range.length, 300);
+}
+
+TEST(transfer_metadata, invalid_stripes) {
+    // Test that malformed stripes are rejected.
+    for (const auto* value : {"", "1", "1/", "/2", "2/2", "0/0", "a/2"}) {
+        EXPECT_THROW(
+            get_stripe_range(value, 1000, 100),
+            file_transfer::exceptions::invalid_argument
+        ) << value;
+    }
+}
+
+TEST(transfer_metadata, select_compression) {
+    // Test that the first offered algorithm which is enabled is selected,
+    // with its level clamped to the range of the algorithm.
+    using file_transfer::detail::compression_algorithm;
+    const std::vector<compression_algorithm> enabled{
+        compression_algorithm::zlib
+    };
+    const auto settings = select_compression("brotli,zlib:4", enabled);
+    ASSERT_TRUE(settings);
+    EXPECT_EQ(settings->algorithm, compression_algorithm::zlib);
+    EXPECT_EQ(settings->level, 4);
+    EXPECT_EQ(select_compression("zlib", enabled)->level, 1);
+    EXPECT_EQ(select_compression("zlib:99", enabled)->level, 9);
+    EXPECT_FALSE(select_compression("zlib", {}));
+    EXPECT_FALSE(select_compression("brotli", enabled));
+    EXPECT_THROW(
+        select_compression("zlib:fast", enabled),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+TEST(transfer_metadata, parse_delta_block_size) {
+    using file_transfer::metadata::parse_delta_block_size;
+    EXPECT_EQ(parse_delta_block_size("4096"), 4096);
+    for (const auto* value : {"", "-1", "4k", "511", "16777217"}) {
+        EXPECT_THROW(
+            parse_delta_block_size(value),
+            file_transfer::exceptions::invalid_argument
+        );
+    }
+}
+
+TEST(transfer_metadata, parse_glob_patterns) {
+    using file_transfer::metadata::parse_glob_patterns;
+    EXPECT_EQ(
+        parse_glob_patterns("*.txt,results/**"),
+        (std::vector<std::string>{"*.txt", "results/**"})
+    );
+    EXPECT_EQ(parse_glob_patterns("a"), std::vector<std::string>{"a"});
+    for (const auto* value : {"", ",", "a,", ",a", "a,,b"}) {
+        EXPECT_THROW(
+            parse_glob_patterns(value),
+            file_transfer::exceptions::invalid_argument
+        );
+    }
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <utility>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "exception_types.h"
+#include "upload_session_store.h"
+
+#include "test_utils.h"
+
+namespace {
+
+using file_transfer::detail::upload_checkpoint;
+using file_transfer::detail::upload_session_store;
+
+using test_utils::read_file;
+using test_utils::write_file;
+
+using upload_session_store_test = test_utils::temporary_directory_test<>;
+
+TEST_F(upload_session_store_test, save_load_remove) {
+    // Test that checkpoints can be stored and loaded again.
+    const upload_session_store store{m_dir};
+    EXPECT_FALSE(store.load("session").has_value());
+
+    upload_checkpoint checkpoint;
+    checkpoint.file_name = "some dir/file\nname \r\n";
+    checkpoint.file_size = 1000;
+    checkpoint.checksum_algorithm = "blake3";
+    checkpoint.source_hex_digest = "abcdef";
+    checkpoint.offset = 500;
+    checkpoint.hash_state = std::string("\0\x01\xff state", 10);
+    store.save("session", checkpoint);
+
+    const auto loaded = upload_session_store{m_dir}.load("session");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->file_name, checkpoint.file_name);
+    EXPECT_EQ(loaded->file_size, checkpoint.file_size);
+    EXPECT_EQ(loaded->checksum_algorithm, checkpoint.checksum_algorithm);
+    EXPECT_EQ(loaded->source_hex_digest, checkpoint.source_hex_digest);
+    EXPECT_EQ(loaded->offset, checkpoint.offset);
+    EXPECT_EQ(loaded->hash_state, checkpoint.hash_state);
+
+    store.remove("session");
+    EXPECT_FALSE(store.load("session").has_value());
+}
+
+TEST_F(upload_session_store_test, no_checksum) {
+    // Test a checkpoint of an upload without checksum, which is
+    // synchronized to disk.
+    const upload_session_store store{m_dir};
+    upload_checkpoint checkpoint;
+    checkpoint.file_name = "file";
+    checkpoint.file_size = 10;
+    checkpoint.offset = 5;
+    store.save("session", checkpoint, true);
+    checkpoint.offset = 8;
+    store.save("session", checkpoint, true);
+
+    const auto loaded = store.load("session");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->checksum_algorithm, "");
+    EXPECT_EQ(loaded->source_hex_digest, "");
+    EXPECT_EQ(loaded->hash_state, "");
+    EXPECT_EQ(loaded->offset, 8);
+    const boost::filesystem::directory_iterator entries{m_dir};
+    for (const auto& entry : entries) {
+        EXPECT_NE(entry.path().extension(), ".tmp");
+    }
+}
+
+TEST_F(upload_session_store_test, malformed_checkpoint) {
+    // Test that a checkpoint whose file name is cut short, or does not
+    // start with its length, is ignored.
+    const upload_session_store store{m_dir};
+    write_file(m_dir / "short.upload-session", "20 file\n10 5 - - -\n");
+    EXPECT_FALSE(store.load("short").has_value());
+    write_file(m_dir / "name.upload-session", "file\n10 5 - - -\n");
+    EXPECT_FALSE(store.load("name").has_value());
+    write_file(m_dir / "valid.upload-session", "4 file\n10 5 - - -\n");
+    ASSERT_TRUE(store.load("valid").has_value());
+    EXPECT_EQ(store.load("valid")->file_name, "file");
+}
+
+TEST_F(upload_session_store_test, exclusive_sessions) {
+    // Test that a session can only be used by one upload at a time.
+    upload_session_store store{m_dir};
+    {
+        const auto lease = store.acquire("session");
+        EXPECT_THROW(
+            static_cast<void>(store.acquire("session")),
+            file_transfer::exceptions::failed_precondition
+        );
+        EXPECT_NO_THROW(static_cast<void>(store.acquire("other")));
+    }
+    auto lease = store.acquire("session");
+    upload_session_store::lease moved{std::move(lease)};
+    EXPECT_THROW(
+        static_cast<void>(store.acquire("session")),
+        file_transfer::exceptions::failed_precondition
+    );
+    moved = upload_session_store::lease{};
+    EXPECT_NO_THROW(static_cast<void>(store.acquire("session")));
+}
+
+TEST_F(upload_session_store_test, remove_abandoned) {
+    // Test that sessions which are older than the maximum age are removed
+    // with their temporary files when the store is constructed.
+    const auto store_dir = m_dir / "sessions";
+    const auto file = m_dir / "file";
+    const auto temporary =
+        upload_session_store::get_temporary_path(file, "old");
+    {
+        const upload_session_store store{store_dir};
+        upload_checkpoint checkpoint;
+        checkpoint.file_name = file.string();
+        checkpoint.file_size = 10;
+        checkpoint.offset = 5;
+        store.save("old", checkpoint);
+        store.save("recent", checkpoint);
+    }
+    write_file(temporary, "12345");
+    write_file(file, "in place");
+    boost::filesystem::last_write_time(
+        store_dir / "old.upload-session", std::time(nullptr) - 7200
+    );
+
+    const upload_session_store store{store_dir, std::chrono::hours{1}};
+    EXPECT_FALSE(store.load("old").has_value());
+    EXPECT_FALSE(boost::filesystem::exists(temporary));
+    EXPECT_TRUE(store.load("recent").has_value());
+    EXPECT_EQ(read_file(file), "in place");
+}
+
+TEST(upload_session_store, session_ids) {
+    // Test that session ids which are not safe file names are rejected.
+    EXPECT_NO_THROW(upload_session_store::check_session_id("a-Z_09"));
+    EXPECT_THROW(
+        upload_session_store::check_session_id(""),
+        file_transfer::exceptions::invalid_argument
+    );
+    EXPECT_THROW(
+        upload_session_store::check_session_id("../file"),
+        file_transfer::exceptions::invalid_argument
+    );
+    EXPECT_THROW(
+        upload_session_store::check_session_id(std::string(129, 'a')),
+        file_transfer::exceptions::invalid_argument
+    );
+}
+
+} // namespace
@@ -1,9 +1,100 @@
 #include "test_utils.h"
 
+#include <ios>
+#include <iterator>
+#include <random>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "checksum.h"
+
 namespace test_utils {
 
 boost::filesystem::path get_test_data_dir() {
     return std::getenv("TEST_DATA_DIR");
 }
 
+boost::filesystem::path make_temporary_directory() {
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path();
+    boost::filesystem::create_directories(path);
+    return path;
+}
+
+void write_file(
+    const boost::filesystem::path& path_, const std::string& content_
+) {
+    boost::filesystem::ofstream out_file{
+        path_, std::ios_base::binary | std::ios_base::trunc
+    };
+    out_file << content_;
+}
+
+std::string read_file(const boost::filesystem::path& path_) {
+    boost::filesystem::ifstream in_file{path_, std::ios_base::binary};
+    return {
+        std::istreambuf_iterator<char>(in_file),
+        std::istreambuf_iterator<char>()
+    };
+}
+
+std::string make_random(std::size_t size_, unsigned seed_) {
+    std::mt19937 generator{seed_};
+    std::string data(size_, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(generator());
+    }
+    return data;
+}
+
+std::vector<std::string> get_temporary_files(
+    const boost::filesystem::path& directory_
+) {
+    std::vector<std::string> result;
+    const boost::filesystem::directory_iterator entries{directory_};
+    for (const auto& entry : entries) {
+        if (entry.path().extension() == ".part") {
+            result.push_back(entry.path().filename().string());
+        }
+    }
+    return result;
+}
+
+std::string get_sha1(const std::string& data_) {
+    auto hasher = file_transfer::detail::make_hasher(
+        file_transfer::detail::checksum_algorithm::sha1
+    );
+    hasher->update(data_.data(), data_.size());
+    return hasher->hex_digest();
+}
+
+server_context::server_context(
+    const std::map<std::string, std::string>& client_metadata_
+)
+    : m_spouse{&m_context} {
+    for (const auto& [key, value] : client_metadata_) {
+        m_spouse.AddClientMetadata(key, value);
+    }
+}
+
+std::optional<std::string>
+server_context::get_initial_metadata(const std::string& key_) const {
+    const auto initial_metadata = m_spouse.GetInitialMetadata();
+    const auto it = initial_metadata.find(key_);
+    if (it == initial_metadata.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<std::string>
+server_context::get_trailing_metadata(const std::string& key_) const {
+    const auto trailing_metadata = m_spouse.GetTrailingMetadata();
+    const auto it = trailing_metadata.find(key_);
+    if (it == trailing_metadata.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 } // namespace test_utils
@@ -1,11 +1,105 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include <gtest/gtest.h>
+
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <grpcpp/server_context.h>
+#include <grpcpp/test/server_context_test_spouse.h>
 
 namespace test_utils {
 
 boost::filesystem::path get_test_data_dir();
 
+/**
+ * Create an empty directory with a unique name in the temporary directory.
+ */
+boost::filesystem::path make_temporary_directory();
+
+/**
+ * Write the content of a file, replacing the file if it exists.
+ */
+void write_file(
+    const boost::filesystem::path& path_, const std::string& content_
+);
+
+/**
+ * Read the whole content of a file.
+ */
+std::string read_file(const boost::filesystem::path& path_);
+
+/**
+ * Make reproducible data which does not compress.
+ */
+std::string make_random(std::size_t size_, unsigned seed_);
+
+/**
+ * Get the names of the temporary files of uploads in a directory.
+ */
+std::vector<std::string> get_temporary_files(
+    const boost::filesystem::path& directory_
+);
+
+/**
+ * Get the SHA1 hex digest of some data.
+ */
+std::string get_sha1(const std::string& data_);
+
+/**
+ * Server context of a call, through which a session can be tested without
+ * a server.
+ */
+class server_context {
+public:
+    /**
+     * @param client_metadata_ Metadata which the client sent with the call.
+     */
+    explicit server_context(
+        const std::map<std::string, std::string>& client_metadata_ = {}
+    );
+    server_context(const server_context&) = delete;
+    server_context& operator=(const server_context&) = delete;
+
+    ::grpc::ServerContext& get() { return m_context; }
+
+    /**
+     * Get a value of the initial metadata which the server sent, if any.
+     */
+    std::optional<std::string> get_initial_metadata(const std::string& key_
+    ) const;
+
+    /**
+     * Get a value of the trailing metadata which the server sent, if any.
+     */
+    std::optional<std::string> get_trailing_metadata(const std::string& key_
+    ) const;
+
+private:
+    ::grpc::ServerContext m_context;
+    ::grpc::testing::ServerContextTestSpouse m_spouse;
+};
+
+/**
+ * Fixture which provides an empty temporary directory, which is removed
+ * with its content after each test.
+ *
+ * @tparam Base Base class of the fixture, for example
+ *      ::testing::TestWithParam<T> for parameterized tests.
+ */
+template <typename Base = ::testing::Test>
+class temporary_directory_test : public Base {
+protected:
+    void SetUp() override { m_dir = make_temporary_directory(); }
+    void TearDown() override { boost::filesystem::remove_all(m_dir); }
+
+    boost::filesystem::path m_dir;
+};
+
 } // namespace test_utils
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "exception_types.h"
+#include "write_behind.h"
+
+namespace {
+
+using file_transfer::detail::write_behind;
+
+/**
+ * Stream buffer which records the size of each write, and can fail.
+ */
+class recording_buffer final : public std::stringbuf {
+public:
+    std::vector<std::size_t> write_sizes;
+    bool fail = false;
+
+protected:
+    auto xsputn(const char* data_, std::streamsize size_)
+        -> std::streamsize override {
+        if (fail) {
+            return 0;
+        }
+        write_sizes.push_back(static_cast<std::size_t>(size_));
+        return std::stringbuf::xsputn(data_, size_);
+    }
+};
+
+auto make_data(std::size_t size_, char first_) -> std::string {
+    std::string data(size_, '\0');
+    for (std::size_t i = 0; i < size_; ++i) {
+        data[i] = static_cast<char>(first_ + static_cast<char>(i % 50));
+    }
+    return data;
+}
+
+TEST(write_behind, coalesces_aligned_blocks) {
+    // Test that small chunks are written as blocks which end at block
+    // boundaries, starting from an unaligned offset.
+    boost::asio::thread_pool pool{2};
+    recording_buffer buffer;
+    std::ostream out{&buffer};
+    std::string expected;
+    {
+        write_behind stage{out, pool, 30, 100, 2};
+        for (int i = 0; i < 20; ++i) {
+            const auto chunk = make_data(17, static_cast<char>('a' + i));
+            expected += chunk;
+            stage.write(chunk);
+        }
+        stage.flush();
+    }
+    EXPECT_EQ(buffer.str(), expected);
+    // 340 bytes from offset 30: up to 100, 200, 300, and the rest.
+    EXPECT_EQ(buffer.write_sizes, (std::vector<std::size_t>{70, 100, 100, 70}));
+}
+
+TEST(write_behind, flush_keeps_alignment) {
+    // Test that a flush in the middle of a block does not shift the
+    // later block boundaries.
+    boost::asio::thread_pool pool{1};
+    recording_buffer buffer;
+    std::ostream out{&buffer};
+    write_behind stage{out, pool, 0, 100, 1};
+    stage.write(make_data(40, 'a'));
+    stage.flush();
+    stage.write(make_data(250, 'b'));
+    stage.flush();
+    EXPECT_EQ(buffer.write_sizes, (std::vector<std::size_t>{40, 60, 100, 90}));
+    EXPECT_EQ(buffer.str(), make_data(40, 'a') + make_data(250, 'b'));
+}
+
+TEST(write_behind, large_chunks) {
+    // Test that chunks larger than the block size are split into blocks.
+    boost::asio::thread_pool pool{1};
+    recording_buffer buffer;
+    std::ostream out{&buffer};
+    write_behind stage{out, pool, 0, 64, 1};
+    const auto chunk = make_data(1000, 'x');
+    stage.write(chunk);
+    stage.write(chunk);
+    stage.flush();
+    EXPECT_EQ(buffer.str(), chunk + chunk);
+    EXPECT_EQ(buffer.write_sizes.size(), 32);
+}
+
+TEST(write_behind, error) {
+    // Test that a failed write is raised by a later call.
+    boost::asio::thread_pool pool{1};
+    recording_buffer buffer;
+    buffer.fail = true;
+    std::ostream out{&buffer};
+    write_behind stage{out, pool, 0, 10, 1};
+    stage.write(make_data(25, 'a'));
+    EXPECT_THROW(stage.flush(), file_transfer::exceptions::internal);
+}
+
+} // namespace